@@ -0,0 +1,57 @@
+#include <iostream>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/Url.h"
+#include "zypp/media/CurlHandlePool.h"
+
+using std::cout;
+using std::endl;
+using namespace zypp;
+using namespace zypp::media;
+
+BOOST_AUTO_TEST_CASE(pool_key)
+{
+  // same server, different path: same key
+  BOOST_CHECK_EQUAL( CurlHandlePool::key( Url("http://mirror.org/repo/oss") ),
+                     CurlHandlePool::key( Url("http://mirror.org/repo/non-oss?ssl_verify=no") ) );
+
+  // scheme, host, port, user or proxy differ: different key
+  std::string key( CurlHandlePool::key( Url("http://mirror.org/repo") ) );
+  BOOST_CHECK( key != CurlHandlePool::key( Url("https://mirror.org/repo") ) );
+  BOOST_CHECK( key != CurlHandlePool::key( Url("http://other.org/repo") ) );
+  BOOST_CHECK( key != CurlHandlePool::key( Url("http://mirror.org:8080/repo") ) );
+  BOOST_CHECK( key != CurlHandlePool::key( Url("http://user@mirror.org/repo") ) );
+  BOOST_CHECK( key != CurlHandlePool::key( Url("http://mirror.org/repo?proxy=proxy.org&proxyport=3128") ) );
+}
+
+BOOST_AUTO_TEST_CASE(pool_reuse)
+{
+  CurlHandlePool & pool( CurlHandlePool::instance() );
+  pool.clear();
+  CurlHandlePool::Stats before( pool.stats() );
+
+  std::string key( CurlHandlePool::key( Url("http://mirror.org/repo") ) );
+  CURL * easy = pool.get( key );
+  BOOST_REQUIRE( easy );
+  BOOST_CHECK_EQUAL( pool.stats().created, before.created + 1 );
+
+  pool.put( key, easy );
+  BOOST_CHECK_EQUAL( pool.idle(), 1U );
+
+  // other key does not get it
+  CURL * other = pool.get( CurlHandlePool::key( Url("http://other.org/repo") ) );
+  BOOST_CHECK( other != easy );
+  BOOST_CHECK_EQUAL( pool.idle(), 1U );
+
+  // same key does
+  BOOST_CHECK( pool.get( key ) == easy );
+  BOOST_CHECK_EQUAL( pool.stats().reused, before.reused + 1 );
+  BOOST_CHECK_EQUAL( pool.idle(), 0U );
+
+  pool.put( key, easy );
+  pool.put( key, other );
+  BOOST_CHECK_EQUAL( pool.idle(), 2U );
+  pool.clear();
+  BOOST_CHECK_EQUAL( pool.idle(), 0U );
+  cout << pool << endl;
+}
@@ -0,0 +1,81 @@
+#include <iostream>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/Url.h"
+#include "zypp/TmpPath.h"
+#include "zypp/media/MirrorScores.h"
+
+using std::cout;
+using std::endl;
+using namespace zypp;
+using namespace zypp::media;
+
+static const time_t now = 1400000000;
+static const time_t week = 7 * 24 * 60 * 60;
+
+BOOST_AUTO_TEST_CASE(mirror_rank)
+{
+  filesystem::TmpDir tmp;
+  MirrorScores scores( tmp / "MirrorScores" );
+
+  scores.success( "slow.org", 1000, .5, now );
+  scores.success( "medium.org", 10000, .2, now );
+  scores.success( "fast.org", 100000, .1, now );
+  BOOST_CHECK_EQUAL( scores.throughput( "fast.org" ), 100000 );
+  BOOST_CHECK_EQUAL( scores.throughput( "new.org" ), 0 );
+
+  std::vector<Url> urls;
+  urls.push_back( Url("http://slow.org/repo") );
+  urls.push_back( Url("http://new.org/repo") );
+  urls.push_back( Url("http://medium.org/repo") );
+  urls.push_back( Url("http://fast.org/repo") );
+  scores.rank( urls, now );
+  BOOST_REQUIRE_EQUAL( urls.size(), 4U );
+  BOOST_CHECK_EQUAL( urls[0].getHost(), "fast.org" );
+  // unknown mirrors rank like the median one, keeping their order
+  BOOST_CHECK_EQUAL( urls[1].getHost(), "new.org" );
+  BOOST_CHECK_EQUAL( urls[2].getHost(), "medium.org" );
+  BOOST_CHECK_EQUAL( urls[3].getHost(), "slow.org" );
+}
+
+BOOST_AUTO_TEST_CASE(mirror_failing)
+{
+  filesystem::TmpDir tmp;
+  MirrorScores scores( tmp / "MirrorScores" );
+
+  for ( unsigned i = 0; i < 4; ++i )
+    scores.failure( "bad.org", now );
+  BOOST_CHECK( scores.failing( "bad.org", now ) );
+  BOOST_CHECK( ! scores.failing( "new.org", now ) );
+  // failures decay
+  BOOST_CHECK( ! scores.failing( "bad.org", now + week ) );
+
+  std::vector<Url> urls;
+  urls.push_back( Url("http://bad.org/repo") );
+  urls.push_back( Url("http://new.org/repo") );
+  scores.rank( urls, now );
+  BOOST_REQUIRE_EQUAL( urls.size(), 1U );
+  BOOST_CHECK_EQUAL( urls[0].getHost(), "new.org" );
+
+  // at least one url is kept
+  urls.clear();
+  urls.push_back( Url("http://bad.org/repo") );
+  urls.push_back( Url("http://bad.org/other") );
+  scores.rank( urls, now );
+  BOOST_CHECK_EQUAL( urls.size(), 1U );
+}
+
+BOOST_AUTO_TEST_CASE(mirror_persistence)
+{
+  filesystem::TmpDir tmp;
+  {
+    MirrorScores scores( tmp / "MirrorScores" );
+    scores.success( "fast.org", 100000, .1, now );
+    for ( unsigned i = 0; i < 4; ++i )
+      scores.failure( "bad.org", now );
+    scores.save();
+  }
+  MirrorScores scores( tmp / "MirrorScores" );
+  BOOST_CHECK_EQUAL( scores.throughput( "fast.org" ), 100000 );
+  BOOST_CHECK( scores.failing( "bad.org", now ) );
+}
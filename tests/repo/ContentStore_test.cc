@@ -0,0 +1,85 @@
+#include <iostream>
+#include <fstream>
+#include <utime.h>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+#include "zypp/repo/ContentStore.h"
+
+using namespace std;
+using namespace zypp;
+using namespace zypp::repo;
+
+static CheckSum makeFile( const Pathname & file_r, char fill_r, unsigned size_r = 600 )
+{
+  {
+    ofstream out( file_r.c_str() );
+    out << string( size_r, fill_r );
+  }
+  return CheckSum::sha256( filesystem::checksum( file_r, CheckSum::sha256Type() ) );
+}
+
+static void setMtime( const Pathname & file_r, time_t mtime_r )
+{
+  struct utimbuf times = { mtime_r, mtime_r };
+  ::utime( file_r.c_str(), &times );
+}
+
+BOOST_AUTO_TEST_CASE(store_disabled)
+{
+  filesystem::TmpDir tmp;
+  ContentStore store( tmp / "content", 0 );
+  CheckSum sum( makeFile( tmp / "a", 'a' ) );
+
+  BOOST_CHECK( ! store.enabled() );
+  BOOST_CHECK( store.path( sum ).empty() );
+  BOOST_CHECK( ! store.insert( sum, tmp / "a" ) );
+  BOOST_CHECK( ! store.contains( sum ) );
+}
+
+BOOST_AUTO_TEST_CASE(store_provide)
+{
+  filesystem::TmpDir tmp;
+  ContentStore store( tmp / "content", ByteCount( 1, ByteCount::MB ) );
+  CheckSum sum( makeFile( tmp / "a", 'a' ) );
+
+  BOOST_CHECK( store.path( CheckSum() ).empty() );
+  BOOST_CHECK_EQUAL( store.path( sum ), tmp / "content/sha256" / sum.checksum().substr( 0, 2 ) / sum.checksum() );
+  BOOST_CHECK( ! store.provide( sum, tmp / "repo2/a" ) );
+
+  BOOST_CHECK( store.insert( sum, tmp / "a" ) );
+  BOOST_CHECK( store.contains( sum ) );
+  BOOST_CHECK( store.provide( sum, tmp / "repo2/a" ) );
+  BOOST_CHECK_EQUAL( filesystem::checksum( tmp / "repo2/a", CheckSum::sha256Type() ), sum.checksum() );
+  // all hardlinks to the same file
+  BOOST_CHECK_EQUAL( PathInfo( store.path( sum ) ).nlink(), 3U );
+  // not held by the store alone
+  BOOST_CHECK_EQUAL( store.size(), ByteCount( 0 ) );
+}
+
+BOOST_AUTO_TEST_CASE(store_evict)
+{
+  filesystem::TmpDir tmp;
+  ContentStore store( tmp / "content", ByteCount( 1, ByteCount::K ) );
+  time_t now = time( 0 );
+
+  CheckSum old( makeFile( tmp / "old", 'o' ) );
+  BOOST_CHECK( store.insert( old, tmp / "old" ) );
+  filesystem::unlink( tmp / "old" );
+  setMtime( store.path( old ), now - 100 );
+
+  CheckSum recent( makeFile( tmp / "recent", 'r' ) );
+  BOOST_CHECK( store.insert( recent, tmp / "recent" ) );
+  filesystem::unlink( tmp / "recent" );
+  BOOST_CHECK_EQUAL( store.size(), ByteCount( 1200 ) );
+
+  // still held by the repo cache, so not evicted
+  CheckSum pinned( makeFile( tmp / "pinned", 'p' ) );
+  BOOST_CHECK( store.insert( pinned, tmp / "pinned" ) );
+
+  BOOST_CHECK( ! store.contains( old ) );
+  BOOST_CHECK( store.contains( recent ) );
+  BOOST_CHECK( store.contains( pinned ) );
+  BOOST_CHECK_EQUAL( store.size(), ByteCount( 600 ) );
+}
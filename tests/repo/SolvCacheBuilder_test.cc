@@ -0,0 +1,90 @@
+#include <iostream>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/Logger.h"
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+#include "zypp/sat/Pool.h"
+#include "zypp/sat/LookupAttr.h"
+#include "zypp/repo/RepoException.h"
+#include "zypp/repo/SolvCacheBuilder.h"
+
+using namespace std;
+using namespace zypp;
+using namespace zypp::repo;
+
+#define DATADIR (Pathname(TESTS_SRC_DIR) + "/repo")
+
+BOOST_AUTO_TEST_CASE(build_rpmmd)
+{
+  filesystem::TmpDir tmp;
+  Pathname solvfile( tmp.path() / "solv" );
+
+  SolvCacheBuilder( RepoType::RPMMD, DATADIR + "/yum/data/extensions" ).build( solvfile );
+  BOOST_REQUIRE( PathInfo( solvfile ).isFile() );
+  BOOST_CHECK( ! PathInfo( solvfile.extend( ".new" ) ).isExist() );
+
+  Repository repo( sat::Pool::instance().addRepoSolv( solvfile, "rpmmd" ) );
+  BOOST_CHECK( repo.solvablesSize() > 0 );
+  BOOST_CHECK_EQUAL( repo.generatedTimestamp(), Date(1227279057) );
+  // RepoManager rebuilds solv files without toolversion
+  BOOST_CHECK( ! sat::LookupRepoAttr( sat::SolvAttr::repositoryToolVersion, repo ).begin().asString().empty() );
+  repo.eraseFromPool();
+}
+
+BOOST_AUTO_TEST_CASE(build_rpmmd_extensions)
+{
+  // data repo2solv.sh merged, too
+  filesystem::TmpDir tmp;
+  Pathname solvfile( tmp.path() / "solv" );
+
+  SolvCacheBuilder( RepoType::RPMMD, DATADIR + "/yum/data/solvcache" ).build( solvfile );
+  Repository repo( sat::Pool::instance().addRepoSolv( solvfile, "solvcache" ) );
+
+  // suseinfo
+  BOOST_CHECK_EQUAL( repo.suggestedExpirationTimestamp(), Date(1227279057 + 3600) );
+  BOOST_CHECK( repo.maybeOutdated() );
+  Repository::Keywords keywords( repo.keywords() );
+  BOOST_REQUIRE( ! keywords.empty() );
+  BOOST_CHECK_EQUAL( *keywords.begin(), "solvcache" );
+
+  bool product = false;
+  for_( it, repo.solvablesBegin(), repo.solvablesEnd() )
+  {
+    if ( it->ident() == "foo" )
+    {
+      // susedata.de
+      BOOST_CHECK_EQUAL( it->lookupStrAttribute( sat::SolvAttr::summary, Locale("de") ), "Ein Testpaket" );
+    }
+    else if ( it->ident() == "product:testproduct" )
+      product = true;
+  }
+  BOOST_CHECK( product );
+  repo.eraseFromPool();
+}
+
+BOOST_AUTO_TEST_CASE(build_susetags)
+{
+  filesystem::TmpDir tmp;
+  Pathname solvfile( tmp.path() / "solv" );
+
+  SolvCacheBuilder( RepoType::YAST2, DATADIR + "/susetags/data/stable-x86-subset" ).build( solvfile );
+  BOOST_REQUIRE( PathInfo( solvfile ).isFile() );
+
+  Repository repo( sat::Pool::instance().addRepoSolv( solvfile, "susetags" ) );
+  BOOST_CHECK( repo.solvablesSize() > 0 );
+  BOOST_CHECK( ! sat::LookupRepoAttr( sat::SolvAttr::repositoryToolVersion, repo ).begin().asString().empty() );
+  repo.eraseFromPool();
+}
+
+BOOST_AUTO_TEST_CASE(build_fails)
+{
+  filesystem::TmpDir tmp;
+  Pathname solvfile( tmp.path() / "solv" );
+
+  BOOST_CHECK_THROW( SolvCacheBuilder( RepoType::RPMMD, tmp.path() ).build( solvfile ), RepoException );
+  BOOST_CHECK_THROW( SolvCacheBuilder( RepoType::NONE, tmp.path() ).build( solvfile ), RepoUnknownTypeException );
+  BOOST_CHECK( ! PathInfo( solvfile ).isExist() );
+  BOOST_CHECK( ! PathInfo( solvfile.extend( ".new" ) ).isExist() );
+}
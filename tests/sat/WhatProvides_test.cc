@@ -1,4 +1,5 @@
 #include "TestSetup.h"
+#include "zypp/PoolQuery.h"
 
 BOOST_AUTO_TEST_CASE(WhatProvides)
 {
@@ -60,3 +61,83 @@ BOOST_AUTO_TEST_CASE(WhatProvides)
     BOOST_CHECK( a == q.begin() );
   }
 }
+
+BOOST_AUTO_TEST_CASE(WhatProvidesTable)
+{
+  // openSUSE-11.1 is still loaded; add a repo providing file lists.
+  TestSetup test( Arch_x86_64 );
+  test.loadRepo( TESTS_SRC_DIR"/data/OBS_zypp_svn-11.1", "zyppsvn" );
+
+  {
+    sat::WhatProvidesTable t;
+    BOOST_CHECK( t.empty() );
+    BOOST_CHECK_EQUAL( t.size(), 0U );
+  }
+
+  {
+    Capabilities caps( sat::WhatProvides( Capability("zypper") ).begin()->requires() );
+    BOOST_REQUIRE( ! caps.empty() );
+    sat::WhatProvidesTable t( caps );
+    BOOST_CHECK_EQUAL( t.size(), caps.size() );
+    BOOST_CHECK_EQUAL( t.offsets().size(), caps.size()+1 );
+    BOOST_CHECK_EQUAL( t.offsets().back(), t.ids().size() );
+
+    unsigned row = 0;
+    for_( it, caps.begin(), caps.end() )
+    {
+      sat::WhatProvides q( *it );
+      BOOST_CHECK_EQUAL( t.rowSize( row ), q.size() );
+      BOOST_CHECK( std::equal( q.begin(), q.end(), t.begin( row ) ) );
+      ++row;
+    }
+  }
+
+  {
+    std::vector<std::string> files;
+    files.push_back( "/usr/bin/zypper" );
+    files.push_back( "/no/such/file" );
+    files.push_back( "zypper" );
+    sat::LookupAttr q( sat::SolvAttr::filelist, sat::Pool::instance().reposFind( "zyppsvn" ) );
+    for_( it, q.begin(), q.end() )
+    {
+      files.push_back( it.asString() );
+      if ( files.size() == 20 )
+        break;
+    }
+    BOOST_REQUIRE( files.size() > 3 );
+
+    sat::WhatProvidesTable t( files );
+    BOOST_CHECK_EQUAL( t.size(), files.size() );
+    BOOST_CHECK_EQUAL( t.rowSize( 1 ), 0U );
+    BOOST_CHECK_EQUAL( t.rowSize( 2 ), 0U );
+    for ( unsigned row = 0; row < files.size(); ++row )
+    {
+      if ( row == 1 || row == 2 )
+        continue;
+      BOOST_CHECK( t.rowSize( row ) );
+
+      PoolQuery pq;
+      pq.addAttribute( sat::SolvAttr::filelist, files[row] );
+      pq.setMatchExact();
+      pq.setFilesMatchFullPath( true );
+      sat::SolvableSet expect( pq.begin(), pq.end() );
+      sat::WhatProvides prv( Capability( files[row] ) );
+      for_( it, prv.begin(), prv.end() )
+        expect.insert( *it );
+
+      sat::SolvableSet got( t.begin( row ), t.end( row ) );
+      BOOST_CHECK_EQUAL( got.size(), t.rowSize( row ) ); // no duplicates
+      BOOST_CHECK_EQUAL( got.size(), expect.size() );
+      for_( it, expect.begin(), expect.end() )
+        BOOST_CHECK( got.contains( *it ) );
+    }
+
+    // same result in several threads
+    for ( unsigned workers = 0; workers <= 4; workers += 2 )
+    {
+      sat::WhatProvidesTable p( files, workers );
+      BOOST_CHECK( p.offsets() == t.offsets() );
+      BOOST_CHECK( p.ids() == t.ids() );
+    }
+  }
+}
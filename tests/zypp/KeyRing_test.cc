@@ -8,6 +8,7 @@
 #include "zypp/base/Exception.h"
 #include "zypp/KeyRing.h"
 #include "zypp/PublicKey.h"
+#include "zypp/PgpKeyRing.h"
 #include "zypp/TmpPath.h"
 
 #include <boost/test/auto_unit_test.hpp>
@@ -209,3 +210,54 @@ BOOST_AUTO_TEST_CASE(signature_test)
 }
 
 
+BOOST_AUTO_TEST_CASE(native_verify_test)
+{
+  PublicKey key( DATADIR + "public.asc" );
+
+  PgpSignature sig( DATADIR + "repomd.xml.asc" );
+  BOOST_REQUIRE( sig );
+  BOOST_CHECK_EQUAL( sig.issuer(), key.id() );
+  BOOST_CHECK( ! PgpSignature( DATADIR + "public.asc" ) );
+
+  PgpKeyRing native;
+  BOOST_REQUIRE( native.load( DATADIR + "public.asc" ) );
+  BOOST_CHECK_EQUAL( native.size(), 1U );
+  BOOST_CHECK_EQUAL( native.verify( DATADIR + "repomd.xml", sig ), PgpKeyRing::VERIFY_GOOD );
+  BOOST_CHECK_EQUAL( native.verify( DATADIR + "repomd.xml.corrupted", sig ), PgpKeyRing::VERIFY_BAD );
+  BOOST_CHECK_EQUAL( native.verify( DATADIR + "repomd.xml", PgpSignature() ), PgpKeyRing::VERIFY_UNHANDLED );
+
+  // exported key reads back the same
+  TmpFile tmp;
+  {
+    std::ofstream out( tmp.path().c_str() );
+    BOOST_CHECK( native.exportKey( key.id(), out ) );
+    BOOST_CHECK( ! native.exportKey( "0123456789ABCDEF", out ) );
+  }
+  BOOST_CHECK_EQUAL( PublicKey( tmp.path() ).fingerprint(), key.fingerprint() );
+}
+
+BOOST_AUTO_TEST_CASE(native_verify_subkey_test)
+{
+  PgpSignature md5( DATADIR + "repomd.xml.md5.asc" );
+  PgpSignature subkey( DATADIR + "repomd.xml.subkey.asc" );
+  PgpSignature foreign( DATADIR + "repomd.xml.foreign.asc" );
+  BOOST_REQUIRE( md5 && subkey && foreign );
+
+  PgpKeyRing native;
+  BOOST_REQUIRE( native.load( DATADIR + "native.asc" ) );
+  BOOST_CHECK_EQUAL( native.verify( DATADIR + "repomd.xml", subkey ), PgpKeyRing::VERIFY_GOOD );
+  BOOST_CHECK_EQUAL( native.verify( DATADIR + "repomd.xml.corrupted", subkey ), PgpKeyRing::VERIFY_BAD );
+  // gpg rejects MD5 signatures
+  BOOST_CHECK_EQUAL( native.verify( DATADIR + "repomd.xml", md5 ), PgpKeyRing::VERIFY_UNHANDLED );
+  BOOST_CHECK_EQUAL( native.verify( DATADIR + "repomd.xml", foreign ), PgpKeyRing::VERIFY_UNHANDLED );
+
+  // signing subkey without back signature
+  BOOST_REQUIRE( native.load( DATADIR + "native-nobacksig.asc" ) );
+  BOOST_CHECK_EQUAL( native.verify( DATADIR + "repomd.xml", subkey ), PgpKeyRing::VERIFY_UNHANDLED );
+
+  // subkey without binding signature
+  BOOST_REQUIRE( native.load( DATADIR + "native-unbound.asc" ) );
+  BOOST_CHECK_EQUAL( native.verify( DATADIR + "repomd.xml", foreign ), PgpKeyRing::VERIFY_UNHANDLED );
+  BOOST_CHECK_EQUAL( native.verify( DATADIR + "repomd.xml.corrupted", foreign ), PgpKeyRing::VERIFY_UNHANDLED );
+}
+
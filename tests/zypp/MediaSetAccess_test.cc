@@ -5,6 +5,7 @@
 #include <boost/test/unit_test_log.hpp>
 
 #include "zypp/MediaSetAccess.h"
+#include "zypp/media/MediaManager.h"
 #include "zypp/Url.h"
 #include "zypp/PathInfo.h"
 
@@ -263,5 +264,58 @@ BOOST_AUTO_TEST_CASE(msa_remote_tests)
   web.stop();
 }
 
+/*
+ * conditional request remote
+ */
+BOOST_AUTO_TEST_CASE(msa_remote_if_modified)
+{
+  WebServer web( DATADIR / "/src1/cd1", 10002 );
+  web.start();
+  media::MediaManager mediamanager;
+  media::MediaAccessId id = mediamanager.open( web.url() );
+  mediamanager.attach( id );
+
+  // the first request returns the validators
+  std::string validators;
+  BOOST_CHECK( mediamanager.provideFileIfModified( id, "/test.txt", validators ) );
+  BOOST_CHECK( ! validators.empty() );
+  BOOST_CHECK( PathInfo( mediamanager.localPath( id, "/test.txt" ) ).isFile() );
+
+  // unchanged since
+  BOOST_CHECK( ! mediamanager.provideFileIfModified( id, "/test.txt", validators ) );
+
+  // unknown validators
+  std::string other( "\"other\"\t" );
+  BOOST_CHECK( mediamanager.provideFileIfModified( id, "/test.txt", other ) );
+  BOOST_CHECK_EQUAL( other, validators );
+
+  mediamanager.release( id );
+  mediamanager.close( id );
+  web.stop();
+}
+
+/*
+ * conditional request through the media set
+ */
+BOOST_AUTO_TEST_CASE(msa_remote_provide_if_modified)
+{
+  WebServer web( DATADIR / "/src1/cd1", 10002 );
+  web.start();
+  MediaSetAccess setaccess( web.url(), "/" );
+
+  std::string validators;
+  Pathname local = setaccess.provideFileIfModified( "/test.txt", validators );
+  BOOST_CHECK( PathInfo( local ).isFile() );
+  BOOST_CHECK( ! validators.empty() );
+
+  // unchanged since
+  std::string unchanged( validators );
+  BOOST_CHECK( setaccess.provideFileIfModified( "/test.txt", unchanged ).empty() );
+  BOOST_CHECK_EQUAL( unchanged, validators );
+
+  // no user callback connected: the error is propagated
+  BOOST_CHECK_THROW( setaccess.provideFileIfModified( "/testBADNAME.txt", validators ), media::MediaFileNotFoundException );
+  web.stop();
+}
 
 // vim: set ts=2 sts=2 sw=2 ai et:
@@ -0,0 +1,46 @@
+#include <stdlib.h>
+#include <iostream>
+#include <string>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/LogControl.h"
+#include "zypp/base/Logger.h"
+#include "zypp/TmpPath.h"
+#include "zypp/target/modalias/Modalias.h"
+
+using boost::unit_test::test_case;
+using namespace std;
+using namespace zypp;
+using target::Modalias;
+
+BOOST_AUTO_TEST_CASE(modalias_query)
+{
+  // Don't scan /sys
+  filesystem::TmpFile empty;
+  ::setenv( "ZYPP_MODALIAS_SYSFS", empty.path().c_str(), 1 );
+  Modalias & modalias( Modalias::instance() );
+  BOOST_CHECK( modalias.modaliasList().empty() );
+  BOOST_CHECK( ! modalias.query( "pci:*" ) );
+
+  Modalias::ModaliasList devices;
+  devices.push_back( "pci:v00008086d0000265Asv00008086sd00004556bc0Csc03i00" );
+  devices.push_back( "usb:v046DpC52Bd2410dc00dsc00dp00ic03isc01ip01in00" );
+  devices.push_back( "acpi:PNP0C0A:" );
+  modalias.modaliasList( devices );
+  BOOST_CHECK_EQUAL( modalias.modaliasList().size(), 3 );
+
+  BOOST_CHECK( modalias.query( "pci:v00008086d0000265Asv*sd*bc*sc*i*" ) );
+  BOOST_CHECK( modalias.query( "pci:v00008086d0000265Asv*sd*bc*sc*i*" ) );	// remembered
+  BOOST_CHECK( ! modalias.query( "pci:v000010DEd*sv*sd*bc*sc*i*" ) );
+  BOOST_CHECK( modalias.query( "usb:v046Dp*" ) );
+  BOOST_CHECK( modalias.query( "*PNP0C0A*" ) );
+  BOOST_CHECK( modalias.query( "acpi:PNP0C0A:" ) );
+  BOOST_CHECK( ! modalias.query( "acpi:PNP0C0A" ) );
+  BOOST_CHECK( modalias.query( "usb:v046[cD]p*" ) );
+  BOOST_CHECK( ! modalias.query( "" ) );
+
+  // a new list drops the remembered results
+  modalias.modaliasList( Modalias::ModaliasList() );
+  BOOST_CHECK( ! modalias.query( "pci:v00008086d0000265Asv*sd*bc*sc*i*" ) );
+}
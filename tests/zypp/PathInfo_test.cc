@@ -47,6 +47,33 @@ BOOST_AUTO_TEST_CASE(pathinfo_checksum_test)
   BOOST_REQUIRE( is_checksum( file.path(), file_md5 ) );
 }
 
+/**
+ * Test case for
+ * void rememberChecksum( const Pathname & file, const CheckSum & checksum_r );
+ */
+BOOST_AUTO_TEST_CASE(pathinfo_remember_checksum_test)
+{
+  TmpFile file;
+  {
+    ofstream str( file.path().asString().c_str() );
+    str << "I will test the checksum of this";
+  }
+
+  // as if computed while downloading
+  rememberChecksum( file.path(), CheckSum( "sha1", "0123456789abcdef0123456789abcdef01234567" ) );
+  BOOST_CHECK_EQUAL( checksum( file.path(), "sha1" ), "0123456789abcdef0123456789abcdef01234567" );
+  BOOST_CHECK_EQUAL( checksum( file.path(), "SHA1" ), "0123456789abcdef0123456789abcdef01234567" );
+  BOOST_CHECK_EQUAL( checksum( file.path(), "md5" ), "f139a810b84d82d1f29fc53c5e59beae" );
+
+  // changing the file forgets it
+  {
+    ofstream str( file.path().asString().c_str(), ofstream::app );
+    str << "!";
+  }
+  BOOST_CHECK( checksum( file.path(), "sha1" ) != "0123456789abcdef0123456789abcdef01234567" );
+  BOOST_CHECK( checksum( file.path(), "md5" ) != "f139a810b84d82d1f29fc53c5e59beae" );
+}
+
 BOOST_AUTO_TEST_CASE(pathinfo_is_exist_test)
 {
   TmpDir dir;
@@ -210,3 +237,53 @@ BOOST_AUTO_TEST_CASE(test_exchange)
   BOOST_CHECK( PathInfo(a).isFile() );
   BOOST_CHECK( PathInfo(b).isDir() );
 }
+
+BOOST_AUTO_TEST_CASE(test_copy_and_clean_dir)
+{
+  TmpDir root;
+  Pathname src( root/"src" );
+  filesystem::assert_file( src/"file" );
+  filesystem::assert_file( src/".hidden" );
+  filesystem::assert_file( src/"sub/deep/file" );
+  BOOST_CHECK_EQUAL( filesystem::hardlink( src/"file", src/"sub/link" ), 0 );
+  BOOST_CHECK_EQUAL( filesystem::symlink( "../file", src/"sub/sym" ), 0 );
+
+  Pathname dst( root/"dst" );
+  filesystem::assert_dir( dst );
+  BOOST_CHECK_EQUAL( filesystem::copy_dir( src, dst ), 0 );
+  BOOST_CHECK_EQUAL( filesystem::copy_dir( src, dst ), EEXIST );
+  BOOST_CHECK( PathInfo(dst/"src/.hidden").isFile() );
+  BOOST_CHECK( PathInfo(dst/"src/sub/deep/file").isFile() );
+  BOOST_CHECK( PathInfo(dst/"src/sub/sym",PathInfo::LSTAT).isLink() );
+  BOOST_CHECK_EQUAL( filesystem::readlink( dst/"src/sub/sym" ), Pathname("../file") );
+  BOOST_CHECK_EQUAL( PathInfo(dst/"src/sub/link").ino(), PathInfo(dst/"src/file").ino() );
+  BOOST_CHECK( PathInfo(dst/"src/file").ino() != PathInfo(src/"file").ino() );
+
+  BOOST_CHECK_EQUAL( filesystem::copy_dir_content( src, dst ), 0 );
+  BOOST_CHECK( PathInfo(dst/"sub/deep/file").isFile() );
+
+  // clean_dir keeps top level dotfiles
+  BOOST_CHECK_EQUAL( filesystem::clean_dir( src, true ), 0 );
+  BOOST_CHECK( PathInfo(src/".hidden").isFile() );
+  BOOST_CHECK( ! PathInfo(src/"file").isExist() );
+  BOOST_CHECK( ! PathInfo(src/"sub").isExist() );
+
+  BOOST_CHECK_EQUAL( filesystem::recursive_rmdir( dst, true ), 0 );
+  BOOST_CHECK( ! PathInfo(dst).isExist() );
+  BOOST_CHECK_EQUAL( filesystem::recursive_rmdir( dst ), 0 );
+}
+
+BOOST_AUTO_TEST_CASE(test_copy_same_file)
+{
+  TmpDir root;
+  Pathname file( root/"file" );
+  {
+    std::ofstream out( file.c_str() );
+    out << "content";
+  }
+  BOOST_CHECK_EQUAL( filesystem::copy_file2dir( file, root ), EEXIST );
+  BOOST_CHECK_EQUAL( filesystem::copy( file, file ), EEXIST );
+  BOOST_CHECK_EQUAL( filesystem::hardlink( file, root/"link" ), 0 );
+  BOOST_CHECK_EQUAL( filesystem::copy( file, root/"link" ), EEXIST );
+  BOOST_CHECK_EQUAL( PathInfo(file).size(), 7U );
+}
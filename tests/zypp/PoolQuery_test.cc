@@ -840,3 +840,184 @@ BOOST_AUTO_TEST_CASE(addDependency)
 }
 
 
+
+/////////////////////////////////////////////////////////////////////////////
+// queries using the sat::QueryIndex must find the same solvables
+/////////////////////////////////////////////////////////////////////////////
+namespace
+{
+  std::vector<sat::Solvable> collect( const PoolQuery & q, bool indexed )
+  {
+    ZConfig::instance().set_pool_queryIndex( indexed );
+    std::vector<sat::Solvable> ret( q.begin(), q.end() );
+    ZConfig::instance().set_default_pool_queryIndex();
+    std::sort( ret.begin(), ret.end() );
+    return ret;
+  }
+
+  void checkIndexed( const PoolQuery & q )
+  {
+    std::vector<sat::Solvable> plain( collect( q, false ) );
+    std::vector<sat::Solvable> indexed( collect( q, true ) );
+    BOOST_CHECK_EQUAL( plain.size(), indexed.size() );
+    BOOST_CHECK( plain == indexed );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(pool_query_index)
+{
+  {
+    PoolQuery q;
+    q.addString("zypper");
+    q.addAttribute(sat::SolvAttr::name);
+    checkIndexed( q );
+    BOOST_CHECK( ! collect( q, true ).empty() );
+  }
+  {
+    PoolQuery q;
+    q.addString("ZYPP");
+    q.setCaseSensitive( false );
+    q.addAttribute(sat::SolvAttr::name);
+    q.addAttribute(sat::SolvAttr::summary);
+    checkIndexed( q );
+  }
+  {
+    PoolQuery q;
+    q.addString("libzypp.so");
+    q.addAttribute(sat::SolvAttr::provides);
+    checkIndexed( q );
+  }
+  {
+    PoolQuery q;
+    q.addString("yast2-*manag?r");
+    q.setMatchGlob();
+    q.addAttribute(sat::SolvAttr::name);
+    checkIndexed( q );
+  }
+  {
+    PoolQuery q;
+    q.addString("zypper");
+    q.setMatchExact();
+    q.addAttribute(sat::SolvAttr::name);
+    q.addRepo("zyppsvn");
+    checkIndexed( q );
+  }
+  {
+    PoolQuery q;
+    q.addString("no-such-package-name");
+    q.addAttribute(sat::SolvAttr::name);
+    checkIndexed( q );
+    BOOST_CHECK( collect( q, true ).empty() );
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// parallelResult must find the same solvables as the iterator
+/////////////////////////////////////////////////////////////////////////////
+namespace
+{
+  void checkParallel( const PoolQuery & q )
+  {
+    sat::SolvableSet sequential( q.begin(), q.end() );
+    for ( unsigned workers = 1; workers <= 4; workers *= 2 )
+    {
+      sat::SolvableSet parallel( q.parallelResult( workers ) );
+      BOOST_CHECK_EQUAL( parallel.size(), sequential.size() );
+      for_( it, sequential.begin(), sequential.end() )
+        BOOST_CHECK( parallel.contains( *it ) );
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(pool_query_parallel)
+{
+  {
+    PoolQuery q;
+    q.addString("^lib.*zypp");
+    q.setMatchRegex();
+    q.addAttribute(sat::SolvAttr::name);
+    checkParallel( q );
+    BOOST_CHECK( ! q.parallelResult().empty() );
+  }
+  {
+    // file lists: searched per repo
+    PoolQuery q;
+    q.addString("zypper");
+    q.addAttribute(sat::SolvAttr::filelist);
+    q.setFilesMatchFullPath( true );
+    checkParallel( q );
+  }
+  {
+    PoolQuery q;
+    q.addString("^/usr/s?bin/");
+    q.setMatchRegex();
+    q.addAttribute(sat::SolvAttr::filelist);
+    q.setFilesMatchFullPath( true );
+    checkParallel( q );
+  }
+  {
+    // file lists, basenames only
+    PoolQuery q;
+    q.addString("zypp*");
+    q.setMatchGlob();
+    q.addAttribute(sat::SolvAttr::filelist);
+    q.setUninstalledOnly();
+    checkParallel( q );
+  }
+  {
+    // more than one attribute: evaluated in the calling thread
+    PoolQuery q;
+    q.addString("zypp");
+    q.addAttribute(sat::SolvAttr::name);
+    q.addAttribute(sat::SolvAttr::description);
+    q.setUninstalledOnly();
+    checkParallel( q );
+  }
+  {
+    PoolQuery q;
+    q.addString("zypp");
+    q.addAttribute(sat::SolvAttr::name);
+    q.addRepo("zyppsvn");
+    checkParallel( q );
+  }
+  {
+    // predicated: evaluated in the calling thread
+    PoolQuery q;
+    q.addDependency( sat::SolvAttr::provides, "kernel" );
+    checkParallel( q );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(pool_query_name_query)
+{
+  std::string name;
+  {
+    PoolQuery q;
+    q.addAttribute(sat::SolvAttr::name, "zypper");
+    q.addKind(ResKind::package);
+    q.setMatchExact();
+    BOOST_CHECK( q.isNameQuery( name ) );
+    BOOST_CHECK_EQUAL( name, "zypper" );
+
+    std::vector<sat::Solvable> all( sat::Pool::instance().solvablesBegin(), sat::Pool::instance().solvablesEnd() );
+    sat::SolvableSet subset( q.subsetResult( all ) );
+    sat::SolvableSet full( q.begin(), q.end() );
+    BOOST_CHECK( ! full.empty() );
+    BOOST_CHECK_EQUAL( subset.size(), full.size() );
+    for_( it, full.begin(), full.end() )
+      BOOST_CHECK( subset.contains( *it ) );
+  }
+  {
+    PoolQuery q;
+    q.addAttribute(sat::SolvAttr::name, "zypp*");
+    q.setMatchGlob();
+    BOOST_CHECK( ! q.isNameQuery( name ) );
+  }
+  {
+    PoolQuery q;
+    q.addString("zypper");
+    q.addAttribute(sat::SolvAttr::name);
+    q.addAttribute(sat::SolvAttr::summary);
+    BOOST_CHECK( ! q.isNameQuery( name ) );
+  }
+}
@@ -3,6 +3,7 @@
 #include <fstream>
 #include <list>
 #include <string>
+#include <utime.h>
 
 #include "zypp/base/LogTools.h"
 #include "zypp/base/Exception.h"
@@ -133,6 +134,59 @@ BOOST_AUTO_TEST_CASE(service_file_link_bug)
   manager.modifyService(service.alias(), service);
 }
 
+// the parsed repo files are remembered in the cache
+BOOST_AUTO_TEST_CASE(known_repos_cache_test)
+{
+  TmpDir tmpCachePath;
+  RepoManagerOptions opts( RepoManagerOptions::makeTestSetup( tmpCachePath ) ) ;
+
+  filesystem::mkdir( opts.knownReposPath );
+  BOOST_CHECK_EQUAL( filesystem::copy_dir_content( DATADIR + "/repos.d", opts.knownReposPath ), 0 );
+  filesystem::mkdir( opts.repoRawCachePath );
+  filesystem::mkdir( opts.repoRawCachePath / "garbage" );
+
+  // files modified just now are not trusted
+  list<string> entries;
+  filesystem::readdir( entries, opts.knownReposPath, false );
+  entries.push_back( "." );
+  struct utimbuf old = { 1000000000, 1000000000 };
+  for_( it, entries.begin(), entries.end() )
+    ::utime( (opts.knownReposPath / *it).c_str(), &old );
+
+  list<RepoInfo> repos;
+  {
+    RepoManager manager( opts );
+    repos.insert( repos.end(), manager.repoBegin(), manager.repoEnd() );
+  }
+  BOOST_CHECK_EQUAL( repos.size(), (unsigned) 4 );
+  BOOST_CHECK( PathInfo( opts.repoCachePath / "repos.d.cache" ).isFile() );
+  BOOST_CHECK( ! PathInfo( opts.repoRawCachePath / "garbage" ).isExist() );
+
+  {
+    RepoManager manager( opts );
+    BOOST_CHECK_EQUAL( manager.repoSize(), repos.size() );
+    for_( it, repos.begin(), repos.end() )
+    {
+      RepoInfo cached( manager.getRepo( *it ) );
+      BOOST_CHECK_EQUAL( cached.name(), it->name() );
+      BOOST_CHECK_EQUAL( cached.url(), it->url() );
+      BOOST_CHECK_EQUAL( cached.enabled(), it->enabled() );
+      BOOST_CHECK_EQUAL( cached.filepath(), it->filepath() );
+    }
+  }
+
+  // adding a file makes it read again
+  {
+    ofstream str( (opts.knownReposPath / "added.repo").c_str() );
+    str << "[added]" << endl << "baseurl=http://example.org/" << endl;
+  }
+  {
+    RepoManager manager( opts );
+    BOOST_CHECK_EQUAL( manager.repoSize(), repos.size() + 1 );
+    BOOST_CHECK( manager.hasRepo( "added" ) );
+  }
+}
+
 BOOST_AUTO_TEST_CASE(repomanager_test)
 {
   TmpDir tmpCachePath;
@@ -255,6 +309,12 @@ BOOST_AUTO_TEST_CASE(repomanager_test)
   manager.buildCache(repo);
 
   manager.loadFromCache(repo);
+  unsigned solvables = sat::Pool::instance().reposFind( repo.alias() ).solvablesSize();
+
+  // loading a list replaces the repo in the pool
+  std::list<RepoInfo> toload( 1, repo );
+  manager.loadFromCache( toload );
+  BOOST_CHECK_EQUAL( sat::Pool::instance().reposFind( repo.alias() ).solvablesSize(), solvables );
 
   if ( manager.isCached(repo ) )
   {
@@ -327,5 +327,35 @@ BOOST_AUTO_TEST_CASE(status_change)
   // TODO: Test status/pickStatus transactions (w./w.o. multiinstall)
 }
 
-/////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(pool_update)
+{
+  // Adding or removing a repo must update the changed Selectables only.
+  ResPoolProxy before( test.poolProxy() );
+  ui::Selectable::Ptr candidate( before.lookup( ResKind::package, "candidate" ) );
+  BOOST_REQUIRE( candidate );
+
+  test.loadRepo( TESTS_SRC_DIR "/data/OBS_zypp_svn-11.1", "zyppsvn" );
+  ResPoolProxy added( test.poolProxy() );
+  BOOST_CHECK( added.size() > before.size() );
+  BOOST_CHECK( added.lookup( ResKind::package, "candidate" ) == candidate );
+  ui::Selectable::Ptr zypper( added.lookup( ResKind::package, "zypper" ) );
+  BOOST_REQUIRE( zypper );
+  BOOST_CHECK_EQUAL( zypper->availableSize(), size_t( std::distance( test.pool().byIdentBegin( ResKind::package, IdString("zypper") ),
+                                                                     test.pool().byIdentEnd( ResKind::package, IdString("zypper") ) ) ) );
+
+  PoolItem item( *zypper->availableBegin() );
+  BOOST_REQUIRE( item );
+  BOOST_CHECK_EQUAL( item.satSolvable().ident(), IdString("zypper") );
+  BOOST_CHECK( item.resolvable() );
+
+  test.satpool().reposFind( "zyppsvn" ).eraseFromPool();
+  ResPoolProxy removed( test.poolProxy() );
+  BOOST_CHECK( ! item );   // left the pool
+  BOOST_CHECK( ! item.resolvable() );
+  BOOST_CHECK_EQUAL( removed.size(), before.size() );
+  BOOST_CHECK( removed.lookup( ResKind::package, "candidate" ) == candidate );
+  BOOST_CHECK( ! removed.lookup( ResKind::package, "zypper" ) );
+  BOOST_CHECK( test.pool().byIdentBegin( ResKind::package, IdString("zypper") ) == test.pool().byIdentEnd( ResKind::package, IdString("zypper") ) );
+}
 
+/////////////////////////////////////////////////////////////////////////////
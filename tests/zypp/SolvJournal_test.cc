@@ -0,0 +1,90 @@
+
+#include "zypp/base/Logger.h"
+#include "zypp/TmpPath.h"
+#include "zypp/RepoStatus.h"
+#include "zypp/PathInfo.h"
+#include "zypp/target/SolvJournal.h"
+
+#include <boost/test/auto_unit_test.hpp>
+
+using boost::unit_test::test_case;
+
+using namespace std;
+using namespace zypp;
+using namespace zypp::filesystem;
+using zypp::target::SolvJournal;
+
+BOOST_AUTO_TEST_CASE(solvjournal_applicable)
+{
+  TmpDir tmp;
+  RepoStatus solv;
+  solv.setChecksum( "solv" );
+  RepoStatus products;
+  products.setChecksum( "products" );
+  RepoStatus rpmdb;
+  rpmdb.setChecksum( "rpmdb" );
+
+  SolvJournal journal( tmp.path() / "journal" );
+  // not started
+  journal.installed( 1 );
+  BOOST_CHECK( ! PathInfo( journal.file() ).isExist() );
+  BOOST_CHECK( ! journal.applicable( solv, rpmdb, products ) );
+
+  journal.start( solv, products );
+  journal.installed( 1 );
+  journal.removed( 2 );
+  // not finished
+  BOOST_CHECK( ! journal.applicable( solv, rpmdb, products ) );
+
+  journal.finish( rpmdb );
+  BOOST_CHECK( journal.applicable( solv, rpmdb, products ) );
+  BOOST_CHECK( ! journal.applicable( rpmdb, rpmdb, products ) );
+  BOOST_CHECK( ! journal.applicable( solv, solv, products ) );
+  BOOST_CHECK( ! journal.applicable( solv, rpmdb, rpmdb ) );
+
+  // restart
+  journal.start( solv, products );
+  journal.invalidate();
+  journal.finish( rpmdb );
+  BOOST_CHECK( ! journal.applicable( solv, rpmdb, products ) );
+
+  journal.discard();
+  BOOST_CHECK( ! PathInfo( journal.file() ).isExist() );
+}
+
+BOOST_AUTO_TEST_CASE(solvjournal_replay)
+{
+  TmpDir tmp;
+  RepoStatus status;
+  SolvJournal journal( tmp.path() / "journal" );
+  std::set<unsigned> drop;
+  std::set<unsigned> add;
+
+  // 1 2 3 in the solv file; 2 removed, 4 installed, 3 obsoleted by 5
+  journal.start( status, status );
+  journal.removed( 2 );
+  journal.installed( 4 );
+  journal.installed( 5 );
+  journal.finish( status );
+  BOOST_CHECK( journal.replay( { 1, 2, 3 }, { 1, 4, 5 }, drop, add ) );
+  BOOST_CHECK( drop == std::set<unsigned>( { 2, 3 } ) );
+  BOOST_CHECK( add == std::set<unsigned>( { 4, 5 } ) );
+
+  // the removed header is still in the database
+  BOOST_CHECK( ! journal.replay( { 1, 2, 3 }, { 1, 2, 4, 5 }, drop, add ) );
+  // the removed header is not in the solv file
+  BOOST_CHECK( ! journal.replay( { 1, 3 }, { 1, 4, 5 }, drop, add ) );
+  // unknown header in the database
+  BOOST_CHECK( ! journal.replay( { 1, 2, 3 }, { 1, 4, 5, 6 }, drop, add ) );
+
+  // installed and removed again; the header number reused
+  journal.start( status, status );
+  journal.installed( 4 );
+  journal.removed( 4 );
+  journal.removed( 1 );
+  journal.installed( 1 );
+  journal.finish( status );
+  BOOST_CHECK( journal.replay( { 1, 2 }, { 1, 2 }, drop, add ) );
+  BOOST_CHECK( drop == std::set<unsigned>( { 1 } ) );
+  BOOST_CHECK( add == std::set<unsigned>( { 1 } ) );
+}
@@ -13,6 +13,7 @@
 #define ZYPP_CALLBACK_H
 
 #include "zypp/base/NonCopyable.h"
+#include "zypp/thread/WorkerPool.h"
 
 ///////////////////////////////////////////////////////////////////
 namespace zypp
@@ -125,6 +126,12 @@ namespace zypp
    * \li \c whoIsConnected Return a 'ReceiveReport*' to the currently
    * connected ReceiveReport, or \c NULL if none is connected.
    *
+   * \par Threads
+   *
+   * Reports sent from a \ref thread::WorkerPool thread are never delivered
+   * to the connected receiver, but to the task structures defaults.
+   * Receivers are always invoked by the applications own thread.
+   *
   */
   namespace callback
   { /////////////////////////////////////////////////////////////////
@@ -197,8 +204,9 @@ namespace zypp
          { _receiver = &_noReceiver; }
 
       public:
+         /** The connected receiver (default receiver if called from a \ref thread::WorkerPool thread). */
          Receiver * operator->()
-         { return _receiver; }
+         { return thread::WorkerPool::isWorkerThread() ? &_noReceiver : _receiver; }
 
       private:
         DistributeReport()
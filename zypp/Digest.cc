@@ -27,6 +27,7 @@
 #endif
 
 #include "zypp/Digest.h"
+#include "zypp/thread/Once.h"
 
 namespace zypp {
 
@@ -66,7 +67,8 @@ namespace zypp {
 
     	bool initialized : 1;
     	bool finalized : 1;
-    	static bool openssl_digests_added;
+    	static thread::OnceFlag openssl_digests_added;
+    	static void addOpensslDigests();
 
     	std::string name;
 
@@ -77,7 +79,15 @@ namespace zypp {
 
     using namespace std;
 
-    bool Digest::P::openssl_digests_added = false;
+    thread::OnceFlag Digest::P::openssl_digests_added = ZYPP_ONCE_INIT;
+
+    void Digest::P::addOpensslDigests()
+    {
+      OPENSSL_config(NULL);
+      ENGINE_load_builtin_engines();
+      ENGINE_register_all_complete();
+      OpenSSL_add_all_digests();
+    }
 
     Digest::P::P() :
       md(NULL),
@@ -93,14 +103,8 @@ namespace zypp {
 
     bool Digest::P::maybeInit()
     {
-      if(!openssl_digests_added)
-      {
-      	OPENSSL_config(NULL);
-      	ENGINE_load_builtin_engines();
-      	ENGINE_register_all_complete();
-    	OpenSSL_add_all_digests();
-    	openssl_digests_added = true;
-      }
+      // thread safe: Digests may be computed in parallel
+      thread::callOnce( openssl_digests_added, &P::addOpensslDigests );
 
       if(!initialized)
       {
@@ -15,8 +15,11 @@
 #include <errno.h>
 #include <unistd.h>
 #include <sys/wait.h>
+#include <sys/syscall.h>
 #include <fcntl.h>
+#include <dirent.h>
 #include <pty.h> // openpty
+#include <spawn.h>
 #include <stdlib.h> // setenv
 
 #include <cstring> // strsignal
@@ -30,8 +33,114 @@
 
 using namespace std;
 
+extern char ** environ;
+
+// posix_spawn_file_actions_addclosefrom_np
+#if defined(__GLIBC__) && ( __GLIBC__ > 2 || ( __GLIBC__ == 2 && __GLIBC_MINOR__ >= 34 ) )
+#define ZYPP_HAVE_SPAWN_CLOSEFROM 1
+#endif
+
 namespace zypp {
 
+    namespace
+    {
+      /** Close all file descriptors from \a lowfd_r on.
+       * Used after fork, so it's restricted to async-signal-safe calls.
+       * Prefers \c close_range, then the entries in \c /proc/self/fd, and
+       * iterates over the whole descriptor table only as last resort.
+       */
+      void closeFdsFrom( int lowfd_r )
+      {
+#ifdef SYS_close_range
+        if ( ::syscall( SYS_close_range, lowfd_r, ~0U, 0 ) == 0 )
+          return;
+#endif
+        int dirfd = ::open( "/proc/self/fd", O_RDONLY|O_DIRECTORY|O_CLOEXEC );
+        if ( dirfd >= 0 )
+        {
+          char buf[4096];
+          for ( long n = ::syscall( SYS_getdents64, dirfd, buf, sizeof(buf) ); n > 0; n = ::syscall( SYS_getdents64, dirfd, buf, sizeof(buf) ) )
+          {
+            for ( long pos = 0; pos < n; )
+            {
+              struct dirent64 * d = reinterpret_cast<struct dirent64 *>( buf + pos );
+              pos += d->d_reclen;
+              int fd = 0;
+              const char * c = d->d_name;
+              for ( ; *c >= '0' && *c <= '9'; ++c )
+                fd = fd * 10 + ( *c - '0' );
+              if ( *c == '\0' && c != d->d_name && fd >= lowfd_r && fd != dirfd )
+                ::close( fd );
+            }
+          }
+          ::close( dirfd );
+          return;
+        }
+        for ( int i = ::getdtablesize() - 1; i >= lowfd_r; --i )
+          ::close( i );
+      }
+
+#ifdef ZYPP_HAVE_SPAWN_CLOSEFROM
+      /** Start \a argv via \c posix_spawnp, stdin/stdout connected to \a stdin_r/\a stdout_r.
+       * Performs in the child what the fork branch in \ref ExternalProgram::start_program does,
+       * except for a stdin redirection or chdir. Their errors are handled differently in the
+       * fork branch, so they are not started here.
+       * \return 0 or errno
+       */
+      int spawnProgram( pid_t & pid_r, const char *const *argv, const ExternalProgram::Environment & environment,
+                        int stdin_r, int stdout_r,
+                        ExternalProgram::Stderr_Disposition stderr_disp, int stderr_fd, bool default_locale )
+      {
+        // The childs environment: ours, overwritten by environment and LC_ALL
+        std::vector<std::string> env;
+        for ( char ** e = environ; e && *e; ++e )
+        {
+          const char * eq = ::strchr( *e, '=' );
+          std::string key( *e, eq ? eq - *e : ::strlen( *e ) );
+          if ( environment.find( key ) != environment.end() || ( default_locale && key == "LC_ALL" ) )
+            continue;
+          env.push_back( *e );
+        }
+        for_( it, environment.begin(), environment.end() )
+        {
+          if ( ! ( default_locale && it->first == "LC_ALL" ) )
+            env.push_back( it->first + "=" + it->second );
+        }
+        if ( default_locale )
+          env.push_back( "LC_ALL=C" );
+
+        std::vector<char *> envp;
+        envp.reserve( env.size() + 1 );
+        for_( it, env.begin(), env.end() )
+          envp.push_back( const_cast<char *>( it->c_str() ) );
+        envp.push_back( nullptr );
+
+        posix_spawn_file_actions_t actions;
+        int ret = ::posix_spawn_file_actions_init( &actions );
+        if ( ret )
+          return ret;
+
+        ::posix_spawn_file_actions_adddup2( &actions, stdin_r, 0 );
+        ::posix_spawn_file_actions_adddup2( &actions, stdout_r, 1 );
+
+        if ( stderr_disp == ExternalProgram::Discard_Stderr )
+          ::posix_spawn_file_actions_addopen( &actions, 2, "/dev/null", O_WRONLY, 0 );
+        else if ( stderr_disp == ExternalProgram::Stderr_To_Stdout )
+          ::posix_spawn_file_actions_adddup2( &actions, 1, 2 );
+        else if ( stderr_disp == ExternalProgram::Stderr_To_FileDesc )
+          ::posix_spawn_file_actions_adddup2( &actions, stderr_fd, 2 );
+
+        ::posix_spawn_file_actions_addclosefrom_np( &actions, 3 );
+
+        ret = ::posix_spawnp( &pid_r, argv[0], &actions, nullptr, const_cast<char *const *>( argv ), &envp[0] );
+        ::posix_spawn_file_actions_destroy( &actions );
+        if ( ret )
+          pid_r = -1;
+        return ret;
+      }
+#endif
+    } // namespace
+
     ExternalProgram::ExternalProgram()
       : use_pty (false)
       , pid( -1 )
@@ -270,6 +379,37 @@ namespace zypp {
     	}
       }
 
+#ifdef ZYPP_HAVE_SPAWN_CLOSEFROM
+      if ( ! use_pty && ! root && ! redirectStdin && ! chdirTo )
+      {
+        // No need to fork: let posix_spawn do the childs setup
+        int ret = spawnProgram( pid, argv, environment, to_external[0], from_external[1],
+                                stderr_disp, stderr_fd, default_locale );
+        ::close(to_external[0]);   // belongs to child process
+        ::close(from_external[1]); // belongs to child process
+        if ( ret )
+        {
+          _execError = str::form( _("Can't exec '%s' (%s)."), argv[0], strerror(ret) );
+          _exitStatus = 129;
+          ERR << _execError << endl;
+          ::close(to_external[1]);
+          ::close(from_external[0]);
+          return;
+        }
+
+        inputfile = fdopen(from_external[0], "r");
+        outputfile = fdopen(to_external[1], "w");
+        DBG << "pid " << pid << " spawned" << endl;
+
+        if (!inputfile || !outputfile)
+        {
+          ERR << "Cannot create streams to external program " << argv[0] << endl;
+          close();
+        }
+        return;
+      }
+#endif
+
       // Create module process
       if ((pid = fork()) == 0)
       {
@@ -354,9 +494,7 @@ namespace zypp {
 	}
 
     	// close all filedesctiptors above stderr
-    	for ( int i = ::getdtablesize() - 1; i > 2; --i ) {
-    	  ::close( i );
-    	}
+    	closeFdsFrom( 3 );
 
     	execvp(argv[0], const_cast<char *const *>(argv));
         // don't want to get here
@@ -448,8 +586,8 @@ namespace zypp {
 	    else if ( retval )
 	    {
 	      // Data is available now.
-	      static size_t linebuffer_size = 0;      // static because getline allocs
-	      static char * linebuffer = 0;           // and reallocs if buffer is too small
+	      static thread_local size_t linebuffer_size = 0;      // static because getline allocs
+	      static thread_local char * linebuffer = 0;           // and reallocs if buffer is too small
 	      getline( &linebuffer, &linebuffer_size, inputfile );
 	      // ::feof check is important as select returns
 	      // positive if the file was closed.
@@ -31,6 +31,12 @@ namespace zypp {
      * and some exec.. call, gives you access to the program's
      * stdio and closes the program after use.
      *
+     * Unless a pty, chroot, stdin redirection or chdir is requested, the
+     * program is started via \c posix_spawn (if the libc supports closing
+     * the inherited file descriptors there). This avoids copying the page
+     * tables of a large process. Use pipes (\c use_pty \c false, the
+     * default) to benefit from it.
+     *
      * \code
      *
      * const char* argv[] =
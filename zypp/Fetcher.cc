@@ -26,6 +26,7 @@
 #include "zypp/base/UserRequestException.h"
 #include "zypp/parser/susetags/ContentFileReader.h"
 #include "zypp/parser/susetags/RepoIndex.h"
+#include "zypp/repo/ContentStore.h"
 
 using namespace std;
 
@@ -379,6 +380,17 @@ namespace zypp
         }
       }
     } // iterate over caches
+
+    // maybe downloaded for some other repo
+    if ( repo::ContentStore::instance().provide( resource.checksum(), dest_full_path ) )
+    {
+      if ( is_checksum( dest_full_path, resource.checksum() ) )
+      {
+        MIL << "file " << resource.filename() << " found in content store. Using cached copy." << endl;
+        return true;
+      }
+      filesystem::unlink( dest_full_path );
+    }
     return false;
   }
 
@@ -836,6 +848,10 @@ namespace zypp
       // validate job, this throws if not valid
       validate((*it_res)->location, dest_dir, (*it_res)->checkers);
 
+      // checksum verified, share it with other repos
+      if ( ! (*it_res)->location.checksum().empty() )
+        repo::ContentStore::instance().insert( (*it_res)->location.checksum(), dest_dir + (*it_res)->location.filename() );
+
       if ( ! progress.incr() )
         ZYPP_THROW(AbortRequestException());
     } // for each job
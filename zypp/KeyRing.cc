@@ -29,8 +29,12 @@
 #include "zypp/base/WatchFile.h"
 #include "zypp/PathInfo.h"
 #include "zypp/KeyRing.h"
+#include "zypp/PgpKeyRing.h"
 #include "zypp/ExternalProgram.h"
 #include "zypp/TmpPath.h"
+#include "zypp/thread/Mutex.h"
+#include "zypp/thread/MutexLock.h"
+#include "zypp/thread/WorkerPool.h"
 
 using std::endl;
 
@@ -86,22 +90,36 @@ namespace zypp
     /// \code
     ///   const std::list<PublicKeyData> & cachedPublicKeyData( const Pathname & keyring );
     /// \endcode
+    ///
+    /// A \c pubring.gpg is parsed by \ref PgpKeyRing and kept in memory,
+    /// so signatures can be verified without running gpg. gpg is used
+    /// if the keyring can't be parsed (or is a keybox).
     ///////////////////////////////////////////////////////////////////
     struct CachedPublicKeyData // : private base::NonCopyable - but KeyRing uses RWCOW though also NonCopyable :(
     {
       const std::list<PublicKeyData> & operator()( const Pathname & keyring_r ) const
       { return getData( keyring_r ); }
 
+      /** The parsed keyring or \c NULL if it must be handled by gpg. */
+      const PgpKeyRing * nativeKeyRing( const Pathname & keyring_r ) const
+      {
+	Cache & cache( _cacheMap[keyring_r] );
+	getData( keyring_r );
+	return cache._nativeValid ? &cache._native : 0;
+      }
+
     private:
       struct Cache
       {
 	scoped_ptr<WatchFile> _keyringP;
 	std::list<PublicKeyData> _data;
+	PgpKeyRing _native;
+	bool _nativeValid;
 
 	// Empty copy ctor to allow insert into std::map as
 	// scoped_ptr is noncopyable.
-	Cache() {}
-	Cache( const Cache & rhs ) {}
+	Cache() : _nativeValid( false ) {}
+	Cache( const Cache & rhs ) : _nativeValid( false ) {}
       };
 
       typedef std::map<Pathname,Cache> CacheMap;
@@ -121,6 +139,20 @@ namespace zypp
       {
 	if ( cache_r._keyringP->hasChanged() )
 	{
+	  cache_r._nativeValid = ( ! PathInfo( keyring_r/"pubring.kbx" ).isExist()
+	                           && cache_r._native.load( keyring_r/"pubring.gpg" ) );
+	  if ( cache_r._nativeValid )
+	  {
+	    PublicKeyScanner scanner;
+	    std::vector<std::string> lines( cache_r._native.colonListing() );
+	    for_( it, lines.begin(), lines.end() )
+	      scanner.scan( *it );
+
+	    cache_r._data.swap( scanner._keys );
+	    MIL << "Found keys: " << cache_r._data  << endl;
+	    return cache_r._data;
+	  }
+
 	  const char* argv[] =
 	  {
 	    GPG_BINARY,
@@ -162,7 +194,10 @@ namespace zypp
   //
   //	CLASS NAME : KeyRing::Impl
   //
-  /** KeyRing implementation. */
+  /** KeyRing implementation.
+   * \note The public KeyRing methods are serialized via \ref _mutex, so
+   * a KeyRing may be used from within \ref thread::WorkerPool threads.
+   */
   struct KeyRing::Impl
   {
     Impl( const Pathname & baseTmpDir )
@@ -228,6 +263,8 @@ namespace zypp
     std::list<PublicKey> publicKeys( const Pathname & keyring);
     const std::list<PublicKeyData> & publicKeyData( const Pathname & keyring )
     { return cachedPublicKeyData( keyring ); }
+    const PgpKeyRing * nativeKeyRing( const Pathname & keyring )
+    { return cachedPublicKeyData.nativeKeyRing( keyring ); }
 
     /** Get \ref PublicKeyData for ID (\c false if ID is not found). */
     PublicKeyData publicKeyExists( const std::string & id, const Pathname & keyring );
@@ -249,6 +286,10 @@ namespace zypp
      * \endcode
      */
     CachedPublicKeyData cachedPublicKeyData;
+
+  public:
+    /** Serialize access from multiple threads. */
+    thread::Mutex _mutex;
   };
   ///////////////////////////////////////////////////////////////////
 
@@ -326,6 +367,10 @@ namespace zypp
 
   void KeyRing::Impl::dumpPublicKey( const std::string & id, const Pathname & keyring, std::ostream & stream )
   {
+    const PgpKeyRing * native( nativeKeyRing( keyring ) );
+    if ( native && native->exportKey( id, stream ) )
+      return;
+
     const char* argv[] =
     {
       GPG_BINARY,
@@ -369,6 +414,26 @@ namespace zypp
     callback::SendReport<KeyRingReport> report;
     MIL << "Going to verify signature for " << filedesc << " ( " << file << " ) with " << signature << endl;
 
+    if ( thread::WorkerPool::isWorkerThread() )
+    {
+      // A worker thread can't ask the user. Silently accept a good
+      // signature made by a trusted key; everything else must be
+      // decided by the application thread.
+      if ( signature.empty() || (!PathInfo( signature ).isExist()) )
+      {
+        MIL << "Unsigned file: decision deferred to the application thread." << endl;
+        return false;
+      }
+      std::string id = readSignatureKeyId( signature );
+      if ( publicKeyExists( id, trustedKeyRing() ) && verifyFile( file, signature, trustedKeyRing() ) )
+      {
+        MIL << "File signature is verified by trusted key " << id << endl;
+        return true;
+      }
+      MIL << "Key " << id << " not trusted or verification failed: decision deferred to the application thread." << endl;
+      return false;
+    }
+
     // if signature does not exists, ask user if he wants to accept unsigned file.
     if( signature.empty() || (!PathInfo( signature ).isExist()) )
     {
@@ -560,6 +625,13 @@ namespace zypp
           _("Signature file %s not found"))% signature.asString())));
 
     MIL << "Determining key id if signature " << signature << endl;
+    PgpSignature sig( signature );
+    if ( ! sig.issuer().empty() )
+    {
+      MIL << "Determined key id [" << sig.issuer() << "] for signature " << signature << endl;
+      return sig.issuer();
+    }
+
     // HACK create a tmp keyring with no keys
     filesystem::TmpDir dir( _base_dir, "fake-keyring" );
 
@@ -611,6 +683,15 @@ namespace zypp
 
   bool KeyRing::Impl::verifyFile( const Pathname & file, const Pathname & signature, const Pathname & keyring )
   {
+    const PgpKeyRing * native( nativeKeyRing( keyring ) );
+    if ( native )
+    {
+      PgpKeyRing::VerifyResult res( native->verify( file, PgpSignature( signature ) ) );
+      DBG << "Native verify " << file << ": " << res << endl;
+      if ( res != PgpKeyRing::VERIFY_UNHANDLED )
+	return( res == PgpKeyRing::VERIFY_GOOD );
+    }
+
     const char* argv[] =
     {
       GPG_BINARY,
@@ -659,56 +740,104 @@ namespace zypp
 
 
   void KeyRing::importKey( const PublicKey & key, bool trusted )
-  { _pimpl->importKey( key, trusted ); }
+  {
+    thread::MutexLock lock( _pimpl->_mutex );
+    _pimpl->importKey( key, trusted );
+  }
 
   void KeyRing::multiKeyImport( const Pathname & keyfile_r, bool trusted_r )
-  { _pimpl->multiKeyImport( keyfile_r, trusted_r ); }
+  {
+    thread::MutexLock lock( _pimpl->_mutex );
+    _pimpl->multiKeyImport( keyfile_r, trusted_r );
+  }
 
   std::string KeyRing::readSignatureKeyId( const Pathname & signature )
-  { return _pimpl->readSignatureKeyId( signature ); }
+  {
+    thread::MutexLock lock( _pimpl->_mutex );
+    return _pimpl->readSignatureKeyId( signature );
+  }
 
   void KeyRing::deleteKey( const std::string & id, bool trusted )
-  { _pimpl->deleteKey( id, trusted ); }
+  {
+    thread::MutexLock lock( _pimpl->_mutex );
+    _pimpl->deleteKey( id, trusted );
+  }
 
   std::list<PublicKey> KeyRing::publicKeys()
-  { return _pimpl->publicKeys(); }
+  {
+    thread::MutexLock lock( _pimpl->_mutex );
+    return _pimpl->publicKeys();
+  }
 
   std:: list<PublicKey> KeyRing::trustedPublicKeys()
-  { return _pimpl->trustedPublicKeys(); }
+  {
+    thread::MutexLock lock( _pimpl->_mutex );
+    return _pimpl->trustedPublicKeys();
+  }
 
   std::list<PublicKeyData> KeyRing::publicKeyData()
-  { return _pimpl->publicKeyData(); }
+  {
+    thread::MutexLock lock( _pimpl->_mutex );
+    return _pimpl->publicKeyData();
+  }
 
   std::list<PublicKeyData> KeyRing::trustedPublicKeyData()
-  { return _pimpl->trustedPublicKeyData(); }
+  {
+    thread::MutexLock lock( _pimpl->_mutex );
+    return _pimpl->trustedPublicKeyData();
+  }
 
   bool KeyRing::verifyFileSignatureWorkflow(
       const Pathname & file,
       const std::string filedesc,
       const Pathname & signature,
       const KeyContext & keycontext )
-  { return _pimpl->verifyFileSignatureWorkflow( file, filedesc, signature, keycontext ); }
+  {
+    thread::MutexLock lock( _pimpl->_mutex );
+    return _pimpl->verifyFileSignatureWorkflow( file, filedesc, signature, keycontext );
+  }
 
   bool KeyRing::verifyFileSignature( const Pathname & file, const Pathname & signature )
-  { return _pimpl->verifyFileSignature( file, signature ); }
+  {
+    thread::MutexLock lock( _pimpl->_mutex );
+    return _pimpl->verifyFileSignature( file, signature );
+  }
 
   bool KeyRing::verifyFileTrustedSignature( const Pathname & file, const Pathname & signature )
-  { return _pimpl->verifyFileTrustedSignature( file, signature ); }
+  {
+    thread::MutexLock lock( _pimpl->_mutex );
+    return _pimpl->verifyFileTrustedSignature( file, signature );
+  }
 
   void KeyRing::dumpPublicKey( const std::string & id, bool trusted, std::ostream & stream )
-  { _pimpl->dumpPublicKey( id, trusted, stream ); }
+  {
+    thread::MutexLock lock( _pimpl->_mutex );
+    _pimpl->dumpPublicKey( id, trusted, stream );
+  }
 
   PublicKey KeyRing::exportPublicKey( const PublicKeyData & keyData )
-  { return _pimpl->exportPublicKey( keyData ); }
+  {
+    thread::MutexLock lock( _pimpl->_mutex );
+    return _pimpl->exportPublicKey( keyData );
+  }
 
   PublicKey KeyRing::exportTrustedPublicKey( const PublicKeyData & keyData )
-  { return _pimpl->exportTrustedPublicKey( keyData ); }
+  {
+    thread::MutexLock lock( _pimpl->_mutex );
+    return _pimpl->exportTrustedPublicKey( keyData );
+  }
 
   bool KeyRing::isKeyTrusted( const std::string & id )
-  { return _pimpl->isKeyTrusted( id ); }
+  {
+    thread::MutexLock lock( _pimpl->_mutex );
+    return _pimpl->isKeyTrusted( id );
+  }
 
   bool KeyRing::isKeyKnown( const std::string & id )
-  { return _pimpl->isKeyKnown( id ); }
+  {
+    thread::MutexLock lock( _pimpl->_mutex );
+    return _pimpl->isKeyKnown( id );
+  }
 
   /////////////////////////////////////////////////////////////////
 } // namespace zypp
@@ -18,6 +18,7 @@
 #include "zypp/base/Logger.h"
 #include "zypp/base/IOStream.h"
 #include "zypp/PoolItem.h"
+#include "zypp/ResPool.h"
 #include "zypp/PoolQueryUtil.tcc"
 #include "zypp/ZYppCallbacks.h"
 #include "zypp/sat/SolvAttr.h"
@@ -36,6 +37,40 @@ using namespace zypp::str;
 namespace zypp
 {
 
+namespace
+{
+  /**
+   * The solvables matched by a lock.
+   * Most locks just name a package. Those are looked up by ident
+   * instead of searching the whole pool.
+   */
+  std::set<sat::Solvable> lockedBy( const PoolQuery & q )
+  {
+    std::string name;
+    if ( q.isNameQuery( name ) && q.caseSensitive() && ! q.kinds().empty() )
+    {
+      std::set<sat::Solvable> ret;
+      ResPool pool( ResPool::instance() );
+      for_( kind, q.kinds().begin(), q.kinds().end() )
+      {
+        for_( it, pool.byIdentBegin( *kind, IdString(name) ), pool.byIdentEnd( *kind, IdString(name) ) )
+          ret.insert( it->satSolvable() );
+      }
+      return ret;
+    }
+    return std::set<sat::Solvable>( q.begin(), q.end() );
+  }
+
+  /** Whether a lock matches nothing. */
+  bool emptyLock( const PoolQuery & q )
+  {
+    std::string name;
+    if ( q.isNameQuery( name ) && q.caseSensitive() && ! q.kinds().empty() )
+      return lockedBy( q ).empty();
+    return q.empty();
+  }
+}
+
 Locks& Locks::instance()
 {
   static Locks _instance;
@@ -232,7 +267,7 @@ bool Locks::existEmpty() const
 {
   for_( it, _pimpl->locks.begin(), _pimpl->locks.end() )
   {
-    if( it->empty() )
+    if( emptyLock( *it ) )
       return true;
   }
 
@@ -257,7 +292,7 @@ public:
     if( skip_rest )
       return false;
     searched++;
-    if( !q.empty() )
+    if( !emptyLock(q) )
       return false;
 
     if (!report->progress((100*searched)/all))
@@ -323,7 +358,8 @@ private:
   int contains(const PoolQuery& q, std::set<sat::Solvable>& s)
   {
     bool intersect = false;
-    for_( it,q.begin(),q.end() )
+    std::set<sat::Solvable> locked( lockedBy(q) );
+    for_( it,locked.begin(),locked.end() )
     {
       if ( s.find(*it)!=s.end() )
       {
@@ -394,7 +430,7 @@ bool Locks::Impl::mergeList(callback::SendReport<SavingLocksReport>& report)
     << " to add: " << toAdd.size() << "to remove: " << toRemove.size() << endl;
   for_(it,toRemove.begin(),toRemove.end())
   {
-    std::set<sat::Solvable> s(it->begin(),it->end());
+    std::set<sat::Solvable> s( lockedBy(*it) );
     locks.remove_if(LocksRemovePredicate(s,*it, report));
   }
 
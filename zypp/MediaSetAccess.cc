@@ -116,6 +116,27 @@ IMPL_PTR_TYPE(MediaSetAccess);
     }
   };
 
+  struct ProvideFileIfModifiedOperation
+  {
+    ProvideFileIfModifiedOperation( const std::string & validators_r )
+        : validators( validators_r )
+    {}
+
+    Pathname result;
+    std::string validators;
+    void operator()( media::MediaAccessId media, const Pathname &file )
+    {
+      media::MediaManager media_mgr;
+      // A retry must ask with the original validators.
+      std::string newValidators( validators );
+      if ( media_mgr.provideFileIfModified(media, file, newValidators) )
+      {
+        result = media_mgr.localPath(media, file);
+        validators = newValidators;
+      }
+    }
+  };
+
   struct ProvideDirTreeOperation
   {
     Pathname result;
@@ -170,6 +191,16 @@ IMPL_PTR_TYPE(MediaSetAccess);
     return op.result;
   }
 
+  Pathname MediaSetAccess::provideFileIfModified( const Pathname & file, std::string & validators_r, unsigned media_nr, ProvideFileOptions options )
+  {
+    OnMediaLocation resource;
+    ProvideFileIfModifiedOperation op( validators_r );
+    resource.setLocation(file, media_nr);
+    provide( boost::ref(op), resource, options, Pathname() );
+    validators_r = op.validators;
+    return op.result;
+  }
+
   bool MediaSetAccess::doesFileExist(const Pathname & file, unsigned media_nr )
   {
     ProvideFileExistenceOperation op;
@@ -206,16 +237,21 @@ IMPL_PTR_TYPE(MediaSetAccess);
         if ( ! media_mgr.isAttached(media) )
           media_mgr.attach(media);
 	media_mgr.setDeltafile(media, deltafile);
+	media_mgr.setChecksumType(media, resource.checksum().type());
 	deltafileset = true;
         op(media, file);
 	media_mgr.setDeltafile(media, Pathname());
+	media_mgr.setChecksumType(media, std::string());
         break;
       }
       catch ( media::MediaException & excp )
       {
         ZYPP_CAUGHT(excp);
 	if (deltafileset)
+	{
 	  media_mgr.setDeltafile(media, Pathname());
+	  media_mgr.setChecksumType(media, std::string());
+	}
         media::MediaChangeReport::Action user = media::MediaChangeReport::ABORT;
         unsigned int devindex = 0;
         vector<string> devices;
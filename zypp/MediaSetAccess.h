@@ -169,6 +169,25 @@ namespace zypp
        */
       Pathname provideFile(const Pathname & file, unsigned media_nr = 1, ProvideFileOptions options = PROVIDE_DEFAULT );
 
+      /**
+       * Provides \a file from media \a media_nr, unless it did not change
+       * since it was downloaded with \a validators_r.
+       *
+       * Like \ref provideFile, but the request is conditional (e.g. HTTP
+       * If-None-Match). If the file is provided, \a validators_r is set to
+       * the validators of the new file.
+       *
+       * \param file path to the file relative to media URL
+       * \param validators_r the validators of the last download (or empty)
+       * \param media_nr the media number in the media set
+       * \return local pathname of the requested file or an empty
+       *         pathname if the file did not change.
+       *
+       * \throws MediaException, SkipRequestException as \ref provideFile.
+       * \see zypp::media::MediaManager::provideFileIfModified()
+       */
+      Pathname provideFileIfModified( const Pathname & file, std::string & validators_r, unsigned media_nr = 1, ProvideFileOptions options = PROVIDE_DEFAULT );
+
       /**
        * Release file from media.
        * This signal that file is not needed anymore.
@@ -13,6 +13,8 @@
 #include <sys/types.h> // for ::minor, ::major macros
 #include <utime.h>     // for ::utime
 #include <sys/statvfs.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>  // for FICLONE
 
 #include <iostream>
 #include <fstream>
@@ -25,10 +27,16 @@
 #include "zypp/base/Errno.h"
 
 #include "zypp/AutoDispose.h"
-#include "zypp/ExternalProgram.h"
 #include "zypp/PathInfo.h"
 #include "zypp/Digest.h"
 #include "zypp/TmpPath.h"
+#include "zypp/thread/Mutex.h"
+#include "zypp/thread/MutexLock.h"
+#include "zypp/thread/WorkerPool.h"
+
+#if defined(__GLIBC__) && ( __GLIBC__ > 2 || ( __GLIBC__ == 2 && __GLIBC_MINOR__ >= 27 ) )
+#define ZYPP_HAVE_COPY_FILE_RANGE 1
+#endif
 
 using std::endl;
 using std::string;
@@ -379,42 +387,363 @@ namespace zypp
 
     ///////////////////////////////////////////////////////////////////
     //
-    //	METHOD NAME : recursive_rmdir
-    //	METHOD TYPE : int
+    //	In-process tree removal and copy
     //
-    static int recursive_rmdir_1( const Pathname & dir )
+    ///////////////////////////////////////////////////////////////////
+    namespace
     {
-      DIR * dp;
-      struct dirent * d;
+      /** RAII for a file descriptor. */
+      struct FdGuard
+      {
+        explicit FdGuard( int fd_r = -1 ) : _fd( fd_r ) {}
+        ~FdGuard() { if ( _fd >= 0 ) ::close( _fd ); }
+        int get() const { return _fd; }
+        int release() { int ret = _fd; _fd = -1; return ret; }
+      private:
+        int _fd;
+        FdGuard( const FdGuard & );
+        FdGuard & operator=( const FdGuard & );
+      };
 
-      if ( ! (dp = opendir( dir.c_str() )) )
-        return _Log_Result( errno );
+      inline int openDirAt( int dirfd_r, const char * name_r )
+      { return ::openat( dirfd_r, name_r, O_RDONLY|O_DIRECTORY|O_NOFOLLOW|O_CLOEXEC ); }
+
+      /** Whether \a d_r is a directory (not following symlinks). */
+      inline bool isDirEntry( int dirfd_r, const struct dirent * d_r )
+      {
+        if ( d_r->d_type != DT_UNKNOWN )
+          return d_r->d_type == DT_DIR;
+        struct stat st;
+        return( ::fstatat( dirfd_r, d_r->d_name, &st, AT_SYMLINK_NOFOLLOW ) == 0 && S_ISDIR( st.st_mode ) );
+      }
+
+      inline bool isDots( const char * name_r )
+      { return( name_r[0] == '.' && ( name_r[1] == '\0' || ( name_r[1] == '.' && name_r[2] == '\0' ) ) ); }
+
+      inline bool isDotfile( const std::string & name_r )
+      { return( ! name_r.empty() && name_r[0] == '.' ); }
+
+      /** The entries of the directory \a dirfd_r (without \c . and \c ..).
+       * \a subdirs_r receives the directories, \a others_r everything else.
+       */
+      int readDirAt( int dirfd_r, std::vector<std::string> & subdirs_r, std::vector<std::string> & others_r )
+      {
+        int fd = ::dup( dirfd_r );
+        if ( fd < 0 )
+          return errno;
+        DIR * dp = ::fdopendir( fd );
+        if ( ! dp )
+        {
+          int ret = errno;
+          ::close( fd );
+          return ret;
+        }
+        for ( struct dirent * d = ::readdir( dp ); d; d = ::readdir( dp ) )
+        {
+          if ( isDots( d->d_name ) )
+            continue;
+          ( isDirEntry( dirfd_r, d ) ? subdirs_r : others_r ).push_back( d->d_name );
+        }
+        ::closedir( dp );
+        return 0;
+      }
+
+      int removeContentAt( int dirfd_r );
+
+      /** Remove the directory \a name_r in \a dirfd_r including its content. */
+      int removeDirAt( int dirfd_r, const std::string & name_r )
+      {
+        int ret = 0;
+        {
+          FdGuard fd( openDirAt( dirfd_r, name_r.c_str() ) );
+          if ( fd.get() < 0 )
+            return errno;
+          ret = removeContentAt( fd.get() );
+        }
+        if ( ::unlinkat( dirfd_r, name_r.c_str(), AT_REMOVEDIR ) != 0 && ! ret )
+          ret = errno;
+        return ret;
+      }
+
+      /** Remove the content of the directory \a dirfd_r like <tt>rm -rf</tt> does:
+       * Go on after errors. Return the first error.
+       */
+      int removeContentAt( int dirfd_r )
+      {
+        std::vector<std::string> subdirs;
+        std::vector<std::string> others;
+        int ret = readDirAt( dirfd_r, subdirs, others );
+
+        for_( it, others.begin(), others.end() )
+        {
+          if ( ::unlinkat( dirfd_r, it->c_str(), 0 ) != 0 && ! ret && errno != ENOENT )
+            ret = errno;
+        }
+        for_( it, subdirs.begin(), subdirs.end() )
+        {
+          int res = removeDirAt( dirfd_r, *it );
+          if ( res && ! ret && res != ENOENT )
+            ret = res;
+        }
+        return ret;
+      }
 
-      while ( (d = readdir(dp)) )
+      /** Remove the content of \a path_r. Subdirectories are removed in parallel
+       * if \a parallel_r. Entries starting with a \c '.' are kept if \a keepDotfiles_r
+       * (like a shells \c * does).
+       */
+      int removeContent( const Pathname & path_r, bool parallel_r, bool keepDotfiles_r )
       {
-        std::string direntry = d->d_name;
-        if ( direntry == "." || direntry == ".." )
-          continue;
-        Pathname new_path( dir / d->d_name );
+        FdGuard dirfd( ::open( path_r.c_str(), O_RDONLY|O_DIRECTORY|O_NOFOLLOW|O_CLOEXEC ) );
+        if ( dirfd.get() < 0 )
+          return errno;
+
+        std::vector<std::string> subdirs;
+        std::vector<std::string> others;
+        int ret = readDirAt( dirfd.get(), subdirs, others );
+        if ( keepDotfiles_r )
+        {
+          subdirs.erase( std::remove_if( subdirs.begin(), subdirs.end(), isDotfile ), subdirs.end() );
+          others.erase( std::remove_if( others.begin(), others.end(), isDotfile ), others.end() );
+        }
+
+        for_( it, others.begin(), others.end() )
+        {
+          if ( ::unlinkat( dirfd.get(), it->c_str(), 0 ) != 0 && ! ret && errno != ENOENT )
+            ret = errno;
+        }
+
+        std::vector<int> results( subdirs.size(), 0 );
+        if ( parallel_r && subdirs.size() > 1 && ! thread::WorkerPool::isWorkerThread() )
+        {
+          thread::WorkerPool pool( std::min<unsigned>( subdirs.size(), thread::WorkerPool::defaultSize() ) );
+          for ( unsigned i = 0; i < subdirs.size(); ++i )
+          {
+            int fd = dirfd.get();
+            const std::string & name( subdirs[i] );
+            int & result( results[i] );
+            pool.schedule( [fd,&name,&result]() { result = removeDirAt( fd, name ); } );
+          }
+          pool.wait();
+        }
+        else
+        {
+          for ( unsigned i = 0; i < subdirs.size(); ++i )
+            results[i] = removeDirAt( dirfd.get(), subdirs[i] );
+        }
+        for_( it, results.begin(), results.end() )
+        {
+          if ( *it && ! ret && *it != ENOENT )
+            ret = *it;
+        }
+        return ret;
+      }
 
+      /** Copy the data of \a srcfd_r to \a dstfd_r. Try a reflink first,
+       * then copy_file_range, then read/write.
+       */
+      int copyData( int srcfd_r, int dstfd_r )
+      {
+#ifdef FICLONE
+        if ( ::ioctl( dstfd_r, FICLONE, srcfd_r ) == 0 )
+          return 0;
+#endif
+#ifdef ZYPP_HAVE_COPY_FILE_RANGE
+        for ( ;; )
+        {
+          ssize_t n = ::copy_file_range( srcfd_r, NULL, dstfd_r, NULL, 1024*1024*1024, 0 );
+          if ( n == 0 )
+            return 0;
+          if ( n < 0 )
+          {
+            if ( errno == EINTR )
+              continue;
+            if ( errno != EXDEV && errno != ENOSYS && errno != EINVAL && errno != EOPNOTSUPP )
+              return errno;
+            break;	// not supported here: plain copy
+          }
+        }
+        // Nothing was copied if it's not supported.
+#endif
+        char buf[65536];
+        for ( ;; )
+        {
+          ssize_t n = ::read( srcfd_r, buf, sizeof(buf) );
+          if ( n == 0 )
+            return 0;
+          if ( n < 0 )
+          {
+            if ( errno == EINTR )
+              continue;
+            return errno;
+          }
+          for ( ssize_t done = 0; done < n; )
+          {
+            ssize_t w = ::write( dstfd_r, buf + done, n - done );
+            if ( w < 0 )
+            {
+              if ( errno == EINTR )
+                continue;
+              return errno;
+            }
+            done += w;
+          }
+        }
+      }
+
+      /** Copy the regular file \a srcname_r in \a srcdirfd_r to \a dstname_r
+       * in \a dstdirfd_r like \c cp does (the mode is taken from the source
+       * and umask applies). An existing destination is overwritten, or removed
+       * first if \a removeDestination_r. Returns \c EEXIST if the destination
+       * is the source file itself, which would otherwise be truncated or removed.
+       */
+      int copyFileAt( int srcdirfd_r, const char * srcname_r, int dstdirfd_r, const char * dstname_r, bool removeDestination_r )
+      {
+        FdGuard src( ::openat( srcdirfd_r, srcname_r, O_RDONLY|O_CLOEXEC ) );
+        if ( src.get() < 0 )
+          return errno;
         struct stat st;
-        if ( ! lstat( new_path.c_str(), &st ) )
+        if ( ::fstat( src.get(), &st ) != 0 )
+          return errno;
+
+        struct stat dst_st;
+        if ( ::fstatat( dstdirfd_r, dstname_r, &dst_st, 0 ) == 0
+             && dst_st.st_dev == st.st_dev && dst_st.st_ino == st.st_ino )
+          return EEXIST;
+
+        if ( removeDestination_r && ::unlinkat( dstdirfd_r, dstname_r, 0 ) != 0 && errno != ENOENT )
+          return errno;
+        FdGuard dst( ::openat( dstdirfd_r, dstname_r, O_WRONLY|O_CREAT|O_TRUNC|O_CLOEXEC, st.st_mode & 07777 ) );
+        if ( dst.get() < 0 )
+          return errno;
+
+        int ret = copyData( src.get(), dst.get() );
+        if ( ::close( dst.release() ) != 0 && ! ret )
+          ret = errno;
+        return ret;
+      }
+
+      /** Hardlinked files already copied: source (dev,ino) to their copy. */
+      typedef std::map<std::pair<dev_t,ino_t>,Pathname> CopiedLinks;
+
+      int copyDirAt( int srcdirfd_r, const char * srcname_r, int dstdirfd_r, const Pathname & dstpath_r, CopiedLinks & links_r );
+
+      /** Copy the content of \a srcdirfd_r into \a dstdirfd_r like <tt>cp -dR</tt>
+       * does: Symlinks are copied as symlinks, hardlinks within the tree are kept.
+       * Go on after errors. Return the first error.
+       */
+      int copyContentAt( int srcdirfd_r, int dstdirfd_r, const Pathname & dstpath_r, CopiedLinks & links_r )
+      {
+        std::vector<std::string> subdirs;
+        std::vector<std::string> others;
+        int ret = readDirAt( srcdirfd_r, subdirs, others );
+
+        for_( it, others.begin(), others.end() )
         {
-          if ( S_ISDIR( st.st_mode ) )
-            recursive_rmdir_1( new_path );
+          const char * name = it->c_str();
+          struct stat st;
+          int res = 0;
+          if ( ::fstatat( srcdirfd_r, name, &st, AT_SYMLINK_NOFOLLOW ) != 0 )
+            res = errno;
+          else if ( S_ISLNK( st.st_mode ) )
+          {
+            std::vector<char> target( st.st_size + 1 );
+            ssize_t len = ::readlinkat( srcdirfd_r, name, &target[0], target.size() );
+            if ( len < 0 )
+              res = errno;
+            else
+            {
+              target[len] = '\0';
+              ::unlinkat( dstdirfd_r, name, 0 );
+              if ( ::symlinkat( &target[0], dstdirfd_r, name ) != 0 )
+                res = errno;
+            }
+          }
+          else if ( S_ISREG( st.st_mode ) )
+          {
+            CopiedLinks::const_iterator link( st.st_nlink > 1 ? links_r.find( std::make_pair( st.st_dev, st.st_ino ) ) : links_r.end() );
+            if ( link != links_r.end() )
+            {
+              ::unlinkat( dstdirfd_r, name, 0 );
+              if ( ::linkat( AT_FDCWD, link->second.c_str(), dstdirfd_r, name, 0 ) != 0 )
+                res = errno;
+            }
+            else
+            {
+              res = copyFileAt( srcdirfd_r, name, dstdirfd_r, name, false );
+              if ( ! res && st.st_nlink > 1 )
+                links_r[std::make_pair( st.st_dev, st.st_ino )] = dstpath_r / name;
+            }
+          }
           else
-            ::unlink( new_path.c_str() );
+          {
+            // fifo, device, socket
+            ::unlinkat( dstdirfd_r, name, 0 );
+            if ( ::mknodat( dstdirfd_r, name, st.st_mode, st.st_rdev ) != 0 )
+              res = errno;
+          }
+          if ( res )
+          {
+            WAR << "copy " << dstpath_r / name << ": " << str::strerror( res ) << endl;
+            if ( ! ret )
+              ret = res;
+          }
         }
+
+        for_( it, subdirs.begin(), subdirs.end() )
+        {
+          int res = copyDirAt( srcdirfd_r, it->c_str(), dstdirfd_r, dstpath_r / *it, links_r );
+          if ( res && ! ret )
+            ret = res;
+        }
+        return ret;
       }
-      closedir( dp );
 
-      if ( ::rmdir( dir.c_str() ) < 0 )
-        return errno;
+      /** Copy the directory \a srcname_r in \a srcdirfd_r to \a dstpath_r
+       * (which is \a dstdirfd_r / \a dstpath_r.basename()).
+       */
+      int copyDirAt( int srcdirfd_r, const char * srcname_r, int dstdirfd_r, const Pathname & dstpath_r, CopiedLinks & links_r )
+      {
+        FdGuard src( openDirAt( srcdirfd_r, srcname_r ) );
+        if ( src.get() < 0 )
+          return errno;
+        struct stat st;
+        if ( ::fstat( src.get(), &st ) != 0 )
+          return errno;
+
+        std::string dstname( dstpath_r.basename() );
+        if ( ::mkdirat( dstdirfd_r, dstname.c_str(), ( st.st_mode & 07777 ) | S_IRWXU ) != 0 && errno != EEXIST )
+          return errno;
+        FdGuard dst( openDirAt( dstdirfd_r, dstname.c_str() ) );
+        if ( dst.get() < 0 )
+          return errno;
+
+        int ret = copyContentAt( src.get(), dst.get(), dstpath_r, links_r );
+        if ( ( st.st_mode & S_IRWXU ) != S_IRWXU )
+          ::fchmod( dst.get(), applyUmaskTo( st.st_mode & 07777 ) );	// as created, but now filled
+        return ret;
+      }
+
+      /** Copy the content of \a srcpath_r into the existing directory \a destpath_r. */
+      int copyContent( const Pathname & srcpath_r, const Pathname & destpath_r )
+      {
+        FdGuard src( ::open( srcpath_r.c_str(), O_RDONLY|O_DIRECTORY|O_CLOEXEC ) );
+        if ( src.get() < 0 )
+          return errno;
+        FdGuard dst( ::open( destpath_r.c_str(), O_RDONLY|O_DIRECTORY|O_CLOEXEC ) );
+        if ( dst.get() < 0 )
+          return errno;
+        CopiedLinks links;
+        return copyContentAt( src.get(), dst.get(), destpath_r, links );
+      }
+    } // namespace
 
-      return 0;
-    }
     ///////////////////////////////////////////////////////////////////
-    int recursive_rmdir( const Pathname & path )
+    //
+    //	METHOD NAME : recursive_rmdir
+    //	METHOD TYPE : int
+    //
+    int recursive_rmdir( const Pathname & path, bool parallel_r )
     {
       MIL << "recursive_rmdir " << path << ' ';
       PathInfo p( path );
@@ -427,7 +756,10 @@ namespace zypp
         return _Log_Result( ENOTDIR );
       }
 
-      return _Log_Result( recursive_rmdir_1( path ) );
+      int ret = removeContent( path, parallel_r, false );
+      if ( ::rmdir( path.c_str() ) < 0 && ! ret )
+        ret = errno;
+      return _Log_Result( ret );
     }
 
     ///////////////////////////////////////////////////////////////////
@@ -435,7 +767,7 @@ namespace zypp
     //	METHOD NAME : clean_dir
     //	METHOD TYPE : int
     //
-    int clean_dir( const Pathname & path )
+    int clean_dir( const Pathname & path, bool parallel_r )
     {
       MIL << "clean_dir " << path << ' ';
       PathInfo p( path );
@@ -448,13 +780,7 @@ namespace zypp
         return _Log_Result( ENOTDIR );
       }
 
-      string cmd( str::form( "cd '%s' && rm -rf --preserve-root -- *", path.asString().c_str() ) );
-      ExternalProgram prog( cmd, ExternalProgram::Stderr_To_Stdout );
-      for ( string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-        MIL << "  " << output;
-      }
-      int ret = prog.close();
-      return _Log_Result( ret, "returned" );
+      return _Log_Result( removeContent( path, parallel_r, true ) );
     }
 
     ///////////////////////////////////////////////////////////////////
@@ -481,21 +807,12 @@ namespace zypp
         return _Log_Result( EEXIST );
       }
 
-
-      const char *const argv[] = {
-        "/bin/cp",
-        "-dR",
-        "--",
-        srcpath.asString().c_str(),
-        destpath.asString().c_str(),
-        NULL
-      };
-      ExternalProgram prog( argv, ExternalProgram::Stderr_To_Stdout );
-      for ( string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-        MIL << "  " << output;
+      FdGuard dst( ::open( destpath.c_str(), O_RDONLY|O_DIRECTORY|O_CLOEXEC ) );
+      if ( dst.get() < 0 ) {
+        return _Log_Result( errno );
       }
-      int ret = prog.close();
-      return _Log_Result( ret, "returned" );
+      CopiedLinks links;
+      return _Log_Result( copyDirAt( AT_FDCWD, srcpath.c_str(), dst.get(), destpath / srcpath.basename(), links ) );
     }
 
     ///////////////////////////////////////////////////////////////////
@@ -521,22 +838,7 @@ namespace zypp
         return _Log_Result( EEXIST );
       }
 
-      std::string src( srcpath.asString());
-      src += "/.";
-      const char *const argv[] = {
-        "/bin/cp",
-        "-dR",
-        "--",
-        src.c_str(),
-        destpath.asString().c_str(),
-        NULL
-      };
-      ExternalProgram prog( argv, ExternalProgram::Stderr_To_Stdout );
-      for ( string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-        MIL << "  " << output;
-      }
-      int ret = prog.close();
-      return _Log_Result( ret, "returned" );
+      return _Log_Result( copyContent( srcpath, destpath ) );
     }
 
     ///////////////////////////////////////////////////////////////////////
@@ -763,20 +1065,7 @@ namespace zypp
         return _Log_Result( EISDIR );
       }
 
-      const char *const argv[] = {
-        "/bin/cp",
-        "--remove-destination",
-        "--",
-        file.asString().c_str(),
-        dest.asString().c_str(),
-        NULL
-      };
-      ExternalProgram prog( argv, ExternalProgram::Stderr_To_Stdout );
-      for ( string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-        MIL << "  " << output;
-      }
-      int ret = prog.close();
-      return _Log_Result( ret, "returned" );
+      return _Log_Result( copyFileAt( AT_FDCWD, file.c_str(), AT_FDCWD, dest.c_str(), /*removeDestination*/true ) );
     }
 
     ///////////////////////////////////////////////////////////////////
@@ -930,19 +1219,7 @@ namespace zypp
         return _Log_Result( ENOTDIR );
       }
 
-      const char *const argv[] = {
-        "/bin/cp",
-        "--",
-        file.asString().c_str(),
-        dest.asString().c_str(),
-        NULL
-      };
-      ExternalProgram prog( argv, ExternalProgram::Stderr_To_Stdout );
-      for ( string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-        MIL << "  " << output;
-      }
-      int ret = prog.close();
-      return _Log_Result( ret, "returned" );
+      return _Log_Result( copyFileAt( AT_FDCWD, file.c_str(), AT_FDCWD, (dest / file.basename()).c_str(), false ) );
     }
 
     ///////////////////////////////////////////////////////////////////
@@ -977,16 +1254,99 @@ namespace zypp
     //  METHOD NAME : checksum
     //  METHOD TYPE : std::string
     //
+    namespace
+    {
+      /** Checksums computed while writing files. Indexed by device and
+       * inode; size and mtime tell whether the file was changed since.
+       * (Not ctime, as hardlinking the file must not invalidate it.)
+       */
+      struct ChecksumCache
+      {
+        struct Entry
+        {
+          off_t _size;
+          struct timespec _mtime;
+          std::map<std::string,std::string> _sums;	// lowercased type: checksum
+        };
+        typedef std::map<std::pair<dev_t,ino_t>,Entry> Entries;
+
+        static ChecksumCache & instance()
+        {
+          static ChecksumCache _cache;
+          return _cache;
+        }
+
+        static bool sameFile( const struct stat & st_r, const Entry & entry_r )
+        {
+          return( st_r.st_size == entry_r._size
+                  && st_r.st_mtim.tv_sec == entry_r._mtime.tv_sec
+                  && st_r.st_mtim.tv_nsec == entry_r._mtime.tv_nsec );
+        }
+
+        void remember( const struct stat & st_r, const std::string & algorithm_r, const std::string & sum_r )
+        {
+          if ( sum_r.empty() || ! S_ISREG( st_r.st_mode ) )
+            return;
+
+          thread::MutexLock lock( _mutex );
+          if ( _entries.size() >= 8192 )
+            _entries.clear();	// it's just a cache
+          Entry & entry( _entries[std::make_pair( st_r.st_dev, st_r.st_ino )] );
+          if ( ! sameFile( st_r, entry ) )
+          {
+            entry._size = st_r.st_size;
+            entry._mtime = st_r.st_mtim;
+            entry._sums.clear();
+          }
+          entry._sums[str::toLower( algorithm_r )] = sum_r;
+        }
+
+        std::string lookup( const struct stat & st_r, const std::string & algorithm_r )
+        {
+          thread::MutexLock lock( _mutex );
+          Entries::iterator it( _entries.find( std::make_pair( st_r.st_dev, st_r.st_ino ) ) );
+          if ( it == _entries.end() )
+            return std::string();
+          if ( ! sameFile( st_r, it->second ) )
+          {
+            _entries.erase( it );
+            return std::string();
+          }
+          std::map<std::string,std::string>::const_iterator sum( it->second._sums.find( str::toLower( algorithm_r ) ) );
+          return( sum == it->second._sums.end() ? std::string() : sum->second );
+        }
+
+      private:
+        Entries _entries;
+        thread::Mutex _mutex;
+      };
+    }
+
+    void rememberChecksum( const Pathname & file, const CheckSum & checksum_r )
+    {
+      struct stat st;
+      if ( ! checksum_r.empty() && ::stat( file.c_str(), &st ) == 0 )
+        ChecksumCache::instance().remember( st, checksum_r.type(), checksum_r.checksum() );
+    }
+
     std::string checksum( const Pathname & file, const std::string &algorithm )
     {
-      if ( ! PathInfo( file ).isFile() ) {
+      struct stat st;
+      if ( ::stat( file.c_str(), &st ) != 0 || ! S_ISREG( st.st_mode ) ) {
         return string();
       }
+      std::string remembered( ChecksumCache::instance().lookup( st, algorithm ) );
+      if ( ! remembered.empty() ) {
+        DBG << "Remembered " << algorithm << " checksum of " << file << endl;
+        return remembered;
+      }
       std::ifstream istr( file.asString().c_str() );
       if ( ! istr ) {
         return string();
       }
-      return Digest::digest( algorithm, istr );
+      std::string ret( Digest::digest( algorithm, istr ) );
+      ChecksumCache::instance().remember( st, algorithm, ret );	// st: as before reading
+      return ret;
     }
 
     bool is_checksum( const Pathname & file, const CheckSum &checksum )
@@ -421,35 +421,44 @@ namespace zypp
     /**
      * Like 'rm -r DIR'. Delete a directory, recursively removing its contents.
      *
+     * The tree is removed in-process. If \a parallel_r is \c true, the
+     * subdirectories of \a path are removed concurrently by a
+     * \ref thread::WorkerPool (useful for large caches).
+     *
      * @return 0 on success, ENOTDIR if path is not a directory, otherwise the
-     * commands return value.
+     * first errno encountered.
      **/
-    int recursive_rmdir( const Pathname & path );
+    int recursive_rmdir( const Pathname & path, bool parallel_r = false );
 
     /**
      * Like 'rm -r DIR/ *'. Delete directory contents, but keep the directory itself.
+     * As with the shells \c *, top level entries starting with a \c '.' are kept.
+     * \a parallel_r as in \ref recursive_rmdir.
      *
      * @return 0 on success, ENOTDIR if path is not a directory, otherwise the
-     * commands return value.
+     * first errno encountered.
      **/
-    int clean_dir( const Pathname & path );
+    int clean_dir( const Pathname & path, bool parallel_r = false );
 
     /**
-     * Like 'cp -a srcpath destpath'. Copy directory tree. srcpath/destpath must be
+     * Like 'cp -dR srcpath destpath'. Copy directory tree. srcpath/destpath must be
      * directories. 'basename srcpath' must not exist in destpath.
      *
+     * Symlinks are copied as symlinks, hardlinks within the tree are preserved.
+     * File data are reflinked or copied in-kernel if the filesystem supports it.
+     *
      * @return 0 on success, ENOTDIR if srcpath/destpath is not a directory, EEXIST if
-     * 'basename srcpath' exists in destpath, otherwise the commands return value.
+     * 'basename srcpath' exists in destpath, otherwise the first errno encountered.
      **/
     int copy_dir( const Pathname & srcpath, const Pathname & destpath );
 
     /**
-     * Like 'cp -a srcpath/. destpath'. Copy the content of srcpath recursively
+     * Like 'cp -dR srcpath/. destpath'. Copy the content of srcpath recursively
      * into destpath. Both \p srcpath and \p destpath has to exists.
      *
      * @return 0 on success, ENOTDIR if srcpath/destpath is not a directory,
-     * EEXIST if srcpath and destpath are equal, otherwise the commands
-     * return value.
+     * EEXIST if srcpath and destpath are equal, otherwise the first errno
+     * encountered.
      */
     int copy_dir_content( const Pathname & srcpath, const Pathname & destpath);
 
@@ -631,7 +640,8 @@ namespace zypp
      * Like 'cp file dest'. Copy file to destination file.
      *
      * @return 0 on success, EINVAL if file is not a file, EISDIR if
-     * destiantion is a directory, otherwise the commands return value.
+     * destiantion is a directory, EEXIST if destination is file itself,
+     * otherwise errno.
      **/
     int copy( const Pathname & file, const Pathname & dest );
 
@@ -691,7 +701,7 @@ namespace zypp
      * Like 'cp file dest'. Copy file to dest dir.
      *
      * @return 0 on success, EINVAL if file is not a file, ENOTDIR if dest
-     * is no directory, otherwise the commands return value.
+     * is no directory, EEXIST if file is already in dest, otherwise errno.
      **/
     int copy_file2dir( const Pathname & file, const Pathname & dest );
     //@}
@@ -719,10 +729,23 @@ namespace zypp
     /**
      * Compute a files checksum
      *
+     * If the checksum was computed while the file was written (see
+     * \ref rememberChecksum) or by an earlier call, the file is not
+     * read again.
+     *
      * @return the files checksum on success, otherwise an empty string..
      **/
     std::string checksum( const Pathname & file, const std::string &algorithm );
 
+    /**
+     * Remember the checksum of a file computed while writing it.
+     *
+     * Call this when the file is complete (i.e. after it was renamed to
+     * its final name). \ref checksum will return \a checksum_r instead of
+     * reading the file, as long as the file (inode) is not changed.
+     **/
+    void rememberChecksum( const Pathname & file, const CheckSum & checksum_r );
+
     /**
      * check files checksum
      *
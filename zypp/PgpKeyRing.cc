@@ -0,0 +1,1265 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/PgpKeyRing.cc
+ *
+*/
+#include <ctime>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <map>
+
+#include <openssl/bn.h>
+#include <openssl/rsa.h>
+#include <openssl/dsa.h>
+#include <openssl/objects.h>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/String.h"
+#include "zypp/PathInfo.h"
+#include "zypp/Date.h"
+#include "zypp/Digest.h"
+#include "zypp/PgpKeyRing.h"
+
+#undef  ZYPP_BASE_LOGGER_LOGGROUP
+#define ZYPP_BASE_LOGGER_LOGGROUP "zypp::KeyRing"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+
+  ///////////////////////////////////////////////////////////////////
+  namespace
+  { /////////////////////////////////////////////////////////////////
+
+    typedef unsigned char byte;
+
+    enum PacketTag
+    {
+      TAG_SIGNATURE  = 2,
+      TAG_PUBKEY     = 6,
+      TAG_TRUST      = 12,
+      TAG_USERID     = 13,
+      TAG_PUBSUBKEY  = 14,
+      TAG_USERATTR   = 17
+    };
+
+    enum PubkeyAlgo
+    {
+      ALGO_RSA       = 1,
+      ALGO_RSA_E     = 2,
+      ALGO_RSA_S     = 3,
+      ALGO_ELGAMAL_E = 16,
+      ALGO_DSA       = 17,
+      ALGO_ELGAMAL   = 20
+    };
+
+    std::string hexstring( const byte * data_r, unsigned len_r )
+    {
+      static const char digits[] = "0123456789ABCDEF";
+      std::string ret;
+      ret.reserve( 2*len_r );
+      for ( unsigned i = 0; i < len_r; ++i )
+      {
+        ret += digits[data_r[i] >> 4];
+        ret += digits[data_r[i] & 0x0f];
+      }
+      return ret;
+    }
+
+    inline unsigned get16( const byte * p )
+    { return ( unsigned(p[0]) << 8 ) | p[1]; }
+
+    inline unsigned long get32( const byte * p )
+    { return ( (unsigned long)p[0] << 24 ) | ( (unsigned long)p[1] << 16 ) | ( (unsigned long)p[2] << 8 ) | p[3]; }
+
+    ///////////////////////////////////////////////////////////////////
+    // ASCII armor
+    ///////////////////////////////////////////////////////////////////
+
+    unsigned long crc24( const std::string & data_r )
+    {
+      unsigned long crc = 0xB704CEUL;
+      for_( it, data_r.begin(), data_r.end() )
+      {
+        crc ^= ( (unsigned long)(byte)*it ) << 16;
+        for ( int i = 0; i < 8; ++i )
+        {
+          crc <<= 1;
+          if ( crc & 0x1000000UL )
+            crc ^= 0x1864CFBUL;
+        }
+      }
+      return crc & 0xFFFFFFUL;
+    }
+
+    int base64value( char ch_r )
+    {
+      if ( 'A' <= ch_r && ch_r <= 'Z' ) return ch_r - 'A';
+      if ( 'a' <= ch_r && ch_r <= 'z' ) return ch_r - 'a' + 26;
+      if ( '0' <= ch_r && ch_r <= '9' ) return ch_r - '0' + 52;
+      if ( ch_r == '+' ) return 62;
+      if ( ch_r == '/' ) return 63;
+      return -1;
+    }
+
+    /** Append the base64 decoded \a text_r to \a result_r. */
+    bool base64decode( const std::string & text_r, std::string & result_r )
+    {
+      unsigned long bits = 0;
+      int nbits = 0;
+      for_( it, text_r.begin(), text_r.end() )
+      {
+        if ( *it == '=' )
+          break;
+        int val = base64value( *it );
+        if ( val < 0 )
+        {
+          if ( ::isspace( (byte)*it ) )
+            continue;
+          return false;
+        }
+        bits = ( bits << 6 ) | val;
+        nbits += 6;
+        if ( nbits >= 8 )
+        {
+          nbits -= 8;
+          result_r += char( ( bits >> nbits ) & 0xff );
+        }
+      }
+      return true;
+    }
+
+    std::string base64encode( const std::string & data_r )
+    {
+      static const char digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+      std::string ret;
+      ret.reserve( ( data_r.size() + 2 ) / 3 * 4 );
+      for ( std::string::size_type i = 0; i < data_r.size(); i += 3 )
+      {
+        unsigned long bits = (unsigned long)(byte)data_r[i] << 16;
+        if ( i+1 < data_r.size() ) bits |= (unsigned long)(byte)data_r[i+1] << 8;
+        if ( i+2 < data_r.size() ) bits |= (byte)data_r[i+2];
+        ret += digits[( bits >> 18 ) & 0x3f];
+        ret += digits[( bits >> 12 ) & 0x3f];
+        ret += ( i+1 < data_r.size() ? digits[( bits >> 6 ) & 0x3f] : '=' );
+        ret += ( i+2 < data_r.size() ? digits[bits & 0x3f] : '=' );
+      }
+      return ret;
+    }
+
+    /** Decode all armored blocks of type \a type_r (e.g. \c "SIGNATURE") in \a text_r.
+     * The decoded data are appended to \a result_r. Returns \c false if
+     * there is no such block or a block is malformed.
+     */
+    bool dearmor( const std::string & text_r, const std::string & type_r, std::string & result_r )
+    {
+      const std::string begin( "-----BEGIN PGP " + type_r + "-----" );
+      const std::string end( "-----END PGP " + type_r + "-----" );
+
+      bool found = false;
+      std::istringstream in( text_r );
+      enum { OUTSIDE, HEADER, BODY, DONE } state = OUTSIDE;
+      std::string body;
+      std::string crc;
+      for ( std::string line; std::getline( in, line ); )
+      {
+        if ( ! line.empty() && line[line.size()-1] == '\r' )
+          line.erase( line.size()-1 );
+
+        switch ( state )
+        {
+          case OUTSIDE:
+            if ( line == begin )
+            {
+              state = HEADER;
+              body.clear();
+              crc.clear();
+            }
+            break;
+
+          case HEADER:
+            if ( str::trim( line ).empty() )
+              state = BODY;
+            else if ( line.find( ':' ) == std::string::npos )
+              return false;
+            break;
+
+          case BODY:
+          case DONE:
+            if ( line == end )
+            {
+              std::string data;
+              if ( ! base64decode( body, data ) )
+                return false;
+              if ( ! crc.empty() )
+              {
+                std::string sum;
+                if ( ! base64decode( crc, sum ) || sum.size() != 3 )
+                  return false;
+                const byte * p = (const byte *)sum.data();
+                if ( ( ( (unsigned long)p[0] << 16 ) | ( (unsigned long)p[1] << 8 ) | p[2] ) != crc24( data ) )
+                  return false;
+              }
+              result_r += data;
+              found = true;
+              state = OUTSIDE;
+            }
+            else if ( state == BODY && ! line.empty() && line[0] == '=' )
+            {
+              crc = line.substr( 1 );
+              state = DONE;
+            }
+            else if ( state == BODY )
+              body += line;
+            break;
+        }
+      }
+      return found && state == OUTSIDE;
+    }
+
+    /** Write \a data_r ASCII armored as type \a type_r. */
+    void armor( std::ostream & str, const std::string & type_r, const std::string & data_r )
+    {
+      str << "-----BEGIN PGP " << type_r << "-----" << endl;
+      str << endl;
+      std::string text( base64encode( data_r ) );
+      for ( std::string::size_type i = 0; i < text.size(); i += 64 )
+        str << text.substr( i, 64 ) << endl;
+      unsigned long crc = crc24( data_r );
+      std::string sum;
+      sum += char( ( crc >> 16 ) & 0xff );
+      sum += char( ( crc >> 8 ) & 0xff );
+      sum += char( crc & 0xff );
+      str << "=" << base64encode( sum ) << endl;
+      str << "-----END PGP " << type_r << "-----" << endl;
+    }
+
+    /** Read the file content. If it is ASCII armored, the decoded blocks of
+     * type \a type_r (e.g. \c "SIGNATURE"). Returns \c false on error.
+     */
+    bool readPgpData( const Pathname & file_r, const std::string & type_r, std::string & result_r )
+    {
+      std::ifstream in( file_r.c_str(), std::ios::in | std::ios::binary );
+      if ( ! in )
+        return false;
+      std::ostringstream buf;
+      buf << in.rdbuf();
+      std::string data( buf.str() );
+
+      result_r.clear();
+      if ( data.empty() )
+        return true;
+      if ( (byte)data[0] & 0x80 )
+      {
+        result_r.swap( data );	// binary
+        return true;
+      }
+      return dearmor( data, type_r, result_r );
+    }
+
+    ///////////////////////////////////////////////////////////////////
+    // Packets
+    ///////////////////////////////////////////////////////////////////
+
+    struct Packet
+    {
+      unsigned     tag;
+      const byte * body;
+      unsigned     len;
+      std::string::size_type begin;	// offset of the header
+      std::string::size_type end;	// offset behind the body
+    };
+
+    /** Read the packet at \a pos_r in \a data_r and advance \a pos_r.
+     * Partial body lengths are not supported.
+     */
+    bool nextPacket( const std::string & data_r, std::string::size_type & pos_r, Packet & packet_r )
+    {
+      const byte * data = (const byte *)data_r.data();
+      std::string::size_type size = data_r.size();
+      if ( pos_r >= size || ! ( data[pos_r] & 0x80 ) )
+        return false;
+
+      std::string::size_type pos = pos_r;
+      byte ptag = data[pos++];
+      unsigned long len = 0;
+      if ( ptag & 0x40 )
+      {
+        // new format
+        packet_r.tag = ptag & 0x3f;
+        if ( pos >= size )
+          return false;
+        byte l0 = data[pos++];
+        if ( l0 < 192 )
+          len = l0;
+        else if ( l0 < 224 )
+        {
+          if ( pos >= size )
+            return false;
+          len = ( (unsigned long)( l0 - 192 ) << 8 ) + data[pos++] + 192;
+        }
+        else if ( l0 == 255 )
+        {
+          if ( pos + 4 > size )
+            return false;
+          len = get32( data + pos );
+          pos += 4;
+        }
+        else
+          return false; // partial body length
+      }
+      else
+      {
+        // old format
+        packet_r.tag = ( ptag >> 2 ) & 0x0f;
+        switch ( ptag & 0x03 )
+        {
+          case 0:
+            if ( pos + 1 > size ) return false;
+            len = data[pos];
+            pos += 1;
+            break;
+          case 1:
+            if ( pos + 2 > size ) return false;
+            len = get16( data + pos );
+            pos += 2;
+            break;
+          case 2:
+            if ( pos + 4 > size ) return false;
+            len = get32( data + pos );
+            pos += 4;
+            break;
+          default:
+            len = size - pos; // indeterminate: up to the end
+            break;
+        }
+      }
+      if ( len > size - pos )
+        return false;
+
+      packet_r.body  = data + pos;
+      packet_r.len   = len;
+      packet_r.begin = pos_r;
+      packet_r.end   = pos + len;
+      pos_r = packet_r.end;
+      return true;
+    }
+
+    /** Read an MPI at \a pos_r and advance \a pos_r. */
+    bool readMpi( const byte * body_r, unsigned len_r, unsigned & pos_r, std::string & mpi_r, unsigned * bits_r = 0 )
+    {
+      if ( pos_r + 2 > len_r )
+        return false;
+      unsigned bits = get16( body_r + pos_r );
+      unsigned bytes = ( bits + 7 ) / 8;
+      pos_r += 2;
+      if ( pos_r + bytes > len_r )
+        return false;
+      mpi_r.assign( (const char *)body_r + pos_r, bytes );
+      pos_r += bytes;
+      if ( bits_r )
+        *bits_r = bits;
+      return true;
+    }
+
+    /** Number of public key MPIs for \a algo_r (0 if unsupported). */
+    unsigned pubkeyMpis( unsigned algo_r )
+    {
+      switch ( algo_r )
+      {
+        case ALGO_RSA:
+        case ALGO_RSA_E:
+        case ALGO_RSA_S:
+          return 2;
+        case ALGO_ELGAMAL_E:
+        case ALGO_ELGAMAL:
+          return 3;
+        case ALGO_DSA:
+          return 4;
+      }
+      return 0;
+    }
+
+    /** Number of signature MPIs for \a algo_r (0 if unsupported). */
+    unsigned signatureMpis( unsigned algo_r )
+    {
+      switch ( algo_r )
+      {
+        case ALGO_RSA:
+        case ALGO_RSA_S:
+          return 1;
+        case ALGO_DSA:
+          return 2;
+      }
+      return 0;
+    }
+
+    /** Digest name and OpenSSL NID for an OpenPGP hash algorithm.
+     * MD5 (1) and RIPEMD160 (3) are rejected by gpg, so we don't accept them either.
+     */
+    bool hashAlgo( unsigned algo_r, std::string & name_r, int & nid_r )
+    {
+      switch ( algo_r )
+      {
+        case 2:  name_r = "sha1";      nid_r = NID_sha1;      return true;
+        case 8:  name_r = "sha256";    nid_r = NID_sha256;    return true;
+        case 9:  name_r = "sha384";    nid_r = NID_sha384;    return true;
+        case 10: name_r = "sha512";    nid_r = NID_sha512;    return true;
+        case 11: name_r = "sha224";    nid_r = NID_sha224;    return true;
+      }
+      return false;
+    }
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class SigData
+    /// \brief A parsed signature packet.
+    ///////////////////////////////////////////////////////////////////
+    struct SigData
+    {
+      SigData()
+      : version( 0 ), cls( 0 ), pkalgo( 0 ), hashalgo( 0 )
+      , created( 0 ), expires( 0 ), keyExpires( 0 ), keyFlags( 0 ), hasKeyFlags( false ), criticalUnknown( false )
+      { left16[0] = left16[1] = 0; }
+
+      /** Parse the body of a signature packet. */
+      bool parse( const byte * body_r, unsigned len_r )
+      {
+        if ( len_r < 1 )
+          return false;
+        version = body_r[0];
+        unsigned pos = 0;
+        if ( version == 3 || version == 2 )
+        {
+          // 3: 5, class, time, keyid, pkalgo, hashalgo, left16, MPIs
+          if ( len_r < 19 || body_r[1] != 5 )
+            return false;
+          cls      = body_r[2];
+          created  = get32( body_r + 3 );
+          issuer   = hexstring( body_r + 7, 8 );
+          pkalgo   = body_r[15];
+          hashalgo = body_r[16];
+          left16[0] = body_r[17];
+          left16[1] = body_r[18];
+          hashed.assign( (const char *)body_r + 2, 5 );
+          pos = 19;
+        }
+        else if ( version == 4 )
+        {
+          // 4, class, pkalgo, hashalgo, hashed subpackets, unhashed subpackets, left16, MPIs
+          if ( len_r < 6 )
+            return false;
+          cls      = body_r[1];
+          pkalgo   = body_r[2];
+          hashalgo = body_r[3];
+          unsigned hlen = get16( body_r + 4 );
+          if ( 6 + hlen + 2 > len_r )
+            return false;
+          if ( ! parseSubpackets( body_r + 6, hlen, true ) )
+            return false;
+          hashed.assign( (const char *)body_r, 6 + hlen );
+          pos = 6 + hlen;
+          unsigned ulen = get16( body_r + pos );
+          pos += 2;
+          if ( pos + ulen + 2 > len_r )
+            return false;
+          if ( ! parseSubpackets( body_r + pos, ulen, false ) )
+            return false;
+          pos += ulen;
+          left16[0] = body_r[pos];
+          left16[1] = body_r[pos+1];
+          pos += 2;
+        }
+        else
+          return false;
+
+        for ( unsigned i = signatureMpis( pkalgo ); i; --i )
+        {
+          mpis.push_back( std::string() );
+          if ( ! readMpi( body_r, len_r, pos, mpis.back() ) )
+            return false;
+        }
+        return true;
+      }
+
+      bool parseSubpackets( const byte * data_r, unsigned len_r, bool hashed_r )
+      {
+        unsigned pos = 0;
+        while ( pos < len_r )
+        {
+          unsigned long slen = data_r[pos++];
+          if ( slen >= 192 && slen < 255 )
+          {
+            if ( pos >= len_r )
+              return false;
+            slen = ( ( slen - 192 ) << 8 ) + data_r[pos++] + 192;
+          }
+          else if ( slen == 255 )
+          {
+            if ( pos + 4 > len_r )
+              return false;
+            slen = get32( data_r + pos );
+            pos += 4;
+          }
+          if ( slen < 1 || slen > len_r - pos )
+            return false;
+
+          bool critical = data_r[pos] & 0x80;
+          unsigned type = data_r[pos] & 0x7f;
+          const byte * val = data_r + pos + 1;
+          unsigned vlen = slen - 1;
+          switch ( type )
+          {
+            case 2:	// signature creation time
+              if ( vlen == 4 && hashed_r )
+                created = get32( val );
+              break;
+            case 3:	// signature expiration time
+              if ( vlen == 4 && hashed_r )
+                expires = get32( val );
+              break;
+            case 9:	// key expiration time
+              if ( vlen == 4 && hashed_r )
+                keyExpires = get32( val );
+              break;
+            case 27:	// key flags
+              if ( vlen >= 1 && hashed_r )
+              {
+                keyFlags = val[0];
+                hasKeyFlags = true;
+              }
+              break;
+            case 32:	// embedded signature
+              if ( embedded.empty() )
+                embedded.assign( (const char *)val, vlen );
+              break;
+            case 16:	// issuer
+              if ( vlen == 8 && issuer.empty() )
+                issuer = hexstring( val, 8 );
+              break;
+            case 33:	// issuer fingerprint
+              if ( vlen == 21 && val[0] == 4 && issuer.empty() )
+                issuer = hexstring( val + 13, 8 );
+              break;
+            case 4: case 5: case 6: case 7: case 10: case 11: case 12:
+            case 21: case 22: case 23: case 24: case 25: case 26:
+            case 28: case 29: case 30: case 31:
+              break;
+            default:
+              if ( critical )
+                criticalUnknown = true;
+              break;
+          }
+          pos += slen;
+        }
+        return true;
+      }
+
+      unsigned version;
+      unsigned cls;
+      unsigned pkalgo;
+      unsigned hashalgo;
+      std::string hashed;		// signed data following the document
+      std::string issuer;
+      Date::ValueType created;
+      unsigned long expires;		// seconds after created
+      unsigned long keyExpires;		// seconds after key creation
+      unsigned keyFlags;
+      bool hasKeyFlags;
+      std::string embedded;		// e.g. a subkeys back signature
+      bool criticalUnknown;
+      byte left16[2];
+      std::vector<std::string> mpis;
+    };
+
+    ///////////////////////////////////////////////////////////////////
+    // OpenSSL
+    ///////////////////////////////////////////////////////////////////
+
+    inline BIGNUM * bignum( const std::string & mpi_r )
+    { return ::BN_bin2bn( (const byte *)mpi_r.data(), mpi_r.size(), NULL ); }
+
+    bool rsaVerify( const std::vector<std::string> & key_r, int nid_r,
+                    const std::vector<unsigned char> & digest_r, const std::string & sig_r )
+    {
+      ::RSA * rsa = ::RSA_new();
+      if ( ! rsa )
+        return false;
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+      rsa->n = bignum( key_r[0] );
+      rsa->e = bignum( key_r[1] );
+#else
+      ::RSA_set0_key( rsa, bignum( key_r[0] ), bignum( key_r[1] ), NULL );
+#endif
+      bool ret = false;
+      std::string::size_type size = ::RSA_size( rsa );
+      if ( sig_r.size() <= size )
+      {
+        // The MPI may be shorter than the modulus.
+        std::string sig( size - sig_r.size(), '\0' );
+        sig += sig_r;
+        ret = ( ::RSA_verify( nid_r, &digest_r[0], digest_r.size(),
+                              (byte *)sig.data(), sig.size(), rsa ) == 1 );
+      }
+      ::RSA_free( rsa );
+      return ret;
+    }
+
+    bool dsaVerify( const std::vector<std::string> & key_r,
+                    const std::vector<unsigned char> & digest_r, const std::vector<std::string> & sig_r )
+    {
+      ::DSA * dsa = ::DSA_new();
+      ::DSA_SIG * sig = ::DSA_SIG_new();
+      bool ret = false;
+      if ( dsa && sig )
+      {
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+        dsa->p = bignum( key_r[0] );
+        dsa->q = bignum( key_r[1] );
+        dsa->g = bignum( key_r[2] );
+        dsa->pub_key = bignum( key_r[3] );
+        sig->r = bignum( sig_r[0] );
+        sig->s = bignum( sig_r[1] );
+#else
+        ::DSA_set0_pqg( dsa, bignum( key_r[0] ), bignum( key_r[1] ), bignum( key_r[2] ) );
+        ::DSA_set0_key( dsa, bignum( key_r[3] ), NULL );
+        ::DSA_SIG_set0( sig, bignum( sig_r[0] ), bignum( sig_r[1] ) );
+#endif
+        ret = ( ::DSA_do_verify( &digest_r[0], digest_r.size(), sig, dsa ) == 1 );
+      }
+      if ( sig )
+        ::DSA_SIG_free( sig );
+      if ( dsa )
+        ::DSA_free( dsa );
+      return ret;
+    }
+
+    /** Join \a fields_r to a colon listing line. */
+    std::string colonLine( const std::vector<std::string> & fields_r )
+    {
+      std::string ret;
+      for_( it, fields_r.begin(), fields_r.end() )
+      {
+        ret += *it;
+        ret += ':';
+      }
+      ret += '\n';
+      return ret;
+    }
+
+    /////////////////////////////////////////////////////////////////
+  } // namespace
+  ///////////////////////////////////////////////////////////////////
+
+  ///////////////////////////////////////////////////////////////////
+  //
+  //	CLASS NAME : PgpSignature::Impl
+  //
+  ///////////////////////////////////////////////////////////////////
+  struct PgpSignature::Impl
+  {
+    SigData _sig;
+  };
+
+  PgpSignature::PgpSignature()
+  {}
+
+  PgpSignature::PgpSignature( const Pathname & file_r )
+  {
+    std::string data;
+    if ( ! readPgpData( file_r, "SIGNATURE", data ) )
+    {
+      DBG << "Can't read signature " << file_r << endl;
+      return;
+    }
+
+    std::string::size_type pos = 0;
+    Packet packet;
+    Packet found;
+    unsigned sigs = 0;
+    while ( pos < data.size() )
+    {
+      if ( ! nextPacket( data, pos, packet ) )
+      {
+        DBG << "Malformed signature " << file_r << endl;
+        return;
+      }
+      if ( packet.tag == TAG_SIGNATURE )
+      {
+        found = packet;
+        ++sigs;
+      }
+    }
+    if ( sigs != 1 )
+    {
+      if ( sigs )
+        DBG << "Multiple signatures in " << file_r << endl;
+      return;
+    }
+
+    Impl * impl = new Impl;
+    if ( impl->_sig.parse( found.body, found.len ) )
+      _pimpl.reset( impl );
+    else
+    {
+      DBG << "Unsupported signature " << file_r << endl;
+      delete impl;
+    }
+  }
+
+  PgpSignature::~PgpSignature()
+  {}
+
+  PgpSignature::operator bool() const
+  { return bool(_pimpl); }
+
+  std::string PgpSignature::issuer() const
+  { return _pimpl ? _pimpl->_sig.issuer : std::string(); }
+
+  std::ostream & operator<<( std::ostream & str, const PgpSignature & obj )
+  {
+    if ( ! obj )
+      return str << "PgpSignature()";
+    const SigData & sig( obj._pimpl->_sig );
+    return str << "PgpSignature(v" << sig.version << " class " << sig.cls
+               << " algo " << sig.pkalgo << "/" << sig.hashalgo
+               << " by " << sig.issuer << " " << Date( sig.created ) << ")";
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  //
+  //	CLASS NAME : PgpKeyRing::Impl
+  //
+  ///////////////////////////////////////////////////////////////////
+  struct PgpKeyRing::Impl
+  {
+    /** A primary key or subkey. */
+    struct Key
+    {
+      Key() : version( 0 ), algo( 0 ), bits( 0 ), created( 0 ), expires( 0 ), cert( 0 ), revoked( false ), signing( false ) {}
+      unsigned version;
+      unsigned algo;
+      unsigned bits;
+      Date::ValueType created;
+      Date::ValueType expires;
+      std::string id;
+      std::string fingerprint;
+      std::vector<std::string> mpis;
+      unsigned cert;
+      bool revoked;
+      bool signing;			// has a valid self signature allowing to sign
+      std::string packet;		// as hashed by signatures
+      std::vector<SigData> sigs;	// binding signatures (subkeys)
+    };
+
+    /** A user id and its certifications. */
+    struct Uid
+    {
+      std::string name;
+      std::string packet;		// as hashed by signatures
+      std::vector<SigData> sigs;
+    };
+
+    /** A transferable public key. */
+    struct Cert
+    {
+      Cert() : primary( 0 ), begin( 0 ), end( 0 ) {}
+      unsigned primary;
+      std::vector<unsigned> subkeys;
+      std::vector<Uid> uids;
+      std::string::size_type begin;	// its packets in _data
+      std::string::size_type end;
+    };
+
+    std::string _data;
+    std::vector<Key> _keys;
+    std::vector<Cert> _certs;
+    std::multimap<std::string,unsigned> _byId;
+
+    /** Prepare \a digest_r for \a sig_r made by \a key_r; \c false if we don't handle the algorithms. */
+    static bool initDigest( const Key & key_r, const SigData & sig_r, Digest & digest_r, int & nid_r )
+    {
+      bool rsa = ( ( key_r.algo == ALGO_RSA || key_r.algo == ALGO_RSA_S ) && ( sig_r.pkalgo == ALGO_RSA || sig_r.pkalgo == ALGO_RSA_S ) );
+      bool dsa = ( key_r.algo == ALGO_DSA && sig_r.pkalgo == ALGO_DSA );
+      std::string hashname;
+      return ( rsa || dsa ) && ! sig_r.mpis.empty() && hashAlgo( sig_r.hashalgo, hashname, nid_r ) && digest_r.create( hashname );
+    }
+
+    /** Complete \a digest_r with the signatures trailer and check \a sig_r. */
+    static VerifyResult finishDigest( const Key & key_r, const SigData & sig_r, Digest & digest_r, int nid_r )
+    {
+      digest_r.update( sig_r.hashed.data(), sig_r.hashed.size() );
+      if ( sig_r.version == 4 )
+      {
+        unsigned long len = sig_r.hashed.size();
+        char trailer[6] = { 4, char(0xff), char( ( len >> 24 ) & 0xff ), char( ( len >> 16 ) & 0xff ), char( ( len >> 8 ) & 0xff ), char( len & 0xff ) };
+        digest_r.update( trailer, 6 );
+      }
+      std::vector<unsigned char> hash( digest_r.digestVector() );
+      if ( hash.size() < 2 )
+        return VERIFY_UNHANDLED;
+      if ( hash[0] != sig_r.left16[0] || hash[1] != sig_r.left16[1] )
+        return VERIFY_BAD;
+
+      bool good = ( key_r.algo == ALGO_DSA ) ? dsaVerify( key_r.mpis, hash, sig_r.mpis ) : rsaVerify( key_r.mpis, nid_r, hash, sig_r.mpis[0] );
+      return good ? VERIFY_GOOD : VERIFY_BAD;
+    }
+
+    /** Whether \a sig_r is a valid v4 signature by \a key_r over \a prefix_r (the key and user id packets). */
+    static bool checkKeySig( const Key & key_r, const SigData & sig_r, const std::string & prefix_r )
+    {
+      if ( sig_r.version != 4 || sig_r.criticalUnknown || sig_r.issuer != key_r.id )
+        return false;
+      Digest digest;
+      int nid;
+      if ( ! initDigest( key_r, sig_r, digest, nid ) )
+        return false;
+      digest.update( prefix_r.data(), prefix_r.size() );
+      return finishDigest( key_r, sig_r, digest, nid ) == VERIFY_GOOD;
+    }
+
+    /** Whether the subkey binding \a sig_r carries a valid back signature by \a subkey_r. */
+    static bool checkBackSig( const Key & primary_r, const Key & subkey_r, const SigData & sig_r )
+    {
+      SigData back;
+      if ( sig_r.embedded.empty() || ! back.parse( (const byte *)sig_r.embedded.data(), sig_r.embedded.size() ) )
+        return false;
+      return back.cls == 0x19 && checkKeySig( subkey_r, back, primary_r.packet + subkey_r.packet );
+    }
+
+    bool parseKey( const Packet & packet_r, Key & key_r )
+    {
+      const byte * body = packet_r.body;
+      unsigned len = packet_r.len;
+      if ( len < 1 )
+        return false;
+      key_r.version = body[0];
+      unsigned pos = 0;
+      if ( key_r.version == 4 )
+      {
+        if ( len < 6 )
+          return false;
+        key_r.created = get32( body + 1 );
+        key_r.algo = body[5];
+        pos = 6;
+      }
+      else if ( key_r.version == 3 || key_r.version == 2 )
+      {
+        if ( len < 8 )
+          return false;
+        key_r.created = get32( body + 1 );
+        key_r.algo = body[7];
+        pos = 8;
+      }
+      else
+        return false;
+
+      for ( unsigned i = 0; i < pubkeyMpis( key_r.algo ); ++i )
+      {
+        key_r.mpis.push_back( std::string() );
+        if ( ! readMpi( body, len, pos, key_r.mpis.back(), i == 0 ? &key_r.bits : 0 ) )
+          return false;
+      }
+
+      key_r.packet += char(0x99);
+      key_r.packet += char( ( len >> 8 ) & 0xff );
+      key_r.packet += char( len & 0xff );
+      key_r.packet.append( (const char *)body, len );
+
+      if ( key_r.version == 4 )
+      {
+        Digest sha1;
+        sha1.create( Digest::sha1() );
+        char head[3] = { char(0x99), char( ( len >> 8 ) & 0xff ), char( len & 0xff ) };
+        sha1.update( head, 3 );
+        sha1.update( (const char *)body, len );
+        std::vector<unsigned char> fpr( sha1.digestVector() );
+        if ( fpr.size() != 20 )
+          return false;
+        key_r.fingerprint = hexstring( &fpr[0], 20 );
+        key_r.id = key_r.fingerprint.substr( 24 );
+      }
+      else
+      {
+        // v3 keys are RSA only
+        if ( key_r.mpis.size() != 2 || key_r.mpis[0].size() < 8 )
+          return false;
+        Digest md5;
+        md5.create( Digest::md5() );
+        md5.update( key_r.mpis[0].data(), key_r.mpis[0].size() );
+        md5.update( key_r.mpis[1].data(), key_r.mpis[1].size() );
+        std::vector<unsigned char> fpr( md5.digestVector() );
+        if ( fpr.size() != 16 )
+          return false;
+        key_r.fingerprint = hexstring( &fpr[0], 16 );
+        key_r.id = hexstring( (const byte *)key_r.mpis[0].data() + key_r.mpis[0].size() - 8, 8 );
+      }
+      return true;
+    }
+
+    bool parse()
+    {
+      std::string::size_type pos = 0;
+      Packet packet;
+      Key * current = 0;	// the key signatures refer to
+      Uid * uid = 0;		// the user id certifications refer to
+      while ( pos < _data.size() )
+      {
+        if ( ! nextPacket( _data, pos, packet ) )
+          return false;
+
+        switch ( packet.tag )
+        {
+          case TAG_PUBKEY:
+          case TAG_PUBSUBKEY:
+          {
+            Key key;
+            if ( ! parseKey( packet, key ) )
+              return false;
+            if ( packet.tag == TAG_PUBKEY )
+            {
+              _certs.push_back( Cert() );
+              _certs.back().primary = _keys.size();
+              _certs.back().begin = packet.begin;
+            }
+            else if ( _certs.empty() )
+              return false;
+            else
+              _certs.back().subkeys.push_back( _keys.size() );
+            key.cert = _certs.size() - 1;
+            _byId.insert( std::make_pair( key.id, _keys.size() ) );
+            _keys.push_back( key );
+            current = &_keys.back();
+            uid = 0;
+          }
+          break;
+
+          case TAG_USERID:
+          case TAG_USERATTR:
+            if ( _certs.empty() )
+              return false;
+            _certs.back().uids.push_back( Uid() );
+            uid = &_certs.back().uids.back();
+            if ( packet.tag == TAG_USERID )
+              uid->name.assign( (const char *)packet.body, packet.len );
+            else
+              uid->name = "[user attribute]";
+            uid->packet += char( packet.tag == TAG_USERID ? 0xb4 : 0xd1 );
+            for ( int shift = 24; shift >= 0; shift -= 8 )
+              uid->packet += char( ( packet.len >> shift ) & 0xff );
+            uid->packet.append( (const char *)packet.body, packet.len );
+            break;
+
+          case TAG_SIGNATURE:
+          {
+            if ( ! current )
+              return false;
+            SigData sig;
+            if ( ! sig.parse( packet.body, packet.len ) )
+            {
+              // e.g. made by an unsupported algorithm; not needed for listing
+              DBG << "Skip unsupported signature packet" << endl;
+              break;
+            }
+            // Revocations are not verified, so they only ever make us leave a key to gpg.
+            if ( sig.cls == 0x20 || sig.cls == 0x28 )
+              current->revoked = true;
+            else if ( uid )
+              uid->sigs.push_back( sig );
+            else
+              current->sigs.push_back( sig );
+          }
+          break;
+
+          default:
+            break;
+        }
+        if ( ! _certs.empty() )
+          _certs.back().end = pos;
+
+        // pointers may be invalidated by the next push_back
+        if ( current )
+          current = &_keys.back();
+        if ( uid )
+          uid = &_certs.back().uids.back();
+      }
+
+      // key expiration and usage from the latest self signature
+      for_( it, _keys.begin(), _keys.end() )
+      {
+        const Key & primary( _keys[_certs[it->cert].primary] );
+        bool isPrimary = ( &*it == &primary );
+        std::vector<std::pair<const SigData *,std::string> > sigs;	// and the data they sign
+        if ( isPrimary )
+        {
+          const std::vector<Uid> & uids( _certs[it->cert].uids );
+          for_( uit, uids.begin(), uids.end() )
+            for_( sit, uit->sigs.begin(), uit->sigs.end() )
+              if ( sit->cls >= 0x10 && sit->cls <= 0x13 )
+                sigs.push_back( std::make_pair( &*sit, primary.packet + uit->packet ) );
+        }
+        else
+        {
+          for_( sit, it->sigs.begin(), it->sigs.end() )
+            if ( sit->cls == 0x18 )
+              sigs.push_back( std::make_pair( &*sit, primary.packet + it->packet ) );
+        }
+
+        // Only a verified self signature is used for verifying. If there is none,
+        // the latest claimed one still provides the expiration for the listing.
+        const SigData * latest = 0;
+        const SigData * valid = 0;
+        for_( sit, sigs.begin(), sigs.end() )
+        {
+          const SigData & sig( *sit->first );
+          if ( sig.issuer != primary.id )
+            continue;
+          if ( ! latest || sig.created >= latest->created )
+            latest = &sig;
+          if ( ( ! valid || sig.created >= valid->created ) && checkKeySig( primary, sig, sit->second ) )
+            valid = &sig;
+        }
+        if ( valid )
+          latest = valid;
+        if ( latest )
+          it->expires = latest->keyExpires ? it->created + latest->keyExpires : 0;
+
+        // A subkey must be bound for signing and cross-certify the primary key.
+        if ( valid )
+        {
+          if ( isPrimary )
+            it->signing = ( ! valid->hasKeyFlags || ( valid->keyFlags & 0x02 ) );
+          else
+            it->signing = ( valid->hasKeyFlags && ( valid->keyFlags & 0x02 ) && checkBackSig( primary, *it, *valid ) );
+        }
+        if ( primary.revoked )
+          it->revoked = true;
+      }
+      return true;
+    }
+
+    void listKey( const Key & key_r, const char * type_r, std::vector<std::string> & lines_r ) const
+    {
+      std::vector<std::string> fields;
+      fields.push_back( type_r );
+      fields.push_back( key_r.revoked ? "r" : "-" );
+      fields.push_back( str::numstring( key_r.bits ) );
+      fields.push_back( str::numstring( key_r.algo ) );
+      fields.push_back( key_r.id );
+      fields.push_back( str::numstring( key_r.created ) );
+      fields.push_back( key_r.expires ? str::numstring( key_r.expires ) : std::string() );
+      fields.push_back( "" );
+      fields.push_back( "-" );
+      fields.push_back( "" );
+      lines_r.push_back( colonLine( fields ) );
+
+      fields.clear();
+      fields.push_back( "fpr" );
+      fields.resize( 9 );
+      fields.push_back( key_r.fingerprint );
+      lines_r.push_back( colonLine( fields ) );
+    }
+
+    /** \a name_r is listed for self signatures (gpg shows the signers user id). */
+    void listSig( const SigData & sig_r, const Key & primary_r, const std::string & name_r, std::vector<std::string> & lines_r ) const
+    {
+      std::vector<std::string> fields( 3 );
+      fields[0] = "sig";
+      fields.push_back( str::numstring( sig_r.pkalgo ) );
+      fields.push_back( sig_r.issuer );
+      fields.push_back( str::numstring( sig_r.created ) );
+      fields.resize( 9 );
+      fields.push_back( sig_r.issuer == primary_r.id ? name_r : std::string() );
+      fields.push_back( str::form( "%02xx", sig_r.cls ) );
+      lines_r.push_back( colonLine( fields ) );
+    }
+
+    std::vector<std::string> colonListing() const
+    {
+      std::vector<std::string> ret;
+      for_( cit, _certs.begin(), _certs.end() )
+      {
+        const Key & primary( _keys[cit->primary] );
+        listKey( primary, "pub", ret );
+        std::string primaryName;
+        for_( uit, cit->uids.begin(), cit->uids.end() )
+        {
+          std::string name( uit->name );
+          str::replaceAll( name, ":", "\\x3a" );
+          if ( primaryName.empty() )
+            primaryName = name;
+
+          std::vector<std::string> fields;
+          fields.push_back( "uid" );
+          fields.push_back( primary.revoked ? "r" : "-" );
+          fields.resize( 9 );
+          fields.push_back( name );
+          ret.push_back( colonLine( fields ) );
+          for_( sit, uit->sigs.begin(), uit->sigs.end() )
+            listSig( *sit, primary, name, ret );
+        }
+        for_( sit, cit->subkeys.begin(), cit->subkeys.end() )
+        {
+          const Key & subkey( _keys[*sit] );
+          listKey( subkey, "sub", ret );
+          for_( bit, subkey.sigs.begin(), subkey.sigs.end() )
+            listSig( *bit, primary, primaryName, ret );
+        }
+      }
+      return ret;
+    }
+
+    /** Indices of the certificates matching \a id_r. */
+    std::vector<unsigned> findCerts( const std::string & id_r ) const
+    {
+      std::string id( str::toUpper( id_r ) );
+      if ( id.size() > 2 && id[0] == '0' && id[1] == 'X' )
+        id.erase( 0, 2 );
+
+      std::vector<unsigned> ret;
+      for_( it, _keys.begin(), _keys.end() )
+      {
+        bool match = ( id.size() == 16 && it->id == id )
+                  || ( id.size() == 8 && it->id.compare( 8, 8, id ) == 0 )
+                  || ( id.size() > 16 && it->fingerprint == id );
+        if ( match && std::find( ret.begin(), ret.end(), it->cert ) == ret.end() )
+          ret.push_back( it->cert );
+      }
+      return ret;
+    }
+  };
+
+  ///////////////////////////////////////////////////////////////////
+  //
+  //	CLASS NAME : PgpKeyRing
+  //
+  ///////////////////////////////////////////////////////////////////
+
+  PgpKeyRing::PgpKeyRing()
+  : _pimpl( new Impl )
+  {}
+
+  PgpKeyRing::~PgpKeyRing()
+  {}
+
+  bool PgpKeyRing::load( const Pathname & file_r )
+  {
+    _pimpl.reset( new Impl );
+    if ( ! PathInfo( file_r ).isExist() )
+      return true;
+
+    Impl * impl = new Impl;
+    if ( ! readPgpData( file_r, "PUBLIC KEY BLOCK", impl->_data ) || ! impl->parse() )
+    {
+      WAR << "Can't parse keys in " << file_r << endl;
+      delete impl;
+      return false;
+    }
+    _pimpl.reset( impl );
+    MIL << "Loaded " << *this << " from " << file_r << endl;
+    return true;
+  }
+
+  bool PgpKeyRing::empty() const
+  { return _pimpl->_certs.empty(); }
+
+  unsigned PgpKeyRing::size() const
+  { return _pimpl->_certs.size(); }
+
+  std::vector<std::string> PgpKeyRing::colonListing() const
+  { return _pimpl->colonListing(); }
+
+  bool PgpKeyRing::exportKey( const std::string & id_r, std::ostream & str ) const
+  {
+    std::vector<unsigned> certs( _pimpl->findCerts( id_r ) );
+    if ( certs.empty() )
+      return false;
+
+    // the certificates packets, except for the local trust packets
+    std::string data;
+    for_( it, certs.begin(), certs.end() )
+    {
+      const Impl::Cert & cert( _pimpl->_certs[*it] );
+      std::string::size_type pos = cert.begin;
+      Packet packet;
+      while ( pos < cert.end && nextPacket( _pimpl->_data, pos, packet ) )
+      {
+        if ( packet.tag != TAG_TRUST )
+          data.append( _pimpl->_data, packet.begin, packet.end - packet.begin );
+      }
+    }
+    armor( str, "PUBLIC KEY BLOCK", data );
+    return true;
+  }
+
+  PgpKeyRing::VerifyResult PgpKeyRing::verify( const Pathname & file_r, const PgpSignature & sig_r ) const
+  {
+    if ( ! sig_r )
+      return VERIFY_UNHANDLED;
+    const SigData & sig( sig_r._pimpl->_sig );
+
+    // Leave the special cases to gpg.
+    if ( sig.cls != 0x00 || sig.criticalUnknown || sig.issuer.empty() || sig.mpis.empty() )
+      return VERIFY_UNHANDLED;
+    if ( sig.expires && Date::ValueType( sig.created + sig.expires ) < ::time( 0 ) )
+      return VERIFY_UNHANDLED;
+
+    typedef std::multimap<std::string,unsigned>::const_iterator IdIter;
+    std::pair<IdIter,IdIter> range( _pimpl->_byId.equal_range( sig.issuer ) );
+    if ( std::distance( range.first, range.second ) != 1 )
+      return VERIFY_UNHANDLED;	// unknown or ambiguous key
+    const Impl::Key & key( _pimpl->_keys[range.first->second] );
+    if ( ! key.signing || key.revoked || key.created > sig.created )
+      return VERIFY_UNHANDLED;
+    if ( key.expires && key.expires < ::time( 0 ) )
+      return VERIFY_UNHANDLED;
+
+    Digest digest;
+    int nid;
+    if ( ! Impl::initDigest( key, sig, digest, nid ) )
+      return VERIFY_UNHANDLED;
+
+    std::ifstream in( file_r.c_str(), std::ios::in | std::ios::binary );
+    if ( ! in )
+      return VERIFY_UNHANDLED;
+    char buf[65536];
+    while ( in )
+    {
+      in.read( buf, sizeof(buf) );
+      if ( in.gcount() )
+        digest.update( buf, in.gcount() );
+    }
+    if ( in.bad() )
+      return VERIFY_UNHANDLED;
+
+    return Impl::finishDigest( key, sig, digest, nid );
+  }
+
+  std::ostream & operator<<( std::ostream & str, const PgpKeyRing & obj )
+  {
+    return str << "PgpKeyRing(" << obj._pimpl->_certs.size() << " keys, "
+               << obj._pimpl->_keys.size() - obj._pimpl->_certs.size() << " subkeys)";
+  }
+
+  std::ostream & operator<<( std::ostream & str, PgpKeyRing::VerifyResult obj )
+  {
+    switch ( obj )
+    {
+      case PgpKeyRing::VERIFY_GOOD:	 return str << "GOOD";
+      case PgpKeyRing::VERIFY_BAD:	 return str << "BAD";
+      case PgpKeyRing::VERIFY_UNHANDLED: return str << "UNHANDLED";
+    }
+    return str << "?";
+  }
+
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,159 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/PgpKeyRing.h
+ *
+*/
+#ifndef ZYPP_PGPKEYRING_H
+#define ZYPP_PGPKEYRING_H
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "zypp/base/PtrTypes.h"
+#include "zypp/Pathname.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+
+  ///////////////////////////////////////////////////////////////////
+  /// \class PgpSignature
+  /// \brief A detached OpenPGP signature read from file.
+  ///
+  /// The file may be ASCII armored (\c .asc) or binary and must contain
+  /// exactly one signature packet (version 3 or 4).
+  ///////////////////////////////////////////////////////////////////
+  class PgpSignature
+  {
+    friend std::ostream & operator<<( std::ostream & str, const PgpSignature & obj );
+
+    public:
+      /** Implementation */
+      struct Impl;
+
+    public:
+      /** Default ctor: no signature */
+      PgpSignature();
+
+      /** Ctor reading the signature from \a file_r. */
+      explicit PgpSignature( const Pathname & file_r );
+
+      /** Dtor */
+      ~PgpSignature();
+
+    public:
+      /** Whether a signature was read. */
+      explicit operator bool() const;
+
+      /** The id of the key that made the signature (16 hex digits, uppercase).
+       * Empty if unknown.
+       */
+      std::string issuer() const;
+
+    private:
+      friend class PgpKeyRing;
+      /** Pointer to implementation */
+      RW_pointer<Impl> _pimpl;
+  };
+  ///////////////////////////////////////////////////////////////////
+
+  /** \relates PgpSignature Stream output */
+  std::ostream & operator<<( std::ostream & str, const PgpSignature & obj );
+
+  ///////////////////////////////////////////////////////////////////
+  /// \class PgpKeyRing
+  /// \brief OpenPGP public keys parsed into memory.
+  ///
+  /// Reads a gpg keyring (\c pubring.gpg) or a file containing ASCII
+  /// armored or binary public key blocks. This allows \ref KeyRing to
+  /// list keys and verify detached signatures without running gpg.
+  ///
+  /// Signatures made by RSA and DSA keys are verified in-process, using
+  /// the OpenSSL crypto functions. Whatever is not supported (e.g. other
+  /// key algorithms, MD5 and RIPEMD160 digests, text mode signatures,
+  /// revoked or expired keys and expired signatures) is reported as
+  /// \ref VERIFY_UNHANDLED and should be passed to gpg.
+  ///
+  /// A key is used for verifying only if it has a valid self signature.
+  /// A subkey in addition needs a binding signature allowing to sign and
+  /// a valid back signature. Expiration is taken from the latest valid
+  /// self signature; revocations are not verified and always make a key
+  /// unhandled.
+  ///////////////////////////////////////////////////////////////////
+  class PgpKeyRing
+  {
+    friend std::ostream & operator<<( std::ostream & str, const PgpKeyRing & obj );
+
+    public:
+      /** Implementation */
+      struct Impl;
+
+      /** Result of \ref verify */
+      enum VerifyResult
+      {
+        VERIFY_GOOD,		//!< good signature
+        VERIFY_BAD,		//!< bad signature
+        VERIFY_UNHANDLED	//!< can't tell; ask gpg
+      };
+
+    public:
+      /** Default ctor: empty keyring */
+      PgpKeyRing();
+
+      /** Dtor */
+      ~PgpKeyRing();
+
+    public:
+      /** Load the keys in \a file_r, replacing the current ones.
+       * A missing file is an empty keyring.
+       * \return \c false if the file could not be parsed. The keyring is
+       * empty then.
+       */
+      bool load( const Pathname & file_r );
+
+      /** Whether there are no keys. */
+      bool empty() const;
+
+      /** Number of primary keys. */
+      unsigned size() const;
+
+    public:
+      /** The keys as listed by
+       * <tt>gpg --with-colons --fixed-list-mode --with-fingerprint --with-sig-list</tt>.
+       * The lines are suitable for \ref PublicKeyScanner.
+       */
+      std::vector<std::string> colonListing() const;
+
+      /** Write the keys matching \a id_r ASCII armored to \a str, like
+       * <tt>gpg -a --export</tt> does. \a id_r may be a short or long key
+       * id or a fingerprint.
+       * \return \c false if no key matches.
+       */
+      bool exportKey( const std::string & id_r, std::ostream & str ) const;
+
+      /** Verify \a file_r against the detached signature \a sig_r. */
+      VerifyResult verify( const Pathname & file_r, const PgpSignature & sig_r ) const;
+
+    private:
+      /** Pointer to implementation */
+      RW_pointer<Impl> _pimpl;
+  };
+  ///////////////////////////////////////////////////////////////////
+
+  /** \relates PgpKeyRing Stream output */
+  std::ostream & operator<<( std::ostream & str, const PgpKeyRing & obj );
+
+  /** \relates PgpKeyRing::VerifyResult Stream output */
+  std::ostream & operator<<( std::ostream & str, PgpKeyRing::VerifyResult obj );
+
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_PGPKEYRING_H
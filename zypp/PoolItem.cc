@@ -10,8 +10,9 @@
  *
 */
 #include <iostream>
+#include <deque>
+#include <vector>
 #include "zypp/base/Logger.h"
-#include "zypp/base/DefaultIntegral.h"
 
 #include "zypp/PoolItem.h"
 #include "zypp/ResPool.h"
@@ -29,6 +30,13 @@ namespace zypp
   //	CLASS NAME : PoolItem::Impl
   //
   /** PoolItem implementation.
+   * The data of all PoolItems, kept in arrays indexed by the solvable
+   * id. Id \c 0 is the empty PoolItem.
+   *
+   * \c _status and \c _savedStatus are \c std::deque, so references
+   * returned by \ref PoolItem::status stay valid if the arrays grow.
+   * The \ref ResObject is created on demand.
+   *
    * \c _buddy handling:
    * \li \c ==0 no buddy
    * \li \c >0 this uses \c _buddy status
@@ -36,131 +44,169 @@ namespace zypp
    */
   struct PoolItem::Impl
   {
+    typedef sat::detail::SolvableIdType SolvableIdType;
+
     public:
-      Impl() {}
+      /** The data of all PoolItems. */
+      static Impl & instance()
+      {
+        static Impl _instance;
+        return _instance;
+      }
 
-      Impl( ResObject::constPtr res_r,
-            const ResStatus & status_r )
-      : _status( status_r )
-      , _resolvable( res_r )
-      {}
+    public:
+      /** Whether \a id_r is a PoolItem in the pool. */
+      bool valid( SolvableIdType id_r ) const
+      { return id_r < _valid.size() && _valid[id_r]; }
+
+      /** Set up the data for a new PoolItem \a id_r. */
+      void create( SolvableIdType id_r, const ResStatus & status_r )
+      {
+        if ( id_r >= _valid.size() )
+        {
+          SolvableIdType size = id_r + 1;
+          _status.resize( size );
+          _savedStatus.resize( size );
+          _buddy.resize( size, sat::detail::noId );
+          _resolvable.resize( size );
+          _valid.resize( size, false );
+        }
+        _status[id_r] = status_r;
+        _savedStatus[id_r] = ResStatus();
+        _buddy[id_r] = sat::detail::noId;
+        _resolvable[id_r] = ResObject::constPtr();
+        _valid[id_r] = true;
+      }
+
+      /** Drop the data of PoolItem \a id_r. */
+      void erase( SolvableIdType id_r )
+      {
+        if ( ! valid( id_r ) )
+          return;
+        // release a buddy relation
+        sat::detail::IdType buddy( _buddy[id_r] );
+        if ( buddy )
+          _buddy[buddy < 0 ? -buddy : buddy] = sat::detail::noId;
+        _buddy[id_r] = sat::detail::noId;
+        _resolvable[id_r] = ResObject::constPtr();
+        _valid[id_r] = false;
+      }
 
-      ResStatus & status() const
-      { return _buddy > 0 ? PoolItem(buddy()).status() : _status; }
+      ResStatus & status( SolvableIdType id_r )
+      {
+        if ( ! valid( id_r ) )
+          return _status[0];
+        return _buddy[id_r] > 0 ? _status[_buddy[id_r]] : _status[id_r];
+      }
 
-      sat::Solvable buddy() const
+      sat::Solvable buddy( SolvableIdType id_r ) const
       {
-        if ( !_buddy )
+        if ( ! valid( id_r ) || ! _buddy[id_r] )
           return sat::Solvable::noSolvable;
-        if ( _buddy < 0 )
-          return sat::Solvable( -_buddy );
-        return sat::Solvable( _buddy );
+        if ( _buddy[id_r] < 0 )
+          return sat::Solvable( -_buddy[id_r] );
+        return sat::Solvable( _buddy[id_r] );
       }
 
-      void setBuddy( sat::Solvable solv_r );
+      void setBuddy( SolvableIdType id_r, sat::Solvable solv_r );
 
-      ResObject::constPtr resolvable() const
-      { return _resolvable; }
+      ResObject::constPtr resolvable( SolvableIdType id_r )
+      {
+        if ( ! valid( id_r ) )
+          return ResObject::constPtr();
+        if ( ! _resolvable[id_r] )
+          _resolvable[id_r] = makeResObject( sat::Solvable( id_r ) );
+        return _resolvable[id_r];
+      }
 
-      ResStatus & statusReset() const
+      ResStatus & statusReset( SolvableIdType id_r )
       {
-        _status.setLock( false, zypp::ResStatus::USER );
-        _status.resetTransact( zypp::ResStatus::USER );
-        return _status;
+        ResStatus & status( _status[valid( id_r ) ? id_r : 0] );
+        status.setLock( false, zypp::ResStatus::USER );
+        status.resetTransact( zypp::ResStatus::USER );
+        return status;
       }
 
     public:
-      bool isUndetermined() const
+      bool isUndetermined( SolvableIdType id_r )
       {
-	  return status().isUndetermined();
+	  return status( id_r ).isUndetermined();
       }
 
-      bool isRelevant() const
+      bool isRelevant( SolvableIdType id_r )
       {
-	  return !status().isNonRelevant();
+	  return !status( id_r ).isNonRelevant();
       }
 
-      bool isSatisfied() const
+      bool isSatisfied( SolvableIdType id_r )
       {
-	  return status().isSatisfied();
+	  return status( id_r ).isSatisfied();
       }
 
-      bool isBroken() const
+      bool isBroken( SolvableIdType id_r )
       {
-	  return status().isBroken();
+	  return status( id_r ).isBroken();
       }
 
-      bool isNeeded() const
+      bool isNeeded( SolvableIdType id_r )
       {
-	return status().isToBeInstalled() || ( isBroken() && ! status().isLocked() );
+	return status( id_r ).isToBeInstalled() || ( isBroken( id_r ) && ! status( id_r ).isLocked() );
       }
 
-      bool isUnwanted() const
+      bool isUnwanted( SolvableIdType id_r )
       {
-	return isBroken() && status().isLocked();
+	return isBroken( id_r ) && status( id_r ).isLocked();
       }
 
-    private:
-      mutable ResStatus     _status;
-      ResObject::constPtr   _resolvable;
-      DefaultIntegral<sat::detail::IdType,sat::detail::noId> _buddy;
-
     /** \name Poor man's save/restore state.
        * \todo There may be better save/restore state strategies.
      */
     //@{
     public:
-      void saveState() const
-      { _savedStatus = status(); }
-      void restoreState() const
-      { status() = _savedStatus; }
-      bool sameState() const
+      void saveState( SolvableIdType id_r )
+      { _savedStatus[valid( id_r ) ? id_r : 0] = status( id_r ); }
+      void restoreState( SolvableIdType id_r )
+      { status( id_r ) = _savedStatus[valid( id_r ) ? id_r : 0]; }
+      bool sameState( SolvableIdType id_r )
       {
-        if ( status() == _savedStatus )
+        const ResStatus & savedStatus( _savedStatus[valid( id_r ) ? id_r : 0] );
+        const ResStatus & status( this->status( id_r ) );
+        if ( status == savedStatus )
           return true;
         // some bits changed...
-        if ( status().getTransactValue() != _savedStatus.getTransactValue()
-             && ( ! status().isBySolver() // ignore solver state changes
+        if ( status.getTransactValue() != savedStatus.getTransactValue()
+             && ( ! status.isBySolver() // ignore solver state changes
                   // removing a user lock also goes to bySolver
-                  || _savedStatus.getTransactValue() == ResStatus::LOCKED ) )
+                  || savedStatus.getTransactValue() == ResStatus::LOCKED ) )
           return false;
-        if ( status().isLicenceConfirmed() != _savedStatus.isLicenceConfirmed() )
+        if ( status.isLicenceConfirmed() != savedStatus.isLicenceConfirmed() )
           return false;
         return true;
       }
-    private:
-      mutable ResStatus _savedStatus;
     //@}
 
-    public:
-      /** Offer default Impl. */
-      static shared_ptr<Impl> nullimpl()
-      {
-        static shared_ptr<Impl> _nullimpl( new Impl );
-        return _nullimpl;
-      }
+    private:
+      Impl()
+      : _status( 1 ), _savedStatus( 1 ), _buddy( 1, sat::detail::noId ), _resolvable( 1 ), _valid( 1, false )
+      {}
+
+    private:
+      std::deque<ResStatus>                 _status;
+      std::deque<ResStatus>                 _savedStatus;
+      std::vector<sat::detail::IdType>      _buddy;
+      std::vector<ResObject::constPtr>      _resolvable;
+      std::vector<bool>                     _valid;
   };
   ///////////////////////////////////////////////////////////////////
 
-  /** \relates PoolItem::Impl Stream output */
-  inline std::ostream & operator<<( std::ostream & str, const PoolItem::Impl & obj )
-  {
-    str << obj.status();
-    if (obj.resolvable())
-	str << *obj.resolvable();
-    else
-	str << "(NULL)";
-    return str;
-  }
-
-  inline void PoolItem::Impl::setBuddy( sat::Solvable solv_r )
+  inline void PoolItem::Impl::setBuddy( SolvableIdType id_r, sat::Solvable solv_r )
   {
     PoolItem myBuddy( solv_r );
-    if ( myBuddy )
+    if ( myBuddy && valid( id_r ) )
     {
-      myBuddy._pimpl->_buddy = -resolvable()->satSolvable().id();
-      _buddy = myBuddy.satSolvable().id();
-      DBG << *this << " has buddy " << myBuddy << endl;
+      _buddy[myBuddy._id] = -id_r;
+      _buddy[id_r] = myBuddy._id;
+      DBG << PoolItem( id_r ) << " has buddy " << myBuddy << endl;
     }
   }
 
@@ -176,7 +222,7 @@ namespace zypp
   //	METHOD TYPE : Ctor
   //
   PoolItem::PoolItem()
-  : _pimpl( Impl::nullimpl() )
+  : _id( sat::detail::noSolvableId )
   {}
 
   ///////////////////////////////////////////////////////////////////
@@ -185,7 +231,7 @@ namespace zypp
   //	METHOD TYPE : Ctor
   //
   PoolItem::PoolItem( const sat::Solvable & solvable_r )
-  : _pimpl( ResPool::instance().find( solvable_r )._pimpl )
+  : _id( ResPool::instance().find( solvable_r )._id )
   {}
 
   ///////////////////////////////////////////////////////////////////
@@ -194,7 +240,7 @@ namespace zypp
   //	METHOD TYPE : Ctor
   //
   PoolItem::PoolItem( const ResObject::constPtr & resolvable_r )
-  : _pimpl( ResPool::instance().find( resolvable_r )._pimpl )
+  : _id( ResPool::instance().find( resolvable_r )._id )
   {}
 
   ///////////////////////////////////////////////////////////////////
@@ -202,8 +248,8 @@ namespace zypp
   //	METHOD NAME : PoolItem::PoolItem
   //	METHOD TYPE : Ctor
   //
-  PoolItem::PoolItem( Impl * implptr_r )
-  : _pimpl( implptr_r )
+  PoolItem::PoolItem( sat::detail::SolvableIdType id_r )
+  : _id( id_r )
   {}
 
   ///////////////////////////////////////////////////////////////////
@@ -213,9 +259,18 @@ namespace zypp
   //
   PoolItem PoolItem::makePoolItem( const sat::Solvable & solvable_r )
   {
-    return PoolItem( new Impl( makeResObject( solvable_r ), solvable_r.isSystem() ) );
+    Impl::instance().create( solvable_r.id(), solvable_r.isSystem() );
+    return PoolItem( solvable_r.id() );
   }
 
+  ///////////////////////////////////////////////////////////////////
+  //
+  //	METHOD NAME : PoolItem::erasePoolItem
+  //	METHOD TYPE : void
+  //
+  void PoolItem::erasePoolItem( const PoolItem & item_r )
+  { Impl::instance().erase( item_r._id ); }
+
   ///////////////////////////////////////////////////////////////////
   //
   //	METHOD NAME : PoolItem::~PoolItem
@@ -238,47 +293,50 @@ namespace zypp
   //
   ///////////////////////////////////////////////////////////////////
 
+  PoolItem::operator bool() const
+  { return Impl::instance().valid( _id ); }
+
   ResStatus & PoolItem::status() const
-  { return _pimpl->status(); }
+  { return Impl::instance().status( _id ); }
 
   ResStatus & PoolItem::statusReset() const
-  { return _pimpl->statusReset(); }
+  { return Impl::instance().statusReset( _id ); }
 
   sat::Solvable PoolItem::buddy() const
-  { return _pimpl->buddy(); }
+  { return Impl::instance().buddy( _id ); }
 
   void PoolItem::setBuddy( sat::Solvable solv_r )
-  { _pimpl->setBuddy( solv_r ); }
+  { Impl::instance().setBuddy( _id, solv_r ); }
 
   bool PoolItem::isUndetermined() const
-  { return _pimpl->isUndetermined(); }
+  { return Impl::instance().isUndetermined( _id ); }
 
   bool PoolItem::isRelevant() const
-  { return _pimpl->isRelevant(); }
+  { return Impl::instance().isRelevant( _id ); }
 
   bool PoolItem::isSatisfied() const
-  { return _pimpl->isSatisfied(); }
+  { return Impl::instance().isSatisfied( _id ); }
 
   bool PoolItem::isBroken() const
-  { return _pimpl->isBroken(); }
+  { return Impl::instance().isBroken( _id ); }
 
   bool PoolItem::isNeeded() const
-  { return _pimpl->isNeeded(); }
+  { return Impl::instance().isNeeded( _id ); }
 
   bool PoolItem::isUnwanted() const
-  { return _pimpl->isUnwanted(); }
+  { return Impl::instance().isUnwanted( _id ); }
 
   void PoolItem::saveState() const
-  { _pimpl->saveState(); }
+  { Impl::instance().saveState( _id ); }
 
   void PoolItem::restoreState() const
-  { _pimpl->restoreState(); }
+  { Impl::instance().restoreState( _id ); }
 
   bool PoolItem::sameState() const
-  { return _pimpl->sameState(); }
+  { return Impl::instance().sameState( _id ); }
 
   ResObject::constPtr PoolItem::resolvable() const
-  { return _pimpl->resolvable(); }
+  { return Impl::instance().resolvable( _id ); }
 
   /******************************************************************
    **
@@ -287,7 +345,13 @@ namespace zypp
   */
   std::ostream & operator<<( std::ostream & str, const PoolItem & obj )
   {
-    return str << *obj._pimpl;
+    str << obj.status();
+    ResObject::constPtr res( obj.resolvable() );
+    if ( res )
+      str << *res;
+    else
+      str << "(NULL)";
+    return str;
   }
 
   /////////////////////////////////////////////////////////////////
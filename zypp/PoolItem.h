@@ -46,6 +46,10 @@ namespace zypp
    * \c const, i.e. you can't change the refered PoolItem. The PoolItem
    * (i.e. the status) is always mutable.
    *
+   * \note A PoolItem is just the \ref sat::Solvable id. The status data
+   * of all items are kept in arrays indexed by the id, the \ref ResObject
+   * is created on demand. Once the solvable is removed from the pool, all
+   * copies of its PoolItem evaluate to \c false.
   */
   class PoolItem
   {
@@ -112,7 +116,7 @@ namespace zypp
 
       /** Return the corresponding \ref sat::Solvable. */
       sat::Solvable satSolvable() const
-      { return resolvable() ? resolvable()->satSolvable() : sat::Solvable::noSolvable; }
+      { return sat::Solvable( _id ); }
 
       /** Return the buddy we share our status object with.
        * A \ref Product e.g. may share it's status with an associated reference \ref Package.
@@ -137,20 +141,21 @@ namespace zypp
 
       /** Conversion to bool to allow pointer style tests
        *  for nonNULL \ref resolvable. */
-      explicit operator bool() const
-      { return bool(resolvable()); }
+      explicit operator bool() const;
 
     private:
       friend class Impl;
       friend class pool::PoolImpl;
       /** \ref PoolItem generator for \ref pool::PoolImpl. */
       static PoolItem makePoolItem( const sat::Solvable & solvable_r );
+      /** Called by \ref pool::PoolImpl when the solvable left the pool. */
+      static void erasePoolItem( const PoolItem & item_r );
       /** Buddies are set by \ref pool::PoolImpl.*/
       void setBuddy( sat::Solvable solv_r );
       /** internal ctor */
-      explicit PoolItem( Impl * implptr_r );
-      /** Pointer to implementation */
-      RW_pointer<Impl> _pimpl;
+      explicit PoolItem( sat::detail::SolvableIdType id_r );
+      /** The solvable id (index into the \ref Impl arrays). */
+      sat::detail::SolvableIdType _id;
 
     private:
       /** \name tmp hack for save/restore state. */
@@ -169,15 +174,15 @@ namespace zypp
 
   /** \relates PoolItem */
   inline bool operator==( const PoolItem & lhs, const PoolItem & rhs )
-  { return lhs.resolvable() == rhs.resolvable(); }
+  { return lhs.satSolvable().id() == rhs.satSolvable().id(); }
 
   /** \relates PoolItem */
   inline bool operator==( const PoolItem & lhs, const ResObject::constPtr & rhs )
-  { return lhs.resolvable() == rhs; }
+  { return rhs ? lhs.satSolvable().id() == rhs->satSolvable().id() : ! lhs; }
 
   /** \relates PoolItem */
   inline bool operator==( const ResObject::constPtr & lhs, const PoolItem & rhs )
-  { return lhs == rhs.resolvable(); }
+  { return rhs == lhs; }
 
 
   /** \relates PoolItem */
@@ -237,10 +242,10 @@ namespace zypp
 namespace std
 { /////////////////////////////////////////////////////////////////
 
-  /** \relates zypp::PoolItem Order in std::container follows ResObject::constPtr.*/
+  /** \relates zypp::PoolItem Order in std::container follows sat::Solvable.*/
   template<>
     inline bool less<zypp::PoolItem>::operator()( const zypp::PoolItem & lhs, const zypp::PoolItem & rhs ) const
-    { return lhs.resolvable() < rhs.resolvable(); }
+    { return lhs.satSolvable().id() < rhs.satSolvable().id(); }
 
   /////////////////////////////////////////////////////////////////
 } // namespace zypp
@@ -18,10 +18,14 @@
 #include "zypp/base/String.h"
 #include "zypp/repo/RepoException.h"
 #include "zypp/RelCompare.h"
+#include "zypp/ZConfig.h"
 
 #include "zypp/sat/Pool.h"
+#include "zypp/sat/detail/PoolImpl.h"
 #include "zypp/sat/Solvable.h"
+#include "zypp/sat/QueryIndex.h"
 #include "zypp/base/StrMatcher.h"
+#include "zypp/thread/WorkerPool.h"
 
 #include "zypp/PoolQuery.h"
 
@@ -1447,6 +1451,9 @@ attremptycheckend:
 
 	bool advance( base_iterator & base_r ) const
 	{
+	  if ( _useCandidates )
+	    return advanceCandidates( base_r );
+
 	  if ( base_r == end() )
 	    base_r = startNewQyery(); // first candidate
 	  else
@@ -1548,6 +1555,9 @@ attremptycheckend:
 	  _status_flags = query_r->_status_flags;
           // StrMatcher
           _attrMatchList = query_r->_attrMatchList;
+
+	  if ( ! _neverMatchRepo && ZConfig::instance().pool_queryIndex() )
+	    initCandidates();
 	}
 
 	~PoolQueryMatcher()
@@ -1567,7 +1577,22 @@ attremptycheckend:
 	    q.setRepo( *_repos.begin() );
 	  // else: handled in isAMatch.
 
-	  // Attribute restriction:
+	  setAttrRestriction( q );
+	  return q.begin();
+	}
+
+	/** Initialize a new base query for one candidate solvable. */
+	base_iterator startSolvableQuery( sat::Solvable solv_r ) const
+	{
+	  sat::LookupAttr q;
+	  setAttrRestriction( q );
+	  q.setSolvable( solv_r );
+	  return q.begin();
+	}
+
+	/** Attribute restriction for the base query. */
+	void setAttrRestriction( sat::LookupAttr & q ) const
+	{
 	  if ( _attrMatchList.size() == 1 ) // all (SolvAttr::allAttr) or 1 attr
 	  {
             const AttrMatchData & matchData( _attrMatchList.front() );
@@ -1580,10 +1605,324 @@ attremptycheckend:
             // no restriction, it's all handled in isAMatch.
             q.setAttr( sat::SolvAttr::allAttr );
           }
+	}
 
-	  return q.begin();
+	/** Let the \ref sat::QueryIndex preselect the solvables to look at.
+	 * Each attribute must be indexed and its matcher usable by the index,
+	 * otherwise the whole pool must be searched anyway.
+	 */
+	void initCandidates()
+	{
+	  for_( mi, _attrMatchList.begin(), _attrMatchList.end() )
+	  {
+	    if ( ! ( sat::QueryIndex::indexed( mi->attr ) && sat::QueryIndex::usable( mi->strMatcher ) ) )
+	      return;
+	  }
+
+	  const sat::QueryIndex & index( sat::QueryIndex::instance() );
+	  sat::QueryIndex::Candidates candidates;
+	  for_( mi, _attrMatchList.begin(), _attrMatchList.end() )
+	  {
+	    if ( ! index.candidates( mi->attr, mi->strMatcher, candidates ) )
+	      return;
+	  }
+	  _candidates.swap( candidates );
+	  _useCandidates = true;
+	}
+
+	/** \ref advance visiting the index candidates only.
+	 * The base query of each candidate is restricted to the
+	 * candidate, so \ref isAMatch and \ref matchDetail are
+	 * not affected.
+	 */
+	bool advanceCandidates( base_iterator & base_r ) const
+	{
+	  sat::QueryIndex::Candidates::const_iterator cand( _candidates.begin() );
+	  if ( base_r != end() )
+	    cand = std::upper_bound( cand, _candidates.end(), base_r.inSolvable().id() );
+
+	  for ( ; cand != _candidates.end(); ++cand )
+	  {
+	    sat::Solvable solv( *cand );
+	    // Repo restriction if not handled in isAMatch:
+	    if ( _repos.size() == 1 && solv.repository() != *_repos.begin() )
+	      continue;
+
+	    if ( isASolvableMatch( solv, base_r ) )
+	      return true;
+	  }
+	  return false;
+	}
+
+	/** Run the base query restricted to \a solv_r.
+	 * Leaves \a base_r on the match or at \ref end.
+	 */
+	bool isASolvableMatch( sat::Solvable solv_r, base_iterator & base_r ) const
+	{
+	  base_r = startSolvableQuery( solv_r );
+	  while ( base_r != end() )
+	  {
+	    if ( isAMatch( base_r ) )
+	      return true;
+	    // No match: try next
+	    ++base_r;
+	  }
+	  return false;
+	}
+
+      public:
+	/** Collect all matching solvables in pool order.
+	 * \see \ref PoolQuery::parallelResult
+	 */
+	void collect( std::vector<sat::Solvable> & result_r, unsigned workers_r ) const
+	{
+	  if ( _neverMatchRepo )
+	    return;
+
+	  if ( _useCandidates || ! parallelSafe() )
+	  {
+	    base_iterator base;
+	    while ( advance( base ) )
+	      result_r.push_back( base.inSolvable() );
+	    return;
+	  }
+
+	  std::vector<ParallelJob> jobs;
+	  {
+	    sat::Pool satpool( sat::Pool::instance() );
+	    if ( ! workers_r )
+	      workers_r = thread::WorkerPool::defaultSize();
+	    // Repos bigger than this are split into ranges. File lists
+	    // are searched per repo (see \ref parallelSafe).
+	    unsigned chunkSize = std::max( 256U, unsigned( satpool.solvablesSize() / ( workers_r * 8 ) ) );
+	    bool wholeRepos = ( _attrMatchList.front().attr == sat::SolvAttr::filelist );
+
+	    for_( rit, satpool.reposBegin(), satpool.reposEnd() )
+	    {
+	      Repository repo( *rit );
+	      if ( ! _repos.empty() && _repos.find( repo ) == _repos.end() )
+		continue;
+	      if ( _status_flags && ( (_status_flags == PoolQuery::INSTALLED_ONLY) != repo.isSystemRepo() ) )
+		continue;
+
+	      if ( wholeRepos || repo.solvablesSize() <= chunkSize )
+	      {
+		jobs.push_back( ParallelJob( repo ) );
+		continue;
+	      }
+	      for_( sit, repo.solvablesBegin(), repo.solvablesEnd() )
+	      {
+		if ( jobs.empty() || jobs.back().repo || jobs.back().solvables.size() == chunkSize )
+		{
+		  jobs.push_back( ParallelJob() );
+		  jobs.back().solvables.reserve( chunkSize );
+		}
+		jobs.back().solvables.push_back( *sit );
+	      }
+	    }
+	  }
+	  if ( jobs.empty() )
+	    return;
+
+	  // Compile in the calling thread; jobs just use the matcher.
+	  if ( _attrMatchList.front().strMatcher )
+	    _attrMatchList.front().strMatcher.compile();
+
+	  {
+	    thread::WorkerPool workers( std::min( workers_r, unsigned(jobs.size()) ) );
+	    for_( it, jobs.begin(), jobs.end() )
+	    {
+	      ParallelJob * job = &(*it);
+	      workers.schedule( [this,job]() { runJob( *job ); } );
+	    }
+	    workers.wait();
+	  }
+
+	  for_( it, jobs.begin(), jobs.end() )
+	    result_r.insert( result_r.end(), it->found.begin(), it->found.end() );
 	}
 
+	/** Collect those of \a solvables_r matching the query. */
+	void collectFrom( const std::vector<sat::Solvable> & solvables_r, std::vector<sat::Solvable> & result_r ) const
+	{
+	  if ( _neverMatchRepo )
+	    return;
+
+	  base_iterator base;
+	  for_( it, solvables_r.begin(), solvables_r.end() )
+	  {
+	    // Repo restriction if not handled in isAMatch:
+	    if ( _repos.size() == 1 && it->repository() != *_repos.begin() )
+	      continue;
+	    if ( isASolvableMatch( *it, base ) )
+	      result_r.push_back( *it );
+	  }
+	}
+
+      private:
+	/** A part of the pool searched by one \ref thread::WorkerPool job.
+	 * Either a whole \ref Repository, or a range of solvables.
+	 */
+	struct ParallelJob
+	{
+	  ParallelJob( Repository repo_r = Repository::noRepository )
+	  : repo( repo_r )
+	  {}
+	  Repository                 repo;
+	  std::vector<sat::Solvable> solvables;
+	  std::vector<sat::Solvable> found;
+	};
+
+	/** Whether the matching is safe to be done in several threads.
+	 * Concurrent libsolv dataiterators are not read-only:
+	 * \li Checksums and full file paths are stringified in the pools
+	 * shared temp space.
+	 * \li Vertical data (e.g. descriptions) are paged in from
+	 * the solv file through the repodatas shared page store.
+	 * \li Stub repodata are loaded on demand.
+	 *
+	 * So just a single attribute stored incore in every repo is searched
+	 * in parallel (not \ref sat::SolvAttr::allAttr, which is used for
+	 * more than one attribute). Predicates are arbitrary code.
+	 *
+	 * File lists are the exception: They are searched per repo, so no
+	 * repodata is paged in by two threads, and the file list entries are
+	 * matched by \ref runFileListJob, not by the dataiterator. Still all
+	 * file lists must be loaded.
+	 */
+	bool parallelSafe() const
+	{
+	  if ( _attrMatchList.size() != 1 )
+	    return false;
+	  const AttrMatchData & matchData( _attrMatchList.front() );
+	  if ( matchData.predicate || matchData.strMatcher.flags().test( Match::CHECKSUMS ) )
+	    return false;
+	  if ( matchData.attr == sat::SolvAttr::allAttr )
+	    return false;
+	  if ( matchData.attr == sat::SolvAttr::filelist )
+	    return attrLoaded( matchData.attr, false );
+	  return attrLoaded( matchData.attr, true );
+	}
+
+	/** Whether \a attr_r is loaded (and if \a incore_r, stored incore) in all repos. */
+	static bool attrLoaded( sat::SolvAttr attr_r, bool incore_r )
+	{
+	  sat::Pool satpool( sat::Pool::instance() );
+	  for_( rit, satpool.reposBegin(), satpool.reposEnd() )
+	  {
+	    ::_Repo * repo( rit->get() );
+	    int rdid;
+	    ::_Repodata * data;
+	    FOR_REPODATAS( repo, rdid, data )
+	    {
+	      for ( int k = 1; k < data->nkeys; ++k )
+	      {
+		if ( data->keys[k].name == attr_r.id()
+		     && ( data->state == REPODATA_STUB
+		          || ( incore_r && data->keys[k].storage == KEY_STORAGE_VERTICAL_OFFSET ) ) )
+		  return false;
+	      }
+	    }
+	  }
+	  return true;
+	}
+
+	/** Search the part of the pool assigned to \a job_r.
+	 * A whole repo is searched by a single base query, so the
+	 * search string is compiled just once. Solvable ranges are
+	 * searched solvable by solvable.
+	 */
+	void runJob( ParallelJob & job_r ) const
+	{
+	  if ( job_r.repo && _attrMatchList.front().attr == sat::SolvAttr::filelist )
+	  {
+	    runFileListJob( job_r );
+	  }
+	  else if ( job_r.repo )
+	  {
+	    sat::LookupAttr q;
+	    q.setRepo( job_r.repo );
+	    setAttrRestriction( q );
+	    base_iterator base( q.begin() );
+	    while ( base != end() )
+	    {
+	      if ( isAMatch( base ) )
+	      {
+		job_r.found.push_back( base.inSolvable() );
+		base.nextSkipSolvable(); // assert we don't visit this Solvable again
+	      }
+	      ++base;
+	    }
+	  }
+	  else
+	  {
+	    base_iterator base;
+	    for_( it, job_r.solvables.begin(), job_r.solvables.end() )
+	    {
+	      if ( isASolvableMatch( *it, base ) )
+		job_r.found.push_back( *it );
+	    }
+	  }
+	}
+
+
+	/** Search the file lists of the repo assigned to \a job_r.
+	 * The base query just iterates the file list entries. Matching is
+	 * done here, building the full path (if \ref Match::FILES) per job
+	 * instead of in the pools shared temp space like \c repodata_dir2str.
+	 */
+	void runFileListJob( ParallelJob & job_r ) const
+	{
+	  const StrMatcher & matcher( _attrMatchList.front().strMatcher );
+	  bool fullPath = matcher.flags().test( Match::FILES );
+	  const ::_Repodata * dirData = 0;
+	  std::map<sat::detail::IdType,std::string> dirs; // dirStrings of dirData
+
+	  sat::LookupAttr q( sat::SolvAttr::filelist, job_r.repo );
+	  base_iterator base( q.begin() );
+	  while ( base != end() )
+	  {
+	    bool matches = true; // empty searchstring matches always
+	    if ( matcher )
+	    {
+	      ::_Dataiterator * di( base.get() );
+	      if ( fullPath )
+	      {
+		if ( di->data != dirData )
+		{
+		  dirData = di->data;
+		  dirs.clear();
+		}
+		std::map<sat::detail::IdType,std::string>::iterator dir( dirs.find( di->kv.id ) );
+		if ( dir == dirs.end() )
+		  dir = dirs.insert( std::make_pair( di->kv.id, dirString( di->data, di->kv.id ) ) ).first;
+		matches = matcher.doMatch( ( dir->second + "/" + di->kv.str ).c_str() );
+	      }
+	      else
+		matches = matcher.doMatch( di->kv.str );
+	    }
+
+	    if ( matches && isAMatch( base ) )
+	    {
+	      job_r.found.push_back( base.inSolvable() );
+	      base.nextSkipSolvable(); // assert we don't visit this Solvable again
+	    }
+	    ++base;
+	  }
+	}
+
+	/** Same as \c repodata_dir2str, but not using the pools temp space. */
+	static std::string dirString( ::_Repodata * data_r, sat::detail::IdType did_r )
+	{
+	  std::string ret;
+	  for ( sat::detail::IdType did = did_r; did; did = ::dirpool_parent( &data_r->dirpool, did ) )
+	  {
+	    sat::detail::IdType comp( ::dirpool_compid( &data_r->dirpool, did ) );
+	    const char * comps( ::stringpool_id2str( data_r->localpool ? &data_r->spool : &data_r->repo->pool->ss, comp ) );
+	    ret = ( did == did_r ? std::string( comps ) : std::string( comps ) + "/" + ret );
+	  }
+	  return ret;
+	}
 
 	/** Check whether we are on a match.
 	 *
@@ -1682,6 +2021,9 @@ attremptycheckend:
         int _status_flags;
         /** StrMatcher per attribtue. */
         AttrMatchList _attrMatchList;
+        /** The solvables to look at, if preselected by the \ref sat::QueryIndex. */
+        sat::QueryIndex::Candidates _candidates;
+	DefaultIntegral<bool,false> _useCandidates;
     };
     ///////////////////////////////////////////////////////////////////
 
@@ -1737,6 +2079,46 @@ attremptycheckend:
     return shared_ptr<detail::PoolQueryMatcher>( new detail::PoolQueryMatcher( _pimpl.getPtr() ) );
   }
 
+  sat::SolvableSet PoolQuery::parallelResult( unsigned workers_r ) const
+  {
+    std::vector<sat::Solvable> found;
+    detail::PoolQueryMatcher( _pimpl.getPtr() ).collect( found, workers_r );
+    return sat::SolvableSet( found.begin(), found.end() );
+  }
+
+  sat::SolvableSet PoolQuery::subsetResult( const std::vector<sat::Solvable> & solvables_r ) const
+  {
+    std::vector<sat::Solvable> found;
+    detail::PoolQueryMatcher( _pimpl.getPtr() ).collectFrom( solvables_r, found );
+    return sat::SolvableSet( found.begin(), found.end() );
+  }
+
+  bool PoolQuery::isNameQuery( std::string & name_r ) const
+  {
+    const Impl & q( *_pimpl );
+    if ( ! ( q._strings.empty()
+          && q._attrs.size() == 1
+          && q._attrs.begin()->first == sat::SolvAttr::name
+          && q._attrs.begin()->second.size() == 1
+          && q._uncompiledPredicated.empty()
+          && ! q._match_word
+          && q._status_flags == ALL
+          && q._op == Rel::ANY
+          && q._repos.empty()
+          && q._flags.test( Match::SKIP_KIND ) ) )
+      return false;
+
+    const std::string & name( *q._attrs.begin()->second.begin() );
+    if ( name.empty() )
+      return false;
+    if ( ! ( q._flags.isModeString()
+          || ( q._flags.isModeGlob() && name.find_first_of( "*?[\\" ) == std::string::npos ) ) )
+      return false;
+
+    name_r = name;
+    return true;
+  }
+
   /////////////////////////////////////////////////////////////////
 } // namespace zypp
 ///////////////////////////////////////////////////////////////////
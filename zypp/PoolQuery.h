@@ -24,6 +24,7 @@
 #include "zypp/sat/LookupAttr.h"
 #include "zypp/base/StrMatcher.h"
 #include "zypp/sat/Pool.h"
+#include "zypp/sat/SolvableSet.h"
 
 ///////////////////////////////////////////////////////////////////
 namespace zypp
@@ -135,6 +136,56 @@ namespace zypp
      */
     void execute(ProcessResolvable fnc);
 
+    /**
+     * Evaluate the whole query on \a workers_r threads
+     * (\c 0 uses \ref thread::WorkerPool::defaultSize).
+     *
+     * The pool is split into jobs per \ref Repository. Big repositories
+     * are further split into ranges of solvables. The result is the same
+     * as collecting \ref begin .. \ref end, no matter how many threads
+     * were used.
+     *
+     * Meant for expensive queries like \c REGEX matches. Only queries
+     * searching a single attribute are evaluated in parallel:
+     * \li attributes held in memory by all repos (e.g. names or provides),
+     * \li \ref sat::SolvAttr::filelist, one job per \ref Repository,
+     * if all file lists are loaded.
+     *
+     * Queries for more than one attribute (or all attributes), other
+     * attributes paged in from the solv file on demand (e.g. descriptions),
+     * using a predicate (see \ref addDependency with an edition or arch)
+     * or \ref Match::CHECKSUMS are evaluated in the calling thread, as
+     * are queries the \ref sat::QueryIndex already restricts.
+     *
+     * The pool must not be modified while the query runs.
+     *
+     * \throws sat::MatchInvalidRegexException as \ref begin does.
+     */
+    sat::SolvableSet parallelResult( unsigned workers_r = 0 ) const;
+
+    /**
+     * The query result restricted to \a solvables_r.
+     *
+     * Instead of searching the whole pool, the query is evaluated
+     * for each of the given solvables. This is faster if they are
+     * just a small part of the pool (e.g. the solvables of a newly
+     * loaded repo).
+     *
+     * \throws sat::MatchInvalidRegexException as \ref begin does.
+     */
+    sat::SolvableSet subsetResult( const std::vector<sat::Solvable> & solvables_r ) const;
+
+    /**
+     * Whether the query matches solvables just by name.
+     *
+     * That's a query for a single \ref sat::SolvAttr::name string in
+     * mode \c STRING (or a \c GLOB without wildcards), optionally
+     * restricted to some \ref kinds. Such a query (e.g. a package lock)
+     * can be evaluated by comparing the solvables \ref sat::Solvable::name
+     * to \a name_r (respecting \ref caseSensitive).
+     */
+    bool isNameQuery( std::string & name_r ) const;
+
     /**
      * Filter by selectable kind.
      *
@@ -18,6 +18,7 @@
 #include "zypp/base/String.h"
 #include "zypp/base/Regex.h"
 #include "zypp/PublicKey.h"
+#include "zypp/PgpKeyRing.h"
 #include "zypp/ExternalProgram.h"
 #include "zypp/TmpPath.h"
 #include "zypp/PathInfo.h"
@@ -343,6 +344,47 @@ namespace zypp
         PathInfo info( _dataFile.path() );
         MIL << "Reading pubkey from " << info.path() << " of size " << info.size() << " and sha1 " << filesystem::checksum(info.path(), "sha1") << endl;
 
+	PublicKeyScanner scanner;
+	PgpKeyRing native;
+	if ( native.load( _dataFile.path() ) && ! native.empty() )
+	{
+	  // gpg does not list the signatures here
+	  std::vector<std::string> lines( native.colonListing() );
+	  for_( it, lines.begin(), lines.end() )
+	  {
+	    if ( ! str::hasPrefix( *it, "sig:" ) )
+	      scanner.scan( *it );
+	  }
+	}
+	else
+	  scanWithGpg( scanner );
+
+	switch ( scanner._keys.size() )
+	{
+	  case 0:
+	    ZYPP_THROW( BadKeyException( "File " + _dataFile.path().asString() + " doesn't contain public key data" , _dataFile.path() ) );
+	    break;
+
+	  case 1:
+	    // ok.
+	    _keyData = scanner._keys.back();
+	    _hiddenKeys.clear();
+	    break;
+
+	  default:
+	    WAR << "File " << _dataFile.path().asString() << " contains multiple keys: " <<  scanner._keys << endl;
+	    _keyData = scanner._keys.back();
+	    scanner._keys.pop_back();
+	    _hiddenKeys.swap( scanner._keys );
+	    break;
+	}
+
+	MIL << "Read pubkey from " << info.path() << ": " << _keyData << endl;
+      }
+
+      /** Scan the key file using gpg. */
+      void scanWithGpg( PublicKeyScanner & scanner ) const
+      {
         static filesystem::TmpDir dir;
         const char* argv[] =
         {
@@ -364,34 +406,11 @@ namespace zypp
         };
         ExternalProgram prog( argv, ExternalProgram::Discard_Stderr, false, -1, true );
 
-	PublicKeyScanner scanner;
         for ( std::string line = prog.receiveLine(); !line.empty(); line = prog.receiveLine() )
         {
 	  scanner.scan( line );
 	}
         prog.close();
-
-	switch ( scanner._keys.size() )
-	{
-	  case 0:
-	    ZYPP_THROW( BadKeyException( "File " + _dataFile.path().asString() + " doesn't contain public key data" , _dataFile.path() ) );
-	    break;
-
-	  case 1:
-	    // ok.
-	    _keyData = scanner._keys.back();
-	    _hiddenKeys.clear();
-	    break;
-
-	  default:
-	    WAR << "File " << _dataFile.path().asString() << " contains multiple keys: " <<  scanner._keys << endl;
-	    _keyData = scanner._keys.back();
-	    scanner._keys.pop_back();
-	    _hiddenKeys.swap( scanner._keys );
-	    break;
-	}
-
-	MIL << "Read pubkey from " << info.path() << ": " << _keyData << endl;
       }
 
     private:
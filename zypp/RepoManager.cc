@@ -17,12 +17,22 @@
 #include <list>
 #include <map>
 #include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "zypp/base/InputStream.h"
+#include "zypp/base/IOStream.h"
 #include "zypp/base/LogTools.h"
 #include "zypp/base/Gettext.h"
 #include "zypp/base/Function.h"
 #include "zypp/base/Regex.h"
+#include "zypp/base/UserRequestException.h"
+#include "zypp/thread/Mutex.h"
+#include "zypp/thread/MutexLock.h"
+#include "zypp/thread/WorkerPool.h"
 #include "zypp/PathInfo.h"
 #include "zypp/TmpPath.h"
 
@@ -36,6 +46,7 @@
 #include "zypp/ExternalProgram.h"
 #include "zypp/ManagedFile.h"
 
+#include "zypp/parser/IniDict.h"
 #include "zypp/parser/RepoFileReader.h"
 #include "zypp/parser/ServiceFileReader.h"
 #include "zypp/repo/ServiceRepos.h"
@@ -43,6 +54,7 @@
 #include "zypp/repo/susetags/Downloader.h"
 #include "zypp/parser/plaindir/RepoParser.h"
 #include "zypp/repo/PluginServices.h"
+#include "zypp/repo/SolvCacheBuilder.h"
 
 #include "zypp/Target.h" // for Target::targetDistribution() for repo index services
 #include "zypp/ZYppFactory.h" // to get the Target from ZYpp instance
@@ -99,6 +111,78 @@ namespace zypp
       private:
         media::MediaAccessId _mid;
     };
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class RefreshValidators
+    /// \brief The validators (e.g. HTTP ETag and Last-Modified) of the files
+    /// downloaded when checking a repo for changes.
+    ///
+    /// Stored in the raw cache, so the next check can ask the server whether
+    /// the files changed, instead of downloading them. One line per file:
+    /// the checksum of the file the validators belong to, the files name and
+    /// the validators, separated by TAB.
+    ///////////////////////////////////////////////////////////////////
+    class RefreshValidators
+    {
+    public:
+      /** Name of the file in the raw cache. */
+      static const char * fileName()
+      { return "refresh.validators"; }
+
+    public:
+      /** Read the validators stored in \a file_r. */
+      RefreshValidators( const Pathname & file_r )
+      : _file( file_r )
+      {
+        std::ifstream str( _file.c_str() );
+        for( iostr::EachLine in( str ); in; in.next() )
+        {
+          std::string::size_type sep1( in->find( '\t' ) );
+          std::string::size_type sep2( sep1 == std::string::npos ? sep1 : in->find( '\t', sep1 + 1 ) );
+          if ( sep2 != std::string::npos )
+            _validators[in->substr( sep1 + 1, sep2 - sep1 - 1 )] = Entry( in->substr( 0, sep1 ), in->substr( sep2 + 1 ) );
+        }
+      }
+
+      /** The validators of \a name_r, if they belong to a file with checksum \a checksum_r. */
+      std::string get( const Pathname & name_r, const std::string & checksum_r ) const
+      {
+        std::map<std::string,Entry>::const_iterator it( _validators.find( name_r.asString() ) );
+        if ( it == _validators.end() || checksum_r.empty() || it->second.first != checksum_r )
+          return std::string();
+        return it->second.second;
+      }
+
+      /** Remember the validators of \a name_r, downloaded with checksum \a checksum_r. */
+      void set( const Pathname & name_r, const std::string & checksum_r, const std::string & validators_r )
+      {
+        if ( validators_r.empty() )
+          _validators.erase( name_r.asString() );
+        else
+          _validators[name_r.asString()] = Entry( checksum_r, validators_r );
+      }
+
+      /** Write the validators. It's just a cache, so failing to write is not an error. */
+      void save() const
+      {
+        if ( _validators.empty() )
+        {
+          filesystem::unlink( _file );
+          return;
+        }
+        std::ofstream str( _file.c_str() );
+        for_( it, _validators.begin(), _validators.end() )
+          str << it->second.first << '\t' << it->first << '\t' << it->second.second << endl;
+        if ( ! str )
+          WAR << "Can't write " << _file << endl;
+      }
+
+    private:
+      /** checksum and validators */
+      typedef std::pair<std::string,std::string> Entry;
+      Pathname _file;
+      std::map<std::string,Entry> _validators;
+    };
     ///////////////////////////////////////////////////////////////////
 
     /** Check if alias_r is present in repo/service container. */
@@ -209,37 +293,367 @@ namespace zypp
 
     ////////////////////////////////////////////////////////////////////////////
 
+    /** The stamp an \ref IniDirCache compares to detect changed files. */
+    struct FileStamp
+    {
+      FileStamp()
+      : size( 0 ), mtime( 0 ), ino( 0 )
+      {}
+
+      explicit FileStamp( const Pathname & file_r )
+      : size( 0 ), mtime( 0 ), ino( 0 )
+      {
+	struct stat st;
+	if ( ::stat( file_r.c_str(), &st ) == 0 )
+	{
+	  size  = st.st_size;
+	  mtime = uint64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+	  ino   = st.st_ino;
+	}
+      }
+
+      /** Whether the file was modified so recently (compared to \a now_r),
+       * that a further change might leave the stamp unchanged.
+       */
+      bool isRacy( time_t now_r ) const
+      { return mtime / 1000000000 + 1 >= uint64_t(now_r); }
+
+      bool operator==( const FileStamp & rhs ) const
+      { return size == rhs.size && mtime == rhs.mtime && ino == rhs.ino; }
+
+      bool operator!=( const FileStamp & rhs ) const
+      { return ! ( *this == rhs ); }
+
+      uint64_t size;
+      uint64_t mtime;	//!< in nanoseconds
+      uint64_t ino;
+    };
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class IniDirCache
+    /// \brief The parsed ini files of a directory, remembered in a cache file.
+    ///
+    /// Reading the \c .repo or \c .service files means a readdir, plus an
+    /// open and a parse per file. The parsed \ref parser::IniDict of each file
+    /// is written to a binary cache file, together with the stamps of the
+    /// directory and of each file. As long as the stamps match, the dicts
+    /// are taken from the cache, which costs one stat per file.
+    ///
+    /// Adding, removing or renaming a file changes the directories stamp,
+    /// files edited in place change their own stamp.
+    ///////////////////////////////////////////////////////////////////
+    class IniDirCache : private base::NonCopyable
+    {
+    public:
+      /** A file and its content. */
+      typedef std::pair<Pathname, shared_ptr<parser::IniDict> > File;
+
+    public:
+      /** Load the files of \a dir_r remembered in \a cache_r.
+       * If the cache is missing or outdated, it's empty and the
+       * files must be passed to \ref parse.
+       */
+      IniDirCache( const Pathname & dir_r, const Pathname & cache_r )
+      : _dir( dir_r )
+      , _cache( cache_r )
+      , _dirStamp( dir_r )
+      , _valid( false )
+      , _dirty( true )
+      {
+	if ( load() )
+	{
+	  _valid = true;
+	  _dirty = false;
+	}
+	else
+	{
+	  _files.clear();
+	  _auxStamps.clear();
+	}
+      }
+
+      /** Whether the files were taken from the cache. */
+      bool valid() const
+      { return _valid; }
+
+      /** The remembered files in the order they were parsed. */
+      const std::list<File> & files() const
+      { return _files; }
+
+      /** Parse \a file_r and remember its content.
+       * \throws Exception with message \a openError_r, if not empty and \a file_r can't be opened.
+       */
+      const parser::IniDict & parse( const Pathname & file_r, const std::string & openError_r = std::string() )
+      {
+	FileStamp stamp( file_r );	// before reading, so a concurrent change is noticed next time
+	InputStream is( file_r );
+	if ( ! openError_r.empty() && is.stream().fail() )
+	{
+	  ZYPP_THROW( Exception( openError_r ) );
+	}
+	shared_ptr<parser::IniDict> dict( new parser::IniDict( is ) );
+	_files.push_back( File( file_r, dict ) );
+	_stamps.push_back( stamp );
+	_dirty = true;
+	return *dict;
+      }
+
+      /** Stamps of further files or directories the user wants to remember. */
+      const std::vector<FileStamp> & auxStamps() const
+      { return _auxStamps; }
+
+      /** Set the \ref auxStamps. */
+      void setAuxStamps( const std::vector<FileStamp> & stamps_r )
+      {
+	if ( stamps_r != _auxStamps )
+	{
+	  _auxStamps = stamps_r;
+	  _dirty = true;
+	}
+      }
+
+      /** Write the cache file if it changed.
+       * It's just a cache, so failing to write is not an error.
+       * Not done if a files stamp is too recent to be trusted. Such
+       * \ref auxStamps are not remembered.
+       */
+      void save()
+      {
+	if ( ! _dirty )
+	  return;
+
+	time_t now = ::time( 0 );
+	bool racy = _dirStamp.isRacy( now );
+	for_( it, _stamps.begin(), _stamps.end() )
+	  racy = racy || it->isRacy( now );
+	if ( racy )
+	{
+	  DBG << "Not writing " << _cache << ": files were just modified" << endl;
+	  return;
+	}
+	bool auxRacy = false;
+	for_( it, _auxStamps.begin(), _auxStamps.end() )
+	  auxRacy = auxRacy || it->isRacy( now );
+
+	std::string buf( magic() );
+	putStr( buf, _dir.asString() );
+	putStamp( buf, _dirStamp );
+	putNum( buf, auxRacy ? 0 : _auxStamps.size() );
+	if ( ! auxRacy )
+	{
+	  for_( it, _auxStamps.begin(), _auxStamps.end() )
+	    putStamp( buf, *it );
+	}
+	putNum( buf, _files.size() );
+	std::list<FileStamp>::const_iterator stamp( _stamps.begin() );
+	for_( it, _files.begin(), _files.end() )
+	{
+	  const parser::IniDict & dict( *it->second );
+	  putStr( buf, it->first.basename() );
+	  putStamp( buf, *stamp++ );
+	  putNum( buf, std::distance( dict.sectionsBegin(), dict.sectionsEnd() ) );
+	  for_( sit, dict.sectionsBegin(), dict.sectionsEnd() )
+	  {
+	    putStr( buf, *sit );
+	    putNum( buf, std::distance( dict.entriesBegin( *sit ), dict.entriesEnd( *sit ) ) );
+	    for_( eit, dict.entriesBegin( *sit ), dict.entriesEnd( *sit ) )
+	    {
+	      putStr( buf, eit->first );
+	      putStr( buf, eit->second );
+	    }
+	  }
+	}
+
+	filesystem::TmpFile tmp( filesystem::TmpFile::makeSibling( _cache ) );
+	if ( ! tmp )
+	{
+	  DBG << "Can't write " << _cache << endl;
+	  return;
+	}
+	std::ofstream str( tmp.path().c_str(), std::ios::binary );
+	str.write( buf.data(), buf.size() );
+	str.close();
+	if ( ! str || filesystem::rename( tmp.path(), _cache ) != 0 )
+	{
+	  WAR << "Can't write " << _cache << endl;
+	  return;
+	}
+	tmp.autoCleanup( false );
+	_dirty = false;
+	MIL << "Remembered " << _files.size() << " files of " << _dir << " in " << _cache << endl;
+      }
+
+    private:
+      static std::string magic()
+      { return std::string( "ZYPPINI1", 8 ); }
+
+      static void putNum( std::string & buf_r, uint64_t num_r )
+      { buf_r.append( reinterpret_cast<const char *>( &num_r ), sizeof(num_r) ); }
+
+      static void putStr( std::string & buf_r, const std::string & str_r )
+      { putNum( buf_r, str_r.size() ); buf_r.append( str_r ); }
+
+      static void putStamp( std::string & buf_r, const FileStamp & stamp_r )
+      { putNum( buf_r, stamp_r.size ); putNum( buf_r, stamp_r.mtime ); putNum( buf_r, stamp_r.ino ); }
+
+      /** Reads back what \ref save wrote; \c false on truncated data. */
+      struct Reader
+      {
+	Reader( const std::string & buf_r )
+	: _cur( buf_r.data() ), _end( buf_r.data() + buf_r.size() )
+	{}
+
+	bool getNum( uint64_t & num_r )
+	{
+	  if ( _end - _cur < ptrdiff_t(sizeof(num_r)) )
+	    return false;
+	  ::memcpy( &num_r, _cur, sizeof(num_r) );
+	  _cur += sizeof(num_r);
+	  return true;
+	}
+
+	bool getStr( std::string & str_r )
+	{
+	  uint64_t len;
+	  if ( ! getNum( len ) || uint64_t(_end - _cur) < len )
+	    return false;
+	  str_r.assign( _cur, len );
+	  _cur += len;
+	  return true;
+	}
+
+	bool getStamp( FileStamp & stamp_r )
+	{ return getNum( stamp_r.size ) && getNum( stamp_r.mtime ) && getNum( stamp_r.ino ); }
+
+	bool atEnd() const
+	{ return _cur == _end; }
+
+	const char * _cur;
+	const char * _end;
+      };
+
+      /** Load the cache, \c false if missing or outdated. */
+      bool load()
+      {
+	std::ifstream str( _cache.c_str(), std::ios::binary );
+	if ( ! str )
+	  return false;
+	std::ostringstream content;
+	content << str.rdbuf();
+	std::string buf( content.str() );
+
+	if ( buf.compare( 0, magic().size(), magic() ) != 0 )
+	  return false;
+	buf.erase( 0, magic().size() );
+	Reader rd( buf );
+
+	std::string dir;
+	FileStamp stamp;
+	if ( ! ( rd.getStr( dir ) && dir == _dir.asString()
+	         && rd.getStamp( stamp ) && stamp == _dirStamp ) )
+	  return false;
+
+	uint64_t count;
+	if ( ! rd.getNum( count ) )
+	  return false;
+	for ( ; count; --count )
+	{
+	  if ( ! rd.getStamp( stamp ) )
+	    return false;
+	  _auxStamps.push_back( stamp );
+	}
+
+	if ( ! rd.getNum( count ) )
+	  return false;
+	for ( ; count; --count )
+	{
+	  std::string name;
+	  uint64_t sections;
+	  if ( ! ( rd.getStr( name ) && rd.getStamp( stamp ) && rd.getNum( sections ) ) )
+	    return false;
+	  Pathname file( _dir / name );
+	  if ( stamp != FileStamp( file ) )
+	  {
+	    DBG << "Outdated " << _cache << ": " << file << " changed" << endl;
+	    return false;
+	  }
+
+	  shared_ptr<parser::IniDict> dict( new parser::IniDict );
+	  for ( ; sections; --sections )
+	  {
+	    std::string section;
+	    uint64_t entries;
+	    if ( ! ( rd.getStr( section ) && rd.getNum( entries ) ) )
+	      return false;
+	    dict->consume( section );	// remember even empty sections
+	    for ( ; entries; --entries )
+	    {
+	      std::string key;
+	      std::string value;
+	      if ( ! ( rd.getStr( key ) && rd.getStr( value ) ) )
+		return false;
+	      dict->insertEntry( section, key, value );
+	    }
+	  }
+	  _files.push_back( File( file, dict ) );
+	  _stamps.push_back( stamp );
+	}
+	return rd.atEnd();
+      }
+
+    private:
+      Pathname _dir;
+      Pathname _cache;
+      FileStamp _dirStamp;
+      std::list<File> _files;
+      std::list<FileStamp> _stamps;
+      std::vector<FileStamp> _auxStamps;
+      bool _valid;
+      bool _dirty;
+    };
+
+    ////////////////////////////////////////////////////////////////////////////
+
     /**
      * \short List of RepoInfo's from a directory
      *
      * Goes trough every file ending with ".repo" in a directory and adds all
-     * RepoInfo's contained in that file.
+     * RepoInfo's contained in that file. Unless they are remembered in
+     * \a cache.
      *
      * \param dir pathname of the directory to read.
+     * \param cache the files remembered for \a dir.
      */
-    std::list<RepoInfo> repositories_in_dir( const Pathname &dir )
+    std::list<RepoInfo> repositories_in_dir( const Pathname &dir, IniDirCache & cache )
     {
       MIL << "directory " << dir << endl;
-      std::list<RepoInfo> repos;
-      std::list<Pathname> entries;
-      if ( filesystem::readdir( entries, dir, false ) != 0 )
+      if ( ! cache.valid() )
       {
-	// TranslatorExplanation '%s' is a pathname
-	ZYPP_THROW(Exception(str::form(_("Failed to read directory '%s'"), dir.c_str())));
-      }
-
-      str::regex allowedRepoExt("^\\.repo(_[0-9]+)?$");
-      for ( std::list<Pathname>::const_iterator it = entries.begin(); it != entries.end(); ++it )
-      {
-	if (str::regex_match(it->extension(), allowedRepoExt))
+	std::list<Pathname> entries;
+	if ( filesystem::readdir( entries, dir, false ) != 0 )
 	{
-	  std::list<RepoInfo> tmp = repositories_in_file( *it );
-	  repos.insert( repos.end(), tmp.begin(), tmp.end() );
+	  // TranslatorExplanation '%s' is a pathname
+	  ZYPP_THROW(Exception(str::form(_("Failed to read directory '%s'"), dir.c_str())));
+	}
 
-	  //std::copy( collector.repos.begin(), collector.repos.end(), std::back_inserter(repos));
-	  //MIL << "ok" << endl;
+	str::regex allowedRepoExt("^\\.repo(_[0-9]+)?$");
+	for ( std::list<Pathname>::const_iterator it = entries.begin(); it != entries.end(); ++it )
+	{
+	  if (str::regex_match(it->extension(), allowedRepoExt))
+	    cache.parse( *it );
 	}
       }
+      else
+	MIL << "using the remembered content of " << dir << endl;
+
+      std::list<RepoInfo> repos;
+      for_( it, cache.files().begin(), cache.files().end() )
+      {
+	MIL << "repo file: " << it->first << endl;
+	RepoCollector collector;
+	parser::RepoFileReader parser( *it->second, it->first, bind( &RepoCollector::collect, &collector, _1 ) );
+	repos.insert( repos.end(), collector.repos.begin(), collector.repos.end() );
+      }
       return repos;
     }
 
@@ -325,6 +739,25 @@ namespace zypp
       return opt.repoSolvCachePath / info.escaped_alias();
     }
 
+    /** Read the solv-file \a file_r into the page cache, so libsolv finds it there.
+     * The file itself is still passed to libsolv, which needs a real file to
+     * page in vertical data (e.g. file lists) on demand instead of keeping them
+     * in memory. Used in worker threads, so it must not log or touch the pool.
+     */
+    void readAheadSolvFile( const Pathname & file_r )
+    {
+      if ( file_r.empty() )
+        return;
+      int fd = ::open( file_r.c_str(), O_RDONLY|O_CLOEXEC );
+      if ( fd < 0 )
+        return;
+      ::posix_fadvise( fd, 0, 0, POSIX_FADV_WILLNEED );
+      char buf[65536];
+      while ( ::read( fd, buf, sizeof(buf) ) > 0 )
+        ;
+      ::close( fd );
+    }
+
     ////////////////////////////////////////////////////////////////////////////
 
     /** Functor collecting ServiceInfos into a ServiceSet. */
@@ -443,12 +876,16 @@ namespace zypp
 
     void refreshMetadata( const RepoInfo & info, RawMetadataRefreshPolicy policy, OPT_PROGRESS );
 
+    void refreshMetadata( const std::list<RepoInfo> & infos, RawMetadataRefreshPolicy policy, OPT_PROGRESS );
+
     void cleanMetadata( const RepoInfo & info, OPT_PROGRESS );
 
     void cleanPackages( const RepoInfo & info, OPT_PROGRESS );
 
     void buildCache( const RepoInfo & info, CacheBuildPolicy policy, OPT_PROGRESS );
 
+    void buildCache( const std::list<RepoInfo> & infos, CacheBuildPolicy policy, OPT_PROGRESS );
+
     repo::RepoType probe( const Url & url, const Pathname & path = Pathname() ) const;
 
     void cleanCacheDirGarbage( OPT_PROGRESS );
@@ -463,6 +900,11 @@ namespace zypp
 
     void loadFromCache( const RepoInfo & info, OPT_PROGRESS );
 
+    void loadFromCache( const std::list<RepoInfo> & infos, OPT_PROGRESS );
+
+    /** Load \a info from its solv-file. */
+    void loadSolvFile( const RepoInfo & info, OPT_PROGRESS );
+
     void addRepository( const RepoInfo & info, OPT_PROGRESS );
 
     void addRepositories( const Url & url, OPT_PROGRESS );
@@ -528,6 +970,42 @@ namespace zypp
 
     void touchIndexFile( const RepoInfo & info );
 
+    /** The raw cache dirs of all known repos (\see \ref Fetcher::addCachePath). */
+    std::list<Pathname> rawCachePaths() const;
+
+    /** Refresh \a info trying \a urls_r one by one.
+     * Unlike \ref refreshMetadata this does not touch the known repos,
+     * so it may be called from a \ref thread::WorkerPool thread. If \a info
+     * had to be probed, the type is returned in \a probedtype_r.
+     */
+    void refreshMetadataFromUrls( const RepoInfo & info, const std::list<Url> & urls_r,
+				  RawMetadataRefreshPolicy policy, const std::list<Pathname> & cachepaths_r,
+				  repo::RepoType & probedtype_r );
+
+    /** Remember a probed \ref RepoType in the repos .repo file. */
+    void saveProbedType( const RepoInfo & info, const repo::RepoType & probedtype_r );
+
+    /** What \ref buildSolvFile needs to know. */
+    struct CacheBuild
+    {
+      RepoInfo info;
+      RepoStatus status;	///< raw metadata status to remember on success
+      repo::RepoType type;	///< the (probed) repo type
+      Pathname metadata;	///< the raw metadata dir
+      Pathname solvfile;	///< the solv file to build
+    };
+
+    /** Check whether \a info needs to be built, refresh and clean the cache if necessary.
+     * \return \c false if the cache is up to date.
+     */
+    bool prepareBuildCache( const RepoInfo & info, CacheBuildPolicy policy, CacheBuild & build_r, OPT_PROGRESS );
+
+    /** Build the solv file. The solv file is removed on error.
+     * Except for \ref RepoType::RPMPLAINDIR this may be called from a
+     * \ref thread::WorkerPool thread.
+     */
+    void buildSolvFile( const CacheBuild & build_r );
+
     template<typename OutputIterator>
     void getRepositoriesInService( const std::string & alias, OutputIterator out ) const
     {
@@ -612,20 +1090,30 @@ namespace zypp
   void RepoManager::Impl::init_knownServices()
   {
     Pathname dir = _options.knownServicesPath;
-    std::list<Pathname> entries;
     if (PathInfo(dir).isExist())
     {
-      if ( filesystem::readdir( entries, dir, false ) != 0 )
+      IniDirCache cache( dir, _options.repoCachePath / "services.d.cache" );
+      if ( ! cache.valid() )
       {
-        // TranslatorExplanation '%s' is a pathname
-        ZYPP_THROW(Exception(str::form(_("Failed to read directory '%s'"), dir.c_str())));
+        std::list<Pathname> entries;
+        if ( filesystem::readdir( entries, dir, false ) != 0 )
+        {
+          // TranslatorExplanation '%s' is a pathname
+          ZYPP_THROW(Exception(str::form(_("Failed to read directory '%s'"), dir.c_str())));
+        }
+
+        //str::regex allowedServiceExt("^\\.service(_[0-9]+)?$");
+        for_(it, entries.begin(), entries.end() )
+        {
+          cache.parse( *it, "Failed to open service file" );
+        }
       }
 
-      //str::regex allowedServiceExt("^\\.service(_[0-9]+)?$");
-      for_(it, entries.begin(), entries.end() )
+      for_(it, cache.files().begin(), cache.files().end() )
       {
-        parser::ServiceFileReader(*it, ServiceCollector(_services));
+        parser::ServiceFileReader(*it->second, it->first, ServiceCollector(_services));
       }
+      cache.save();
     }
 
     repo::PluginServices(_options.pluginsPath/"services", ServiceCollector(_services));
@@ -637,8 +1125,9 @@ namespace zypp
 
     if ( PathInfo(_options.knownReposPath).isExist() )
     {
+      IniDirCache cache( _options.knownReposPath, _options.repoCachePath / "repos.d.cache" );
       std::list<std::string> repoEscAliases;
-      for ( RepoInfo & repoInfo : repositories_in_dir(_options.knownReposPath) )
+      for ( RepoInfo & repoInfo : repositories_in_dir(_options.knownReposPath, cache) )
       {
         // set the metadata path for the repo
         repoInfo.setMetadataPath( rawcache_path_for_repoinfo(_options, repoInfo) );
@@ -651,22 +1140,31 @@ namespace zypp
       repoEscAliases.sort();
 
       // delete metadata folders without corresponding repo (e.g. old tmp directories)
-      for ( const Pathname & cachePath : { _options.repoRawCachePath
-					 , _options.repoSolvCachePath } )
+      // Needed only if the repos or the cache directories changed since the last time.
+      std::vector<FileStamp> cacheStamps { FileStamp( _options.repoRawCachePath ),
+					   FileStamp( _options.repoSolvCachePath ) };
+      if ( ! cache.valid() || cacheStamps != cache.auxStamps() )
       {
-	std::list<std::string> entries;
-	if ( filesystem::readdir( entries, cachePath, false ) == 0 )
+	for ( const Pathname & cachePath : { _options.repoRawCachePath
+					   , _options.repoSolvCachePath } )
 	{
-	  entries.sort();
-	  std::set<std::string> oldfiles;
-	  set_difference( entries.begin(), entries.end(), repoEscAliases.begin(), repoEscAliases.end(),
-			  std::inserter( oldfiles, oldfiles.end() ) );
-	  for ( const std::string & old : oldfiles )
+	  std::list<std::string> entries;
+	  if ( filesystem::readdir( entries, cachePath, false ) == 0 )
 	  {
-	    filesystem::recursive_rmdir( cachePath / old );
+	    entries.sort();
+	    std::set<std::string> oldfiles;
+	    set_difference( entries.begin(), entries.end(), repoEscAliases.begin(), repoEscAliases.end(),
+			    std::inserter( oldfiles, oldfiles.end() ) );
+	    for ( const std::string & old : oldfiles )
+	    {
+	      filesystem::recursive_rmdir( cachePath / old );
+	    }
 	  }
 	}
+	cache.setAuxStamps( { FileStamp( _options.repoRawCachePath ),
+			      FileStamp( _options.repoSolvCachePath ) } );
       }
+      cache.save();
     }
     MIL << "end construct known repos" << endl;
   }
@@ -836,17 +1334,41 @@ namespace zypp
       if ( ( repokind.toEnum() == RepoType::RPMMD_e ) ||
            ( repokind.toEnum() == RepoType::YAST2_e ) )
       {
-        MediaSetAccess media(url);
-        shared_ptr<repo::Downloader> downloader_ptr;
-
+        // The files making up the RepoStatus (see Downloader::status).
+        std::list<Pathname> files;
         if ( repokind.toEnum() == RepoType::RPMMD_e )
-          downloader_ptr.reset(new yum::Downloader(info, mediarootpath));
+          files.push_back( info.path() + "/repodata/repomd.xml" );
         else
-          downloader_ptr.reset( new susetags::Downloader(info, mediarootpath));
+        {
+          files.push_back( info.path() + "/content" );
+          // the media.1/media is always in the root of the media
+          files.push_back( "/media.1/media" );
+        }
+
+        // Ask with the validators of the last check, if they belong to
+        // the cached file. An unchanged file is then not downloaded (HTTP 304).
+        RefreshValidators validators( mediarootpath / RefreshValidators::fileName() );
+        MediaSetAccess media( url );
+        bool changed = false;
+        for ( const Pathname & file : files )
+        {
+          std::string cached( RepoStatus( mediarootpath / file ).checksum() );
+          std::string fileValidators( validators.get( file, cached ) );
+          Pathname provided( media.provideFileIfModified( file, fileValidators ) );
+          if ( provided.empty() )
+          {
+            MIL << file << " not modified" << endl;
+            continue;
+          }
+          std::string checksum( RepoStatus( provided ).checksum() );
+          validators.set( file, checksum, fileValidators );
+          if ( checksum != cached )
+            changed = true;
+        }
+        validators.save();
 
-        RepoStatus newstatus = downloader_ptr->status(media);
         bool refresh = false;
-        if ( oldstatus.checksum() == newstatus.checksum() )
+        if ( ! changed )
         {
           MIL << "repo has not changed" << endl;
           if ( policy == RefreshForced )
@@ -907,18 +1429,270 @@ namespace zypp
   }
 
 
+  std::list<Pathname> RepoManager::Impl::rawCachePaths() const
+  {
+    std::list<Pathname> ret;
+    for_( it, repoBegin(), repoEnd() )
+    {
+      Pathname cachepath( rawcache_path_for_repoinfo( _options, *it ) );
+      if ( PathInfo(cachepath).isExist() )
+        ret.push_back( cachepath );
+    }
+    return ret;
+  }
+
+  void RepoManager::Impl::saveProbedType( const RepoInfo & info, const repo::RepoType & probedtype_r )
+  {
+    if ( probedtype_r == RepoType::NONE )
+      return;
+
+    //save probed type only for repos in system
+    for_( it, repoBegin(), repoEnd() )
+    {
+      if ( info.alias() == (*it).alias() )
+      {
+        RepoInfo modifiedrepo = info;
+        modifiedrepo.setType( probedtype_r );
+        modifyRepository( info.alias(), modifiedrepo );
+        break;
+      }
+    }
+  }
+
   void RepoManager::Impl::refreshMetadata( const RepoInfo & info, RawMetadataRefreshPolicy policy, const ProgressData::ReceiverFnc & progress )
   {
     assert_alias(info);
     assert_urls(info);
 
+    repo::RepoType probedtype;
+    try
+    {
+      refreshMetadataFromUrls( info, std::list<Url>( info.baseUrlsBegin(), info.baseUrlsEnd() ),
+			       policy, rawCachePaths(), probedtype );
+    }
+    catch ( const Exception & excpt )
+    {
+      saveProbedType( info, probedtype );
+      ZYPP_RETHROW( excpt );
+    }
+    saveProbedType( info, probedtype );
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  namespace
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class ParallelRefresh
+    /// \brief Queues of a parallel refresh; one queue per host.
+    ///
+    /// A lane is a job picking the next repo from one hosts queue,
+    /// until the queue is empty. The number of lanes per host limits
+    /// the concurrent connections to a host, while the lanes of
+    /// different hosts are scheduled round robin.
+    ///////////////////////////////////////////////////////////////////
+    struct ParallelRefresh : private base::NonCopyable
+    {
+      /** A repo and it's (replaced) baseurls. */
+      typedef std::pair<RepoInfo,std::list<Url> > Entry;
+
+      ParallelRefresh()
+      : _done( 0 )
+      , _aborted( false )
+      {}
+
+      /** Enqueue an entry to its hosts queue. */
+      void add( const RepoInfo & info_r, const std::list<Url> & urls_r )
+      {
+        const std::string & host( urls_r.front().getHost() );
+        if ( _queue.find( host ) == _queue.end() )
+          _hosts.push_back( host );
+        _queue[host].push_back( Entry( info_r, urls_r ) );
+      }
+
+      /** Get next entry for \a host_r; \c false if none is left or refresh was aborted. */
+      bool next( const std::string & host_r, Entry & entry_r )
+      {
+        thread::MutexLock lock( _mutex );
+        std::list<Entry> & queue( _queue[host_r] );
+        if ( _aborted || queue.empty() )
+          return false;
+        entry_r = queue.front();
+        queue.pop_front();
+        return true;
+      }
+
+      /** Entry is done. Remember it for a retry in case it failed. */
+      void finished( const Entry & entry_r, bool success_r )
+      {
+        thread::MutexLock lock( _mutex );
+        ++_done;
+        if ( ! success_r )
+          _failed.push_back( entry_r.first );
+      }
+
+      /** Don't start new entries. */
+      void abort()
+      {
+        thread::MutexLock lock( _mutex );
+        _aborted = true;
+      }
+
+      unsigned done() const
+      {
+        thread::MutexLock lock( _mutex );
+        return _done;
+      }
+
+      /** Repos whose refresh failed or was not started (after abort). */
+      std::list<RepoInfo> failed() const
+      {
+        thread::MutexLock lock( _mutex );
+        std::list<RepoInfo> ret( _failed );
+        for ( const auto & queue : _queue )
+          for ( const Entry & entry : queue.second )
+            ret.push_back( entry.first );
+        return ret;
+      }
+
+      std::list<std::string> _hosts;	///< hosts in order of appearance
+    private:
+      std::map<std::string,std::list<Entry> > _queue;
+      std::list<RepoInfo> _failed;
+      unsigned _done;
+      bool _aborted;
+      mutable thread::Mutex _mutex;
+    };
+  } // namespace
+  ///////////////////////////////////////////////////////////////////
+
+  void RepoManager::Impl::refreshMetadata( const std::list<RepoInfo> & infos, RawMetadataRefreshPolicy policy, const ProgressData::ReceiverFnc & progressrcv )
+  {
+    ProgressData progress( infos.size() );
+    callback::SendReport<ProgressReport> report;
+    progress.sendTo( ProgressReportAdaptor( progressrcv, report ) );
+    progress.name( _("Refreshing repositories") );
+    progress.toMin();
+
+    // Worker threads can not talk to the application. Repos which need
+    // probing or interaction (auth, untrusted keys, ...), are refreshed
+    // here, after the parallel ones are done.
+    ParallelRefresh parallel;
+    std::list<RepoInfo> serial;
+    unsigned toParallel = 0;
+    for ( const RepoInfo & info : infos )
+    {
+      assert_alias(info);
+      assert_urls(info);
+      // Iterating the baseurls here also initializes the repo variables and
+      // mirrorlists, so workers don't trigger any lazy initialization.
+      std::list<Url> urls( info.baseUrlsBegin(), info.baseUrlsEnd() );
+
+      // Only rpm-md is known to be safe (susetags touches the sat::Pool,
+      // probing may need to modify the repo).
+      if ( ZConfig::instance().repo_refresh_parallel() > 1
+	   && infos.size() > 1
+	   && info.type() == RepoType::RPMMD
+	   && urls.front().schemeIsDownloading() )
+      {
+        parallel.add( info, urls );
+	++toParallel;
+      }
+      else
+        serial.push_back( info );
+    }
+
+    if ( toParallel )
+    {
+      unsigned laneLimit = ZConfig::instance().repo_refresh_parallel_host();
+      unsigned size = std::min( ZConfig::instance().repo_refresh_parallel(), toParallel );
+      MIL << "Refreshing " << toParallel << " repos from " << parallel._hosts.size() << " hosts in parallel ("
+          << size << " max, " << laneLimit << " per host)." << endl;
+
+      std::list<Pathname> cachepaths( rawCachePaths() );
+      thread::WorkerPool pool( size );
+      for ( unsigned lane = 0; lane < laneLimit; ++lane )
+      {
+        for ( const std::string & host : parallel._hosts )
+        {
+	  pool.schedule( [&,host]() {
+	    ParallelRefresh::Entry entry;
+	    while ( parallel.next( host, entry ) )
+	    {
+	      bool success = true;
+	      try
+	      {
+		repo::RepoType probedtype;
+		refreshMetadataFromUrls( entry.first, entry.second, policy, cachepaths, probedtype );
+	      }
+	      catch ( const Exception & excpt )
+	      {
+		ZYPP_CAUGHT( excpt );
+		success = false;
+	      }
+	      parallel.finished( entry, success );
+	    }
+	  } );
+        }
+      }
+
+      while ( ! pool.waitFor( 100 ) )
+      {
+        if ( ! progress.set( parallel.done() ) )
+	  parallel.abort();
+      }
+      if ( ! progress.set( parallel.done() ) )
+        ZYPP_THROW( AbortRequestException() );
+
+      std::list<RepoInfo> failed( parallel.failed() );
+      if ( ! failed.empty() )
+      {
+	MIL << failed.size() << " repos failed to refresh in parallel. Retrying them." << endl;
+	progress.range( progress.val() + serial.size() + failed.size() );
+	serial.splice( serial.end(), failed );
+      }
+    }
+
+    std::list<RepoInfo> failed;
+    RepoException rexception( _("Failed to refresh some repositories.") );
+    for ( const RepoInfo & info : serial )
+    {
+      try
+      {
+        refreshMetadata( info, policy );
+      }
+      catch ( const AbortRequestException & excpt )
+      {
+        ZYPP_RETHROW( excpt );
+      }
+      catch ( const Exception & excpt )
+      {
+        ZYPP_CAUGHT( excpt );
+        ERR << "Failed to refresh " << info.alias() << endl;
+        rexception.remember( excpt );
+        failed.push_back( info );
+      }
+      if ( ! progress.incr() )
+        ZYPP_THROW( AbortRequestException() );
+    }
+
+    if ( ! failed.empty() )
+    {
+      ZYPP_THROW( rexception );
+    }
+    progress.toMax();
+  }
+
+  void RepoManager::Impl::refreshMetadataFromUrls( const RepoInfo & info, const std::list<Url> & urls_r,
+							RawMetadataRefreshPolicy policy, const std::list<Pathname> & cachepaths_r,
+							repo::RepoType & probedtype_r )
+  {
     // we will throw this later if no URL checks out fine
     RepoException rexception(_PL("Valid metadata not found at specified URL",
                                  "Valid metadata not found at specified URLs",
-				 info.baseUrlsSize() ) );
+				 urls_r.size() ) );
 
     // try urls one by one
-    for ( RepoInfo::urls_const_iterator it = info.baseUrlsBegin(); it != info.baseUrlsEnd(); ++it )
+    for ( std::list<Url>::const_iterator it = urls_r.begin(); it != urls_r.end(); ++it )
     {
       try
       {
@@ -944,17 +1718,8 @@ namespace zypp
             {
               // Adjust the probed type in RepoInfo
               info.setProbedType( repokind ); // lazy init!
-              //save probed type only for repos in system
-              for_( it, repoBegin(), repoEnd() )
-              {
-                if ( info.alias() == (*it).alias() )
-                {
-                  RepoInfo modifiedrepo = info;
-                  modifiedrepo.setType( repokind );
-                  modifyRepository( info.alias(), modifiedrepo );
-                  break;
-                }
-              }
+              // caller saves the probed type
+              probedtype_r = repokind;
             }
           break;
           default:
@@ -995,11 +1760,9 @@ namespace zypp
            * repo has the same file, it will not download it
            * but copy it from the other repository
            */
-          for_( it, repoBegin(), repoEnd() )
+          for_( it, cachepaths_r.begin(), cachepaths_r.end() )
           {
-            Pathname cachepath(rawcache_path_for_repoinfo( _options, *it ));
-            if ( PathInfo(cachepath).isExist() )
-              downloader_ptr->addCachePath(cachepath);
+            downloader_ptr->addCachePath(*it);
           }
 
           downloader_ptr->download( media, tmpdir.path() );
@@ -1033,6 +1796,10 @@ namespace zypp
         // ok we have the metadata, now exchange
         // the contents
 	filesystem::exchange( tmpdir.path(), mediarootpath );
+	// keep the validators of the last check; they are used only if
+	// they belong to the new files
+	if ( PathInfo( tmpdir.path() / RefreshValidators::fileName() ).isFile() )
+	  filesystem::rename( tmpdir.path() / RefreshValidators::fileName(), mediarootpath / RefreshValidators::fileName() );
 
         // we are done.
         return;
@@ -1045,7 +1812,7 @@ namespace zypp
         // remember the exception caught for the *first URL*
         // if all other URLs fail, the rexception will be thrown with the
         // cause of the problem of the first URL remembered
-        if (it == info.baseUrlsBegin())
+        if (it == urls_r.begin())
           rexception.remember(e);
       }
     } // for every url
@@ -1060,7 +1827,7 @@ namespace zypp
     ProgressData progress(100);
     progress.sendTo(progressfnc);
 
-    filesystem::recursive_rmdir(rawcache_path_for_repoinfo(_options, info));
+    filesystem::recursive_rmdir(rawcache_path_for_repoinfo(_options, info), true);
     progress.toMax();
   }
 
@@ -1070,12 +1837,12 @@ namespace zypp
     ProgressData progress(100);
     progress.sendTo(progressfnc);
 
-    filesystem::recursive_rmdir(packagescache_path_for_repoinfo(_options, info));
+    filesystem::recursive_rmdir(packagescache_path_for_repoinfo(_options, info), true);
     progress.toMax();
   }
 
 
-  void RepoManager::Impl::buildCache( const RepoInfo & info, CacheBuildPolicy policy, const ProgressData::ReceiverFnc & progressrcv )
+  bool RepoManager::Impl::prepareBuildCache( const RepoInfo & info, CacheBuildPolicy policy, CacheBuild & build_r, const ProgressData::ReceiverFnc & progressrcv )
   {
     assert_alias(info);
     Pathname mediarootpath = rawcache_path_for_repoinfo( _options, info );
@@ -1106,7 +1873,7 @@ namespace zypp
       {
         MIL << info.alias() << " cache is up to date with metadata." << endl;
         if ( policy == BuildIfNeeded ) {
-          return;
+          return false;
         }
         else {
           MIL << info.alias() << " cache rebuild is forced" << endl;
@@ -1116,12 +1883,6 @@ namespace zypp
       needs_cleaning = true;
     }
 
-    ProgressData progress(100);
-    callback::SendReport<ProgressReport> report;
-    progress.sendTo( ProgressReportAdaptor( progressrcv, report ) );
-    progress.name(str::form(_("Building repository '%s' cache"), info.label().c_str()));
-    progress.toMin();
-
     if (needs_cleaning)
     {
       cleanCache(info);
@@ -1142,7 +1903,6 @@ namespace zypp
       Exception ex(str::form( _("Can't create cache at %s - no writing permissions."), base.c_str()) );
       ZYPP_THROW(ex);
     }
-    Pathname solvfile = base / "solv";
 
     // do we have type?
     repo::RepoType repokind = info.type();
@@ -1160,53 +1920,33 @@ namespace zypp
 
     MIL << "repo type is " << repokind << endl;
 
-    switch ( repokind.toEnum() )
+    build_r.info = info;
+    build_r.status = raw_metadata_status;
+    build_r.type = repokind;
+    build_r.metadata = productdatapath;
+    build_r.solvfile = base / "solv";
+    return true;
+  }
+
+  void RepoManager::Impl::buildSolvFile( const CacheBuild & build_r )
+  {
+    switch ( build_r.type.toEnum() )
     {
       case RepoType::RPMMD_e :
       case RepoType::YAST2_e :
       case RepoType::RPMPLAINDIR_e :
       {
         // Take care we unlink the solvfile on exception
-        ManagedFile guard( solvfile, filesystem::unlink );
-        scoped_ptr<MediaMounter> forPlainDirs;
-
-        ExternalProgram::Arguments cmd;
-        cmd.push_back( "repo2solv.sh" );
-
-        // repo2solv expects -o as 1st arg!
-        cmd.push_back( "-o" );
-        cmd.push_back( solvfile.asString() );
+        ManagedFile guard( build_r.solvfile, filesystem::unlink );
 
-        if ( repokind == RepoType::RPMPLAINDIR )
+        if ( build_r.type == RepoType::RPMPLAINDIR )
         {
-          forPlainDirs.reset( new MediaMounter( *info.baseUrlsBegin() ) );
-          // recusive for plaindir as 2nd arg!
-          cmd.push_back( "-R" );
+          MediaMounter forPlainDirs( *build_r.info.baseUrlsBegin() );
           // FIXME this does only work form dir: URLs
-          cmd.push_back( forPlainDirs->getPathName( info.path() ).c_str() );
+          repo::SolvCacheBuilder( build_r.type, forPlainDirs.getPathName( build_r.info.path() ) ).build( build_r.solvfile );
         }
         else
-          cmd.push_back( productdatapath.asString() );
-
-        ExternalProgram prog( cmd, ExternalProgram::Stderr_To_Stdout );
-        std::string errdetail;
-
-        for ( std::string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-          WAR << "  " << output;
-          if ( errdetail.empty() ) {
-            errdetail = prog.command();
-            errdetail += '\n';
-          }
-          errdetail += output;
-        }
-
-        int ret = prog.close();
-        if ( ret != 0 )
-        {
-          RepoException ex(str::form( _("Failed to cache repo (%d)."), ret ));
-          ex.remember( errdetail );
-          ZYPP_THROW(ex);
-        }
+          repo::SolvCacheBuilder( build_r.type, build_r.metadata ).build( build_r.solvfile );
 
         // We keep it.
         guard.resetDispose();
@@ -1216,12 +1956,132 @@ namespace zypp
         ZYPP_THROW(RepoUnknownTypeException( _("Unhandled repository type") ));
       break;
     }
+  }
+
+  void RepoManager::Impl::buildCache( const RepoInfo & info, CacheBuildPolicy policy, const ProgressData::ReceiverFnc & progressrcv )
+  {
+    CacheBuild build;
+    if ( ! prepareBuildCache( info, policy, build, progressrcv ) )
+      return;
+
+    ProgressData progress(100);
+    callback::SendReport<ProgressReport> report;
+    progress.sendTo( ProgressReportAdaptor( progressrcv, report ) );
+    progress.name(str::form(_("Building repository '%s' cache"), info.label().c_str()));
+    progress.toMin();
+
+    buildSolvFile( build );
+
     // update timestamp and checksum
-    setCacheStatus(info, raw_metadata_status);
+    setCacheStatus(info, build.status);
     MIL << "Commit cache.." << endl;
     progress.toMax();
   }
 
+  void RepoManager::Impl::buildCache( const std::list<RepoInfo> & infos, CacheBuildPolicy policy, const ProgressData::ReceiverFnc & progressrcv )
+  {
+    ProgressData progress( infos.size() );
+    callback::SendReport<ProgressReport> report;
+    progress.sendTo( ProgressReportAdaptor( progressrcv, report ) );
+    progress.name( _("Building repository caches") );
+    progress.toMin();
+
+    RepoException rexception( _("Failed to cache some repositories.") );
+    bool failed = false;
+
+    // Checking, refreshing and cleaning is done here. Parsing the metadata
+    // and writing the solv files does not touch anything shared, so it's
+    // done in parallel. Plaindirs need to be mounted, so they are built here.
+    std::vector<CacheBuild> parallel;
+    for ( const RepoInfo & info : infos )
+    {
+      try
+      {
+        CacheBuild build;
+        if ( prepareBuildCache( info, policy, build ) )
+        {
+          if ( build.type == RepoType::RPMPLAINDIR || infos.size() == 1 )
+          {
+            buildSolvFile( build );
+            setCacheStatus( info, build.status );
+          }
+          else
+          {
+            parallel.push_back( build );
+            continue;
+          }
+        }
+      }
+      catch ( const Exception & excpt )
+      {
+        ZYPP_CAUGHT( excpt );
+        ERR << "Failed to build cache for " << info.alias() << endl;
+        rexception.remember( excpt );
+        failed = true;
+      }
+      if ( ! progress.incr() )
+        ZYPP_THROW( AbortRequestException() );
+    }
+
+    if ( ! parallel.empty() )
+    {
+      unsigned size = std::min( thread::WorkerPool::defaultSize(), unsigned(parallel.size()) );
+      MIL << "Building " << parallel.size() << " caches in parallel (" << size << " threads)." << endl;
+
+      std::vector<std::string> errors( parallel.size() );
+      unsigned base = progress.val();
+      unsigned done = 0;
+      thread::Mutex mutex;
+      {
+        thread::WorkerPool pool( size );
+        for ( unsigned i = 0; i < parallel.size(); ++i )
+        {
+          pool.schedule( [&,i]() {
+            try
+            {
+              buildSolvFile( parallel[i] );
+            }
+            catch ( const Exception & excpt )
+            {
+              ZYPP_CAUGHT( excpt );
+              errors[i] = excpt.asUserHistory();
+            }
+            thread::MutexLock lock( mutex );
+            ++done;
+          } );
+        }
+
+        while ( ! pool.waitFor( 100 ) )
+        {
+          thread::MutexLock lock( mutex );
+          progress.set( base + done );
+        }
+      }
+
+      for ( unsigned i = 0; i < parallel.size(); ++i )
+      {
+        if ( errors[i].empty() )
+        {
+          setCacheStatus( parallel[i].info, parallel[i].status );
+        }
+        else
+        {
+          ERR << "Failed to build cache for " << parallel[i].info.alias() << endl;
+          rexception.remember( errors[i] );
+          failed = true;
+        }
+      }
+      if ( ! progress.set( base + parallel.size() ) )
+        ZYPP_THROW( AbortRequestException() );
+    }
+
+    if ( failed )
+    {
+      ZYPP_THROW( rexception );
+    }
+    progress.toMax();
+  }
+
   ////////////////////////////////////////////////////////////////////////////
 
   repo::RepoType RepoManager::Impl::probe( const Url & url, const Pathname & path  ) const
@@ -1372,6 +2232,67 @@ namespace zypp
   ////////////////////////////////////////////////////////////////////////////
 
   void RepoManager::Impl::loadFromCache( const RepoInfo & info, const ProgressData::ReceiverFnc & progressrcv )
+  { loadSolvFile( info, progressrcv ); }
+
+  void RepoManager::Impl::loadFromCache( const std::list<RepoInfo> & infos, const ProgressData::ReceiverFnc & progressrcv )
+  {
+    ProgressData progress( infos.size() );
+    callback::SendReport<ProgressReport> report;
+    progress.sendTo( ProgressReportAdaptor( progressrcv, report ) );
+    progress.name( _("Loading repository caches") );
+    progress.toMin();
+
+    RepoException rexception( _("Failed to load some repositories.") );
+    bool failed = false;
+
+    std::vector<RepoInfo> repos( infos.begin(), infos.end() );
+    std::vector<Pathname> files( repos.size() );
+    for ( unsigned i = 0; i < repos.size(); ++i )
+    {
+      if ( ! repos[i].alias().empty() )	// else loadSolvFile throws
+        files[i] = solv_path_for_repoinfo( _options, repos[i] ) / "solv";
+    }
+
+    // Reading the solv files into the page cache does not touch the pool, so it's
+    // done in parallel and one window ahead of adding them to the pool (which is
+    // serialized).
+    unsigned window = std::max( 1U, std::min( thread::WorkerPool::defaultSize(), unsigned(repos.size()) ) );
+    thread::WorkerPool pool( window );
+    auto readAhead = [&]( unsigned begin_r ) {
+      for ( unsigned i = begin_r; i < std::min( begin_r + window, unsigned(repos.size()) ); ++i )
+        pool.schedule( [&files,i]() { readAheadSolvFile( files[i] ); } );
+    };
+
+    readAhead( 0 );
+    for ( unsigned begin = 0; begin < repos.size(); begin += window )
+    {
+      pool.wait();
+      readAhead( begin + window );
+      for ( unsigned i = begin; i < std::min( begin + window, unsigned(repos.size()) ); ++i )
+      {
+        try
+        {
+          loadSolvFile( repos[i], progressrcv );
+        }
+        catch ( const Exception & excpt )
+        {
+          ZYPP_CAUGHT( excpt );
+          ERR << "Failed to load " << repos[i].alias() << endl;
+          rexception.remember( excpt );
+          failed = true;
+        }
+        if ( ! progress.incr() )
+          ZYPP_THROW( AbortRequestException() );
+      }
+    }
+
+    if ( failed )
+    {
+      ZYPP_THROW( rexception );
+    }
+  }
+
+  void RepoManager::Impl::loadSolvFile( const RepoInfo & info, const ProgressData::ReceiverFnc & progressrcv )
   {
     assert_alias(info);
     Pathname solvfile = solv_path_for_repoinfo(_options, info) / "solv";
@@ -1397,6 +2318,7 @@ namespace zypp
         ZYPP_THROW(Exception("Solv-file was created by old parser."));
       }
       // else: up-to-date (or even newer).
+      sat::Pool::instance().setSolvFileCache( repo, solvfile );
     }
     catch ( const Exception & exp )
     {
@@ -1405,7 +2327,8 @@ namespace zypp
       cleanCache( info, progressrcv );
       buildCache( info, BuildIfNeeded, progressrcv );
 
-      sat::Pool::instance().addRepoSolv( solvfile, info );
+      Repository repo = sat::Pool::instance().addRepoSolv( solvfile, info );
+      sat::Pool::instance().setSolvFileCache( repo, solvfile );
     }
   }
 
@@ -2220,6 +3143,9 @@ namespace zypp
   void RepoManager::refreshMetadata( const RepoInfo &info, RawMetadataRefreshPolicy policy, const ProgressData::ReceiverFnc & progressrcv )
   { return _pimpl->refreshMetadata( info, policy, progressrcv ); }
 
+  void RepoManager::refreshMetadata( const std::list<RepoInfo> & infos, RawMetadataRefreshPolicy policy, const ProgressData::ReceiverFnc & progressrcv )
+  { return _pimpl->refreshMetadata( infos, policy, progressrcv ); }
+
   void RepoManager::cleanMetadata( const RepoInfo &info, const ProgressData::ReceiverFnc & progressrcv )
   { return _pimpl->cleanMetadata( info, progressrcv ); }
 
@@ -2232,6 +3158,9 @@ namespace zypp
   void RepoManager::buildCache( const RepoInfo &info, CacheBuildPolicy policy, const ProgressData::ReceiverFnc & progressrcv )
   { return _pimpl->buildCache( info, policy, progressrcv ); }
 
+  void RepoManager::buildCache( const std::list<RepoInfo> & infos, CacheBuildPolicy policy, const ProgressData::ReceiverFnc & progressrcv )
+  { return _pimpl->buildCache( infos, policy, progressrcv ); }
+
   void RepoManager::cleanCache( const RepoInfo &info, const ProgressData::ReceiverFnc & progressrcv )
   { return _pimpl->cleanCache( info, progressrcv ); }
 
@@ -2241,6 +3170,9 @@ namespace zypp
   void RepoManager::loadFromCache( const RepoInfo &info, const ProgressData::ReceiverFnc & progressrcv )
   { return _pimpl->loadFromCache( info, progressrcv ); }
 
+  void RepoManager::loadFromCache( const std::list<RepoInfo> & infos, const ProgressData::ReceiverFnc & progressrcv )
+  { return _pimpl->loadFromCache( infos, progressrcv ); }
+
   void RepoManager::cleanCacheDirGarbage( const ProgressData::ReceiverFnc & progressrcv )
   { return _pimpl->cleanCacheDirGarbage( progressrcv ); }
 
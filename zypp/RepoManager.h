@@ -296,6 +296,33 @@ namespace zypp
                          RawMetadataRefreshPolicy policy = RefreshIfNeeded,
                          const ProgressData::ReceiverFnc & progressrcv = ProgressData::ReceiverFnc() );
 
+   /**
+    * \short Refresh local raw cache of many repositories
+    *
+    * Like \ref refreshMetadata( const RepoInfo &, RawMetadataRefreshPolicy, const ProgressData::ReceiverFnc & ),
+    * but rpm-md repositories are refreshed in parallel. Up to
+    * \ref ZConfig::repo_refresh_parallel repositories are refreshed at the
+    * same time, but no more than \ref ZConfig::repo_refresh_parallel_host
+    * from the same host. Each repository still replaces its raw cache
+    * atomically, once all of its metadata are downloaded.
+    *
+    * Parallel refreshs do not send any callbacks but the overall progress.
+    * Repositories which need interaction (authentication, importing keys,
+    * ...) are refreshed one after another afterwards, as are those failing
+    * in the first place.
+    *
+    * Repositories that still fail do not stop refreshing the others.
+    *
+    * \throws repo::RepoNoUrlException if no urls are available.
+    * \throws repo::RepoNoAliasException if can't figure an alias
+    * \throws AbortRequestException if the user aborted via \a progressrcv
+    * \throws repo::RepoException if some repositories failed to refresh.
+    *         The exception remembers the failures.
+    */
+   void refreshMetadata( const std::list<RepoInfo> & infos,
+                         RawMetadataRefreshPolicy policy = RefreshIfNeeded,
+                         const ProgressData::ReceiverFnc & progressrcv = ProgressData::ReceiverFnc() );
+
    /**
     * \short Clean local metadata
     *
@@ -345,6 +372,21 @@ namespace zypp
                     CacheBuildPolicy policy = BuildIfNeeded,
                     const ProgressData::ReceiverFnc & progressrcv = ProgressData::ReceiverFnc() );
 
+   /**
+    * \short Build the caches of several repositories
+    *
+    * Like \ref buildCache for a single repository, but the solv files
+    * are built in parallel. A failing repository does not prevent the
+    * others from being built.
+    *
+    * \throws repo::RepoException remembering the errors of all
+    *     repositories which failed.
+    * \throws AbortRequestException if aborted via \a progressrcv.
+    */
+   void buildCache( const std::list<RepoInfo> & infos,
+                    CacheBuildPolicy policy = BuildIfNeeded,
+                    const ProgressData::ReceiverFnc & progressrcv = ProgressData::ReceiverFnc() );
+
    /**
     * \short clean local cache
     *
@@ -380,6 +422,21 @@ namespace zypp
    void loadFromCache( const RepoInfo &info,
                        const ProgressData::ReceiverFnc & progressrcv = ProgressData::ReceiverFnc() );
 
+   /**
+    * \short Load the resolvables of several repositories into the pool
+    *
+    * Like \ref loadFromCache for a single repository, but the solv files
+    * are read ahead in parallel. Adding them to the pool is still done one
+    * by one, in the order given. A failing repository does not prevent the
+    * others from being loaded.
+    *
+    * \throws repo::RepoException remembering the errors of all
+    *     repositories which failed.
+    * \throws AbortRequestException if aborted via \a progressrcv.
+    */
+   void loadFromCache( const std::list<RepoInfo> & infos,
+                       const ProgressData::ReceiverFnc & progressrcv = ProgressData::ReceiverFnc() );
+
    /**
     * Remove any subdirectories of cache directories which no longer belong
     * to any of known repositories.
@@ -129,6 +129,47 @@ namespace zypp
       }
     }
 
+    Impl( const Impl & old_r, const pool::PoolTraits::Id2ItemKeys & changed_r, const pool::PoolImpl & poolImpl_r )
+    : _pool( old_r._pool )
+    , _selPool( old_r._selPool )
+    , _selIndex( old_r._selIndex )
+    {
+      // drop the Selectables of changed idents...
+      std::tr1::unordered_set<const ui::Selectable *> dropped;
+      for_( it, changed_r.begin(), changed_r.end() )
+      {
+        SelectableIndex::iterator sel( _selIndex.find( *it ) );
+        if ( sel != _selIndex.end() )
+        {
+          dropped.insert( sel->second.get() );
+          _selIndex.erase( sel );
+        }
+      }
+      if ( ! dropped.empty() )
+      {
+        for ( SelectablePool::iterator it = _selPool.begin(); it != _selPool.end(); )
+        {
+          if ( dropped.count( it->second.get() ) )
+            _selPool.erase( it++ );
+          else
+            ++it;
+        }
+      }
+
+      // ...and create them anew from the ident index.
+      const pool::PoolImpl::Id2ItemT & id2item( poolImpl_r.id2item() );
+      for_( it, changed_r.begin(), changed_r.end() )
+      {
+        std::pair<pool::PoolImpl::Id2ItemT::const_iterator,pool::PoolImpl::Id2ItemT::const_iterator> range( id2item.equal_range( *it ) );
+        if ( range.first == range.second )
+          continue; // ident is gone
+        ui::Selectable::Ptr p( makeSelectablePtr( range.first, range.second ) );
+        _selPool.insert( SelectablePool::value_type( p->kind(), p ) );
+        _selIndex[*it] = p;
+      }
+      MIL << "Updated " << changed_r.size() << " of " << _selIndex.size() << " Selectables" << endl;
+    }
+
   public:
     ui::Selectable::Ptr lookup( const pool::ByIdent & ident_r ) const
     {
@@ -258,6 +299,15 @@ namespace zypp
   : _pimpl( new Impl( pool_r, poolImpl_r ) )
   {}
 
+  ///////////////////////////////////////////////////////////////////
+  //
+  //	METHOD NAME : ResPoolProxy::ResPoolProxy
+  //	METHOD TYPE : Ctor
+  //
+  ResPoolProxy::ResPoolProxy( const ResPoolProxy & old_r, const pool::PoolTraits::Id2ItemKeys & changed_r, const pool::PoolImpl & poolImpl_r )
+  : _pimpl( new Impl( *old_r._pimpl, changed_r, poolImpl_r ) )
+  {}
+
   ///////////////////////////////////////////////////////////////////
   //
   //	METHOD NAME : ResPoolProxy::~ResPoolProxy
@@ -215,6 +215,8 @@ namespace zypp
     friend class pool::PoolImpl;
     /** Ctor */
     ResPoolProxy( ResPool pool_r, const pool::PoolImpl & poolImpl_r );
+    /** Ctor updating the Selectables of the changed idents \a changed_r in \a old_r. */
+    ResPoolProxy( const ResPoolProxy & old_r, const pool::PoolTraits::Id2ItemKeys & changed_r, const pool::PoolImpl & poolImpl_r );
     /** Pointer to implementation */
     RW_pointer<Impl> _pimpl;
   };
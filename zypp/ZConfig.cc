@@ -295,6 +295,9 @@ namespace zypp
         , updateMessagesNotify		( "single | /usr/lib/zypp/notify-message -p %p" )
         , repo_add_probe          	( false )
         , repo_refresh_delay      	( 10 )
+        , repo_refresh_parallel		( 4 )
+        , repo_refresh_parallel_host	( 2 )
+        , repo_contentStore_size	( 0 )
         , repoLabelIsAlias              ( false )
         , download_use_deltarpm   	( true )
         , download_use_deltarpm_always  ( false )
@@ -304,12 +307,18 @@ namespace zypp
         , download_max_download_speed	( 0 )
         , download_max_silent_tries	( 5 )
         , download_transfer_timeout	( 180 )
+        , download_connection_idle_timeout( 60 )
+        , download_parallel_min_size	( 0 )
         , commit_downloadMode		( DownloadDefault )
+        , commit_singleTransaction	( false )
+        , commit_downloadAhead		( 0 )
+        , commit_downloadAhead_space	( 500 )
         , solver_onlyRequires		( false )
         , solver_allowVendorChange	( false )
         , solver_cleandepsOnRemove	( false )
         , solver_upgradeTestcasesToKeep	( 2 )
         , solverUpgradeRemoveDroppedPackages( true )
+        , pool_queryIndex		( false )
         , apply_locks_file		( true )
         , pluginsPath			( "/usr/lib/zypp/plugins" )
       {
@@ -391,6 +400,20 @@ namespace zypp
                 {
                   str::strtonum(value, repo_refresh_delay);
                 }
+                else if ( entry == "repo.refresh.parallel" )
+                {
+                  str::strtonum(value, repo_refresh_parallel);
+                  if ( repo_refresh_parallel < 1 )	repo_refresh_parallel = 1;
+                }
+                else if ( entry == "repo.refresh.parallel.host" )
+                {
+                  str::strtonum(value, repo_refresh_parallel_host);
+                  if ( repo_refresh_parallel_host < 1 )	repo_refresh_parallel_host = 1;
+                }
+                else if ( entry == "repo.contentStore.size" )
+                {
+                  str::strtonum(value, repo_contentStore_size);
+                }
                 else if ( entry == "repo.refresh.locales" )
 		{
 		  std::vector<std::string> tmp;
@@ -436,10 +459,33 @@ namespace zypp
 		  if ( download_transfer_timeout < 0 )		download_transfer_timeout = 0;
 		  else if ( download_transfer_timeout > 3600 )	download_transfer_timeout = 3600;
                 }
+                else if ( entry == "download.connection_idle_timeout" )
+                {
+                  str::strtonum(value, download_connection_idle_timeout);
+		  if ( download_connection_idle_timeout < 0 )		download_connection_idle_timeout = 0;
+		  else if ( download_connection_idle_timeout > 3600 )	download_connection_idle_timeout = 3600;
+                }
+                else if ( entry == "download.parallel_min_size" )
+                {
+                  str::strtonum(value, download_parallel_min_size);
+		  if ( download_parallel_min_size < 0 )	download_parallel_min_size = 0;
+                }
                 else if ( entry == "commit.downloadMode" )
                 {
                   commit_downloadMode.set( deserializeDownloadMode( value ) );
                 }
+                else if ( entry == "commit.singleTransaction" )
+                {
+                  commit_singleTransaction.set( str::strToBool( value, commit_singleTransaction ) );
+                }
+                else if ( entry == "commit.downloadAhead" )
+                {
+                  str::strtonum(value, commit_downloadAhead);
+                }
+                else if ( entry == "commit.downloadAhead.space" )
+                {
+                  str::strtonum(value, commit_downloadAhead_space);
+                }
                 else if ( entry == "vendordir" )
                 {
                   cfg_vendor_path = Pathname(value);
@@ -472,6 +518,10 @@ namespace zypp
                 {
                   solver_checkSystemFile = Pathname(value);
                 }
+                else if ( entry == "pool.queryIndex" )
+                {
+                  pool_queryIndex.restoreToDefault( str::strToBool( value, pool_queryIndex.getDefault() ) );
+                }
                 else if ( entry == "multiversion" )
                 {
                   str::split( value, inserter( _multiversion, _multiversion.end() ), ", \t" );
@@ -570,6 +620,9 @@ namespace zypp
 
     bool	repo_add_probe;
     unsigned	repo_refresh_delay;
+    unsigned	repo_refresh_parallel;
+    unsigned	repo_refresh_parallel_host;
+    unsigned	repo_contentStore_size;
     LocaleSet	repoRefreshLocales;
     bool	repoLabelIsAlias;
 
@@ -582,8 +635,13 @@ namespace zypp
     int download_max_download_speed;
     int download_max_silent_tries;
     int download_transfer_timeout;
+    int download_connection_idle_timeout;
+    long download_parallel_min_size;
 
     Option<DownloadMode> commit_downloadMode;
+    Option<bool>	commit_singleTransaction;
+    unsigned		commit_downloadAhead;
+    unsigned		commit_downloadAhead_space;
 
     Option<bool>	solver_onlyRequires;
     Option<bool>	solver_allowVendorChange;
@@ -593,6 +651,8 @@ namespace zypp
 
     Pathname solver_checkSystemFile;
 
+    DefaultOption<bool> pool_queryIndex;
+
     std::set<std::string> &		multiversion()		{ return getMultiversion(); }
     const std::set<std::string> &	multiversion() const	{ return getMultiversion(); }
 
@@ -824,6 +884,15 @@ namespace zypp
   unsigned ZConfig::repo_refresh_delay() const
   { return _pimpl->repo_refresh_delay; }
 
+  unsigned ZConfig::repo_refresh_parallel() const
+  { return _pimpl->repo_refresh_parallel; }
+
+  unsigned ZConfig::repo_refresh_parallel_host() const
+  { return _pimpl->repo_refresh_parallel_host; }
+
+  unsigned ZConfig::repo_contentStore_size() const
+  { return _pimpl->repo_contentStore_size; }
+
   LocaleSet ZConfig::repoRefreshLocales() const
   { return _pimpl->repoRefreshLocales.empty() ? Target::requestedLocales("") :_pimpl->repoRefreshLocales; }
 
@@ -863,9 +932,24 @@ namespace zypp
   long ZConfig::download_transfer_timeout() const
   { return _pimpl->download_transfer_timeout; }
 
+  long ZConfig::download_connection_idle_timeout() const
+  { return _pimpl->download_connection_idle_timeout; }
+
+  long ZConfig::download_parallel_min_size() const
+  { return _pimpl->download_parallel_min_size; }
+
   DownloadMode ZConfig::commit_downloadMode() const
   { return _pimpl->commit_downloadMode; }
 
+  bool ZConfig::commit_singleTransaction() const
+  { return _pimpl->commit_singleTransaction; }
+
+  unsigned ZConfig::commit_downloadAhead() const
+  { return _pimpl->commit_downloadAhead; }
+
+  unsigned ZConfig::commit_downloadAhead_space() const
+  { return _pimpl->commit_downloadAhead_space; }
+
   bool ZConfig::solver_onlyRequires() const
   { return _pimpl->solver_onlyRequires; }
 
@@ -886,6 +970,15 @@ namespace zypp
   void ZConfig::setSolverUpgradeRemoveDroppedPackages( bool val_r )	{ _pimpl->solverUpgradeRemoveDroppedPackages.set( val_r ); }
   void ZConfig::resetSolverUpgradeRemoveDroppedPackages()		{ _pimpl->solverUpgradeRemoveDroppedPackages.restoreToDefault(); }
 
+  bool ZConfig::pool_queryIndex() const
+  { return _pimpl->pool_queryIndex; }
+
+  void ZConfig::set_pool_queryIndex( bool yesno_r )
+  { _pimpl->pool_queryIndex.set( yesno_r ); }
+
+  void ZConfig::set_default_pool_queryIndex()
+  { _pimpl->pool_queryIndex.restoreToDefault(); }
+
   const std::set<std::string> & ZConfig::multiversionSpec() const	{ return _pimpl->multiversion(); }
   void ZConfig::multiversionSpec( std::set<std::string> new_r )		{ _pimpl->multiversion().swap( new_r ); }
   void ZConfig::clearMultiversionSpec()					{ _pimpl->multiversion().clear(); }
@@ -181,6 +181,29 @@ namespace zypp
        */
       unsigned repo_refresh_delay() const;
 
+      /**
+       * Maximum number of repositories refreshed concurrently by
+       * \ref RepoManager::refreshMetadata( const std::list<RepoInfo> &, ... ).
+       * Config option <tt>repo.refresh.parallel (4)</tt>.
+       * A value of \c 1 refreshes the repositories one after another.
+       */
+      unsigned repo_refresh_parallel() const;
+
+      /**
+       * Maximum number of repositories refreshed concurrently from
+       * the same host.
+       * Config option <tt>repo.refresh.parallel.host (2)</tt>.
+       */
+      unsigned repo_refresh_parallel_host() const;
+
+      /**
+       * Size limit of the content addressed package and metadata cache
+       * shared by all repositories (in MB). See \ref repo::ContentStore.
+       * Config option <tt>repo.contentStore.size (0)</tt>.
+       * A value of \c 0 disables the shared cache.
+       */
+      unsigned repo_contentStore_size() const;
+
       /**
        * List of locales for which translated package descriptions should be downloaded.
        */
@@ -228,6 +251,19 @@ namespace zypp
        */
       long download_transfer_timeout() const;
 
+      /**
+       * Time in seconds an idle connection is kept open for reuse.
+       * \see \ref media::CurlHandlePool
+       */
+      long download_connection_idle_timeout() const;
+
+      /**
+       * Minimum size in MB of a file downloaded from a plain http server
+       * in ranges on several connections (\c 0 disables it).
+       * \see \ref media::MediaMultiCurl
+       */
+      long download_parallel_min_size() const;
+
 
       /** Whether to consider using a deltarpm when downloading a package.
        * Config option <tt>download.use_deltarpm (true)</tt>
@@ -262,6 +298,25 @@ namespace zypp
        */
       DownloadMode commit_downloadMode() const;
 
+      /**
+       * Whether commit installs and removes all packages in a single
+       * rpm transaction, rather than running rpm once per package.
+       */
+      bool commit_singleTransaction() const;
+
+      /**
+       * Number of packages downloaded ahead, while rpm installs the
+       * current one. Config option <tt>commit.downloadAhead (0)</tt>.
+       * A value of \c 0 disables downloading ahead.
+       */
+      unsigned commit_downloadAhead() const;
+
+      /**
+       * Maximum disk space in MB used by packages downloaded ahead.
+       * Config option <tt>commit.downloadAhead.space (500)</tt>.
+       */
+      unsigned commit_downloadAhead_space() const;
+
       /**
        * Directory for equivalent vendor definitions  (configPath()/vendors.d)
        * \ingroup g_ZC_CONFIGFILES
@@ -317,6 +372,21 @@ namespace zypp
       /** Reset \ref solverUpgradeRemoveDroppedPackages to the \c zypp.conf default. */
       void resetSolverUpgradeRemoveDroppedPackages();
 
+      /**
+       * Whether \ref PoolQuery uses a \ref sat::QueryIndex to preselect the
+       * solvables to look at when searching in name, summary or provides.
+       * Config option <tt>pool.queryIndex (false)</tt>.
+       */
+      bool pool_queryIndex() const;
+      /**
+       * Set \ref pool_queryIndex to a specific value.
+       */
+      void set_pool_queryIndex( bool yesno_r );
+      /**
+       * Set \ref pool_queryIndex to the configfiles default.
+       */
+      void set_default_pool_queryIndex();
+
       /** \name Packages which can be installed in different versions at the same time.
        * This returns the config file values (\c names or \c provides:...). For the corresponding
        * packages use e.g \ref sat::Pool::multiversionBegin, or \ref sat::Solbale::multiversionInstall
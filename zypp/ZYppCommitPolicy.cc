@@ -36,6 +36,7 @@ namespace zypp
       , _downloadMode		( ZConfig::instance().commit_downloadMode() )
       , _rpmInstFlags		( ZConfig::instance().rpmInstallFlags() )
       , _syncPoolAfterCommit	( true )
+      , _singleTransaction	( ZConfig::instance().commit_singleTransaction() )
       {}
 
     public:
@@ -44,6 +45,7 @@ namespace zypp
       DownloadMode		_downloadMode;
       target::rpm::RpmInstFlags	_rpmInstFlags;
       bool			_syncPoolAfterCommit;
+      bool			_singleTransaction;
 
     private:
       friend Impl * rwcowClone<Impl>( const Impl * rhs );
@@ -109,6 +111,13 @@ namespace zypp
   { return _pimpl->_syncPoolAfterCommit; }
 
 
+  ZYppCommitPolicy & ZYppCommitPolicy::singleTransaction( bool yesNo_r )
+  { _pimpl->_singleTransaction = yesNo_r; return *this; }
+
+  bool ZYppCommitPolicy::singleTransaction() const
+  { return _pimpl->_singleTransaction; }
+
+
   std::ostream & operator<<( std::ostream & str, const ZYppCommitPolicy & obj )
   {
     str << "CommitPolicy(";
@@ -119,6 +128,8 @@ namespace zypp
     str << " " << obj.downloadMode();
     if ( obj.syncPoolAfterCommit() )
       str << " syncPoolAfterCommit";
+    if ( obj.singleTransaction() )
+      str << " singleTransaction";
     if ( obj.rpmInstFlags() )
       str << " rpmInstFlags{" << str::hexstring(obj.rpmInstFlags()) << "}";
     return str << " )";
@@ -90,6 +90,14 @@ namespace zypp
 
       bool syncPoolAfterCommit() const;
 
+
+      /** Install and remove all packages in a single rpm transaction
+       * (default: \ref ZConfig::commit_singleTransaction)
+       */
+      ZYppCommitPolicy & singleTransaction( bool yesNo_r );
+
+      bool singleTransaction() const;
+
     public:
       /** Implementation  */
       class Impl;
@@ -12,6 +12,7 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <thread>
 
 #include "zypp/base/Logger.h"
 #include "zypp/base/LogControl.h"
@@ -19,6 +20,8 @@
 #include "zypp/base/String.h"
 #include "zypp/Date.h"
 #include "zypp/PathInfo.h"
+#include "zypp/thread/Mutex.h"
+#include "zypp/thread/MutexLock.h"
 
 using std::endl;
 
@@ -222,6 +225,9 @@ namespace zypp
        *        _no_stream as logstream to the application, and avoid unnecessary formating
        *        of logliles, which would then be discarded when passed to some dummy
        *        LineWriter.
+       *
+       * \note Logging is thread safe. Each thread uses it's own set of
+       * \ref Loglinestream, and writing out a finished line is serialized.
       */
       struct LogControlImpl
       {
@@ -234,14 +240,21 @@ namespace zypp
 
         /** NULL _lineWriter indicates no loggin. */
         void setLineWriter( const shared_ptr<LogControl::LineWriter> & writer_r )
-        { _lineWriter = writer_r; }
+        {
+          thread::MutexLock lock( _mutex );
+          _lineWriter = writer_r;
+        }
 
         shared_ptr<LogControl::LineWriter> getLineWriter() const
-        { return _lineWriter; }
+        {
+          thread::MutexLock lock( _mutex );
+          return _lineWriter;
+        }
 
         /** Assert \a _lineFormater is not NULL. */
         void setLineFormater( const shared_ptr<LogControl::LineFormater> & format_r )
         {
+          thread::MutexLock lock( _mutex );
           if ( format_r )
             _lineFormater = format_r;
           else
@@ -265,6 +278,11 @@ namespace zypp
         shared_ptr<LogControl::LineFormater> _lineFormater;
         shared_ptr<LogControl::LineWriter>   _lineWriter;
 
+        /** Serialize access to \c _lineFormater and \c _lineWriter. */
+        mutable thread::Mutex _mutex;
+        /** The thread which created the singleton uses \c _streamtable. */
+        std::thread::id       _mainThread;
+
       public:
         /** Provide the log stream to write (logger interface) */
         std::ostream & getStream( const std::string & group_r,
@@ -278,11 +296,12 @@ namespace zypp
           if ( level_r == E_XXX && !_excessive )
             return _no_stream;
 
-          if ( !_streamtable[group_r][level_r] )
+          StreamPtr & stream( streamTable()[group_r][level_r] );
+          if ( !stream )
             {
-              _streamtable[group_r][level_r].reset( new Loglinestream( group_r, level_r ) );
+              stream.reset( new Loglinestream( group_r, level_r ) );
             }
-          return _streamtable[group_r][level_r]->getStream( file_r, func_r, line_r );
+          return stream->getStream( file_r, func_r, line_r );
         }
 
         /** Format and write out a logline from Loglinebuf. */
@@ -293,6 +312,7 @@ namespace zypp
                         int                 line_r,
                         const std::string & message_r )
         {
+          thread::MutexLock lock( _mutex );
           if ( _lineWriter )
             _lineWriter->writeOut( _lineFormater->format( group_r, level_r,
                                                           file_r, func_r, line_r,
@@ -306,6 +326,18 @@ namespace zypp
         /** one streambuffer per group and level */
         StreamTable _streamtable;
 
+        /** The calling threads \ref StreamTable.
+         * Threads other than \c _mainThread use a thread local
+         * table, so they never share a \ref Loglinebuf.
+         */
+        StreamTable & streamTable()
+        {
+          if ( std::this_thread::get_id() == _mainThread )
+            return _streamtable;
+          static thread_local StreamTable _threadStreamtable;
+          return _threadStreamtable;
+        }
+
       private:
         /** Singleton ctor.
          * No logging per default, unless enabled via $ZYPP_LOGFILE.
@@ -314,6 +346,7 @@ namespace zypp
         : _no_stream( NULL )
         , _excessive( getenv("ZYPP_FULLLOG") )
         , _lineFormater( new LogControl::LineFormater )
+        , _mainThread( std::this_thread::get_id() )
         {
           if ( getenv("ZYPP_LOGFILE") )
             logfile( getenv("ZYPP_LOGFILE") );
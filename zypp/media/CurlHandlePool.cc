@@ -0,0 +1,277 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file zypp/media/CurlHandlePool.cc
+ *
+*/
+#include <ctime>
+#include <iostream>
+#include <map>
+#include <list>
+#include <mutex>
+
+#include "zypp/base/Logger.h"
+#include "zypp/ZConfig.h"
+#include "zypp/media/CurlHandlePool.h"
+
+#undef CURLVERSION_AT_LEAST
+#define CURLVERSION_AT_LEAST(M,N,O) LIBCURL_VERSION_NUM >= ((((M)<<8)+(N))<<8)+(O)
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+  namespace media
+  { ///////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class CurlHandlePool::Impl
+    /// \brief CurlHandlePool implementation.
+    ///////////////////////////////////////////////////////////////////
+    class CurlHandlePool::Impl : private base::NonCopyable
+    {
+      /** An idle handle. */
+      struct Idle
+      {
+        Idle( CURL * easy_r, time_t since_r )
+        : easy( easy_r ), since( since_r )
+        {}
+        CURL * easy;
+        time_t since;
+      };
+      typedef std::map<std::string, std::list<Idle> > IdleMap;
+
+    public:
+      Impl()
+      : _share( curl_share_init() )
+      {
+        if ( _share )
+        {
+          curl_share_setopt( _share, CURLSHOPT_LOCKFUNC, &Impl::lockShare );
+          curl_share_setopt( _share, CURLSHOPT_UNLOCKFUNC, &Impl::unlockShare );
+          curl_share_setopt( _share, CURLSHOPT_USERDATA, this );
+          curl_share_setopt( _share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS );
+          curl_share_setopt( _share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION );
+#if CURLVERSION_AT_LEAST(7,57,0)
+          curl_share_setopt( _share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT );
+#endif
+        }
+        else
+          WAR << "curl_share_init failed" << endl;
+      }
+
+      ~Impl()
+      {
+        clear();
+        if ( _share )
+          curl_share_cleanup( _share );
+      }
+
+    public:
+      CURL * get( const std::string & key_r )
+      {
+        std::unique_lock<std::mutex> lock( _mutex );
+        expire( time( 0 ) );
+
+        IdleMap::iterator it( _idle.find( key_r ) );
+        if ( it != _idle.end() && ! it->second.empty() )
+        {
+          // most recently used first
+          CURL * ret = it->second.back().easy;
+          it->second.pop_back();
+          if ( it->second.empty() )
+            _idle.erase( it );
+          ++_stats.reused;
+          return ret;
+        }
+
+        CURL * ret = curl_easy_init();
+        if ( ret )
+        {
+          if ( _share )
+            curl_easy_setopt( ret, CURLOPT_SHARE, _share );
+          ++_stats.created;
+        }
+        return ret;
+      }
+
+      void put( const std::string & key_r, CURL * easy_r )
+      {
+        if ( ! easy_r )
+          return;
+
+#if CURLVERSION_AT_LEAST(7,17,1)
+        // Write the cookie jar as curl_easy_cleanup would, and forget the
+        // cookies, so they don't leak into the next user of the handle.
+        curl_easy_setopt( easy_r, CURLOPT_COOKIELIST, "FLUSH" );
+        curl_easy_setopt( easy_r, CURLOPT_COOKIELIST, "ALL" );
+        // Drop options pointing to the former users data.
+        curl_easy_reset( easy_r );
+
+        time_t now = time( 0 );
+        long timeout = ZConfig::instance().download_connection_idle_timeout();
+        long maxidle = ZConfig::instance().download_max_concurrent_connections();
+
+        std::unique_lock<std::mutex> lock( _mutex );
+        expire( now );
+        if ( timeout > 0 )
+        {
+          std::list<Idle> & idle( _idle[key_r] );
+          if ( long(idle.size()) < maxidle )
+          {
+            idle.push_back( Idle( easy_r, now ) );
+            return;
+          }
+        }
+        ++_stats.dropped;
+#else
+        std::unique_lock<std::mutex> lock( _mutex );
+        ++_stats.dropped;
+#endif
+        curl_easy_cleanup( easy_r );
+      }
+
+      void clear()
+      {
+        std::unique_lock<std::mutex> lock( _mutex );
+        for_( it, _idle.begin(), _idle.end() )
+        {
+          for_( h, it->second.begin(), it->second.end() )
+            curl_easy_cleanup( h->easy );
+        }
+        _idle.clear();
+      }
+
+      unsigned idle() const
+      {
+        std::unique_lock<std::mutex> lock( _mutex );
+        unsigned ret = 0;
+        for_( it, _idle.begin(), _idle.end() )
+          ret += it->second.size();
+        return ret;
+      }
+
+      Stats stats() const
+      {
+        std::unique_lock<std::mutex> lock( _mutex );
+        return _stats;
+      }
+
+    private:
+      /** Cleanup handles idle for too long (lock must be held). */
+      void expire( time_t now_r )
+      {
+        long timeout = ZConfig::instance().download_connection_idle_timeout();
+        for ( IdleMap::iterator it = _idle.begin(); it != _idle.end(); )
+        {
+          std::list<Idle> & idle( it->second );
+          // oldest first
+          while ( ! idle.empty() && now_r - idle.front().since >= timeout )
+          {
+            curl_easy_cleanup( idle.front().easy );
+            idle.pop_front();
+            ++_stats.expired;
+          }
+          if ( idle.empty() )
+            _idle.erase( it++ );
+          else
+            ++it;
+        }
+      }
+
+      static void lockShare( CURL *, curl_lock_data data_r, curl_lock_access, void * userp_r )
+      { static_cast<Impl*>(userp_r)->_shareLocks[data_r].lock(); }
+
+      static void unlockShare( CURL *, curl_lock_data data_r, void * userp_r )
+      { static_cast<Impl*>(userp_r)->_shareLocks[data_r].unlock(); }
+
+    private:
+      CURLSH *		_share;
+      std::mutex	_shareLocks[CURL_LOCK_DATA_LAST];
+      IdleMap		_idle;
+      Stats		_stats;
+      mutable std::mutex	_mutex;
+    };
+    ///////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	CLASS NAME : CurlHandlePool
+    //
+    ///////////////////////////////////////////////////////////////////
+
+    CurlHandlePool & CurlHandlePool::instance()
+    {
+      static CurlHandlePool _instance;
+      return _instance;
+    }
+
+    std::string CurlHandlePool::key( const Url & url_r )
+    {
+      std::string ret( url_r.getScheme() );
+      ret += "://";
+      ret += url_r.getUsername();
+      ret += "@";
+      ret += url_r.getHost();
+      ret += ":";
+      ret += url_r.getPort();
+      // explicit proxy settings (the system proxy depends on the rest of the key)
+      std::string proxy( url_r.getQueryParam( "proxy" ) );
+      if ( ! proxy.empty() )
+      {
+        ret += "|";
+        ret += url_r.getQueryParam( "proxyuser" );
+        ret += "@";
+        ret += proxy;
+        ret += ":";
+        ret += url_r.getQueryParam( "proxyport" );
+      }
+      return ret;
+    }
+
+    CurlHandlePool::CurlHandlePool()
+    : _pimpl( new Impl )
+    {}
+
+    CurlHandlePool::~CurlHandlePool()
+    {}
+
+    CURL * CurlHandlePool::get( const std::string & key_r )
+    { return _pimpl->get( key_r ); }
+
+    void CurlHandlePool::put( const std::string & key_r, CURL * easy_r )
+    { _pimpl->put( key_r, easy_r ); }
+
+    void CurlHandlePool::clear()
+    { _pimpl->clear(); }
+
+    unsigned CurlHandlePool::idle() const
+    { return _pimpl->idle(); }
+
+    CurlHandlePool::Stats CurlHandlePool::stats() const
+    { return _pimpl->stats(); }
+
+    std::ostream & operator<<( std::ostream & str, const CurlHandlePool::Stats & obj )
+    {
+      return str << "created " << obj.created
+                 << ", reused " << obj.reused
+                 << ", expired " << obj.expired
+                 << ", dropped " << obj.dropped;
+    }
+
+    std::ostream & operator<<( std::ostream & str, const CurlHandlePool & obj )
+    {
+      return str << "CurlHandlePool(" << obj.idle() << " idle; " << obj.stats() << ")";
+    }
+
+    ///////////////////////////////////////////////////////////////
+  } // namespace media
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,113 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file zypp/media/CurlHandlePool.h
+ *
+*/
+#ifndef ZYPP_MEDIA_CURLHANDLEPOOL_H
+#define ZYPP_MEDIA_CURLHANDLEPOOL_H
+
+#include <iosfwd>
+#include <string>
+#include <curl/curl.h>
+
+#include "zypp/base/NonCopyable.h"
+#include "zypp/base/PtrTypes.h"
+#include "zypp/Url.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+  namespace media
+  { ///////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class CurlHandlePool
+    /// \brief Process wide pool of idle curl easy handles.
+    ///
+    /// An easy handle keeps its connections open after a transfer. Instead
+    /// of cleaning up the handle when a \ref MediaCurl is released, it is
+    /// returned to the pool, so the next media handler talking to the same
+    /// server reuses the open connection (no new TCP and TLS handshake).
+    ///
+    /// Handles are pooled per \ref key (scheme, host, port, user and an
+    /// explicit proxy). At most \ref ZConfig::download_max_concurrent_connections
+    /// handles per key are kept, for at most \ref ZConfig::download_connection_idle_timeout
+    /// seconds. All handles also share the DNS, TLS session and (if supported
+    /// by libcurl) connection caches.
+    ///
+    /// Handles returned by \ref get are reset to the libcurl defaults; the
+    /// caller has to set all options. The pool is thread safe.
+    ///////////////////////////////////////////////////////////////////
+    class CurlHandlePool : private base::NonCopyable
+    {
+      friend std::ostream & operator<<( std::ostream & str, const CurlHandlePool & obj );
+
+    public:
+      /** Pool statistics. */
+      struct Stats
+      {
+        Stats()
+        : created( 0 ), reused( 0 ), expired( 0 ), dropped( 0 )
+        {}
+        unsigned created;	///< handles newly created by \ref get
+        unsigned reused;	///< handles taken from the pool by \ref get
+        unsigned expired;	///< idle handles cleaned up after timeout
+        unsigned dropped;	///< handles cleaned up by \ref put (pool full or disabled)
+      };
+
+    public:
+      /** The process wide pool. */
+      static CurlHandlePool & instance();
+
+      /** The pool key for \a url_r. */
+      static std::string key( const Url & url_r );
+
+    public:
+      /** Get an idle handle for \a key_r or create a new one.
+       * \return \c NULL if a handle can not be created.
+       */
+      CURL * get( const std::string & key_r );
+
+      /** Return a no longer used handle to the pool.
+       * The handle must not be part of a multi handle.
+       */
+      void put( const std::string & key_r, CURL * easy_r );
+
+      /** Cleanup all idle handles. */
+      void clear();
+
+      /** Number of idle handles. */
+      unsigned idle() const;
+
+      /** The statistics. */
+      Stats stats() const;
+
+    public:
+      /** Implementation. */
+      class Impl;
+    private:
+      CurlHandlePool();
+      ~CurlHandlePool();
+      /** Pointer to implementation. */
+      RW_pointer<Impl> _pimpl;
+    };
+    ///////////////////////////////////////////////////////////////////
+
+    /** \relates CurlHandlePool::Stats Stream output */
+    std::ostream & operator<<( std::ostream & str, const CurlHandlePool::Stats & obj );
+
+    /** \relates CurlHandlePool Stream output */
+    std::ostream & operator<<( std::ostream & str, const CurlHandlePool & obj );
+
+    ///////////////////////////////////////////////////////////////
+  } // namespace media
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_MEDIA_CURLHANDLEPOOL_H
@@ -346,6 +346,16 @@ MediaAccess::provideFile( const Pathname & filename ) const
   _handler->provideFile( filename );
 }
 
+bool
+MediaAccess::provideFileIfModified( const Pathname & filename, std::string & validators_r ) const
+{
+  if ( !_handler ) {
+    ZYPP_THROW(MediaNotOpenException("provideFileIfModified(" + filename.asString() + ")"));
+  }
+
+  return _handler->provideFileIfModified( filename, validators_r );
+}
+
 void
 MediaAccess::setDeltafile( const Pathname & filename ) const
 {
@@ -356,6 +366,16 @@ MediaAccess::setDeltafile( const Pathname & filename ) const
   _handler->setDeltafile( filename );
 }
 
+void
+MediaAccess::setChecksumType( const std::string & type ) const
+{
+  if ( !_handler ) {
+    ZYPP_THROW(MediaNotOpenException("setChecksumType(" + type + ")"));
+  }
+
+  _handler->setChecksumType( type );
+}
+
 void
 MediaAccess::releaseFile( const Pathname & filename ) const
 {
@@ -221,6 +221,17 @@ namespace zypp {
 	 **/
 	void provideFile( const Pathname & filename ) const;
 
+	/**
+	 * Like \ref provideFile, but don't provide the file if it did not
+	 * change since it was downloaded with \a validators_r.
+	 *
+	 * \see MediaHandler::provideFileIfModified
+	 * \return \c false if the file did not change and was not provided.
+	 * \throws MediaException
+	 *
+	 **/
+	bool provideFileIfModified( const Pathname & filename, std::string & validators_r ) const;
+
 	/**
 	 * Remove filename below attach point IFF handler downloads files
 	 * to the local filesystem. Never remove anything from media.
@@ -279,6 +290,12 @@ namespace zypp {
 	 */
 	void setDeltafile( const Pathname & filename ) const;
 
+	/**
+	 * set the type of checksum to compute while downloading the next file
+	 * (see \ref filesystem::rememberChecksum)
+	 */
+	void setChecksumType( const std::string & type ) const;
+
     public:
 
 	/**
@@ -25,10 +25,12 @@
 #include "zypp/media/MediaUserAuth.h"
 #include "zypp/media/CredentialManager.h"
 #include "zypp/media/CurlConfig.h"
+#include "zypp/media/CurlHandlePool.h"
 #include "zypp/thread/Once.h"
 #include "zypp/Target.h"
 #include "zypp/ZYppFactory.h"
 #include "zypp/ZConfig.h"
+#include "zypp/Digest.h"
 
 #include <cstdlib>
 #include <sys/types.h>
@@ -149,6 +151,36 @@ namespace
 
     return max;
   }
+
+  /** The validators of a HTTP response. */
+  struct ResponseValidators
+  {
+    std::string etag;
+    std::string lastModified;
+  };
+
+  /** Header callback remembering the \ref ResponseValidators passed as \a stream. */
+  static size_t
+  collect_validators_curl(
+      void *ptr, size_t size, size_t nmemb, void *stream)
+  {
+    ResponseValidators & validators( *(ResponseValidators *)stream );
+    string line( zypp::str::trim( string( (char *)ptr, size * nmemb ) ) );
+    string::size_type sep( line.find( ':' ) );
+
+    if ( zypp::str::hasPrefix( line, "HTTP/" ) )
+      validators = ResponseValidators();	// a new response, e.g. after a redirect
+    else if ( sep != string::npos )
+    {
+      string name( zypp::str::toLower( line.substr( 0, sep ) ) );
+      if ( name == "etag" )
+        validators.etag = zypp::str::trim( line.substr( sep + 1 ) );
+      else if ( name == "last-modified" )
+        validators.lastModified = zypp::str::trim( line.substr( sep + 1 ) );
+    }
+    return log_redirects_curl( ptr, size, nmemb, stream );
+  }
+
 }
 
 namespace zypp {
@@ -193,6 +225,25 @@ namespace zypp {
       zypp::Url                                     url;
     };
 
+    /** Write the downloaded data to \a file and feed it to \a digest. */
+    struct StreamDigest
+    {
+      StreamDigest( FILE *_file )
+        : file(_file)
+      {}
+      FILE   *file;
+      Digest  digest;
+    };
+
+    size_t streamDigestCallback( char *ptr, size_t size, size_t nmemb, void *userdata )
+    {
+      StreamDigest *sd = reinterpret_cast<StreamDigest *>(userdata);
+      size_t ret = ::fwrite( ptr, size, nmemb, sd->file );
+      if ( ret )
+        sd->digest.update( ptr, ret * size );
+      return ret;
+    }
+
     ///////////////////////////////////////////////////////////////////
 
     inline void escape( string & str_r,
@@ -763,7 +814,7 @@ void MediaCurl::attachTo (bool next)
   }
 
   disconnectFrom(); // clean _curl if needed
-  _curl = curl_easy_init();
+  _curl = CurlHandlePool::instance().get( CurlHandlePool::key( _url ) );
   if ( !_curl ) {
     ZYPP_THROW(MediaCurlInitException(_url));
   }
@@ -800,7 +851,8 @@ void MediaCurl::disconnectFrom()
 
   if ( _curl )
   {
-    curl_easy_cleanup( _curl );
+    // keep the connection open for the next one
+    CurlHandlePool::instance().put( CurlHandlePool::key( _url ), _curl );
     _curl = NULL;
   }
 }
@@ -852,6 +904,11 @@ void MediaCurl::getFile( const Pathname & filename ) const
 ///////////////////////////////////////////////////////////////////
 
 void MediaCurl::getFileCopy( const Pathname & filename , const Pathname & target) const
+{
+  getFileCopy( filename, target, OPTION_NONE );
+}
+
+void MediaCurl::getFileCopy( const Pathname & filename , const Pathname & target, RequestOptions options ) const
 {
   callback::SendReport<DownloadProgressReport> report;
 
@@ -863,7 +920,7 @@ void MediaCurl::getFileCopy( const Pathname & filename , const Pathname & target
   {
     try
     {
-      doGetFileCopy(filename, target, report);
+      doGetFileCopy(filename, target, report, options);
       retry = false;
     }
     // retry with proper authentication data
@@ -892,6 +949,64 @@ void MediaCurl::getFileCopy( const Pathname & filename , const Pathname & target
 
 ///////////////////////////////////////////////////////////////////
 
+bool MediaCurl::getFileIfModified( const Pathname & filename, std::string & validators_r ) const
+{
+  if ( _url.getScheme() != "http" && _url.getScheme() != "https" )
+    return MediaHandler::getFileIfModified( filename, validators_r );
+
+  // validators_r is "ETag<TAB>Last-Modified"; a TAB is valid in neither.
+  string::size_type sep( validators_r.find( '\t' ) );
+  string etag( validators_r.substr( 0, sep ) );
+  string lastModified( sep == string::npos ? string() : validators_r.substr( sep + 1 ) );
+
+  curl_slist * headers = 0L;
+  for ( curl_slist * sl = _customHeaders; sl; sl = sl->next )
+    headers = curl_slist_append( headers, sl->data );
+  // Sent as is: the server compares them to its own values.
+  if ( ! etag.empty() )
+    headers = curl_slist_append( headers, ( "If-None-Match: " + etag ).c_str() );
+  if ( ! lastModified.empty() )
+    headers = curl_slist_append( headers, ( "If-Modified-Since: " + lastModified ).c_str() );
+  if ( ! headers )
+    ZYPP_THROW(MediaCurlSetOptException(_url, "Error adding conditional headers"));
+
+  ResponseValidators response;
+  curl_easy_setopt( _curl, CURLOPT_HTTPHEADER, headers );
+  curl_easy_setopt( _curl, CURLOPT_HEADERFUNCTION, collect_validators_curl );
+  curl_easy_setopt( _curl, CURLOPT_HEADERDATA, &response );
+  try
+  {
+    getFileCopy( filename, localPath( filename ).absolutename(), OPTION_NO_IFMODSINCE | OPTION_NO_METALINK );
+  }
+  catch ( const Exception & excpt )
+  {
+    curl_easy_setopt( _curl, CURLOPT_HTTPHEADER, _customHeaders );
+    curl_easy_setopt( _curl, CURLOPT_HEADERFUNCTION, log_redirects_curl );
+    curl_easy_setopt( _curl, CURLOPT_HEADERDATA, (void *)0 );
+    curl_slist_free_all( headers );
+    ZYPP_RETHROW( excpt );
+  }
+  curl_easy_setopt( _curl, CURLOPT_HTTPHEADER, _customHeaders );
+  curl_easy_setopt( _curl, CURLOPT_HEADERFUNCTION, log_redirects_curl );
+  curl_easy_setopt( _curl, CURLOPT_HEADERDATA, (void *)0 );
+  curl_slist_free_all( headers );
+
+  long httpReturnCode = 0;
+  if ( curl_easy_getinfo( _curl, CURLINFO_RESPONSE_CODE, &httpReturnCode ) == CURLE_OK && httpReturnCode == 304 )
+  {
+    DBG << "Not modified: " << getFileUrl( filename ) << endl;
+    return false;
+  }
+
+  if ( response.etag.empty() && response.lastModified.empty() )
+    validators_r.clear();
+  else
+    validators_r = response.etag + '\t' + response.lastModified;
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////
+
 bool MediaCurl::getDoesFileExist( const Pathname & filename ) const
 {
   bool retry = false;
@@ -1347,6 +1462,7 @@ void MediaCurl::doGetFileCopy( const Pathname & filename , const Pathname & targ
         ERR << "Rename failed" << endl;
         ZYPP_THROW(MediaWriteException(dest));
       }
+      rememberStreamChecksum( dest );
     }
     else
     {
@@ -1360,6 +1476,17 @@ void MediaCurl::doGetFileCopy( const Pathname & filename , const Pathname & targ
 
 ///////////////////////////////////////////////////////////////////
 
+void MediaCurl::rememberStreamChecksum( const Pathname & dest ) const
+{
+  if ( ! _streamChecksum.empty() )
+  {
+    filesystem::rememberChecksum( dest, _streamChecksum );
+    _streamChecksum = CheckSum();
+  }
+}
+
+///////////////////////////////////////////////////////////////////
+
 void MediaCurl::doGetFileCopyFile( const Pathname & filename , const Pathname & dest, FILE *file, callback::SendReport<DownloadProgressReport> & report, RequestOptions options ) const
 {
     DBG << filename.asString() << endl;
@@ -1394,7 +1521,27 @@ void MediaCurl::doGetFileCopyFile( const Pathname & filename , const Pathname &
       ZYPP_THROW(MediaCurlSetOptException(url, _curlError));
     }
 
-    ret = curl_easy_setopt( _curl, CURLOPT_WRITEDATA, file );
+    // Compute the checksum the file will be checked against while
+    // it's written. Only if we write the whole file.
+    _streamChecksum = CheckSum();
+    scoped_ptr<StreamDigest> streamDigest;
+    if ( ! checksumType().empty() && ::ftello( file ) == 0 )
+    {
+      streamDigest.reset( new StreamDigest( file ) );
+      if ( ! streamDigest->digest.create( checksumType() ) )
+        streamDigest.reset();
+    }
+
+    if ( streamDigest )
+    {
+      ret = curl_easy_setopt( _curl, CURLOPT_WRITEFUNCTION, &streamDigestCallback );
+      if ( ret == 0 )
+        ret = curl_easy_setopt( _curl, CURLOPT_WRITEDATA, streamDigest.get() );
+      if ( ret != 0 )
+        curl_easy_setopt( _curl, CURLOPT_WRITEFUNCTION, NULL );
+    }
+    else
+      ret = curl_easy_setopt( _curl, CURLOPT_WRITEDATA, file );
     if ( ret != 0 ) {
       ZYPP_THROW(MediaCurlSetOptException(url, _curlError));
     }
@@ -1434,6 +1581,15 @@ void MediaCurl::doGetFileCopyFile( const Pathname & filename , const Pathname &
       WAR << "Can't unset CURLOPT_PROGRESSDATA: " << _curlError << endl;;
     }
 
+    if ( streamDigest )
+    {
+      // back to plain fwrite
+      curl_easy_setopt( _curl, CURLOPT_WRITEFUNCTION, NULL );
+      curl_easy_setopt( _curl, CURLOPT_WRITEDATA, file );
+      if ( ret == 0 )
+        _streamChecksum = CheckSum( checksumType(), streamDigest->digest.digest() );
+    }
+
     if ( ret != 0 )
     {
       ERR << "curl error: " << ret << ": " << _curlError
@@ -44,6 +44,8 @@ class MediaCurl : public MediaHandler
         OPTION_NO_IFMODSINCE = 0x04,
         /** do not send a start ProgressReport */
         OPTION_NO_REPORT_START = 0x08,
+        /** a single plain request (no metalink), using the current headers */
+        OPTION_NO_METALINK = 0x10,
     };
     ZYPP_DECLARE_FLAGS(RequestOptions,RequestOption);
 
@@ -84,6 +86,24 @@ class MediaCurl : public MediaHandler
      */
     virtual void getFileCopy( const Pathname & srcFilename, const Pathname & targetFilename) const;
 
+    /**
+     * Like \ref getFileCopy, passing \a options to \ref doGetFileCopy.
+     *
+     * \throws MediaException
+     *
+     */
+    void getFileCopy( const Pathname & srcFilename, const Pathname & targetFilename, RequestOptions options ) const;
+
+    /**
+     * HTTP conditional request using the ETag and Last-Modified
+     * remembered in \a validators_r.
+     *
+     * \see MediaHandler::getFileIfModified
+     * \throws MediaException
+     *
+     */
+    virtual bool getFileIfModified( const Pathname & filename, std::string & validators_r ) const;
+
     /**
      *
      * \throws MediaException
@@ -150,6 +170,13 @@ class MediaCurl : public MediaHandler
 
     void doGetFileCopyFile( const Pathname & srcFilename, const Pathname & dest, FILE *file, callback::SendReport<DownloadProgressReport> & _report, RequestOptions options = OPTION_NONE ) const;
 
+    /**
+     * Pass the checksum computed by the last \ref doGetFileCopyFile
+     * to \ref filesystem::rememberChecksum. Call it after the file was
+     * moved to \a dest, and only if the file was not changed since.
+     */
+    void rememberStreamChecksum( const Pathname & dest ) const;
+
   private:
     /**
      * Return a comma separated list of available authentication methods
@@ -172,6 +199,8 @@ class MediaCurl : public MediaHandler
     char _curlError[ CURL_ERROR_SIZE ];
     curl_slist *_customHeaders;
     TransferSettings _settings;
+    /** The \ref checksumType of the file downloaded by \ref doGetFileCopyFile. */
+    mutable CheckSum _streamChecksum;
 };
 ZYPP_DECLARE_OPERATORS_FOR_FLAGS(MediaCurl::RequestOptions);
 
@@ -998,6 +998,18 @@ void MediaHandler::provideFile( Pathname filename ) const
   DBG << "provideFile(" << filename << ")" << endl;
 }
 
+bool MediaHandler::provideFileIfModified( Pathname filename, std::string & validators_r ) const
+{
+  if ( !isAttached() ) {
+    INT << "Error: Not attached on provideFileIfModified(" << filename << ")" << endl;
+    ZYPP_THROW(MediaNotAttachedException(url()));
+  }
+
+  bool modified = getFileIfModified( filename, validators_r ); // pass to concrete handler
+  DBG << "provideFileIfModified(" << filename << ") " << (modified ? "modified" : "not modified") << endl;
+  return modified;
+}
+
 
 ///////////////////////////////////////////////////////////////////
 //
@@ -1238,6 +1250,13 @@ void MediaHandler::getFileCopy ( const Pathname & srcFilename, const Pathname &
   }
 }
 
+bool MediaHandler::getFileIfModified( const Pathname & filename, std::string & validators_r ) const
+{
+  getFile( filename );
+  validators_r.clear();
+  return true;
+}
+
 
 
 ///////////////////////////////////////////////////////////////////
@@ -1390,6 +1409,15 @@ Pathname MediaHandler::deltafile() const {
   return _deltafile;
 }
 
+void MediaHandler::setChecksumType( const std::string & type ) const
+{
+  _checksumType = type;
+}
+
+std::string MediaHandler::checksumType() const {
+  return _checksumType;
+}
+
   } // namespace media
 } // namespace zypp
 // vim: set ts=8 sts=2 sw=2 ai noet:
@@ -103,6 +103,9 @@ class MediaHandler {
 	/** file usable for delta downloads */
 	mutable Pathname _deltafile;
 
+	/** checksum to compute while downloading */
+	mutable std::string _checksumType;
+
     protected:
         /**
 	 * Url to handle
@@ -372,6 +375,20 @@ class MediaHandler {
          **/
         virtual void getFileCopy( const Pathname & srcFilename, const Pathname & targetFilename ) const;
 
+        /**
+         * Call concrete handler to provide a file, unless it did not change
+         * since it was downloaded with \a validators_r.
+         * Media must be attached before by callee.
+         *
+         * Default implementation provided that calls getFile(filename)
+         * and clears \a validators_r (no conditional requests).
+         *
+         * \see provideFileIfModified
+         * \throws MediaException
+         *
+         **/
+        virtual bool getFileIfModified( const Pathname & filename, std::string & validators_r ) const;
+
 
 	/**
 	 * Call concrete handler to provide directory content (not recursive!)
@@ -572,6 +589,22 @@ class MediaHandler {
 	 **/
 	void provideFile( Pathname filename ) const;
 
+	/**
+	 * Like \ref provideFile, but don't provide the file if it did not
+	 * change since it was downloaded with \a validators_r (e.g. an HTTP
+	 * conditional request).
+	 *
+	 * \a validators_r is an opaque string returned by a previous call
+	 * (e.g. the HTTP ETag and Last-Modified). If the file is provided, it
+	 * is set to the validators of the new file. Empty if the handler does
+	 * not support conditional requests.
+	 *
+	 * \return \c false if the file did not change and was not provided.
+	 * \throws MediaException
+	 *
+	 **/
+	bool provideFileIfModified( Pathname filename, std::string & validators_r ) const;
+
 	/**
 	 * Call concrete handler to provide a copy of a file under a different place
          * in the file system (usually not under attach point) as a copy.
@@ -649,6 +682,16 @@ class MediaHandler {
 	 */
 	Pathname deltafile () const;
 
+        /*
+         * set the type of checksum to compute while downloading the next file
+         */
+	void setChecksumType( const std::string & type = std::string() ) const;
+
+	/*
+	 * return the checksum type set with setChecksumType()
+	 */
+	std::string checksumType() const;
+
     public:
 
 	/**
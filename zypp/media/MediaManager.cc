@@ -55,18 +55,21 @@ namespace zypp
 
         ManagedMedia()
           : desired (false)
+          , mutex   (new Mutex)
         {}
 
         ManagedMedia(const ManagedMedia &m)
           : desired (m.desired)
           , handler (m.handler)
           , verifier(m.verifier)
+          , mutex   (m.mutex)
         {}
 
         ManagedMedia(const MediaAccessRef &h, const MediaVerifierRef &v)
           : desired (false)
           , handler (h)
           , verifier(v)
+          , mutex   (new Mutex)
         {}
 
         inline void
@@ -116,6 +119,48 @@ namespace zypp
         bool             desired;
         MediaAccessRef   handler;
         MediaVerifierRef verifier;
+        /** Serializes transfers performed by the handler (see \ref HandlerLock). */
+        shared_ptr<Mutex> mutex;
+      };
+
+
+      // -------------------------------------------------------------
+      /**
+       * Use a handler without holding the global \c g_Mutex.
+       *
+       * Transfers may take long. Instead of holding the global
+       * \c g_Mutex, they lock the handlers own mutex. So transfers
+       * using different media access ids may run concurrently.
+       *
+       * The handler and it's mutex must be copied while \c g_Mutex
+       * is held; the handlers mutex is locked after \c g_Mutex was
+       * released:
+       * \code
+       *   ManagedMedia mm;
+       *   {
+       *     MutexLock glock(g_Mutex);
+       *     mm = m_impl->findMM(accessId);
+       *   }
+       *   HandlerLock hlock(mm);
+       *   hlock->provideFile(filename);
+       * \endcode
+       */
+      class HandlerLock
+      {
+      public:
+        explicit HandlerLock(const ManagedMedia &mm)
+          : _handler(mm.handler)
+          , _mutex  (mm.mutex)
+          , _lock   (*_mutex)
+        {}
+
+        MediaAccessRef & operator->()
+        { return _handler; }
+
+      private:
+        MediaAccessRef    _handler;
+        shared_ptr<Mutex> _mutex;
+        MutexLock         _lock;
       };
 
 
@@ -684,13 +729,36 @@ namespace zypp
     MediaManager::provideFile(MediaAccessId   accessId,
                               const Pathname &filename ) const
     {
-      MutexLock glock(g_Mutex);
+      ManagedMedia mm;
+      {
+        MutexLock glock(g_Mutex);
 
-      ManagedMedia &ref( m_impl->findMM(accessId));
+        ManagedMedia &ref( m_impl->findMM(accessId));
 
-      ref.checkDesired(accessId);
+        ref.checkDesired(accessId);
+        mm = ref;
+      }
+      HandlerLock hlock(mm);
+      hlock->provideFile(filename);
+    }
 
-      ref.handler->provideFile(filename);
+    // ---------------------------------------------------------------
+    bool
+    MediaManager::provideFileIfModified(MediaAccessId   accessId,
+                                        const Pathname &filename,
+                                        std::string    &validators_r ) const
+    {
+      ManagedMedia mm;
+      {
+        MutexLock glock(g_Mutex);
+
+        ManagedMedia &ref( m_impl->findMM(accessId));
+
+        ref.checkDesired(accessId);
+        mm = ref;
+      }
+      HandlerLock hlock(mm);
+      return hlock->provideFileIfModified(filename, validators_r);
     }
 
     // ---------------------------------------------------------------
@@ -709,8 +777,8 @@ namespace zypp
 
     // ---------------------------------------------------------------
     void
-    MediaManager::provideDir(MediaAccessId   accessId,
-                             const Pathname &dirname) const
+    MediaManager::setChecksumType(MediaAccessId      accessId,
+                                  const std::string &type ) const
     {
       MutexLock glock(g_Mutex);
 
@@ -718,7 +786,25 @@ namespace zypp
 
       ref.checkDesired(accessId);
 
-      ref.handler->provideDir(dirname);
+      ref.handler->setChecksumType(type);
+    }
+
+    // ---------------------------------------------------------------
+    void
+    MediaManager::provideDir(MediaAccessId   accessId,
+                             const Pathname &dirname) const
+    {
+      ManagedMedia mm;
+      {
+        MutexLock glock(g_Mutex);
+
+        ManagedMedia &ref( m_impl->findMM(accessId));
+
+        ref.checkDesired(accessId);
+        mm = ref;
+      }
+      HandlerLock hlock(mm);
+      hlock->provideDir(dirname);
     }
 
     // ---------------------------------------------------------------
@@ -726,13 +812,17 @@ namespace zypp
     MediaManager::provideDirTree(MediaAccessId   accessId,
                                  const Pathname &dirname) const
     {
-      MutexLock glock(g_Mutex);
-
-      ManagedMedia &ref( m_impl->findMM(accessId));
+      ManagedMedia mm;
+      {
+        MutexLock glock(g_Mutex);
 
-      ref.checkDesired(accessId);
+        ManagedMedia &ref( m_impl->findMM(accessId));
 
-      ref.handler->provideDirTree(dirname);
+        ref.checkDesired(accessId);
+        mm = ref;
+      }
+      HandlerLock hlock(mm);
+      hlock->provideDirTree(dirname);
     }
 
     // ---------------------------------------------------------------
@@ -785,14 +875,18 @@ namespace zypp
                           const Pathname         &dirname,
                           bool                    dots) const
     {
-      MutexLock glock(g_Mutex);
-
-      ManagedMedia &ref( m_impl->findMM(accessId));
+      ManagedMedia mm;
+      {
+        MutexLock glock(g_Mutex);
 
-      // FIXME: ref.checkDesired(accessId); ???
-      ref.checkAttached(accessId);
+        ManagedMedia &ref( m_impl->findMM(accessId));
 
-      ref.handler->dirInfo(retlist, dirname, dots);
+        // FIXME: ref.checkDesired(accessId); ???
+        ref.checkAttached(accessId);
+        mm = ref;
+      }
+      HandlerLock hlock(mm);
+      hlock->dirInfo(retlist, dirname, dots);
     }
 
     // ---------------------------------------------------------------
@@ -802,27 +896,35 @@ namespace zypp
                           const Pathname         &dirname,
                           bool                    dots) const
     {
-      MutexLock glock(g_Mutex);
-
-      ManagedMedia &ref( m_impl->findMM(accessId));
+      ManagedMedia mm;
+      {
+        MutexLock glock(g_Mutex);
 
-      // FIXME: ref.checkDesired(accessId); ???
-      ref.checkAttached(accessId);
+        ManagedMedia &ref( m_impl->findMM(accessId));
 
-      ref.handler->dirInfo(retlist, dirname, dots);
+        // FIXME: ref.checkDesired(accessId); ???
+        ref.checkAttached(accessId);
+        mm = ref;
+      }
+      HandlerLock hlock(mm);
+      hlock->dirInfo(retlist, dirname, dots);
     }
 
     // ---------------------------------------------------------------
     bool
     MediaManager::doesFileExist(MediaAccessId  accessId, const Pathname & filename ) const
     {
-      MutexLock glock(g_Mutex);
-      ManagedMedia &ref( m_impl->findMM(accessId));
-
-      // FIXME: ref.checkDesired(accessId); ???
-      ref.checkAttached(accessId);
+      ManagedMedia mm;
+      {
+        MutexLock glock(g_Mutex);
+        ManagedMedia &ref( m_impl->findMM(accessId));
 
-      return ref.handler->doesFileExist(filename);
+        // FIXME: ref.checkDesired(accessId); ???
+        ref.checkAttached(accessId);
+        mm = ref;
+      }
+      HandlerLock hlock(mm);
+      return hlock->doesFileExist(filename);
     }
 
     // ---------------------------------------------------------------
@@ -759,6 +759,29 @@ namespace zypp
       provideFile(MediaAccessId   accessId,
                   const Pathname &filename ) const;
 
+      /**
+       * Provide file denoted by relative path below of the
+       * 'attach point' of the specified media and the path prefix
+       * on the media, unless it did not change since it was downloaded
+       * with \a validators_r (e.g. an HTTP conditional request).
+       *
+       * \a validators_r is an opaque string returned by a previous call
+       * (e.g. the HTTP ETag and Last-Modified). If the file is provided,
+       * it is set to the validators of the new file. Empty if the media
+       * does not support conditional requests.
+       *
+       * \param accessId  The media access id to use.
+       * \param filename  The filename to provide, relative to localRoot().
+       * \param validators_r The validators of the last download.
+       * \return \c false if the file did not change and was not provided.
+       *
+       * \throws MediaException see \ref provideFile.
+       */
+      bool
+      provideFileIfModified(MediaAccessId   accessId,
+                            const Pathname &filename,
+                            std::string    &validators_r ) const;
+
       /**
        * FIXME: see MediaAccess class.
        */
@@ -836,6 +859,15 @@ namespace zypp
       setDeltafile(MediaAccessId   accessId,
                   const Pathname &filename ) const;
 
+      /**
+       * Compute a checksum of \a type while downloading the next file.
+       * The file need not be read again to check it (see
+       * \ref filesystem::rememberChecksum). An empty \a type turns it off.
+       */
+      void
+      setChecksumType(MediaAccessId      accessId,
+                      const std::string &type ) const;
+
     public:
       /**
        * Get the modification time of the /etc/mtab file.
@@ -14,6 +14,7 @@
 #include <sys/types.h>
 #include <signal.h>
 #include <sys/wait.h>
+#include <sys/epoll.h>
 #include <netdb.h>
 #include <arpa/inet.h>
 
@@ -26,6 +27,8 @@
 #include "zypp/base/Logger.h"
 #include "zypp/media/MediaMultiCurl.h"
 #include "zypp/media/MetaLinkParser.h"
+#include "zypp/media/CurlHandlePool.h"
+#include "zypp/media/MirrorScores.h"
 
 using namespace std;
 using namespace zypp::base;
@@ -58,8 +61,8 @@ public:
   void disableCompetition();
 
   void checkdns();
-  void adddnsfd(fd_set &rset, int &maxfd);
-  void dnsevent(fd_set &rset);
+  void adddnsfd();
+  void dnsevent();
 
   int _workerno;
 
@@ -77,9 +80,13 @@ public:
 
   double _avgspeed;
   double _maxspeed;
+  double _latency;		// average time to first byte
+  size_t _maxblksize;		// block size limit, scaled by the mirrors throughput
 
   double _sleepuntil;
 
+  string _host;
+
 private:
   void stealjob();
 
@@ -120,6 +127,11 @@ public:
 protected:
   friend class multifetchworker;
 
+  // curl_multi_socket_action event loop helpers
+  void socketaction(curl_socket_t s, int evbitmask);
+  static int _socketfunction(CURL *easy, curl_socket_t s, int what, void *userp, void *socketp);
+  static int _timerfunction(CURLM *multi, long timeout_ms, void *userp);
+
   const MediaMultiCurl *_context;
   const Pathname _filename;
   Url _baseurl;
@@ -130,6 +142,9 @@ protected:
   off_t _filesize;
 
   CURLM *_multi;
+  int _epfd;			// epoll fd watching the curl sockets and DNS pipes
+  double _curldeadline;		// when curl wants to be called with CURL_SOCKET_TIMEOUT (0: never)
+  std::map<int, multifetchworker *> _dnsfds;
 
   std::list<multifetchworker *> _workers;
   bool _stealing;
@@ -161,6 +176,7 @@ public:
 };
 
 #define BLKSIZE		131072
+#define MAXBLKSIZE	(8 * BLKSIZE)
 #define MAXURLS		10
 
 
@@ -312,16 +328,28 @@ multifetchworker::multifetchworker(int no, multifetchrequest &request, const Url
   _received = 0;
   _blkstarttime = 0;
   _avgspeed = 0;
+  _latency = 0;
   _sleepuntil = 0;
   _maxspeed = _request->_maxspeed;
   _noendrange = false;
+  _host = url.getHost();
+
+  // fast mirrors get larger blocks (about half a second of data)
+  _maxblksize = BLKSIZE;
+  double throughput = MirrorScores::instance().throughput(_host);
+  if (throughput > 0)
+    {
+      size_t blocks = size_t(throughput / 2 / BLKSIZE);
+      if (blocks > MAXBLKSIZE / BLKSIZE)
+	blocks = MAXBLKSIZE / BLKSIZE;
+      if (blocks > 1)
+	_maxblksize = blocks * BLKSIZE;
+    }
 
   Url curlUrl( clearQueryString(url) );
   _urlbuf = curlUrl.asString();
-  _curl = _request->_context->fromEasyPool(_url.getHost());
-  if (_curl)
-    XXX << "reused worker from pool" << endl;
-  if (!_curl && !(_curl = curl_easy_init()))
+  _curl = CurlHandlePool::instance().get(CurlHandlePool::key(_url));
+  if (!_curl)
     {
       _state = WORKER_BROKEN;
       strncpy(_curlError, "curl_easy_init failed", CURL_ERROR_SIZE);
@@ -381,17 +409,7 @@ multifetchworker::~multifetchworker()
       if (_state == WORKER_FETCH || _state == WORKER_DISCARD)
         curl_multi_remove_handle(_request->_multi, _curl);
       if (_state == WORKER_DONE || _state == WORKER_SLEEP)
-	{
-#if CURLVERSION_AT_LEAST(7,15,5)
-	  curl_easy_setopt(_curl, CURLOPT_MAX_RECV_SPEED_LARGE, (curl_off_t)0);
-#endif
-	  curl_easy_setopt(_curl, CURLOPT_PRIVATE, (void *)0);
-	  curl_easy_setopt(_curl, CURLOPT_WRITEFUNCTION, (void *)0);
-	  curl_easy_setopt(_curl, CURLOPT_WRITEDATA, (void *)0);
-	  curl_easy_setopt(_curl, CURLOPT_HEADERFUNCTION, (void *)0);
-	  curl_easy_setopt(_curl, CURLOPT_HEADERDATA, (void *)0);
-          _request->_context->toEasyPool(_url.getHost(), _curl);
-	}
+        CurlHandlePool::instance().put(CurlHandlePool::key(_url), _curl);
       else
         curl_easy_cleanup(_curl);
       _curl = 0;
@@ -500,21 +518,32 @@ multifetchworker::checkdns()
 }
 
 void
-multifetchworker::adddnsfd(fd_set &rset, int &maxfd)
+multifetchworker::adddnsfd()
 {
   if (_state != WORKER_LOOKUP)
     return;
-  FD_SET(_dnspipe, &rset);
-  if (maxfd < _dnspipe)
-    maxfd = _dnspipe;
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.fd = _dnspipe;
+  if (epoll_ctl(_request->_epfd, EPOLL_CTL_ADD, _dnspipe, &ev))
+    {
+      // no way to get notified, so wait for the lookup now
+      WAR << "#" << _workerno << ": can't watch DNS pipe: " << strerror(errno) << endl;
+      dnsevent();
+      return;
+    }
+  _request->_dnsfds[_dnspipe] = this;
 }
 
 void
-multifetchworker::dnsevent(fd_set &rset)
+multifetchworker::dnsevent()
 {
 
-  if (_state != WORKER_LOOKUP || !FD_ISSET(_dnspipe, &rset))
+  if (_state != WORKER_LOOKUP)
     return;
+  if (_request->_dnsfds.erase(_dnspipe))
+    epoll_ctl(_request->_epfd, EPOLL_CTL_DEL, _dnspipe, 0);
   int status;
   while (waitpid(_pid, &status, 0) == -1)
     {
@@ -704,7 +733,7 @@ multifetchworker::nextjob()
   MediaBlockList *blklist = _request->_blklist;
   if (!blklist)
     {
-      _blksize = BLKSIZE;
+      _blksize = _maxblksize;
       if (_request->_filesize != off_t(-1))
 	{
 	  if (_request->_blkoff >= _request->_filesize)
@@ -713,8 +742,8 @@ multifetchworker::nextjob()
 	      return;
 	    }
 	  _blksize = _request->_filesize - _request->_blkoff;
-	  if (_blksize > BLKSIZE)
-	    _blksize = BLKSIZE;
+	  if (_blksize > _maxblksize)
+	    _blksize = _maxblksize;
 	}
     }
   else
@@ -731,8 +760,8 @@ multifetchworker::nextjob()
 	  _request->_blkoff = blk.off;
 	}
       _blksize = blk.off + blk.size - _request->_blkoff;
-      if (_blksize > BLKSIZE && !blklist->haveChecksum(_request->_blkno))
-	_blksize = BLKSIZE;
+      if (_blksize > _maxblksize && !blklist->haveChecksum(_request->_blkno))
+	_blksize = _maxblksize;
     }
   _blkno = _request->_blkno;
   _blkstart = _request->_blkoff;
@@ -789,6 +818,8 @@ multifetchrequest::multifetchrequest(const MediaMultiCurl *context, const Pathna
   _blklist = blklist;
   _filesize = filesize;
   _multi = multi;
+  _epfd = epoll_create1(EPOLL_CLOEXEC);
+  _curldeadline = 0;
   _stealing = false;
   _havenewjob = false;
   _blkno = 0;
@@ -825,24 +856,88 @@ multifetchrequest::multifetchrequest(const MediaMultiCurl *context, const Pathna
 
 multifetchrequest::~multifetchrequest()
 {
+  MirrorScores & scores(MirrorScores::instance());
   for (std::list<multifetchworker *>::iterator workeriter = _workers.begin(); workeriter != _workers.end(); ++workeriter)
     {
       multifetchworker *worker = *workeriter;
+      if (worker->_state == WORKER_BROKEN)
+	scores.failure(worker->_host);
+      else if (worker->_avgspeed > 0)
+	scores.success(worker->_host, worker->_avgspeed, worker->_latency);
       *workeriter = NULL;
       delete worker;
     }
   _workers.clear();
+  // _multi is reused by the next request
+  curl_multi_setopt(_multi, CURLMOPT_SOCKETFUNCTION, (void *)0);
+  curl_multi_setopt(_multi, CURLMOPT_SOCKETDATA, (void *)0);
+  curl_multi_setopt(_multi, CURLMOPT_TIMERFUNCTION, (void *)0);
+  curl_multi_setopt(_multi, CURLMOPT_TIMERDATA, (void *)0);
+  if (_epfd != -1)
+    close(_epfd);
+}
+
+int
+multifetchrequest::_socketfunction(CURL *easy, curl_socket_t s, int what, void *userp, void *socketp)
+{
+  multifetchrequest *me = reinterpret_cast<multifetchrequest *>(userp);
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.data.fd = s;
+  if (what == CURL_POLL_REMOVE)
+    {
+      epoll_ctl(me->_epfd, EPOLL_CTL_DEL, s, &ev);
+      return 0;
+    }
+  if (what & CURL_POLL_IN)
+    ev.events |= EPOLLIN;
+  if (what & CURL_POLL_OUT)
+    ev.events |= EPOLLOUT;
+  if (epoll_ctl(me->_epfd, EPOLL_CTL_MOD, s, &ev) == -1 && errno == ENOENT)
+    epoll_ctl(me->_epfd, EPOLL_CTL_ADD, s, &ev);
+  return 0;
+}
+
+int
+multifetchrequest::_timerfunction(CURLM *multi, long timeout_ms, void *userp)
+{
+  multifetchrequest *me = reinterpret_cast<multifetchrequest *>(userp);
+  me->_curldeadline = timeout_ms < 0 ? 0 : currentTime() + timeout_ms / 1000.;
+  return 0;
+}
+
+void
+multifetchrequest::socketaction(curl_socket_t s, int evbitmask)
+{
+  for (;;)
+    {
+      CURLMcode mcode;
+      int tasks;
+      mcode = curl_multi_socket_action(_multi, s, evbitmask, &tasks);
+      if (mcode == CURLM_CALL_MULTI_PERFORM)
+        continue;
+      if (mcode != CURLM_OK)
+        ZYPP_THROW(MediaCurlException(_baseurl, "curl_multi_socket_action", "unknown error"));
+      break;
+    }
 }
 
 void
 multifetchrequest::run(std::vector<Url> &urllist)
 {
+  if (_epfd == -1)
+    ZYPP_THROW(MediaCurlException(_baseurl, "epoll_create1() failed", strerror(errno)));
+  curl_multi_setopt(_multi, CURLMOPT_SOCKETFUNCTION, &_socketfunction);
+  curl_multi_setopt(_multi, CURLMOPT_SOCKETDATA, this);
+  curl_multi_setopt(_multi, CURLMOPT_TIMERFUNCTION, &_timerfunction);
+  curl_multi_setopt(_multi, CURLMOPT_TIMERDATA, this);
+
   int workerno = 0;
   std::vector<Url>::iterator urliter = urllist.begin();
   for (;;)
     {
-      fd_set rset, wset, xset;
-      int maxfd, nqueue;
+      struct epoll_event events[64];
+      int nqueue;
 
       if (_finished)
 	{
@@ -863,7 +958,12 @@ multifetchrequest::run(std::vector<Url> &urllist)
 		  worker->nextjob();
 		}
 	      else
-	        _lookupworkers++;
+		{
+		  _lookupworkers++;
+		  worker->adddnsfd();
+		  if (worker->_state != WORKER_LOOKUP)
+		    _lookupworkers--;
+		}
 	    }
 	  ++urliter;
 	  continue;
@@ -881,21 +981,16 @@ multifetchrequest::run(std::vector<Url> &urllist)
 	  break;
 	}
 
-      FD_ZERO(&rset);
-      FD_ZERO(&wset);
-      FD_ZERO(&xset);
-
-      curl_multi_fdset(_multi, &rset, &wset, &xset, &maxfd);
-
-      if (_lookupworkers)
-        for (std::list<multifetchworker *>::iterator workeriter = _workers.begin(); workeriter != _workers.end(); ++workeriter)
-	  (*workeriter)->adddnsfd(rset, maxfd);
-
-      timeval tv;
-      // if we added a new job we have to call multi_perform once
-      // to make it show up in the fd set. do not sleep in this case.
-      tv.tv_sec = 0;
-      tv.tv_usec = _havenewjob ? 0 : 200000;
+      // if we added a new job we have to call curl once to make
+      // its socket show up in the epoll set. do not sleep in this case.
+      // Otherwise wake up at least every 200ms for progress and timeouts.
+      int timeoutms = _havenewjob ? 0 : 200;
+      if (_curldeadline && timeoutms)
+	{
+	  double cl = _curldeadline - currentTime();
+	  if (cl < .2)
+	    timeoutms = cl > 0 ? cl * 1000 : 0;
+	}
       if (_sleepworkers && !_havenewjob)
 	{
 	  if (_minsleepuntil == 0)
@@ -915,36 +1010,43 @@ multifetchrequest::run(std::vector<Url> &urllist)
 	      sl = 0;
 	      _minsleepuntil = 0;
 	    }
-	  if (sl < .2)
-	    tv.tv_usec = sl * 1000000;
+	  if (sl * 1000 < timeoutms)
+	    timeoutms = sl * 1000;
 	}
-      int r = select(maxfd + 1, &rset, &wset, &xset, &tv);
+      int r = epoll_wait(_epfd, events, sizeof(events) / sizeof(*events), timeoutms);
       if (r == -1 && errno != EINTR)
-	ZYPP_THROW(MediaCurlException(_baseurl, "select() failed", "unknown error"));
-      if (r != 0 && _lookupworkers)
-	for (std::list<multifetchworker *>::iterator workeriter = _workers.begin(); workeriter != _workers.end(); ++workeriter)
-	  {
-	    multifetchworker *worker = *workeriter;
-	    if (worker->_state != WORKER_LOOKUP)
+	ZYPP_THROW(MediaCurlException(_baseurl, "epoll_wait() failed", strerror(errno)));
+
+      // dispatch the events: DNS pipes to their worker, sockets to curl
+      for (int i = 0; i < r; i++)
+	{
+	  int fd = events[i].data.fd;
+	  std::map<int, multifetchworker *>::iterator dnsiter = _dnsfds.find(fd);
+	  if (dnsiter != _dnsfds.end())
+	    {
+	      multifetchworker *worker = dnsiter->second;
+	      worker->dnsevent();
+	      if (worker->_state != WORKER_LOOKUP)
+		_lookupworkers--;
 	      continue;
-	    (*workeriter)->dnsevent(rset);
-	    if (worker->_state != WORKER_LOOKUP)
-	      _lookupworkers--;
-	  }
-      _havenewjob = false;
+	    }
+	  int evbitmask = 0;
+	  if (events[i].events & EPOLLIN)
+	    evbitmask |= CURL_CSELECT_IN;
+	  if (events[i].events & EPOLLOUT)
+	    evbitmask |= CURL_CSELECT_OUT;
+	  if (events[i].events & (EPOLLERR | EPOLLHUP))
+	    evbitmask |= CURL_CSELECT_ERR;
+	  socketaction(fd, evbitmask);
+	}
 
-      // run curl
-      for (;;)
-        {
-          CURLMcode mcode;
-	  int tasks;
-          mcode = curl_multi_perform(_multi, &tasks);
-          if (mcode == CURLM_CALL_MULTI_PERFORM)
-            continue;
-	  if (mcode != CURLM_OK)
-	    ZYPP_THROW(MediaCurlException(_baseurl, "curl_multi_perform", "unknown error"));
-	  break;
-        }
+      // curl's own timers (connect, new handles, ...)
+      if (_havenewjob || (_curldeadline && currentTime() >= _curldeadline))
+	{
+	  _curldeadline = 0;
+	  socketaction(CURL_SOCKET_TIMEOUT, 0);
+	}
+      _havenewjob = false;
 
       double now = currentTime();
 
@@ -996,6 +1098,9 @@ multifetchrequest::run(std::vector<Url> &urllist)
 	      else
 		worker->_avgspeed = worker->_blkreceived / (now - worker->_blkstarttime);
 	    }
+	  double starttransfer = 0;
+	  if (cc == CURLE_OK && curl_easy_getinfo(easy, CURLINFO_STARTTRANSFER_TIME, &starttransfer) == CURLE_OK && starttransfer > 0)
+	    worker->_latency = worker->_latency ? (worker->_latency + starttransfer) / 2 : starttransfer;
 	  XXX << "#" << worker->_workerno << ": BLK " << worker->_blkno << " done code " << cc << " speed " << worker->_avgspeed << endl;
 	  curl_multi_remove_handle(_multi, easy);
 	  if (cc == CURLE_HTTP_RETURNED_ERROR)
@@ -1172,16 +1277,6 @@ MediaMultiCurl::~MediaMultiCurl()
       curl_multi_cleanup(_multi);
       _multi = 0;
     }
-  std::map<std::string, CURL *>::iterator it;
-  for (it = _easypool.begin(); it != _easypool.end(); it++)
-    {
-      CURL *easy = it->second;
-      if (easy)
-	{
-	  curl_easy_cleanup(easy);
-	  it->second = NULL;
-	}
-    }
 }
 
 void MediaMultiCurl::setupEasy()
@@ -1281,8 +1376,33 @@ int MediaMultiCurl::progressCallback( void *clientp, double dltotal, double dlno
   return MediaCurl::progressCallback(clientp, dltotal, dlnow, ultotal, ulnow);
 }
 
+// make the downloaded temp file the target
+static void commitTempFile(FILE *file, const string &destNew, const Pathname &dest)
+{
+  if (::fchmod( ::fileno(file), filesystem::applyUmaskTo( 0644 )))
+    {
+      ERR << "Failed to chmod file " << destNew << endl;
+    }
+  if (::fclose(file))
+    {
+      filesystem::unlink(destNew);
+      ERR << "Fclose failed for file '" << destNew << "'" << endl;
+      ZYPP_THROW(MediaWriteException(destNew));
+    }
+  if ( rename( destNew, dest ) != 0 )
+    {
+      ERR << "Rename failed" << endl;
+      ZYPP_THROW(MediaWriteException(dest));
+    }
+  DBG << "done: " << PathInfo(dest) << endl;
+}
+
 void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname & target, callback::SendReport<DownloadProgressReport> & report, RequestOptions options ) const
 {
+  if ( options & OPTION_NO_METALINK )
+    return MediaCurl::doGetFileCopy( filename, target, report, options );
+
+  _streamChecksum = CheckSum();	// set by MediaCurl::doGetFileCopyFile only
   Pathname dest = target.absolutename();
   if( assert_dir( dest.dirname() ) )
   {
@@ -1319,6 +1439,53 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
   DBG << "dest: " << dest << endl;
   DBG << "temp: " << destNew << endl;
 
+  // A large file on a plain http server (no metalink): download ranges
+  // of it on several connections. If this fails, we start over below.
+  off_t filesize = off_t(-1);
+  if (!PathInfo(target).isExist() || (options & OPTION_NO_IFMODSINCE))
+    filesize = parallelFileSize(filename, file);
+  if (filesize > 0)
+    {
+      Url url(getFileUrl(filename));
+      bool done = false;
+      try
+	{
+	  if (!(options & OPTION_NO_REPORT_START))
+	    report->start(url, dest);
+	  options = options | OPTION_NO_REPORT_START;
+	  std::vector<Url> urls(_settings.maxConcurrentConnections(), url);
+	  MIL << "parallel download of " << url << " (" << ByteCount(filesize) << ")" << endl;
+	  multifetch(filename, file, &urls, &report, 0, filesize);
+	  done = true;
+	}
+      catch (MediaCurlException &ex)
+	{
+	  if (ex.errstr() == "User abort")
+	    {
+	      ::fclose(file);
+	      filesystem::unlink(destNew);
+	      ZYPP_RETHROW(ex);
+	    }
+	  ZYPP_CAUGHT(ex);
+	}
+      catch (Exception &ex)
+	{
+	  ZYPP_CAUGHT(ex);
+	}
+      if (done)
+	{
+	  commitTempFile(file, destNew, dest);
+	  return;
+	}
+      WAR << "parallel download failed, using a single connection" << endl;
+      if (::ftruncate(::fileno(file), 0) || ::fseeko(file, 0, SEEK_SET))
+	{
+	  ::fclose(file);
+	  filesystem::unlink(destNew);
+	  ZYPP_THROW(MediaWriteException(destNew));
+	}
+    }
+
   // set IFMODSINCE time condition (no download if not modified)
   if( PathInfo(target).isExist() && !(options & OPTION_NO_IFMODSINCE) )
   {
@@ -1392,6 +1559,7 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
   if (ismetalink)
     {
       bool userabort = false;
+      _streamChecksum = CheckSum();	// that's the metalink file
       fclose(file);
       file = NULL;
       Pathname failedFile = ZConfig::instance().repoCachePath() / "MultiCurl.failed";
@@ -1458,22 +1626,51 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
 	}
     }
 
-  if (::fchmod( ::fileno(file), filesystem::applyUmaskTo( 0644 )))
-    {
-      ERR << "Failed to chmod file " << destNew << endl;
-    }
-  if (::fclose(file))
+  commitTempFile(file, destNew, dest);
+  rememberStreamChecksum(dest);
+}
+
+off_t MediaMultiCurl::parallelFileSize(const Pathname & filename, FILE *file) const
+{
+  long minsize = ZConfig::instance().download_parallel_min_size();
+  if (minsize <= 0 || _settings.maxConcurrentConnections() < 2)
+    return off_t(-1);
+  if (_url.getScheme() != "http" && _url.getScheme() != "https")
+    return off_t(-1);
+  if (!_settings.headRequestsAllowed())
+    return off_t(-1);
+
+  Url url(getFileUrl(filename));
+  string urlbuf(clearQueryString(url).asString());
+  curl_easy_setopt(_curl, CURLOPT_URL, urlbuf.c_str());
+  curl_easy_setopt(_curl, CURLOPT_WRITEDATA, file);
+  // with "Accept: metalink" a metalink server tells us to use the metalink
+  curl_easy_setopt(_curl, CURLOPT_HTTPHEADER, _customHeadersMetalink);
+  curl_easy_setopt(_curl, CURLOPT_NOBODY, 1L);
+  CURLcode ret = curl_easy_perform(_curl);
+  curl_easy_setopt(_curl, CURLOPT_NOBODY, 0L);
+  curl_easy_setopt(_curl, CURLOPT_HTTPGET, 1L);
+  curl_easy_setopt(_curl, CURLOPT_HTTPHEADER, _customHeaders);
+
+  long httpReturnCode = 0;
+  double contentlength = -1;
+  char *ptr = NULL;
+  if (ret != CURLE_OK
+      || curl_easy_getinfo(_curl, CURLINFO_RESPONSE_CODE, &httpReturnCode) != CURLE_OK || httpReturnCode != 200
+      || curl_easy_getinfo(_curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &contentlength) != CURLE_OK)
     {
-      filesystem::unlink(destNew);
-      ERR << "Fclose failed for file '" << destNew << "'" << endl;
-      ZYPP_THROW(MediaWriteException(destNew));
+      DBG << "HEAD " << url << ": " << ret << ", HTTP response " << httpReturnCode << endl;
+      return off_t(-1);
     }
-  if ( rename( destNew, dest ) != 0 )
+  if (curl_easy_getinfo(_curl, CURLINFO_CONTENT_TYPE, &ptr) == CURLE_OK && ptr)
     {
-      ERR << "Rename failed" << endl;
-      ZYPP_THROW(MediaWriteException(dest));
+      string ct = string(ptr);
+      if (ct.find("application/metalink+xml") == 0 || ct.find("application/metalink4+xml") == 0)
+	return off_t(-1);
     }
-  DBG << "done: " << PathInfo(dest) << endl;
+  if (contentlength < double(minsize) * 1024 * 1024)
+    return off_t(-1);
+  return off_t(contentlength);
 }
 
 void MediaMultiCurl::multifetch(const Pathname & filename, FILE *fp, std::vector<Url> *urllist, callback::SendReport<DownloadProgressReport> *report, MediaBlockList *blklist, off_t filesize) const
@@ -1523,6 +1720,7 @@ void MediaMultiCurl::multifetch(const Pathname & filename, FILE *fp, std::vector
     }
   if (!myurllist.size())
     myurllist.push_back(baseurl);
+  MirrorScores::instance().rank(myurllist);
   req.run(myurllist);
   checkFileDigest(baseurl, fp, blklist);
 }
@@ -1553,23 +1751,6 @@ void MediaMultiCurl::setDNSok(const string &host) const
   _dnsok.insert(host);
 }
 
-CURL *MediaMultiCurl::fromEasyPool(const string &host) const
-{
-  if (_easypool.find(host) == _easypool.end())
-    return 0;
-  CURL *ret = _easypool[host];
-  _easypool.erase(host);
-  return ret;
-}
-
-void MediaMultiCurl::toEasyPool(const std::string &host, CURL *easy) const
-{
-  CURL *oldeasy = _easypool[host];
-  _easypool[host] = easy;
-  if (oldeasy)
-    curl_easy_cleanup(oldeasy);
-}
-
   } // namespace media
 } // namespace zypp
 
@@ -54,19 +54,18 @@ protected:
   bool isDNSok(const std::string &host) const;
   void setDNSok(const std::string &host) const;
 
-  CURL *fromEasyPool(const std::string &host) const;
-  void toEasyPool(const std::string &host, CURL *easy) const;
-
   virtual void setupEasy();
   void checkFileDigest(Url &url, FILE *fp, MediaBlockList *blklist) const;
   static int progressCallback( void *clientp, double dltotal, double dlnow, double ultotal, double ulnow );
 
+  /** Size of \a filename if it should be downloaded in parallel ranges, else \c -1. */
+  off_t parallelFileSize(const Pathname &filename, FILE *file) const;
+
 private:
   // the custom headers from MediaCurl plus a "Accept: metalink" header
   curl_slist *_customHeadersMetalink;
   mutable CURLM *_multi;	// reused for all fetches so we can make use of the dns cache
   mutable std::set<std::string> _dnsok;
-  mutable std::map<std::string, CURL *> _easypool;
 };
 
 ///////////////////////////////////////////////////////////////////
@@ -0,0 +1,361 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file zypp/media/MirrorScores.cc
+ *
+*/
+#include <cmath>
+#include <iostream>
+#include <fstream>
+#include <map>
+#include <algorithm>
+#include <mutex>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/String.h"
+#include "zypp/PathInfo.h"
+#include "zypp/ZConfig.h"
+#include "zypp/media/MirrorScores.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+  namespace media
+  { ///////////////////////////////////////////////////////////////
+
+    namespace
+    {
+      /** Half-life of the success/failure counts. */
+      const double halfLife = 7 * 24 * 60 * 60;
+      /** Weight of a new throughput/latency sample. */
+      const double sampleWeight = .3;
+
+      /** Per host data. */
+      struct Record
+      {
+        Record()
+        : throughput( 0 ), latency( 0 ), successes( 0 ), failures( 0 ), updated( 0 )
+        {}
+
+        /** Let the counts decay up to \a now_r. */
+        void decay( time_t now_r )
+        {
+          if ( now_r > updated )
+          {
+            double f = ::pow( .5, ( now_r - updated ) / halfLife );
+            successes *= f;
+            failures *= f;
+            updated = now_r;
+          }
+        }
+
+        /** Expected throughput considering the failure rate. */
+        double score() const
+        { return throughput * ( successes + 1 ) / ( successes + failures + 2 ); }
+
+        bool failing() const
+        { return failures >= 3 && failures > 4 * successes; }
+
+        double throughput;	///< bytes per second
+        double latency;		///< seconds
+        double successes;
+        double failures;
+        time_t updated;
+      };
+    } // namespace
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class MirrorScores::Impl
+    /// \brief MirrorScores implementation.
+    ///////////////////////////////////////////////////////////////////
+    class MirrorScores::Impl : private base::NonCopyable
+    {
+    public:
+      /** Ctor; an empty \a file_r follows the \ref ZConfig::repoCachePath. */
+      Impl( const Pathname & file_r )
+      : _file( file_r.empty() ? configFile() : file_r )
+      , _followConfig( file_r.empty() )
+      , _dirty( false )
+      { read(); }
+
+      ~Impl()
+      {
+        std::unique_lock<std::mutex> lock( _mutex );
+        saveLocked();
+      }
+
+    public:
+      void success( const std::string & host_r, double throughput_r, double latency_r, time_t now_r )
+      {
+        std::unique_lock<std::mutex> lock( _mutex );
+        sync();
+        Record & rec( _records[host_r] );
+        rec.decay( now_r );
+        if ( rec.successes == 0 && rec.throughput == 0 )
+        {
+          rec.throughput = throughput_r;
+          rec.latency = latency_r;
+        }
+        else
+        {
+          rec.throughput = ( 1 - sampleWeight ) * rec.throughput + sampleWeight * throughput_r;
+          rec.latency = ( 1 - sampleWeight ) * rec.latency + sampleWeight * latency_r;
+        }
+        rec.successes += 1;
+        rec.updated = now_r;
+        _dirty = true;
+      }
+
+      void failure( const std::string & host_r, time_t now_r )
+      {
+        std::unique_lock<std::mutex> lock( _mutex );
+        sync();
+        Record & rec( _records[host_r] );
+        rec.decay( now_r );
+        rec.failures += 1;
+        rec.updated = now_r;
+        _dirty = true;
+      }
+
+      double throughput( const std::string & host_r ) const
+      {
+        std::unique_lock<std::mutex> lock( _mutex );
+        sync();
+        RecordMap::const_iterator it( _records.find( host_r ) );
+        return it == _records.end() ? 0 : it->second.throughput;
+      }
+
+      bool failing( const std::string & host_r, time_t now_r ) const
+      {
+        std::unique_lock<std::mutex> lock( _mutex );
+        sync();
+        RecordMap::const_iterator it( _records.find( host_r ) );
+        if ( it == _records.end() )
+          return false;
+        Record rec( it->second );
+        rec.decay( now_r );
+        return rec.failing();
+      }
+
+      void rank( std::vector<Url> & urls_r, time_t now_r ) const
+      {
+        if ( urls_r.size() < 2 )
+          return;
+
+        std::vector<std::pair<double,Url> > ranked;
+        std::vector<bool> known;
+        std::vector<double> knownScores;
+        std::vector<Url> failingUrls;
+        {
+          std::unique_lock<std::mutex> lock( _mutex );
+          sync();
+          for_( it, urls_r.begin(), urls_r.end() )
+          {
+            RecordMap::const_iterator rit( _records.find( it->getHost() ) );
+            if ( rit == _records.end() )
+            {
+              ranked.push_back( std::make_pair( 0.0, *it ) );
+              known.push_back( false );
+              continue;
+            }
+            Record rec( rit->second );
+            rec.decay( now_r );
+            if ( rec.failing() )
+            {
+              failingUrls.push_back( *it );
+              continue;
+            }
+            ranked.push_back( std::make_pair( rec.score(), *it ) );
+            known.push_back( true );
+            knownScores.push_back( rec.score() );
+          }
+        }
+
+        // unknown mirrors rank like an average known one
+        if ( ! knownScores.empty() )
+        {
+          unsigned mid = ( knownScores.size() - 1 ) / 2;
+          std::nth_element( knownScores.begin(), knownScores.begin() + mid, knownScores.end() );
+          double median = knownScores[mid];
+          for ( unsigned i = 0; i < ranked.size(); ++i )
+          {
+            if ( ! known[i] )
+              ranked[i].first = median;
+          }
+          std::stable_sort( ranked.begin(), ranked.end(),
+                            []( const std::pair<double,Url> & lhs, const std::pair<double,Url> & rhs )
+                            { return lhs.first > rhs.first; } );
+        }
+
+        if ( ranked.empty() )
+        {
+          // all failing: keep the first one anyway
+          ranked.push_back( std::make_pair( 0.0, failingUrls.front() ) );
+          failingUrls.erase( failingUrls.begin() );
+        }
+        if ( ! failingUrls.empty() )
+          MIL << "Skipping " << failingUrls.size() << " failing mirrors: " << failingUrls << endl;
+
+        urls_r.clear();
+        for_( it, ranked.begin(), ranked.end() )
+          urls_r.push_back( it->second );
+      }
+
+      void save() const
+      {
+        std::unique_lock<std::mutex> lock( _mutex );
+        saveLocked();
+      }
+
+      const Pathname & file() const
+      { return _file; }
+
+      unsigned size() const
+      {
+        std::unique_lock<std::mutex> lock( _mutex );
+        return _records.size();
+      }
+
+    private:
+      static Pathname configFile()
+      { return ZConfig::instance().repoCachePath() / "MirrorScores"; }
+
+      /** If following the config and the repoCachePath changed (e.g. a
+       * different root), save the scores and read those at the new location.
+       * Called with the mutex locked.
+       */
+      void sync() const
+      {
+        if ( ! _followConfig )
+          return;
+        Pathname file( configFile() );
+        if ( file == _file )
+          return;
+        saveLocked();
+        _records.clear();
+        _file = file;
+        _dirty = false;
+        read();
+      }
+
+      /** Write the scores if changed. Called with the mutex locked. */
+      void saveLocked() const
+      {
+        if ( ! _dirty )
+          return;
+
+        if ( filesystem::assert_dir( _file.dirname() ) != 0 )
+        {
+          DBG << "Can't create " << _file.dirname() << endl;
+          return;
+        }
+        Pathname tmp( _file.extend( ".new" ) );
+        {
+          std::ofstream out( tmp.c_str() );
+          out << "# host throughput latency successes failures updated" << endl;
+          for_( it, _records.begin(), _records.end() )
+          {
+            out << it->first
+                << " " << it->second.throughput
+                << " " << it->second.latency
+                << " " << it->second.successes
+                << " " << it->second.failures
+                << " " << it->second.updated << endl;
+          }
+          if ( ! out )
+          {
+            DBG << "Can't write " << tmp << endl;
+            filesystem::unlink( tmp );
+            return;
+          }
+        }
+        if ( filesystem::rename( tmp, _file ) == 0 )
+          _dirty = false;
+      }
+
+      void read() const
+      {
+        std::ifstream in( _file.c_str() );
+        for( std::string line; std::getline( in, line ); )
+        {
+          if ( line.empty() || line[0] == '#' )
+            continue;
+          std::vector<std::string> words;
+          if ( str::split( line, std::back_inserter( words ) ) != 6 )
+            continue;
+          Record & rec( _records[words[0]] );
+          rec.throughput = str::strtonum<double>( words[1] );
+          rec.latency    = str::strtonum<double>( words[2] );
+          rec.successes  = str::strtonum<double>( words[3] );
+          rec.failures   = str::strtonum<double>( words[4] );
+          rec.updated    = str::strtonum<time_t>( words[5] );
+        }
+      }
+
+    private:
+      typedef std::map<std::string,Record> RecordMap;
+      mutable Pathname	_file;
+      bool		_followConfig;
+      mutable RecordMap	_records;
+      mutable bool	_dirty;
+      mutable std::mutex	_mutex;
+    };
+    ///////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	CLASS NAME : MirrorScores
+    //
+    ///////////////////////////////////////////////////////////////////
+
+    MirrorScores & MirrorScores::instance()
+    {
+      static MirrorScores _instance( ( Pathname() ) ); // follows the ZConfig::repoCachePath
+      return _instance;
+    }
+
+    MirrorScores::MirrorScores( const Pathname & file_r )
+    : _pimpl( new Impl( file_r ) )
+    {}
+
+    MirrorScores::~MirrorScores()
+    {}
+
+    void MirrorScores::success( const std::string & host_r, double throughput_r, double latency_r, time_t now_r )
+    { _pimpl->success( host_r, throughput_r, latency_r, now_r ); }
+
+    void MirrorScores::failure( const std::string & host_r, time_t now_r )
+    { _pimpl->failure( host_r, now_r ); }
+
+    double MirrorScores::throughput( const std::string & host_r ) const
+    { return _pimpl->throughput( host_r ); }
+
+    bool MirrorScores::failing( const std::string & host_r, time_t now_r ) const
+    { return _pimpl->failing( host_r, now_r ); }
+
+    void MirrorScores::rank( std::vector<Url> & urls_r, time_t now_r ) const
+    { _pimpl->rank( urls_r, now_r ); }
+
+    void MirrorScores::save() const
+    { _pimpl->save(); }
+
+    const Pathname & MirrorScores::file() const
+    { return _pimpl->file(); }
+
+    std::ostream & operator<<( std::ostream & str, const MirrorScores & obj )
+    {
+      return str << "MirrorScores(" << obj.file() << ", " << obj._pimpl->size() << " hosts)";
+    }
+
+    ///////////////////////////////////////////////////////////////
+  } // namespace media
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
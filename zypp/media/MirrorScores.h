@@ -0,0 +1,112 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file zypp/media/MirrorScores.h
+ *
+*/
+#ifndef ZYPP_MEDIA_MIRRORSCORES_H
+#define ZYPP_MEDIA_MIRRORSCORES_H
+
+#include <ctime>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "zypp/base/NonCopyable.h"
+#include "zypp/base/PtrTypes.h"
+#include "zypp/Pathname.h"
+#include "zypp/Url.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+  namespace media
+  { ///////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class MirrorScores
+    /// \brief Persistent per host download statistics of metalink mirrors.
+    ///
+    /// Remembers throughput, latency and success/failure counts per host,
+    /// so \ref MediaMultiCurl is able to start a download with the mirrors
+    /// that performed well before, and skip mirrors that keep failing.
+    ///
+    /// Throughput and latency are exponential moving averages. The
+    /// success/failure counts decay with a half-life of a week, so a
+    /// mirror that was failing is tried again after a while.
+    ///
+    /// The process wide \ref instance is stored in \c MirrorScores in
+    /// the \ref ZConfig::repoCachePath. The path is looked up whenever the
+    /// scores are used, so a changed root takes effect. The scores are
+    /// written when the path changes and when the instance is destroyed at
+    /// exit. All methods are thread safe.
+    ///////////////////////////////////////////////////////////////////
+    class MirrorScores : private base::NonCopyable
+    {
+      friend std::ostream & operator<<( std::ostream & str, const MirrorScores & obj );
+
+    public:
+      /** The process wide instance. */
+      static MirrorScores & instance();
+
+      /** Ctor reading the scores stored in \a file_r (if it exists).
+       * An empty \a file_r follows the \ref ZConfig::repoCachePath
+       * like the \ref instance does.
+       */
+      explicit MirrorScores( const Pathname & file_r );
+
+      /** Dtor writing the scores (if changed). */
+      ~MirrorScores();
+
+    public:
+      /** Remember a successful download from \a host_r.
+       * \a throughput_r in bytes per second, \a latency_r in seconds.
+       */
+      void success( const std::string & host_r, double throughput_r, double latency_r, time_t now_r = time( 0 ) );
+
+      /** Remember a failed download from \a host_r. */
+      void failure( const std::string & host_r, time_t now_r = time( 0 ) );
+
+      /** Average throughput of \a host_r (bytes per second, \c 0 if unknown). */
+      double throughput( const std::string & host_r ) const;
+
+      /** Whether \a host_r failed often enough to be skipped. */
+      bool failing( const std::string & host_r, time_t now_r = time( 0 ) ) const;
+
+      /** Sort \a urls_r best mirror first and remove failing mirrors.
+       * Mirrors not known yet are ranked like an average known one, so
+       * they get a chance. Among mirrors ranked equal the original order
+       * is kept. At least one url is kept.
+       */
+      void rank( std::vector<Url> & urls_r, time_t now_r = time( 0 ) ) const;
+
+    public:
+      /** Write the scores to the file (if changed). */
+      void save() const;
+
+      /** The file the scores are stored in. */
+      const Pathname & file() const;
+
+    public:
+      /** Implementation. */
+      class Impl;
+    private:
+      /** Pointer to implementation. */
+      RW_pointer<Impl> _pimpl;
+    };
+    ///////////////////////////////////////////////////////////////////
+
+    /** \relates MirrorScores Stream output */
+    std::ostream & operator<<( std::ostream & str, const MirrorScores & obj );
+
+    ///////////////////////////////////////////////////////////////
+  } // namespace media
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_MEDIA_MIRRORSCORES_H
@@ -61,6 +61,7 @@ namespace zypp
       {
         RepoManager repoManager( sysRoot_r );
         RepoInfoList repos = repoManager.knownRepositories();
+        RepoInfoList toload;
         for_( it, repos.begin(), repos.end() )
         {
           RepoInfo & nrepo( *it );
@@ -87,17 +88,20 @@ namespace zypp
             repoManager.buildCache( nrepo );
           }
 
-          MIL << str::form( "*** load repo '%s'\t", nrepo.name().c_str() ) << std::flush;
-          try
-          {
-            repoManager.loadFromCache( nrepo );
-            MIL << satpool.reposFind( nrepo.alias() ) << endl;
-          }
-          catch ( const Exception & exp )
-          {
-            ERR << "*** load repo failed: " << exp.asString() + "\n" + exp.historyAsString() << endl;
-            ZYPP_RETHROW ( exp );
-          }
+          toload.push_back( nrepo );
+        }
+
+        MIL << "*** load " << toload.size() << " repos" << endl;
+        try
+        {
+          repoManager.loadFromCache( toload );
+          for_( it, toload.begin(), toload.end() )
+            MIL << satpool.reposFind( it->alias() ) << endl;
+        }
+        catch ( const Exception & exp )
+        {
+          ERR << "*** load repo failed: " << exp.asString() + "\n" + exp.historyAsString() << endl;
+          ZYPP_RETHROW ( exp );
         }
       }
       MIL << str::form( "*** Read system at '%s'", sysRoot_r.c_str() ) << endl;
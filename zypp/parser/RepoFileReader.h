@@ -26,6 +26,8 @@ namespace zypp
   namespace parser
   { /////////////////////////////////////////////////////////////////
 
+    class IniDict;
+
     /**
      * \short Read repository data from a .repo file
      *
@@ -87,6 +89,24 @@ namespace zypp
       RepoFileReader( const InputStream &is,
                       const ProcessRepo & callback,
                       const ProgressData::ReceiverFnc &progress = ProgressData::ReceiverFnc() );
+
+     /**
+      * \short Constructor. Creates the reader and start reading.
+      *
+      * Takes the content of \a repo_file already parsed into \a dict
+      * (e.g. remembered from a previous run).
+      *
+      * \param dict The parsed content of \a repo_file
+      * \param repo_file The .repo file the content was read from
+      * \param callback Callback that will be called for each repository.
+      * \param progress Optional progress function. \see ProgressData
+      *
+      * \throws AbortRequestException If the callback returns false
+      */
+      RepoFileReader( const IniDict &dict,
+                      const Pathname &repo_file,
+                      const ProcessRepo & callback,
+                      const ProgressData::ReceiverFnc &progress = ProgressData::ReceiverFnc() );
      
       /**
        * Dtor
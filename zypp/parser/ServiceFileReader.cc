@@ -34,6 +34,8 @@ namespace zypp
     public:
       static void parseServices( const Pathname & file,
           const ServiceFileReader::ProcessService & callback );
+      static void parseServices( const IniDict & dict, const Pathname & file,
+          const ServiceFileReader::ProcessService & callback );
     };
 
     void ServiceFileReader::Impl::parseServices( const Pathname & file,
@@ -47,6 +49,12 @@ namespace zypp
       }
 
       parser::IniDict dict(is);
+      parseServices(dict, file, callback);
+    }
+
+    void ServiceFileReader::Impl::parseServices( const IniDict & dict, const Pathname & file,
+                                  const ServiceFileReader::ProcessService & callback )
+    {
       for ( parser::IniDict::section_const_iterator its = dict.sectionsBegin();
             its != dict.sectionsEnd();
             ++its )
@@ -115,6 +123,13 @@ namespace zypp
       //MIL << "Done" << endl;
     }
 
+    ServiceFileReader::ServiceFileReader( const IniDict & dict,
+                                          const Pathname & service_file,
+                                          const ProcessService & callback )
+    {
+      Impl::parseServices(dict, service_file, callback);
+    }
+
     ServiceFileReader::~ServiceFileReader()
     {}
 
@@ -27,6 +27,8 @@ namespace zypp
   namespace parser
   { /////////////////////////////////////////////////////////////////
 
+    class IniDict;
+
     /**
      * \short Read service data from a .service file
      *
@@ -70,6 +72,22 @@ namespace zypp
       */
       ServiceFileReader( const Pathname & serviceFile,
                       const ProcessService & callback);
+
+     /**
+      * \short Constructor. Creates the reader and start reading.
+      *
+      * Takes the content of \a serviceFile already parsed into \a dict
+      * (e.g. remembered from a previous run).
+      *
+      * \param dict The parsed content of \a serviceFile
+      * \param serviceFile The .service file the content was read from
+      * \param callback Callback that will be called for each service.
+      *
+      * \throws AbortRequestException If the callback returns false
+      */
+      ServiceFileReader( const IniDict & dict,
+                         const Pathname & serviceFile,
+                         const ProcessService & callback );
      
       /**
        * Dtor
@@ -0,0 +1,225 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/pool/HardLockMatcher.cc
+ *
+*/
+#include <iostream>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/String.h"
+#include "zypp/sat/Map.h"
+#include "zypp/sat/Pool.h"
+
+#include "zypp/pool/HardLockMatcher.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+  ///////////////////////////////////////////////////////////////////
+  namespace pool
+  { /////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    { /////////////////////////////////////////////////////////////////
+
+      /** Remove one entry \a name_r, \a kinds_r from \a locks_r. */
+      template <class _NameLocks>
+      bool removeNameLock( _NameLocks & locks_r, const std::string & name_r, const PoolQuery::Kinds & kinds_r )
+      {
+        std::pair<typename _NameLocks::iterator, typename _NameLocks::iterator> range( locks_r.equal_range( name_r ) );
+        for_( it, range.first, range.second )
+        {
+          if ( it->second == kinds_r )
+          {
+            locks_r.erase( it );
+            return true;
+          }
+        }
+        return false;
+      }
+
+      /** Whether a lock \a name_r in \a locks_r matches the kind of \a solv_r. */
+      template <class _NameLocks>
+      bool findNameLock( const _NameLocks & locks_r, const std::string & name_r, sat::Solvable solv_r )
+      {
+        std::pair<typename _NameLocks::const_iterator, typename _NameLocks::const_iterator> range( locks_r.equal_range( name_r ) );
+        for_( it, range.first, range.second )
+        {
+          if ( it->second.empty() || solv_r.isKind( it->second.begin(), it->second.end() ) )
+            return true;
+        }
+        return false;
+      }
+
+      /////////////////////////////////////////////////////////////////
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	CLASS NAME : HardLockMatcher
+    //
+    ///////////////////////////////////////////////////////////////////
+
+    HardLockMatcher::HardLockMatcher()
+    {}
+
+    HardLockMatcher::HardLockMatcher( const HardLockQueries & queries_r )
+    {
+      for_( it, queries_r.begin(), queries_r.end() )
+        add( *it );
+    }
+
+    bool HardLockMatcher::empty() const
+    { return _names.empty() && _namesNocase.empty() && _queries.empty(); }
+
+    unsigned HardLockMatcher::size() const
+    { return _names.size() + _namesNocase.size() + _queries.size(); }
+
+    void HardLockMatcher::add( const PoolQuery & query_r )
+    {
+      std::string name;
+      if ( query_r.isNameQuery( name ) )
+      {
+        if ( query_r.caseSensitive() )
+          _names.insert( std::make_pair( name, query_r.kinds() ) );
+        else
+          _namesNocase.insert( std::make_pair( str::toLower( name ), query_r.kinds() ) );
+      }
+      else
+        _queries.push_back( query_r );
+    }
+
+    bool HardLockMatcher::remove( const PoolQuery & query_r )
+    {
+      std::string name;
+      if ( query_r.isNameQuery( name ) )
+      {
+        if ( query_r.caseSensitive() )
+          return removeNameLock( _names, name, query_r.kinds() );
+        return removeNameLock( _namesNocase, str::toLower( name ), query_r.kinds() );
+      }
+
+      for_( it, _queries.begin(), _queries.end() )
+      {
+        if ( *it == query_r )
+        {
+          _queries.erase( it );
+          return true;
+        }
+      }
+      return false;
+    }
+
+    void HardLockMatcher::clear()
+    {
+      _names.clear();
+      _namesNocase.clear();
+      _queries.clear();
+    }
+
+    bool HardLockMatcher::nameMatch( sat::Solvable solv_r ) const
+    {
+      if ( _names.empty() && _namesNocase.empty() )
+        return false;
+
+      std::string name( solv_r.name() );
+      if ( ! _names.empty() && findNameLock( _names, name, solv_r ) )
+        return true;
+      if ( ! _namesNocase.empty() && findNameLock( _namesNocase, str::toLower( name ), solv_r ) )
+        return true;
+      return false;
+    }
+
+    void HardLockMatcher::collect( const std::vector<sat::Solvable> & solvables_r, sat::SolvableSet & locked_r ) const
+    {
+      if ( solvables_r.empty() || empty() )
+        return;
+
+      for_( it, solvables_r.begin(), solvables_r.end() )
+      {
+        if ( nameMatch( *it ) )
+          locked_r.insert( *it );
+      }
+
+      if ( _queries.empty() )
+        return;
+
+      sat::Pool satpool( sat::Pool::instance() );
+      if ( solvables_r.size() * 4 < satpool.solvablesSize() )
+      {
+        // Just a few solvables: look at them only.
+        for_( qit, _queries.begin(), _queries.end() )
+        {
+          sat::SolvableSet found( qit->subsetResult( solvables_r ) );
+          for_( it, found.begin(), found.end() )
+            locked_r.insert( *it );
+        }
+      }
+      else
+      {
+        // A single scan per query is faster than one per solvable.
+        sat::Map wanted( satpool.capacity() );
+        for_( it, solvables_r.begin(), solvables_r.end() )
+          wanted.set( it->id() );
+
+        for_( qit, _queries.begin(), _queries.end() )
+        {
+          for_( it, qit->begin(), qit->end() )
+          {
+            if ( wanted.test( it->id() ) )
+              locked_r.insert( *it );
+          }
+        }
+      }
+    }
+
+    void HardLockMatcher::collect( sat::SolvableSet & locked_r ) const
+    {
+      if ( empty() )
+        return;
+
+      sat::Pool satpool( sat::Pool::instance() );
+      if ( ! ( _names.empty() && _namesNocase.empty() ) )
+      {
+        for_( it, satpool.solvablesBegin(), satpool.solvablesEnd() )
+        {
+          if ( nameMatch( *it ) )
+            locked_r.insert( *it );
+        }
+      }
+
+      for_( qit, _queries.begin(), _queries.end() )
+      {
+        for_( it, qit->begin(), qit->end() )
+          locked_r.insert( *it );
+      }
+    }
+
+    /******************************************************************
+    **
+    **	FUNCTION NAME : operator<<
+    **	FUNCTION TYPE : std::ostream &
+    */
+    std::ostream & operator<<( std::ostream & str, const HardLockMatcher & obj )
+    {
+      return str << "HardLockMatcher(" << obj._names.size() << " names, "
+                 << obj._namesNocase.size() << " nocase names, "
+                 << obj._queries.size() << " queries)";
+    }
+
+    /////////////////////////////////////////////////////////////////
+  } // namespace pool
+  ///////////////////////////////////////////////////////////////////
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,106 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/pool/HardLockMatcher.h
+ *
+*/
+#ifndef ZYPP_POOL_HARDLOCKMATCHER_H
+#define ZYPP_POOL_HARDLOCKMATCHER_H
+
+#include <iosfwd>
+#include <vector>
+#include <string>
+
+#include "zypp/base/Tr1hash.h"
+#include "zypp/pool/PoolTraits.h"
+#include "zypp/sat/SolvableSet.h"
+#include "zypp/PoolQuery.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+  ///////////////////////////////////////////////////////////////////
+  namespace pool
+  { /////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class HardLockMatcher
+    /// \brief The \ref PoolTraits::HardLockQueries compiled into one matcher.
+    ///
+    /// Most locks just name a package (\ref PoolQuery::isNameQuery).
+    /// Those are kept in a hash keyed by name, so each solvable is checked
+    /// by a single lookup of its name, no matter how many locks there are.
+    /// All other queries are kept as they are and evaluated as usual.
+    ///
+    /// Locks can be added and removed without recompiling the others.
+    ///////////////////////////////////////////////////////////////////
+    class HardLockMatcher
+    {
+      friend std::ostream & operator<<( std::ostream & str, const HardLockMatcher & obj );
+
+      public:
+        typedef PoolTraits::HardLockQueries HardLockQueries;
+
+      public:
+        /** Default ctor: no locks */
+        HardLockMatcher();
+
+        /** Ctor compiling \a queries_r. */
+        explicit HardLockMatcher( const HardLockQueries & queries_r );
+
+      public:
+        /** Whether there are no locks. */
+        bool empty() const;
+
+        /** Number of locks. */
+        unsigned size() const;
+
+        /** Add a lock. */
+        void add( const PoolQuery & query_r );
+
+        /** Remove a lock equal to \a query_r.
+         * \return Whether a lock was removed.
+         */
+        bool remove( const PoolQuery & query_r );
+
+        /** Remove all locks. */
+        void clear();
+
+      public:
+        /** Collect those of \a solvables_r matched by any lock into \a locked_r. */
+        void collect( const std::vector<sat::Solvable> & solvables_r, sat::SolvableSet & locked_r ) const;
+
+        /** Collect all solvables in the pool matched by any lock into \a locked_r. */
+        void collect( sat::SolvableSet & locked_r ) const;
+
+      private:
+        /** Whether a name lock matches \a solv_r. */
+        bool nameMatch( sat::Solvable solv_r ) const;
+
+      private:
+        /** Name locks: name and the kinds they are restricted to. */
+        typedef std::tr1::unordered_multimap<std::string, PoolQuery::Kinds> NameLocks;
+        /** Case sensitive name locks. */
+        NameLocks _names;
+        /** Case insensitive name locks (lowercased name). */
+        NameLocks _namesNocase;
+        /** All other locks. */
+        HardLockQueries _queries;
+    };
+    ///////////////////////////////////////////////////////////////////
+
+    /** \relates HardLockMatcher Stream output */
+    std::ostream & operator<<( std::ostream & str, const HardLockMatcher & obj );
+
+    /////////////////////////////////////////////////////////////////
+  } // namespace pool
+  ///////////////////////////////////////////////////////////////////
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_POOL_HARDLOCKMATCHER_H
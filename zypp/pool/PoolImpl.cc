@@ -12,6 +12,7 @@
 #include <iostream>
 #include "zypp/base/LogTools.h"
 
+#include "zypp/sat/detail/PoolImpl.h"
 #include "zypp/pool/PoolImpl.h"
 
 using std::endl;
@@ -46,6 +47,66 @@ namespace zypp
     PoolImpl::~PoolImpl()
     {}
 
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	METHOD NAME : PoolImpl::updateRepoSpans
+    //	METHOD TYPE : void
+    //
+    void PoolImpl::updateRepoSpans() const
+    {
+      RepoSpans current;
+      sat::Pool pool( satpool() );
+      for_( it, pool.reposBegin(), pool.reposEnd() )
+      {
+        ::_Repo * repo( it->get() );
+        current.push_back( RepoSpan( *it, repo->start, repo->end, repo->nsolvables ) );
+      }
+      std::sort( current.begin(), current.end() );
+
+      // Both are sorted by repo: collect the ranges of all spans not in both.
+      RepoSpans::const_iterator lit( _repoSpans.begin() );
+      RepoSpans::const_iterator rit( current.begin() );
+      while ( lit != _repoSpans.end() || rit != current.end() )
+      {
+        if ( rit == current.end() || ( lit != _repoSpans.end() && *lit < *rit ) )
+        {
+          _dirtyRanges.push_back( std::make_pair( lit->begin, lit->end ) ); // removed
+          ++lit;
+        }
+        else if ( lit == _repoSpans.end() || *rit < *lit )
+        {
+          _dirtyRanges.push_back( std::make_pair( rit->begin, rit->end ) ); // added
+          ++rit;
+        }
+        else
+        {
+          if ( ! ( *lit == *rit ) )
+          {
+            _dirtyRanges.push_back( std::make_pair( lit->begin, lit->end ) ); // changed
+            _dirtyRanges.push_back( std::make_pair( rit->begin, rit->end ) );
+          }
+          ++lit;
+          ++rit;
+        }
+      }
+      _repoSpans.swap( current );
+
+      // Merge overlapping ranges, so no id is looked at twice.
+      std::sort( _dirtyRanges.begin(), _dirtyRanges.end() );
+      IdRanges merged;
+      for_( it, _dirtyRanges.begin(), _dirtyRanges.end() )
+      {
+        if ( it->first >= it->second )
+          continue;
+        if ( merged.empty() || merged.back().second < it->first )
+          merged.push_back( *it );
+        else if ( merged.back().second < it->second )
+          merged.back().second = it->second;
+      }
+      _dirtyRanges.swap( merged );
+      DBG << "Changed solvable ranges: " << _dirtyRanges.size() << endl;
+    }
+
     /////////////////////////////////////////////////////////////////
   } // namespace pool
   ///////////////////////////////////////////////////////////////////
@@ -13,6 +13,7 @@
 #define ZYPP_POOL_POOLIMPL_H
 
 #include <iosfwd>
+#include <algorithm>
 
 #include "zypp/base/Easy.h"
 #include "zypp/base/LogTools.h"
@@ -20,6 +21,7 @@
 #include "zypp/APIConfig.h"
 
 #include "zypp/pool/PoolTraits.h"
+#include "zypp/pool/HardLockMatcher.h"
 #include "zypp/ResPoolProxy.h"
 #include "zypp/PoolQueryResult.h"
 
@@ -190,11 +192,17 @@ namespace zypp
       public:
         ResPoolProxy proxy( ResPool self ) const
         {
-          checkSerial();
+          store(); // collects the changed idents
           if ( !_poolProxy )
           {
             _poolProxy.reset( new ResPoolProxy( self, *this ) );
           }
+          else if ( ! _proxyDirtyKeys.empty() )
+          {
+            // rebuild the changed Selectables only
+            _poolProxy.reset( new ResPoolProxy( *_poolProxy, _proxyDirtyKeys, *this ) );
+          }
+          _proxyDirtyKeys.clear();
           return *_poolProxy;
         }
 
@@ -222,35 +230,45 @@ namespace zypp
         const HardLockQueries & hardLockQueries() const
         { return _hardLockQueries; }
 
-        void reapplyHardLocks() const
+        void reapplyHardLocks( const std::vector<sat::Solvable> & added_r ) const
         {
           // It is assumed that reapplyHardLocks is called after new
           // items were added to the pool, but the _hardLockQueries
           // did not change since. Action is to be performed only on
           // those items that gained the bit in the UserLockQueryField.
-          MIL << "Re-apply " << _hardLockQueries.size() << " HardLockQueries" << endl;
-          PoolQueryResult locked;
-          for_( it, _hardLockQueries.begin(), _hardLockQueries.end() )
-          {
-            locked += *it;
-          }
+          // The queries match solvables by their own attributes, so the
+          // items already in the pool can't gain it. Look at the new ones only.
+          MIL << "Re-apply " << _hardLockMatcher << " to " << added_r.size() << " new Solvables" << endl;
+          sat::SolvableSet locked;
+          _hardLockMatcher.collect( added_r, locked );
           MIL << "HardLockQueries match " << locked.size() << " Solvables." << endl;
-          for_( it, begin(), end() )
+          for_( it, locked.begin(), locked.end() )
           {
-            resstatus::UserLockQueryManip::reapplyLock( it->status(), locked.contains( *it ) );
+            resstatus::UserLockQueryManip::reapplyLock( _store[it->id()].status(), true );
           }
         }
 
         void setHardLockQueries( const HardLockQueries & newLocks_r )
         {
           MIL << "Apply " << newLocks_r.size() << " HardLockQueries" << endl;
-          _hardLockQueries = newLocks_r;
-          // now adjust the pool status
-          PoolQueryResult locked;
+          // Update the matcher by the queries removed and added.
+          HardLockQueries added( newLocks_r );
           for_( it, _hardLockQueries.begin(), _hardLockQueries.end() )
           {
-            locked += *it;
+            HardLockQueries::iterator stay( std::find( added.begin(), added.end(), *it ) );
+            if ( stay != added.end() )
+              added.erase( stay );
+            else
+              _hardLockMatcher.remove( *it );
+          }
+          for_( it, added.begin(), added.end() )
+          {
+            _hardLockMatcher.add( *it );
           }
+          _hardLockQueries = newLocks_r;
+          // now adjust the pool status
+          sat::SolvableSet locked;
+          _hardLockMatcher.collect( locked );
           MIL << "HardLockQueries match " << locked.size() << " Solvables." << endl;
           for_( it, begin(), end() )
           {
@@ -370,20 +388,35 @@ namespace zypp
           if ( _storeDirty )
           {
             sat::Pool pool( satpool() );
-            bool addedItems = false;
+            std::vector<sat::Solvable> addedItems;
+            std::vector<PoolItem> removedItems;
             std::list<PoolItem> addedProducts;
 
+            // Solvable ids are not reused, so the capacity does not shrink.
+            // But if it does, the items beyond are gone.
+            for ( SolvableIdType i = pool.capacity(); i < _store.size(); ++i )
+            {
+              if ( _store[i] )
+              {
+                removedItems.push_back( _store[i] );
+                PoolItem::erasePoolItem( _store[i] );
+              }
+            }
 	    _store.resize( pool.capacity() );
 
-            if ( pool.capacity() )
+            // Look at the solvables of the repositories changed since the last update only.
+            for_( range, _dirtyRanges.begin(), _dirtyRanges.end() )
             {
-              for ( sat::detail::SolvableIdType i = pool.capacity()-1; i != 0; --i )
+              SolvableIdType end = std::min( range->second, SolvableIdType( _store.size() ) );
+              for ( SolvableIdType i = std::max( range->first, SolvableIdType( 1 ) ); i < end; ++i )
               {
                 sat::Solvable s( i );
                 PoolItem & pi( _store[i] );
                 if ( ! s &&  pi )
                 {
                   // the PoolItem got invalidated (e.g unloaded repo)
+                  removedItems.push_back( pi );
+                  PoolItem::erasePoolItem( pi );
                   pi = PoolItem();
                 }
                 else if ( s && ! pi )
@@ -398,15 +431,48 @@ namespace zypp
                   {
                     pi.status().setSoftLock( ResStatus::USER );
                   }
-                  if ( !addedItems )
-                    addedItems = true;
+                  addedItems.push_back( s );
                 }
               }
             }
+            _dirtyRanges.clear();
             _storeDirty = false;
 
             // Now, as the pool is adjusted, ....
 
+            // .... we update the ident index and remember the
+            // changed idents for the ResPoolProxy.
+            if ( ! ( removedItems.empty() && addedItems.empty() ) )
+            {
+              for_( it, removedItems.begin(), removedItems.end() )
+              {
+                sat::detail::IdType key( id2itemKey( it->satSolvable() ) );
+                if ( ! _id2itemDirty )
+                {
+                  std::pair<Id2ItemT::iterator,Id2ItemT::iterator> range( _id2item.equal_range( key ) );
+                  for_( entry, range.first, range.second )
+                  {
+                    if ( entry->second == *it )
+                    {
+                      _id2item.erase( entry );
+                      break;
+                    }
+                  }
+                }
+                if ( _poolProxy )
+                  _proxyDirtyKeys.insert( key );
+              }
+              for_( it, addedItems.begin(), addedItems.end() )
+              {
+                sat::detail::IdType key( id2itemKey( *it ) );
+                if ( ! _id2itemDirty )
+                  _id2item.insert( std::make_pair( key, _store[it->id()] ) );
+                if ( _poolProxy )
+                  _proxyDirtyKeys.insert( key );
+              }
+              DBG << "Pool update: -" << removedItems.size() << " +" << addedItems.size() << " items" << endl;
+            }
+
             // .... we check for product buddies.
             if ( ! addedProducts.empty() )
             {
@@ -417,9 +483,9 @@ namespace zypp
             }
 
             // .... we must reapply those query based hard locks.
-            if ( addedItems )
+            if ( ! addedItems.empty() )
             {
-              reapplyHardLocks();
+              reapplyHardLocks( addedItems );
             }
           }
           return _store;
@@ -427,18 +493,13 @@ namespace zypp
 
 	const Id2ItemT & id2item () const
 	{
-	  checkSerial();
+	  store(); // updates an already built index
 	  if ( _id2itemDirty )
 	  {
-	    store();
 	    _id2item = Id2ItemT( size() );
             for_( it, begin(), end() )
             {
-              const sat::Solvable &s = (*it)->satSolvable();
-              sat::detail::IdType id = s.ident().id();
-              if ( s.isKind( ResKind::srcpackage ) )
-                id = -id;
-              _id2item.insert( std::make_pair( id, *it ) );
+              _id2item.insert( std::make_pair( id2itemKey( (*it)->satSolvable() ), *it ) );
             }
             //INT << _id2item << endl;
 	    _id2itemDirty = false;
@@ -446,6 +507,15 @@ namespace zypp
 	  return _id2item;
 	}
 
+        /** The \ref id2item key of \a solv_r (negative for srcpackages). */
+        static sat::detail::IdType id2itemKey( const sat::Solvable & solv_r )
+        {
+          sat::detail::IdType id = solv_r.ident().id();
+          if ( solv_r.isKind( ResKind::srcpackage ) )
+            id = -id;
+          return id;
+        }
+
         ///////////////////////////////////////////////////////////////////
         //
         ///////////////////////////////////////////////////////////////////
@@ -460,11 +530,36 @@ namespace zypp
         void invalidate() const
         {
           _storeDirty = true;
-	  _id2itemDirty = true;
-	  _id2item.clear();
-          _poolProxy.reset();
+          updateRepoSpans();
         }
 
+        /** A repositories solvable id range and size. */
+        struct RepoSpan
+        {
+          RepoSpan()
+          : begin( 0 ), end( 0 ), size( 0 )
+          {}
+          RepoSpan( Repository repo_r, SolvableIdType begin_r, SolvableIdType end_r, size_type size_r )
+          : repo( repo_r ), begin( begin_r ), end( end_r ), size( size_r )
+          {}
+          bool operator==( const RepoSpan & rhs ) const
+          { return repo == rhs.repo && begin == rhs.begin && end == rhs.end && size == rhs.size; }
+          bool operator<( const RepoSpan & rhs ) const
+          { return repo < rhs.repo; }
+
+          Repository     repo;
+          SolvableIdType begin;
+          SolvableIdType end;
+          size_type      size;
+        };
+        typedef std::vector<RepoSpan> RepoSpans;
+        typedef std::vector<std::pair<SolvableIdType,SolvableIdType> > IdRanges;
+
+        /** Compare the repositories to \ref _repoSpans and remember
+         * the id ranges of those added, removed or changed in \ref _dirtyRanges.
+         */
+        void updateRepoSpans() const;
+
       private:
         /** Watch sat pools serial number. */
         SerialNumberWatcher                   _watcher;
@@ -472,15 +567,23 @@ namespace zypp
         mutable DefaultIntegral<bool,true>    _storeDirty;
 	mutable Id2ItemT		      _id2item;
         mutable DefaultIntegral<bool,true>    _id2itemDirty;
+        /** Repositories as seen by the last \ref updateRepoSpans. */
+        mutable RepoSpans                     _repoSpans;
+        /** Solvable id ranges \ref store needs to look at. */
+        mutable IdRanges                      _dirtyRanges;
 
       private:
         mutable shared_ptr<ResPoolProxy>      _poolProxy;
+        /** \ref id2item keys changed since \ref _poolProxy was built. */
+        mutable PoolTraits::Id2ItemKeys       _proxyDirtyKeys;
 
       private:
         /** Set of solvable idents that should be soft locked per default. */
         AutoSoftLocks                         _autoSoftLocks;
         /** Set of queries that define hardlocks. */
         HardLockQueries                       _hardLockQueries;
+        /** The \ref _hardLockQueries compiled. */
+        HardLockMatcher                       _hardLockMatcher;
     };
     ///////////////////////////////////////////////////////////////////
 
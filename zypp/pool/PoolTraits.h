@@ -80,6 +80,8 @@ namespace zypp
       typedef P_Select2nd<Id2ItemT::value_type>         Id2ItemValueSelector;
       typedef transform_iterator<Id2ItemValueSelector, Id2ItemT::const_iterator>
                                                         byIdent_iterator;
+      /** keys in the ident index (e.g. those that changed) */
+      typedef std::tr1::unordered_set<sat::detail::IdType> Id2ItemKeys;
 
       /** list of known Repositories */
       typedef sat::Pool::RepositoryIterator	        repository_iterator;
@@ -0,0 +1,308 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/repo/ContentStore.cc
+ *
+*/
+#include <cctype>
+#include <iostream>
+#include <list>
+#include <vector>
+#include <algorithm>
+#include <mutex>
+
+#include "zypp/base/Logger.h"
+#include "zypp/base/String.h"
+#include "zypp/PathInfo.h"
+#include "zypp/ZConfig.h"
+#include "zypp/repo/ContentStore.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+  ///////////////////////////////////////////////////////////////////
+  namespace repo
+  { /////////////////////////////////////////////////////////////////
+
+    namespace
+    {
+      /** Checksums come from repo metadata; never let them escape the store. */
+      bool isHexString( const std::string & str_r )
+      {
+        if ( str_r.size() < 2 )
+          return false;
+        for_( it, str_r.begin(), str_r.end() )
+        {
+          if ( ! ( ( '0' <= *it && *it <= '9' ) || ( 'a' <= *it && *it <= 'f' ) || ( 'A' <= *it && *it <= 'F' ) ) )
+            return false;
+        }
+        return true;
+      }
+
+      bool isAlnumString( const std::string & str_r )
+      {
+        if ( str_r.empty() )
+          return false;
+        for_( it, str_r.begin(), str_r.end() )
+        {
+          if ( ! ::isalnum( *it ) )
+            return false;
+        }
+        return true;
+      }
+
+      /** A file held by the store alone. */
+      struct StoredFile
+      {
+        StoredFile( const Pathname & path_r, time_t mtime_r, off_t size_r )
+        : path( path_r ), mtime( mtime_r ), size( size_r )
+        {}
+        Pathname path;
+        time_t   mtime;
+        off_t    size;
+      };
+
+      inline bool olderThan( const StoredFile & lhs, const StoredFile & rhs )
+      { return lhs.mtime < rhs.mtime; }
+    } // namespace
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class ContentStore::Impl
+    /// \brief ContentStore implementation.
+    ///////////////////////////////////////////////////////////////////
+    class ContentStore::Impl : private base::NonCopyable
+    {
+    public:
+      Impl( const Pathname & root_r, const ByteCount & limit_r )
+      : _root( root_r )
+      , _limit( limit_r )
+      , _estimate( -1 )
+      {}
+
+    public:
+      Pathname path( const CheckSum & checksum_r ) const
+      {
+        if ( ! _limit || checksum_r.empty() )
+          return Pathname();
+        std::string type( str::toLower( checksum_r.type() ) );
+        std::string sum( str::toLower( checksum_r.checksum() ) );
+        if ( ! isAlnumString( type ) || ! isHexString( sum ) )
+          return Pathname();
+        return _root / type / sum.substr( 0, 2 ) / sum;
+      }
+
+      bool provide( const CheckSum & checksum_r, const Pathname & dest_r ) const
+      {
+        Pathname file( path( checksum_r ) );
+        if ( file.empty() )
+          return false;
+
+        std::unique_lock<std::mutex> lock( _mutex );
+        if ( ! PathInfo( file ).isFile() )
+          return false;
+
+        Pathname part( dest_r.extend( ".part" ) );
+        if ( filesystem::assert_dir( dest_r.dirname() ) != 0
+             || filesystem::hardlinkCopy( file, part ) != 0
+             || filesystem::rename( part, dest_r ) != 0 )
+        {
+          filesystem::unlink( part );
+          WAR << "Can't provide " << dest_r << " from " << file << endl;
+          return false;
+        }
+        filesystem::touch( file );	// recently used
+        MIL << "Provided " << dest_r << " from " << file << endl;
+        return true;
+      }
+
+      bool insert( const CheckSum & checksum_r, const Pathname & file_r )
+      {
+        Pathname file( path( checksum_r ) );
+        if ( file.empty() )
+          return false;
+
+        std::unique_lock<std::mutex> lock( _mutex );
+        if ( PathInfo( file ).isFile() )
+        {
+          filesystem::touch( file );	// recently used
+          return true;
+        }
+
+        PathInfo pi( file_r );
+        if ( ! pi.isFile() )
+          return false;
+
+        Pathname part( file.extend( ".part" ) );
+        if ( filesystem::assert_dir( file.dirname() ) != 0
+             || filesystem::hardlinkCopy( file_r, part ) != 0
+             || filesystem::rename( part, file ) != 0 )
+        {
+          filesystem::unlink( part );
+          WAR << "Can't store " << file_r << " as " << file << endl;
+          return false;
+        }
+        DBG << "Stored " << file_r << " as " << file << endl;
+
+        // Rather overestimate the size: the file will be held by the
+        // store alone once the repo cache drops it.
+        if ( _estimate >= 0 )
+          _estimate += pi.size();
+        if ( _estimate < 0 || _estimate > _limit )
+          evictLocked();
+        return true;
+      }
+
+      void evict()
+      {
+        std::unique_lock<std::mutex> lock( _mutex );
+        evictLocked();
+      }
+
+      ByteCount size() const
+      {
+        std::unique_lock<std::mutex> lock( _mutex );
+        std::vector<StoredFile> files;
+        return scan( files );
+      }
+
+      const Pathname & root() const
+      { return _root; }
+
+      const ByteCount & limit() const
+      { return _limit; }
+
+    private:
+      /** Collect the files held by the store alone, return their total size. */
+      ByteCount::SizeType scan( std::vector<StoredFile> & files_r ) const
+      {
+        ByteCount::SizeType ret = 0;
+        std::list<std::string> types;
+        filesystem::readdir( types, _root, false );
+        for_( type, types.begin(), types.end() )
+        {
+          std::list<std::string> prefixes;
+          filesystem::readdir( prefixes, _root / *type, false );
+          for_( prefix, prefixes.begin(), prefixes.end() )
+          {
+            Pathname dir( _root / *type / *prefix );
+            std::list<std::string> names;
+            filesystem::readdir( names, dir, false );
+            for_( name, names.begin(), names.end() )
+            {
+              PathInfo pi( dir / *name, PathInfo::LSTAT );
+              if ( ! pi.isFile() || pi.nlink() != 1 )
+                continue;
+              if ( str::hasSuffix( *name, ".part" ) )
+              {
+                // leftover of an interrupted insert
+                filesystem::unlink( pi.path() );
+                continue;
+              }
+              files_r.push_back( StoredFile( pi.path(), pi.mtime(), pi.size() ) );
+              ret += pi.size();
+            }
+          }
+        }
+        return ret;
+      }
+
+      void evictLocked()
+      {
+        std::vector<StoredFile> files;
+        _estimate = scan( files );
+        if ( _estimate <= _limit )
+          return;
+
+        std::sort( files.begin(), files.end(), olderThan );
+        unsigned removed = 0;
+        for_( it, files.begin(), files.end() )
+        {
+          if ( _estimate <= _limit )
+            break;
+          if ( filesystem::unlink( it->path ) == 0 )
+          {
+            _estimate -= it->size;
+            ++removed;
+          }
+        }
+        MIL << "Evicted " << removed << " files from " << _root << " (" << ByteCount( _estimate ) << " left)" << endl;
+      }
+
+    private:
+      Pathname		_root;
+      ByteCount		_limit;
+      ByteCount::SizeType	_estimate;	///< size of files held by the store alone (-1 if unknown)
+      mutable std::mutex	_mutex;
+    };
+    ///////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	CLASS NAME : ContentStore
+    //
+    ///////////////////////////////////////////////////////////////////
+
+    ContentStore & ContentStore::instance()
+    {
+      static ContentStore _instance( ZConfig::instance().repoCachePath() / "content",
+                                     ByteCount( ZConfig::instance().repo_contentStore_size(), ByteCount::MB ) );
+      return _instance;
+    }
+
+    ContentStore::ContentStore( const Pathname & root_r, const ByteCount & limit_r )
+    : _pimpl( new Impl( root_r, limit_r ) )
+    {}
+
+    ContentStore::~ContentStore()
+    {}
+
+    bool ContentStore::enabled() const
+    { return _pimpl->limit() != 0; }
+
+    const Pathname & ContentStore::root() const
+    { return _pimpl->root(); }
+
+    const ByteCount & ContentStore::limit() const
+    { return _pimpl->limit(); }
+
+    Pathname ContentStore::path( const CheckSum & checksum_r ) const
+    { return _pimpl->path( checksum_r ); }
+
+    bool ContentStore::contains( const CheckSum & checksum_r ) const
+    {
+      Pathname file( path( checksum_r ) );
+      return ! file.empty() && PathInfo( file ).isFile();
+    }
+
+    bool ContentStore::provide( const CheckSum & checksum_r, const Pathname & dest_r ) const
+    { return _pimpl->provide( checksum_r, dest_r ); }
+
+    bool ContentStore::insert( const CheckSum & checksum_r, const Pathname & file_r )
+    { return _pimpl->insert( checksum_r, file_r ); }
+
+    void ContentStore::evict()
+    { _pimpl->evict(); }
+
+    ByteCount ContentStore::size() const
+    { return _pimpl->size(); }
+
+    std::ostream & operator<<( std::ostream & str, const ContentStore & obj )
+    {
+      if ( ! obj.enabled() )
+        return str << "ContentStore(disabled)";
+      return str << "ContentStore(" << obj.root() << ", limit " << obj.limit() << ")";
+    }
+
+    /////////////////////////////////////////////////////////////////
+  } // namespace repo
+  ///////////////////////////////////////////////////////////////////
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,121 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/repo/ContentStore.h
+ *
+*/
+#ifndef ZYPP_REPO_CONTENTSTORE_H
+#define ZYPP_REPO_CONTENTSTORE_H
+
+#include <iosfwd>
+
+#include "zypp/base/NonCopyable.h"
+#include "zypp/base/PtrTypes.h"
+#include "zypp/ByteCount.h"
+#include "zypp/CheckSum.h"
+#include "zypp/Pathname.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+  ///////////////////////////////////////////////////////////////////
+  namespace repo
+  { /////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class ContentStore
+    /// \brief Content addressed file cache shared by all repositories.
+    ///
+    /// Files are stored as <tt>root/type/xx/checksum</tt>, where \c xx
+    /// are the first two digits of the checksum. The \ref Fetcher and the
+    /// \ref PackageProvider look up downloaded files there by their
+    /// checksum, so a package or metadata file available in several
+    /// repositories (mirrored or overlapping repos) is downloaded once.
+    ///
+    /// Files are hardlinked into the per repository caches and vice versa
+    /// (or copied, if on a different file system). A file is held by the
+    /// store alone if its link count is \c 1. Those files are removed
+    /// least recently used first, if their total size exceeds \ref limit.
+    ///
+    /// The process wide \ref instance is located in \c content in the
+    /// \ref ZConfig::repoCachePath, its limit is \ref ZConfig::repo_contentStore_size.
+    /// A store with limit \c 0 is disabled; all lookups fail and nothing
+    /// is stored. All methods are thread safe.
+    ///////////////////////////////////////////////////////////////////
+    class ContentStore : private base::NonCopyable
+    {
+      friend std::ostream & operator<<( std::ostream & str, const ContentStore & obj );
+
+    public:
+      /** The process wide store. */
+      static ContentStore & instance();
+
+      /** Ctor using the store at \a root_r limited to \a limit_r. */
+      ContentStore( const Pathname & root_r, const ByteCount & limit_r );
+
+      ~ContentStore();
+
+    public:
+      /** Whether the store is enabled (\ref limit not \c 0). */
+      bool enabled() const;
+
+      /** The stores root directory. */
+      const Pathname & root() const;
+
+      /** Max. size of the files held by the store alone. */
+      const ByteCount & limit() const;
+
+      /** Path of the file with \a checksum_r in the store.
+       * Empty if the store is disabled or \a checksum_r is not usable
+       * as store key (empty or not a hex string).
+       */
+      Pathname path( const CheckSum & checksum_r ) const;
+
+      /** Whether a file with \a checksum_r is in the store. */
+      bool contains( const CheckSum & checksum_r ) const;
+
+      /** Hardlink (or copy) the file with \a checksum_r to \a dest_r.
+       * An existing \a dest_r is replaced.
+       * \return \c false if not in store or if \a dest_r can't be written.
+       */
+      bool provide( const CheckSum & checksum_r, const Pathname & dest_r ) const;
+
+      /** Remember \a file_r as the file with \a checksum_r.
+       * \note The caller must have verified the checksum of \a file_r.
+       * Evicts old files if the store grows beyond its \ref limit.
+       * \return \c false if the store is disabled or the file can't be stored.
+       */
+      bool insert( const CheckSum & checksum_r, const Pathname & file_r );
+
+      /** Remove files held by the store alone, least recently used
+       * first, until they don't exceed \ref limit.
+       */
+      void evict();
+
+      /** Total size of the files held by the store alone. */
+      ByteCount size() const;
+
+    public:
+      /** Implementation. */
+      class Impl;
+    private:
+      /** Pointer to implementation. */
+      RW_pointer<Impl> _pimpl;
+    };
+    ///////////////////////////////////////////////////////////////////
+
+    /** \relates ContentStore Stream output */
+    std::ostream & operator<<( std::ostream & str, const ContentStore & obj );
+
+    /////////////////////////////////////////////////////////////////
+  } // namespace repo
+  ///////////////////////////////////////////////////////////////////
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_REPO_CONTENTSTORE_H
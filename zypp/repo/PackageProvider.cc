@@ -18,6 +18,7 @@
 #include "zypp/base/NonCopyable.h"
 #include "zypp/repo/PackageProvider.h"
 #include "zypp/repo/Applydeltarpm.h"
+#include "zypp/repo/ContentStore.h"
 #include "zypp/repo/PackageDelta.h"
 
 #include "zypp/TmpPath.h"
@@ -186,7 +187,12 @@ namespace zypp
       ProvideFilePolicy policy;
       policy.progressCB( bind( &Base::progressPackageDownload, this, _1 ) );
       policy.failOnChecksumErrorCB( bind( &Base::failOnChecksumError, this ) );
-      return _access.provideFile( _package->repoInfo(), loc, policy );
+      ret = _access.provideFile( _package->repoInfo(), loc, policy );
+
+      // provideFile verified the checksum; share the package with other repos
+      if ( ! loc.checksum().empty() )
+        ContentStore::instance().insert( loc.checksum(), ret );
+      return ret;
     }
 
     ///////////////////////////////////////////////////////////////////
@@ -310,6 +316,10 @@ namespace zypp
       OnMediaLocation loc( _package->location() );
       PathInfo cachepath( info.packagesPath() / loc.filename() );
 
+      // not in the repos cache, but maybe downloaded for some other repo
+      if ( ! cachepath.isExist() && ContentStore::instance().provide( loc.checksum(), cachepath.path() ) )
+        cachepath();
+
       if ( cachepath.isFile() && ! loc.checksum().empty() ) // accept cache hit with matching checksum only!
              // Tempting to do a quick check for matching .rpm-filesize before computing checksum,
       // but real life shows that loc.downloadSize() and the .rpm-filesize frequently do not
@@ -318,6 +328,7 @@ namespace zypp
 	CheckSum cachechecksum( loc.checksum().type(), filesystem::checksum( cachepath.path(), loc.checksum().type() ) );
 	if ( cachechecksum == loc.checksum() )
 	{
+	  ContentStore::instance().insert( loc.checksum(), cachepath.path() );
 	  return ManagedFile( cachepath.path() );  // <-- cache hit
 	}
       }
@@ -391,6 +402,8 @@ namespace zypp
 
       // build the package and put it into the cache
       Pathname destination( _package->repoInfo().packagesPath() / _package->location().filename() );
+      // An old file may be a hardlink to the ContentStore; don't overwrite it in place.
+      filesystem::unlink( destination );
 
       if ( ! applydeltarpm::provide( delta, destination,
                                      bind( &RpmPackageProvider::progressDeltaApply, this, _1 ) ) )
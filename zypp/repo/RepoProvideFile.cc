@@ -324,9 +324,7 @@ namespace zypp
           }
           else
           {
-            std::ifstream input( ret->asString().c_str() );
-            CheckSum retChecksum( loc_r.checksum().type(), input );
-            input.close();
+            CheckSum retChecksum( loc_r.checksum().type(), filesystem::checksum( *ret, loc_r.checksum().type() ) );
 
             if ( loc_r.checksum() != retChecksum )
             {
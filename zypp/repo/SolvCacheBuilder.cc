@@ -0,0 +1,431 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file zypp/repo/SolvCacheBuilder.cc
+ */
+#include <cstdio>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+extern "C"
+{
+#include <solv/pool.h>
+#include <solv/repo.h>
+#include <solv/knownid.h>
+#include <solv/solvversion.h>
+#include <solv/repo_write.h>
+#include <solv/solv_xfopen.h>
+#include <solv/repo_repomdxml.h>
+#include <solv/repo_rpmmd.h>
+#include <solv/repo_updateinfoxml.h>
+#include <solv/repo_deltainfoxml.h>
+#include <solv/repo_content.h>
+#include <solv/repo_susetags.h>
+#include <solv/repo_rpmdb.h>
+}
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/Gettext.h"
+#include "zypp/base/String.h"
+#include "zypp/base/NonCopyable.h"
+#include "zypp/PathInfo.h"
+#include "zypp/ExternalProgram.h"
+#include "zypp/repo/RepoException.h"
+#include "zypp/repo/SolvCacheBuilder.h"
+
+using std::endl;
+
+#undef  ZYPP_BASE_LOGGER_LOGGROUP
+#define ZYPP_BASE_LOGGER_LOGGROUP "zypp::repo::SolvCacheBuilder"
+
+//////////////////////////////////////////////////////////////////////
+namespace zypp
+{ ////////////////////////////////////////////////////////////////////
+  ////////////////////////////////////////////////////////////////////
+  namespace repo
+  { //////////////////////////////////////////////////////////////////
+
+    namespace
+    {
+      ///////////////////////////////////////////////////////////////////
+      /// \class PrivatePool
+      /// \brief A private libsolv pool holding the one repo to write.
+      ///////////////////////////////////////////////////////////////////
+      struct PrivatePool : private base::NonCopyable
+      {
+        PrivatePool()
+        : _pool( ::pool_create() )
+        , _repo( ::repo_create( _pool, "solvcache" ) )
+        {}
+
+        ~PrivatePool()
+        { ::pool_free( _pool ); }
+
+        /** Throw RepoException if \a ret_r indicates a failure. */
+        void assertOk( int ret_r, const Pathname & file_r ) const
+        {
+          if ( ret_r != 0 )
+          {
+            RepoException ex( str::form( _("Failed to cache repo (%d)."), ret_r ) );
+            ex.remember( file_r.asString() + ": " + ::pool_errstr( _pool ) );
+            ZYPP_THROW( ex );
+          }
+        }
+
+        ::Pool * _pool;
+        ::Repo * _repo;
+      };
+
+      ///////////////////////////////////////////////////////////////////
+      /// \class SolvFile
+      /// \brief A (maybe compressed) metadata file opened for reading.
+      ///////////////////////////////////////////////////////////////////
+      struct SolvFile : private base::NonCopyable
+      {
+        SolvFile( const Pathname & file_r )
+        : _file( file_r )
+        , _fp( ::solv_xfopen( file_r.c_str(), "r" ) )
+        {
+          if ( ! _fp )
+          {
+            RepoException ex( str::form( _("Can't open file '%s' for reading."), file_r.c_str() ) );
+            ZYPP_THROW( ex );
+          }
+        }
+
+        ~SolvFile()
+        { ::fclose( _fp ); }
+
+        Pathname _file;
+        FILE * _fp;
+      };
+
+      /** Return \a file_r or \a file_r.gz, whichever exists; or an empty Pathname. */
+      Pathname existingFile( const Pathname & file_r )
+      {
+        if ( PathInfo( file_r ).isFile() )
+          return file_r;
+        Pathname gz( file_r.extend( ".gz" ) );
+        if ( PathInfo( gz ).isFile() )
+          return gz;
+        return Pathname();
+      }
+
+      /** The location of the \c repomd.xml entry of type \a type_r; or an empty Pathname. */
+      Pathname repomdLocation( const PrivatePool & pool_r, const char * type_r )
+      {
+        Pathname ret;
+        ::Dataiterator di;
+        ::dataiterator_init( &di, pool_r._pool, pool_r._repo, SOLVID_META, REPOSITORY_REPOMD_TYPE, type_r, SEARCH_STRING );
+        ::dataiterator_prepend_keyname( &di, REPOSITORY_REPOMD );
+        if ( ::dataiterator_step( &di ) )
+        {
+          ::dataiterator_setpos_parent( &di );
+          const char * location = ::pool_lookup_str( pool_r._pool, SOLVID_POS, REPOSITORY_REPOMD_LOCATION );
+          if ( location )
+            ret = location;
+        }
+        ::dataiterator_free( &di );
+        return ret;
+      }
+
+      /** The types of all \c repomd.xml entries, in file order. */
+      std::vector<std::string> repomdTypes( const PrivatePool & pool_r )
+      {
+        std::vector<std::string> ret;
+        ::Dataiterator di;
+        ::dataiterator_init( &di, pool_r._pool, pool_r._repo, SOLVID_META, REPOSITORY_REPOMD_TYPE, 0, 0 );
+        ::dataiterator_prepend_keyname( &di, REPOSITORY_REPOMD );
+        while ( ::dataiterator_step( &di ) )
+        {
+          const char * type = ::repodata_stringify( pool_r._pool, di.data, di.key, &di.kv, 0 );
+          if ( type )
+            ret.push_back( type );
+        }
+        ::dataiterator_free( &di );
+        return ret;
+      }
+
+      /** Parse rpm-md metadata below \a metadata_r.
+       * \return \c false if the repo contains data we don't parse (appdata),
+       * so the cache must be built by \c repo2solv.sh.
+       */
+      bool addRpmmd( PrivatePool & pool_r, const Pathname & metadata_r )
+      {
+        Pathname repomd( metadata_r / "repodata/repomd.xml" );
+        {
+          SolvFile file( repomd );
+          pool_r.assertOk( ::repo_add_repomdxml( pool_r._repo, file._fp, 0 ), file._file );
+        }
+
+        // Order as in repo2solv.sh: primary first, as the others extend its solvables.
+        std::vector<std::string> present( repomdTypes( pool_r ) );
+        if ( std::find( present.begin(), present.end(), "appdata" ) != present.end() )
+          return false;
+        std::vector<std::string> types;
+        types.push_back( "suseinfo" );
+        types.push_back( "primary" );
+        types.push_back( "susedata" );
+        for ( const std::string & type : present )
+        {
+          if ( str::hasPrefix( type, "susedata." ) )
+            types.push_back( type );	// translations
+        }
+        static const char * more[] = { "patterns", "products", "product", "updateinfo", "deltainfo", "prestodelta", 0 };
+        for ( const char ** type = more; *type; ++type )
+          types.push_back( *type );
+
+        for ( const std::string & kind : types )
+        {
+          Pathname location( repomdLocation( pool_r, kind.c_str() ) );
+          if ( location.empty() )
+          {
+            if ( kind == "primary" )
+            {
+              RepoException ex( str::form( _("Failed to cache repo (%d)."), 1 ) );
+              ex.remember( repomd.asString() + ": no primary" );
+              ZYPP_THROW( ex );
+            }
+            continue;
+          }
+
+          SolvFile file( metadata_r / location );
+          DBG << "Parsing " << kind << " " << file._file << endl;
+          int ret = 0;
+          if ( kind == "suseinfo" )
+            ret = ::repo_add_repomdxml( pool_r._repo, file._fp, 0 );
+          else if ( kind == "primary" || kind == "patterns" || kind == "products" || kind == "product" )
+            ret = ::repo_add_rpmmd( pool_r._repo, file._fp, 0, 0 );
+          else if ( kind == "susedata" )
+            ret = ::repo_add_rpmmd( pool_r._repo, file._fp, 0, REPO_EXTEND_SOLVABLES );
+          else if ( str::hasPrefix( kind, "susedata." ) )
+            ret = ::repo_add_rpmmd( pool_r._repo, file._fp, kind.c_str() + 9, REPO_EXTEND_SOLVABLES );
+          else if ( kind == "updateinfo" )
+            ret = ::repo_add_updateinfoxml( pool_r._repo, file._fp, 0 );
+          else
+            ret = ::repo_add_deltainfoxml( pool_r._repo, file._fp, 0 );
+          pool_r.assertOk( ret, file._file );
+        }
+        return true;
+      }
+
+      /** Build \a solvfile_r from \a metadata_r by running \c repo2solv.sh. */
+      void runRepo2solv( const Pathname & metadata_r, const Pathname & solvfile_r )
+      {
+        ExternalProgram::Arguments cmd;
+        cmd.push_back( "repo2solv.sh" );
+        // repo2solv expects -o as 1st arg!
+        cmd.push_back( "-o" );
+        cmd.push_back( solvfile_r.asString() );
+        cmd.push_back( metadata_r.asString() );
+
+        ExternalProgram prog( cmd, ExternalProgram::Stderr_To_Stdout );
+        std::string errdetail;
+        for ( std::string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() )
+        {
+          WAR << "  " << output;
+          if ( errdetail.empty() )
+          {
+            errdetail = prog.command();
+            errdetail += '\n';
+          }
+          errdetail += output;
+        }
+
+        int ret = prog.close();
+        if ( ret != 0 )
+        {
+          RepoException ex( str::form( _("Failed to cache repo (%d)."), ret ) );
+          ex.remember( errdetail );
+          ZYPP_THROW( ex );
+        }
+      }
+
+      /** Parse susetags metadata below \a metadata_r. */
+      void addSusetags( PrivatePool & pool_r, const Pathname & metadata_r )
+      {
+        {
+          SolvFile file( metadata_r / "content" );
+          pool_r.assertOk( ::repo_add_content( pool_r._repo, file._fp, 0 ), file._file );
+        }
+
+        const char * descr = ::repo_lookup_str( pool_r._repo, SOLVID_META, SUSETAGS_DESCRDIR );
+        Pathname descrdir( metadata_r / ( descr ? descr : "suse/setup/descr" ) );
+        ::Id defvendor = ::repo_lookup_id( pool_r._repo, SOLVID_META, SUSETAGS_DEFAULTVENDOR );
+
+        Pathname packages( existingFile( descrdir / "packages" ) );
+        if ( packages.empty() )
+        {
+          RepoException ex( str::form( _("Failed to cache repo (%d)."), 1 ) );
+          ex.remember( descrdir.asString() + ": no packages file" );
+          ZYPP_THROW( ex );
+        }
+        {
+          SolvFile file( packages );
+          pool_r.assertOk( ::repo_add_susetags( pool_r._repo, file._fp, defvendor, 0,
+                                                REPO_NO_INTERNALIZE|SUSETAGS_RECORD_SHARES ), file._file );
+        }
+
+        // packages.DU, packages.<lang> and patterns extend the packages.
+        std::list<std::string> entries;
+        filesystem::readdir( entries, descrdir, false );
+        entries.sort();
+        for ( const std::string & entry : entries )
+        {
+          std::string name( str::hasSuffix( entry, ".gz" ) ? str::stripSuffix( entry, ".gz" ) : entry );
+          if ( name == "packages" )
+            continue;
+
+          if ( str::hasPrefix( name, "packages." ) )
+          {
+            std::string lang( name.substr( 9 ) );
+            if ( lang == "FL" )
+              continue; // file lists are not cached
+            SolvFile file( descrdir / entry );
+            pool_r.assertOk( ::repo_add_susetags( pool_r._repo, file._fp, defvendor, ( lang == "DU" ? 0 : lang.c_str() ),
+                                                  REPO_NO_INTERNALIZE|REPO_REUSE_REPODATA|REPO_EXTEND_SOLVABLES ), file._file );
+          }
+          else if ( str::hasSuffix( name, ".pat" ) )
+          {
+            SolvFile file( descrdir / entry );
+            pool_r.assertOk( ::repo_add_susetags( pool_r._repo, file._fp, defvendor, 0,
+                                                  REPO_NO_INTERNALIZE ), file._file );
+          }
+        }
+        ::repo_internalize( pool_r._repo );
+      }
+
+      /** Collect all rpms below \a dir_r (recursive), relative to \a root_r. */
+      void collectRpms( const Pathname & root_r, const Pathname & dir_r, std::vector<std::string> & rpms_r )
+      {
+        filesystem::DirContent content;
+        filesystem::readdir( content, root_r / dir_r, false );
+        for ( const filesystem::DirEntry & entry : content )
+        {
+          Pathname rel( dir_r / entry.name );
+          if ( entry.type == filesystem::FT_DIR )
+            collectRpms( root_r, rel, rpms_r );
+          else if ( str::hasSuffix( entry.name, ".rpm" )
+                    && ! str::hasSuffix( entry.name, ".delta.rpm" )
+                    && ! str::hasSuffix( entry.name, ".patch.rpm" ) )
+            rpms_r.push_back( rel.asString().substr( 1 ) ); // strip leading /
+        }
+      }
+
+      /** Read the headers of all rpms below \a metadata_r. */
+      void addPlaindir( PrivatePool & pool_r, const Pathname & metadata_r )
+      {
+        std::vector<std::string> rpms;
+        collectRpms( metadata_r, "/", rpms );
+        std::sort( rpms.begin(), rpms.end() );
+
+        ::Repodata * data = ::repo_add_repodata( pool_r._repo, 0 );
+        for ( const std::string & rpm : rpms )
+        {
+          Pathname file( metadata_r / rpm );
+          ::Id p = ::repo_add_rpm( pool_r._repo, file.c_str(), REPO_REUSE_REPODATA|REPO_NO_INTERNALIZE );
+          if ( ! p )
+          {
+            // like rpms2solv: a broken rpm does not spoil the repo
+            WAR << "Skip " << file << ": " << ::pool_errstr( pool_r._pool ) << endl;
+            continue;
+          }
+          ::repodata_set_location( data, p, 0, 0, rpm.c_str() );
+        }
+        ::repo_internalize( pool_r._repo );
+      }
+    } // namespace
+
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	CLASS NAME : SolvCacheBuilder
+    //
+    ///////////////////////////////////////////////////////////////////
+
+    SolvCacheBuilder::SolvCacheBuilder( const RepoType & type_r, const Pathname & metadata_r )
+    : _type( type_r )
+    , _metadata( metadata_r )
+    {}
+
+    void SolvCacheBuilder::build( const Pathname & solvfile_r ) const
+    {
+      MIL << "Building " << solvfile_r << " from " << *this << endl;
+      PrivatePool pool;
+
+      switch ( _type.toEnum() )
+      {
+        case RepoType::RPMMD_e:
+          if ( ! addRpmmd( pool, _metadata ) )
+          {
+            Pathname tmpfile( solvfile_r.extend( ".new" ) );
+            MIL << "Using repo2solv.sh for " << _metadata << endl;
+            try
+            {
+              runRepo2solv( _metadata, tmpfile );
+            }
+            catch ( const Exception & excpt )
+            {
+              filesystem::unlink( tmpfile );
+              ZYPP_RETHROW( excpt );
+            }
+            if ( filesystem::rename( tmpfile, solvfile_r ) != 0 )
+            {
+              filesystem::unlink( tmpfile );
+              RepoException ex( str::form( _("Can't write cache at %s."), solvfile_r.c_str() ) );
+              ZYPP_THROW( ex );
+            }
+            return;
+          }
+          break;
+        case RepoType::YAST2_e:
+          addSusetags( pool, _metadata );
+          break;
+        case RepoType::RPMPLAINDIR_e:
+          addPlaindir( pool, _metadata );
+          break;
+        default:
+          ZYPP_THROW( RepoUnknownTypeException( _("Unhandled repository type") ) );
+          break;
+      }
+
+      // Like the libsolv tools do; solv files without are rebuilt when loaded.
+      ::Repodata * info = ::repo_add_repodata( pool._repo, 0 );
+      ::repodata_set_str( info, SOLVID_META, REPOSITORY_TOOLVERSION, LIBSOLV_TOOLVERSION );
+      ::repodata_internalize( info );
+
+      Pathname tmpfile( solvfile_r.extend( ".new" ) );
+      FILE * fp = ::fopen( tmpfile.c_str(), "w" );
+      if ( ! fp )
+      {
+        RepoException ex( str::form( _("Can't open file '%s' for writing."), tmpfile.c_str() ) );
+        ZYPP_THROW( ex );
+      }
+      ::repo_write( pool._repo, fp );
+      bool failed = ::ferror( fp );
+      if ( ::fclose( fp ) != 0 || failed
+           || filesystem::rename( tmpfile, solvfile_r ) != 0 )
+      {
+        filesystem::unlink( tmpfile );
+        RepoException ex( str::form( _("Can't write cache at %s."), solvfile_r.c_str() ) );
+        ZYPP_THROW( ex );
+      }
+      MIL << "Built " << solvfile_r << " (" << pool._repo->nsolvables << " solvables)" << endl;
+    }
+
+    std::ostream & operator<<( std::ostream & str, const SolvCacheBuilder & obj )
+    {
+      return str << "SolvCacheBuilder(" << obj.type() << ":" << obj.metadata() << ")";
+    }
+
+    //////////////////////////////////////////////////////////////////
+  } // namespace repo
+  ////////////////////////////////////////////////////////////////////
+  ////////////////////////////////////////////////////////////////////
+} // namespace zypp
+//////////////////////////////////////////////////////////////////////
@@ -0,0 +1,95 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file zypp/repo/SolvCacheBuilder.h
+ */
+#ifndef ZYPP_REPO_SOLVCACHEBUILDER_H
+#define ZYPP_REPO_SOLVCACHEBUILDER_H
+
+#include <iosfwd>
+
+#include "zypp/Pathname.h"
+#include "zypp/repo/RepoType.h"
+
+//////////////////////////////////////////////////////////////////////
+namespace zypp
+{ ////////////////////////////////////////////////////////////////////
+  ////////////////////////////////////////////////////////////////////
+  namespace repo
+  { //////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class SolvCacheBuilder
+    /// \brief Parse raw repo metadata and write the solv file.
+    ///
+    /// Does in-process what \c repo2solv.sh did: The metadata are parsed
+    /// by the libsolv parsers into a private libsolv pool, and the repo
+    /// is written to the solv file. Handles \ref RepoType::RPMMD,
+    /// \ref RepoType::YAST2 and \ref RepoType::RPMPLAINDIR.
+    ///
+    /// For rpm-md \c repomd.xml, \c suseinfo, \c primary, \c susedata and
+    /// its translations, \c patterns, \c products, \c updateinfo and
+    /// \c deltainfo are parsed. Repos providing \c appdata are still built
+    /// by running \c repo2solv.sh.
+    ///
+    /// As the global \ref sat::Pool is not involved, building the cache
+    /// is safe to be done in a \ref thread::WorkerPool thread.
+    ///
+    /// \code
+    ///   SolvCacheBuilder( RepoType::RPMMD, rawdir ).build( cachedir/"solv" );
+    /// \endcode
+    ///////////////////////////////////////////////////////////////////
+    class SolvCacheBuilder
+    {
+      friend std::ostream & operator<<( std::ostream & str, const SolvCacheBuilder & obj );
+
+    public:
+      /** Ctor taking the repo type and the metadata location.
+       * For \ref RepoType::RPMPLAINDIR \a metadata_r is the directory
+       * which is recursively scanned for rpm files. Otherwise it's the
+       * repos raw metadata cache (the dir containing \c repodata/ or
+       * \c content).
+       */
+      SolvCacheBuilder( const RepoType & type_r, const Pathname & metadata_r );
+
+    public:
+      /** The repo type. */
+      const RepoType & type() const
+      { return _type; }
+
+      /** The metadata location. */
+      const Pathname & metadata() const
+      { return _metadata; }
+
+    public:
+      /** Build the solv file \a solvfile_r.
+       * The file is written to a temporary file which is renamed to
+       * \a solvfile_r on success, so an existing \a solvfile_r is
+       * never left in a broken state.
+       * \throws RepoUnknownTypeException if the type is not supported.
+       * \throws RepoException if parsing the metadata or writing the
+       * solv file fails.
+       */
+      void build( const Pathname & solvfile_r ) const;
+
+    private:
+      RepoType _type;
+      Pathname _metadata;
+    };
+
+    /** \relates SolvCacheBuilder Stream output */
+    std::ostream & operator<<( std::ostream & str, const SolvCacheBuilder & obj );
+
+    //////////////////////////////////////////////////////////////////
+  } // namespace repo
+  ////////////////////////////////////////////////////////////////////
+  ////////////////////////////////////////////////////////////////////
+} // namespace zypp
+//////////////////////////////////////////////////////////////////////
+
+#endif // ZYPP_REPO_SOLVCACHEBUILDER_H
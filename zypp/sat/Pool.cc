@@ -164,6 +164,12 @@ namespace zypp
       return ret;
     }
 
+    void Pool::setSolvFileCache( Repository repo_r, const Pathname & file_r )
+    {
+      if ( repo_r )
+        myPool().setSolvFileCache( repo_r.get(), file_r );
+    }
+
     /////////////////////////////////////////////////////////////////
 
     Repository Pool::addRepoHelix( const Pathname & file_r, const std::string & alias_r )
@@ -122,6 +122,14 @@ namespace zypp
         */
         Repository addRepoSolv( const Pathname & file_r, const RepoInfo & info_r );
 
+        /** Remember \a file_r as the solv-file cache \a repo_r was loaded from.
+         * If \ref prepare has to add file provides to \a repo_r, \a file_r is
+         * rewritten to include them. A process loading the rewritten file can
+         * skip searching the file lists, the most expensive part of \ref prepare.
+         * The file is rebuilt anyway when the repositories \ref RepoStatus changes.
+         */
+        void setSolvFileCache( Repository repo_r, const Pathname & file_r );
+
       public:
         /** Load \ref Solvables from a helix-file into a \ref Repository named \c name_r.
          * Supports loading of gzip compressed files (.gz). In case of an exception
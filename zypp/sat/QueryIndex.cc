@@ -0,0 +1,270 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/sat/QueryIndex.cc
+ *
+*/
+#include <ctype.h>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <iterator>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/Easy.h"
+#include "zypp/base/StrMatcher.h"
+#include "zypp/base/SerialNumber.h"
+#include "zypp/base/Measure.h"
+
+#include "zypp/sat/QueryIndex.h"
+#include "zypp/sat/LookupAttr.h"
+#include "zypp/sat/Pool.h"
+#include "zypp/sat/Solvable.h"
+
+#undef ZYPP_BASE_LOGGER_LOGGROUP
+#define ZYPP_BASE_LOGGER_LOGGROUP "PoolQuery"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+  ///////////////////////////////////////////////////////////////////
+  namespace sat
+  { /////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    { /////////////////////////////////////////////////////////////////
+
+      /** The indexed attributes. */
+      const SolvAttr & indexedAttr( unsigned idx_r )
+      {
+        static const SolvAttr attrs[] = {
+          SolvAttr::name,
+          SolvAttr::summary,
+          SolvAttr::provides,
+        };
+        return attrs[idx_r];
+      }
+      const unsigned indexedAttrs = 3;
+
+      inline unsigned trigram( const char * p )
+      {
+        return ( unsigned(::tolower( (unsigned char)p[0] )) << 16 )
+             | ( unsigned(::tolower( (unsigned char)p[1] )) << 8 )
+             |   unsigned(::tolower( (unsigned char)p[2] ));
+      }
+
+      /** Append the trigrams of \a val_r to \a result_r. */
+      void addTrigrams( const char * val_r, std::string::size_type len_r, std::vector<unsigned> & result_r )
+      {
+        for ( std::string::size_type i = 0; i + 3 <= len_r; ++i )
+          result_r.push_back( trigram( val_r + i ) );
+      }
+
+      /** The trigrams a value matched by \a matcher_r must contain (sorted, unique).
+       * These are the trigrams of the literal parts of the searchstring. A glob
+       * is split at the wildcards (and escapes). As the content of a bracket
+       * expression is hard to tell, the pattern is not evaluated beyond a \c '['.
+       */
+      std::vector<unsigned> requiredTrigrams( const StrMatcher & matcher_r )
+      {
+        std::vector<unsigned> ret;
+        const Match & flags( matcher_r.flags() );
+        if ( ! ( flags.isModeString() || flags.isModeSubstring()
+              || flags.isModeStringstart() || flags.isModeStringend()
+              || flags.isModeGlob() ) )
+          return ret;
+
+        const std::string & sstr( matcher_r.searchstring() );
+        if ( ! flags.isModeGlob() )
+        {
+          addTrigrams( sstr.c_str(), sstr.size(), ret );
+        }
+        else
+        {
+          std::string::size_type start = 0;
+          for ( std::string::size_type i = 0; i <= sstr.size(); ++i )
+          {
+            if ( i == sstr.size() || sstr[i] == '*' || sstr[i] == '?' || sstr[i] == '\\' || sstr[i] == '[' )
+            {
+              addTrigrams( sstr.c_str() + start, i - start, ret );
+              if ( i < sstr.size() && sstr[i] == '[' )
+                break;
+              start = i + 1;
+            }
+          }
+        }
+        std::sort( ret.begin(), ret.end() );
+        ret.erase( std::unique( ret.begin(), ret.end() ), ret.end() );
+        return ret;
+      }
+
+      /////////////////////////////////////////////////////////////////
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	CLASS NAME : QueryIndex
+    //
+    ///////////////////////////////////////////////////////////////////
+
+    const QueryIndex & QueryIndex::instance()
+    {
+      static QueryIndex _index;
+      static SerialNumberWatcher _watcher;
+      if ( _watcher.remember( Pool::instance().serial() ) )
+        _index.build();
+      return _index;
+    }
+
+    bool QueryIndex::indexed( SolvAttr attr_r )
+    {
+      for ( unsigned i = 0; i < indexedAttrs; ++i )
+        if ( indexedAttr( i ) == attr_r )
+          return true;
+      return false;
+    }
+
+    bool QueryIndex::usable( const StrMatcher & matcher_r )
+    { return ! requiredTrigrams( matcher_r ).empty(); }
+
+    QueryIndex::QueryIndex()
+    : _serial( 0 )
+    {}
+
+    void QueryIndex::build()
+    {
+      _index.clear();
+      ++_serial;
+      debug::Measure m( "QueryIndex::build" );
+
+      std::vector<unsigned> grams;
+      for ( unsigned i = 0; i < indexedAttrs; ++i )
+      {
+        _index.push_back( AttrIndex( indexedAttr( i ) ) );
+        AttrIndex & idx( _index.back() );
+
+        // trigram << 32 | solvable id
+        std::vector<unsigned long long> entries;
+        LookupAttr q( idx.attr );
+        for_( it, q.begin(), q.end() )
+        {
+          const char * val = it.c_str();
+          if ( ! val )
+            continue;
+          ++idx.values;
+          grams.clear();
+          addTrigrams( val, ::strlen( val ), grams );
+          unsigned long long sid = it.inSolvable().id();
+          for_( g, grams.begin(), grams.end() )
+            entries.push_back( ( (unsigned long long)*g << 32 ) | sid );
+        }
+        std::sort( entries.begin(), entries.end() );
+        entries.erase( std::unique( entries.begin(), entries.end() ), entries.end() );
+
+        idx.ids.reserve( entries.size() );
+        for_( e, entries.begin(), entries.end() )
+        {
+          unsigned g = *e >> 32;
+          if ( idx.trigrams.empty() || idx.trigrams.back() != g )
+          {
+            idx.trigrams.push_back( g );
+            idx.offsets.push_back( idx.ids.size() );
+          }
+          idx.ids.push_back( detail::SolvableIdType( *e & 0xffffffffULL ) );
+        }
+        idx.offsets.push_back( idx.ids.size() );
+      }
+      MIL << *this << endl;
+    }
+
+    bool QueryIndex::candidates( SolvAttr attr_r, const StrMatcher & matcher_r, Candidates & result_r ) const
+    {
+      const AttrIndex * idx = 0;
+      for_( it, _index.begin(), _index.end() )
+      {
+        if ( it->attr == attr_r )
+        {
+          idx = &(*it);
+          break;
+        }
+      }
+      if ( ! idx )
+        return false;
+
+      std::vector<unsigned> grams( requiredTrigrams( matcher_r ) );
+      if ( grams.empty() )
+        return false;
+
+      // The solvable lists of all required trigrams, shortest first.
+      std::vector<std::pair<unsigned,unsigned> > lists;
+      for_( g, grams.begin(), grams.end() )
+      {
+        std::vector<unsigned>::const_iterator pos( std::lower_bound( idx->trigrams.begin(), idx->trigrams.end(), *g ) );
+        if ( pos == idx->trigrams.end() || *pos != *g )
+          return true; // no value contains the trigram: no candidates
+        unsigned n = pos - idx->trigrams.begin();
+        lists.push_back( std::make_pair( idx->offsets[n+1] - idx->offsets[n], idx->offsets[n] ) );
+      }
+      std::sort( lists.begin(), lists.end() );
+
+      Candidates found( idx->ids.begin() + lists[0].second,
+                        idx->ids.begin() + lists[0].second + lists[0].first );
+      for ( unsigned i = 1; i < lists.size() && ! found.empty(); ++i )
+      {
+        Candidates::const_iterator b( idx->ids.begin() + lists[i].second );
+        Candidates common;
+        std::set_intersection( found.begin(), found.end(), b, b + lists[i].first, std::back_inserter( common ) );
+        found.swap( common );
+      }
+
+      if ( result_r.empty() )
+        result_r.swap( found );
+      else if ( ! found.empty() )
+      {
+        Candidates merged;
+        merged.reserve( result_r.size() + found.size() );
+        std::set_union( result_r.begin(), result_r.end(), found.begin(), found.end(), std::back_inserter( merged ) );
+        result_r.swap( merged );
+      }
+      return true;
+    }
+
+    unsigned QueryIndex::size() const
+    {
+      unsigned ret = 0;
+      for_( it, _index.begin(), _index.end() )
+        ret += it->values;
+      return ret;
+    }
+
+    /******************************************************************
+    **
+    **	FUNCTION NAME : operator<<
+    **	FUNCTION TYPE : std::ostream &
+    */
+    std::ostream & operator<<( std::ostream & str, const QueryIndex & obj )
+    {
+      str << "QueryIndex(" << obj._serial << ")";
+      for_( it, obj._index.begin(), obj._index.end() )
+      {
+        str << " {" << it->attr << ": " << it->values << " values, "
+            << it->trigrams.size() << " trigrams, " << it->ids.size() << " refs}";
+      }
+      return str;
+    }
+
+    /////////////////////////////////////////////////////////////////
+  } // namespace sat
+  ///////////////////////////////////////////////////////////////////
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
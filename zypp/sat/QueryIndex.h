@@ -0,0 +1,120 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/sat/QueryIndex.h
+ *
+*/
+#ifndef ZYPP_SAT_QUERYINDEX_H
+#define ZYPP_SAT_QUERYINDEX_H
+
+#include <iosfwd>
+#include <vector>
+
+#include "zypp/base/NonCopyable.h"
+#include "zypp/sat/detail/PoolMember.h"
+#include "zypp/sat/SolvAttr.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+
+  class StrMatcher;
+
+  ///////////////////////////////////////////////////////////////////
+  namespace sat
+  { /////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class QueryIndex
+    /// \brief Trigram index over the solvables name, summary and provides.
+    ///
+    /// For each indexed attribute the index maps every 3 character
+    /// sequence (lowercased) found in the attributes values to the
+    /// sorted list of solvables containing it. A \ref StrMatcher in
+    /// mode \c STRING, \c SUBSTRING, \c STRINGSTART, \c STRINGEND or
+    /// \c GLOB can only match values containing all trigrams of its
+    /// literal parts. Intersecting their lists gives the candidates
+    /// \ref PoolQuery needs to look at.
+    ///
+    /// The candidates are a superset of the matches, the final match is
+    /// still done by \ref LookupAttr. Dependencies are indexed by name,
+    /// as this is what the \ref LookupAttr string match looks at.
+    ///
+    /// \ref instance rebuilds the index whenever the \ref sat::Pool
+    /// serial number changed since it was built. PoolQuery uses the index
+    /// if \ref ZConfig::pool_queryIndex is enabled.
+    ///////////////////////////////////////////////////////////////////
+    class QueryIndex : private base::NonCopyable
+    {
+      friend std::ostream & operator<<( std::ostream & str, const QueryIndex & obj );
+
+      public:
+        typedef std::vector<detail::SolvableIdType> Candidates;
+
+      public:
+        /** The index built for the current content of the \ref sat::Pool. */
+        static const QueryIndex & instance();
+
+        /** Whether \a attr_r is an indexed attribute. */
+        static bool indexed( SolvAttr attr_r );
+
+        /** Whether the index is able to preselect solvables for \a matcher_r.
+         * It must be in a literal or glob mode and provide at least one
+         * literal part of 3 or more characters.
+         */
+        static bool usable( const StrMatcher & matcher_r );
+
+      public:
+        /** Collect the candidates \a matcher_r may match in \a attr_r.
+         * The sorted solvable ids are added to \a result_r, which is
+         * sorted and unique afterwards. Returns \c false (and leaves
+         * \a result_r untouched) if the index can't restrict the
+         * search, e.g. if \a attr_r is not indexed or \a matcher_r
+         * is not \ref usable.
+         */
+        bool candidates( SolvAttr attr_r, const StrMatcher & matcher_r, Candidates & result_r ) const;
+
+        /** Number of indexed attribute values. */
+        unsigned size() const;
+
+      private:
+        QueryIndex();
+        /** (Re)build the index for the current pool content. */
+        void build();
+
+      private:
+        /** The trigram lists of one attribute.
+         * The solvables containing \c trigrams[i] are
+         * <tt>ids[offsets[i]] .. ids[offsets[i+1]-1]</tt>.
+         */
+        struct AttrIndex
+        {
+          AttrIndex( SolvAttr attr_r = SolvAttr::noAttr )
+          : attr( attr_r ), values( 0 )
+          {}
+          SolvAttr              attr;
+          std::vector<unsigned> trigrams;
+          std::vector<unsigned> offsets;
+          Candidates            ids;
+          unsigned              values;
+        };
+        std::vector<AttrIndex> _index;
+        unsigned _serial;
+    };
+    ///////////////////////////////////////////////////////////////////
+
+    /** \relates QueryIndex Stream output */
+    std::ostream & operator<<( std::ostream & str, const QueryIndex & obj );
+
+    /////////////////////////////////////////////////////////////////
+  } // namespace sat
+  ///////////////////////////////////////////////////////////////////
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_SAT_QUERYINDEX_H
@@ -10,10 +10,14 @@
  *
 */
 #include <iostream>
+#include <algorithm>
 
 #include "zypp/base/LogTools.h"
 #include "zypp/sat/WhatProvides.h"
 #include "zypp/sat/detail/PoolImpl.h"
+#include "zypp/sat/Pool.h"
+#include "zypp/sat/LookupAttr.h"
+#include "zypp/thread/WorkerPool.h"
 
 using std::endl;
 
@@ -164,6 +168,264 @@ namespace zypp
       return dumpRange( str << "(" << obj.size() << ")", obj.begin(), obj.end() );
     }
 
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    { /////////////////////////////////////////////////////////////////
+
+      /** WhatProvidesTable ctor helper: one row per Capability. */
+      template <class Iterator>
+      void collectRows( Iterator begin_r, Iterator end_r,
+                        std::vector<unsigned> & offsets_r, std::vector<detail::SolvableIdType> & ids_r )
+      {
+        detail::PoolImpl & pool( detail::PoolMember::myPool() );
+        pool.prepare(); // once for all rows
+        offsets_r.push_back( 0 );
+        for_( it, begin_r, end_r )
+        {
+          for ( unsigned prv = ::pool_whatprovides( pool.getPool(), it->id() ); pool.whatProvidesData( prv ); ++prv )
+            ids_r.push_back( pool.whatProvidesData( prv ) );
+          offsets_r.push_back( ids_r.size() );
+        }
+      }
+
+      /** A solvable found for a row of the \ref WhatProvidesTable. */
+      typedef std::pair<unsigned,detail::SolvableIdType> TableHit;
+
+      ///////////////////////////////////////////////////////////////////
+      /// \class FileListScan
+      /// \brief WhatProvidesTable ctor helper: find files in the file lists.
+      ///
+      /// The requested files are hashed by dirname and basename. File list
+      /// entries are stored as (directory id, basename), so the directory
+      /// ids are translated into strings once per \c Repodata and job, and
+      /// entries in directories not asked for are skipped at the cost of an
+      /// array lookup.
+      ///
+      /// Concurrent libsolv dataiterators are not read-only. Directory
+      /// strings are built by the scan itself, as \c repodata_dir2str uses
+      /// the pools shared temp space. File lists are usually vertical data
+      /// paged in through the repodatas page store, so a job scans a whole
+      /// \ref Repository and no repodata is read by two threads. Loading a
+      /// stub modifies the pool, so the scan is serial if there are any.
+      ///////////////////////////////////////////////////////////////////
+      class FileListScan
+      {
+        /** The rows asking for a basename. */
+        typedef std::tr1::unordered_map<std::string, std::vector<unsigned> > BaseRows;
+
+        /** The per job cache: \c _bases index per directory id (or \c -1). */
+        struct DirCache
+        {
+          DirCache() : _data( 0 ), _index( 0 ) {}
+          std::tr1::unordered_map<const ::_Repodata *, std::vector<int> > _indices;
+          const ::_Repodata * _data;
+          std::vector<int> *  _index;
+        };
+
+        /** A \ref Repository searched by one \ref thread::WorkerPool job. */
+        struct Job
+        {
+          Job( Repository repo_r )
+          : repo( repo_r )
+          {}
+          Repository            repo;
+          std::vector<TableHit> found;
+        };
+
+        public:
+          FileListScan( const std::vector<std::string> & files_r )
+          {
+            for ( unsigned row = 0; row < files_r.size(); ++row )
+            {
+              const std::string & file( files_r[row] );
+              std::string::size_type sep( file.rfind( '/' ) );
+              if ( *file.c_str() != '/' || sep+1 == file.size() )
+                continue; // not a file path
+              std::tr1::unordered_map<std::string, unsigned>::const_iterator dir(
+                _dirs.insert( std::make_pair( file.substr( 0, sep ), unsigned(_bases.size()) ) ).first );
+              if ( dir->second == _bases.size() )
+                _bases.push_back( BaseRows() );
+              _bases[dir->second][file.substr( sep+1 )].push_back( row );
+            }
+          }
+
+          /** Append the hits to \a result_r. */
+          void collect( std::vector<TableHit> & result_r, unsigned workers_r ) const
+          {
+            if ( _dirs.empty() )
+              return;
+
+            if ( workers_r == 1 || hasStubs() )
+            {
+              DirCache cache;
+              scan( LookupAttr( SolvAttr::filelist ), cache, result_r );
+              return;
+            }
+
+            std::vector<Job> jobs;
+            {
+              Pool satpool( Pool::instance() );
+              if ( ! workers_r )
+                workers_r = thread::WorkerPool::defaultSize();
+              for_( rit, satpool.reposBegin(), satpool.reposEnd() )
+                jobs.push_back( Job( *rit ) );
+            }
+            if ( jobs.empty() )
+              return;
+
+            {
+              thread::WorkerPool workers( std::min( workers_r, unsigned(jobs.size()) ) );
+              for_( it, jobs.begin(), jobs.end() )
+              {
+                Job * job = &(*it);
+                workers.schedule( [this,job]() { runJob( *job ); } );
+              }
+              workers.wait();
+            }
+
+            for_( it, jobs.begin(), jobs.end() )
+              result_r.insert( result_r.end(), it->found.begin(), it->found.end() );
+          }
+
+        private:
+          /** Search the repo assigned to \a job_r. */
+          void runJob( Job & job_r ) const
+          {
+            DirCache cache;
+            scan( LookupAttr( SolvAttr::filelist, job_r.repo ), cache, job_r.found );
+          }
+
+          /** Whether a file list is still to be loaded from a stub. */
+          static bool hasStubs()
+          {
+            Pool satpool( Pool::instance() );
+            for_( rit, satpool.reposBegin(), satpool.reposEnd() )
+            {
+              ::_Repo * repo( rit->get() );
+              int rdid;
+              ::_Repodata * data;
+              FOR_REPODATAS( repo, rdid, data )
+              {
+                if ( data->state != REPODATA_STUB )
+                  continue;
+                for ( int k = 1; k < data->nkeys; ++k )
+                {
+                  if ( data->keys[k].name == SolvAttr::filelist.id() )
+                    return true;
+                }
+              }
+            }
+            return false;
+          }
+
+          void scan( const LookupAttr & q_r, DirCache & cache_r, std::vector<TableHit> & found_r ) const
+          {
+            for_( it, q_r.begin(), q_r.end() )
+            {
+              ::_Dataiterator * di( it.get() );
+              const BaseRows * bases( lookupDir( cache_r, di->data, di->kv.id ) );
+              if ( ! bases )
+                continue;
+              BaseRows::const_iterator rows( bases->find( di->kv.str ) );
+              if ( rows == bases->end() )
+                continue;
+              for_( row, rows->second.begin(), rows->second.end() )
+                found_r.push_back( TableHit( *row, it.inSolvable().id() ) );
+            }
+          }
+
+          /** The basenames requested in directory \a did_r or \c NULL. */
+          const BaseRows * lookupDir( DirCache & cache_r, ::_Repodata * data_r, detail::IdType did_r ) const
+          {
+            static const int unknown = -2;
+            if ( data_r != cache_r._data )
+            {
+              cache_r._data = data_r;
+              cache_r._index = &cache_r._indices[data_r];
+            }
+            std::vector<int> & index( *cache_r._index );
+            if ( unsigned(did_r) >= index.size() )
+              index.resize( did_r+1, unknown );
+            if ( index[did_r] == unknown )
+            {
+              std::tr1::unordered_map<std::string, unsigned>::const_iterator dir( _dirs.find( dirString( data_r, did_r ) ) );
+              index[did_r] = ( dir == _dirs.end() ? -1 : int(dir->second) );
+            }
+            return( index[did_r] < 0 ? 0 : &_bases[index[did_r]] );
+          }
+
+          /** Same as \c repodata_dir2str, but not using the pools temp space. */
+          static std::string dirString( ::_Repodata * data_r, detail::IdType did_r )
+          {
+            std::string ret;
+            for ( detail::IdType did = did_r; did; did = ::dirpool_parent( &data_r->dirpool, did ) )
+            {
+              detail::IdType comp( ::dirpool_compid( &data_r->dirpool, did ) );
+              const char * comps( ::stringpool_id2str( data_r->localpool ? &data_r->spool : &data_r->repo->pool->ss, comp ) );
+              ret = ( did == did_r ? std::string( comps ) : std::string( comps ) + "/" + ret );
+            }
+            return ret;
+          }
+
+        private:
+          std::tr1::unordered_map<std::string, unsigned> _dirs; ///< dirname -> index into _bases
+          std::vector<BaseRows> _bases;
+      };
+      ///////////////////////////////////////////////////////////////////
+
+      /////////////////////////////////////////////////////////////////
+    } //namespace
+    ///////////////////////////////////////////////////////////////////
+
+    WhatProvidesTable::WhatProvidesTable()
+    {}
+
+    WhatProvidesTable::WhatProvidesTable( Capabilities caps_r )
+    { collectRows( caps_r.begin(), caps_r.end(), _offsets, _ids ); }
+
+    WhatProvidesTable::WhatProvidesTable( const CapabilitySet & caps_r )
+    { collectRows( caps_r.begin(), caps_r.end(), _offsets, _ids ); }
+
+    WhatProvidesTable::WhatProvidesTable( const std::vector<std::string> & files_r, unsigned workers_r )
+    {
+      detail::PoolImpl & pool( myPool() );
+      pool.prepare();
+
+      std::vector<TableHit> hits;
+      FileListScan( files_r ).collect( hits, workers_r );
+
+      // Explicit file provides (and file lists indexed by pool_addfileprovides).
+      for ( unsigned row = 0; row < files_r.size(); ++row )
+      {
+        if ( *files_r[row].c_str() != '/' )
+          continue; // not a file path
+        detail::IdType id( ::pool_str2id( pool.getPool(), files_r[row].c_str(), /*create*/0 ) );
+        if ( ! id )
+          continue;
+        for ( unsigned prv = ::pool_whatprovides( pool.getPool(), id ); pool.whatProvidesData( prv ); ++prv )
+          hits.push_back( TableHit( row, pool.whatProvidesData( prv ) ) );
+      }
+
+      std::sort( hits.begin(), hits.end() );
+      hits.erase( std::unique( hits.begin(), hits.end() ), hits.end() );
+
+      _ids.reserve( hits.size() );
+      _offsets.reserve( files_r.size()+1 );
+      _offsets.push_back( 0 );
+      std::vector<TableHit>::const_iterator hit( hits.begin() );
+      for ( unsigned row = 0; row < files_r.size(); ++row )
+      {
+        for ( ; hit != hits.end() && hit->first == row; ++hit )
+          _ids.push_back( hit->second );
+        _offsets.push_back( _ids.size() );
+      }
+    }
+
+    std::ostream & operator<<( std::ostream & str, const WhatProvidesTable & obj )
+    {
+      return str << "WhatProvidesTable(" << obj.size() << " rows, " << obj.ids().size() << " ids)";
+    }
+
     ///////////////////////////////////////////////////////////////////
     namespace detail
     { /////////////////////////////////////////////////////////////////
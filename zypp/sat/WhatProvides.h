@@ -14,6 +14,7 @@
 
 #include <iosfwd>
 #include <vector>
+#include <string>
 
 #include "zypp/base/PtrTypes.h"
 #include "zypp/sat/detail/PoolMember.h"
@@ -226,6 +227,151 @@ namespace zypp
     inline WhatProvides::const_iterator WhatProvides::end() const
     { return const_iterator(); }
 
+    namespace detail
+    {
+      class WhatProvidesTableIterator;
+    }
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class WhatProvidesTable
+    /// \brief The providers of many capabilities or files, looked up at once (read only).
+    ///
+    /// Row \c i holds the \ref Solvable providing the \c i-th capability
+    /// or file, in the order they were passed to the ctor. The rows are
+    /// stored compressed (CSR): \ref ids holds all rows one after the other,
+    /// and row \c i is <tt>[offsets()[i], offsets()[i+1])</tt>.
+    ///
+    /// Unlike collecting a \ref WhatProvides per capability, the pool is
+    /// prepared once, and file lists are scanned in a single pass, no
+    /// matter how many files are looked up.
+    ///
+    /// \code
+    ///   sat::WhatProvidesTable table( caps );
+    ///   unsigned row = 0;
+    ///   for_( it, caps.begin(), caps.end() )
+    ///   {
+    ///     cout << *it << " (" << table.rowSize( row ) << ")" << endl;
+    ///     for_( prv, table.begin( row ), table.end( row ) )
+    ///       cout << "  " << *prv << endl;
+    ///     ++row;
+    ///   }
+    /// \endcode
+    ///
+    /// \note As with \ref WhatProvides a system property is provided by
+    /// \ref Solvable::noSolvable with \c isSystem set \c true.
+    ///////////////////////////////////////////////////////////////////
+    class WhatProvidesTable : protected detail::PoolMember
+    {
+      public:
+        typedef unsigned size_type;
+        typedef detail::WhatProvidesTableIterator const_iterator;
+
+      public:
+        /** Default ctor: no rows */
+        WhatProvidesTable();
+
+        /** Ctor: one row per capability in \a caps_r. */
+        explicit
+        WhatProvidesTable( Capabilities caps_r );
+
+        /** Ctor: one row per capability in \a caps_r. */
+        explicit
+        WhatProvidesTable( const CapabilitySet & caps_r );
+
+        /** Ctor: one row per absolute path in \a files_r (other rows stay empty).
+         *
+         * A row holds the solvables listing the file in their
+         * \ref SolvAttr::filelist, and those explicitly providing it,
+         * each solvable once and sorted by id.
+         *
+         * The file lists are scanned by up to \a workers_r threads (\c 0 uses
+         * \ref thread::WorkerPool::defaultSize), one \ref Repository per
+         * job. If a file list still needs to be loaded from a stub, the scan
+         * is done in the calling thread. The result does not depend on the
+         * number of threads used. The pool must not be modified while the
+         * lookup runs.
+         */
+        explicit
+        WhatProvidesTable( const std::vector<std::string> & files_r, unsigned workers_r = 1 );
+
+      public:
+        /** Whether there are no rows. */
+        bool empty() const
+        { return _offsets.size() < 2; }
+
+        /** Number of rows. */
+        size_type size() const
+        { return empty() ? 0 : _offsets.size() - 1; }
+
+        /** Number of providers in row \a row_r. */
+        size_type rowSize( size_type row_r ) const
+        { return _offsets[row_r+1] - _offsets[row_r]; }
+
+        /** Iterator pointing to the first \ref Solvable in row \a row_r. */
+        const_iterator begin( size_type row_r ) const;
+
+        /** Iterator pointing behind the last \ref Solvable in row \a row_r. */
+        const_iterator end( size_type row_r ) const;
+
+      public:
+        /** The rows start offsets into \ref ids (\ref size + 1 entries; empty if no rows). */
+        const std::vector<unsigned> & offsets() const
+        { return _offsets; }
+
+        /** The solvable ids of all rows. */
+        const std::vector<detail::SolvableIdType> & ids() const
+        { return _ids; }
+
+      private:
+        std::vector<unsigned>                _offsets;
+        std::vector<detail::SolvableIdType>  _ids;
+    };
+    ///////////////////////////////////////////////////////////////////
+
+    /** \relates WhatProvidesTable Stream output */
+    std::ostream & operator<<( std::ostream & str, const WhatProvidesTable & obj );
+
+    namespace detail
+    {
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	CLASS NAME : WhatProvidesTable::const_iterator
+    //
+    /** \ref WhatProvidesTable row iterator.
+     * Iterate a range of the tables sat::detail::SolvableIdType array.
+     */
+    class WhatProvidesTableIterator : public boost::iterator_adaptor<
+          WhatProvidesTableIterator         // Derived
+        , const detail::SolvableIdType *    // Base
+        , const Solvable                    // Value
+        , boost::random_access_traversal_tag // CategoryOrTraversal
+        , const Solvable                    // Reference
+        >
+    {
+      public:
+        WhatProvidesTableIterator()
+        : iterator_adaptor_( 0 )
+        {}
+
+        explicit WhatProvidesTableIterator( const detail::SolvableIdType * base_r )
+        : iterator_adaptor_( base_r )
+        {}
+
+      private:
+        friend class boost::iterator_core_access;
+
+        reference dereference() const
+        { return Solvable( *base() ); }
+    };
+    ///////////////////////////////////////////////////////////////////
+    }
+
+    inline WhatProvidesTable::const_iterator WhatProvidesTable::begin( size_type row_r ) const
+    { return const_iterator( _ids.empty() ? 0 : &_ids.front() + _offsets[row_r] ); }
+
+    inline WhatProvidesTable::const_iterator WhatProvidesTable::end( size_type row_r ) const
+    { return const_iterator( _ids.empty() ? 0 : &_ids.front() + _offsets[row_r+1] ); }
+
     /////////////////////////////////////////////////////////////////
   } // namespace sat
   ///////////////////////////////////////////////////////////////////
@@ -23,6 +23,7 @@
 #include "zypp/base/IOStream.h"
 
 #include "zypp/ZConfig.h"
+#include "zypp/TmpPath.h"
 
 #include "zypp/sat/detail/PoolImpl.h"
 #include "zypp/sat/Pool.h"
@@ -35,6 +36,7 @@
 
 extern "C"
 {
+#include <solv/repo_write.h>
 // Workaround libsolv project not providing a common include
 // directory. (the -devel package does, but the git repo doesn't).
 // #include <solv/repo_helix.h>
@@ -263,8 +265,12 @@ namespace zypp
         {
           MIL << "pool_createwhatprovides..." << endl;
 
-          ::pool_addfileprovides( _pool );
+          sat::Queue added;
+          sat::Queue addedInstalled;
+          ::pool_addfileprovides_queue( _pool, added, addedInstalled );
           ::pool_createwhatprovides( _pool );
+          if ( ! _solvFileCaches.empty() )
+            saveAddedFileProvides( added, addedInstalled );
         }
         if ( ! _pool->languages )
         {
@@ -273,6 +279,58 @@ namespace zypp
         }
       }
 
+      void PoolImpl::saveAddedFileProvides( const sat::Queue & added_r, const sat::Queue & addedInstalled_r ) const
+      {
+        for_( it, _solvFileCaches.begin(), _solvFileCaches.end() )
+        {
+          ::_Repo * repo( it->first );
+          const sat::Queue & added( isSystemRepo( repo ) ? addedInstalled_r : added_r );
+          if ( added.empty() || repo->nrepodata < 2 )
+            continue;
+
+          // Written already? (e.g. by a former process)
+          ::Repodata * data = ::repo_id2repodata( repo, 1 );
+          sat::Queue stored;
+          if ( ::repodata_lookup_idarray( data, SOLVID_META, REPOSITORY_ADDEDFILEPROVIDES, stored ) )
+          {
+            bool complete = true;
+            for_( id, added.begin(), added.end() )
+            {
+              if ( ! stored.contains( *id ) )
+              {
+                complete = false;
+                break;
+              }
+            }
+            if ( complete )
+              continue;
+          }
+
+          ::repodata_set_idarray( data, SOLVID_META, REPOSITORY_ADDEDFILEPROVIDES, const_cast<sat::Queue &>( added ) );
+          ::repodata_internalize( data );
+
+          // A process loading the file can skip searching the file lists.
+          // It's just a cache, so failing to write is not an error.
+          const Pathname & file( it->second );
+          filesystem::TmpFile tmp( filesystem::TmpFile::makeSibling( file ) );
+          FILE * fp = tmp ? ::fopen( tmp.path().c_str(), "w" ) : 0;
+          if ( ! fp )
+          {
+            DBG << "Can't rewrite " << file << " to remember " << added.size() << " file provides" << endl;
+            continue;
+          }
+          ::repo_write( repo, fp );
+          bool failed = ::ferror( fp );
+          if ( ::fclose( fp ) != 0 || failed || filesystem::rename( tmp.path(), file ) != 0 )
+          {
+            WAR << "Can't rewrite " << file << " to remember " << added.size() << " file provides" << endl;
+            continue;
+          }
+          tmp.autoCleanup( false );
+          MIL << "Rewrote " << file << " to remember " << added.size() << " file provides" << endl;
+        }
+      }
+
       void PoolImpl::prepareForSolving() const
       {
 	// additional /etc/sysconfig/storage check:
@@ -360,6 +418,7 @@ namespace zypp
                 // Free remembered entries
                   ::repo_free_solvable_block( repo_r, blockBegin, blockSize, /*reuseids*/false );
                   blockBegin = blockSize = 0;
+                  _archFilteredRepos.insert( repo_r );
               }
           }
           if ( blockSize )
@@ -367,6 +426,7 @@ namespace zypp
               // Free remembered entries
               ::repo_free_solvable_block( repo_r, blockBegin, blockSize, /*reuseids*/false );
               blockBegin = blockSize = 0;
+              _archFilteredRepos.insert( repo_r );
           }
         }
         else
@@ -29,6 +29,7 @@ extern "C"
 #include "zypp/Locale.h"
 #include "zypp/Capability.h"
 #include "zypp/IdString.h"
+#include "zypp/sat/Queue.h"
 
 ///////////////////////////////////////////////////////////////////
 namespace zypp
@@ -183,7 +184,19 @@ namespace zypp
           void setRepoInfo( RepoIdType id_r, const RepoInfo & info_r );
           /** */
           void eraseRepoInfo( RepoIdType id_r )
-          { _repoinfos.erase( id_r ); }
+          { _repoinfos.erase( id_r ); _solvFileCaches.erase( id_r ); _archFilteredRepos.erase( id_r ); }
+
+        public:
+          /** Remember the solv-file cache \a id_r was loaded from.
+           * \see \ref Pool::setSolvFileCache
+           */
+          void setSolvFileCache( RepoIdType id_r, const Pathname & file_r )
+          {
+            // Writing back a repo without the incompatible archs would
+            // hide them from a process using a different architecture.
+            if ( ! _archFilteredRepos.count( id_r ) )
+              _solvFileCaches[id_r] = file_r;
+          }
 
         public:
           /** Returns the id stored at \c offset_r in the internal
@@ -276,6 +289,13 @@ namespace zypp
           SerialNumberWatcher _watcher;
           /** Additional \ref RepoInfo. */
           std::map<RepoIdType,RepoInfo> _repoinfos;
+          /** Solv-file caches to remember added file provides. */
+          std::map<RepoIdType,Pathname> _solvFileCaches;
+          /** Repos with solvables of incompatible architecture removed. */
+          std::set<RepoIdType> _archFilteredRepos;
+
+          /** Write the file provides added by \ref prepare to the solv-file caches lacking them. */
+          void saveAddedFileProvides( const sat::Queue & added_r, const sat::Queue & addedInstalled_r ) const;
 
           /**  */
           LocaleSet _requestedLocales;
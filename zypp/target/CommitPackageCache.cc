@@ -12,10 +12,12 @@
 #include <iostream>
 #include "zypp/base/Logger.h"
 #include "zypp/base/Exception.h"
+#include "zypp/ZConfig.h"
 
 #include "zypp/target/CommitPackageCache.h"
 #include "zypp/target/CommitPackageCacheImpl.h"
 #include "zypp/target/CommitPackageCacheReadAhead.h"
+#include "zypp/target/CommitPackageCacheDownloadAhead.h"
 
 using std::endl;
 
@@ -46,6 +48,12 @@ namespace zypp
           MIL << "$ZYPP_COMMIT_NO_PACKAGE_CACHE is set." << endl;
           _pimpl.reset( new Impl( packageProvider_r ) ); // no cache
         }
+      else if ( ZConfig::instance().commit_downloadAhead() )
+        {
+          _pimpl.reset( new CommitPackageCacheDownloadAhead( rootDir_r, packageProvider_r,
+                                                             ZConfig::instance().commit_downloadAhead(),
+                                                             ByteCount( ZConfig::instance().commit_downloadAhead_space(), ByteCount::MB ) ) );
+        }
       else
         {
           _pimpl.reset( new CommitPackageCacheReadAhead( rootDir_r, packageProvider_r ) );
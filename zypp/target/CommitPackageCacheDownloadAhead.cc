@@ -0,0 +1,290 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/target/CommitPackageCacheDownloadAhead.cc
+ *
+*/
+#include <iostream>
+
+#include "zypp/base/Logger.h"
+#include "zypp/base/Exception.h"
+#include "zypp/base/Function.h"
+#include "zypp/base/String.h"
+#include "zypp/PathInfo.h"
+#include "zypp/RepoInfo.h"
+#include "zypp/Package.h"
+#include "zypp/ZConfig.h"
+#include "zypp/MediaSetAccess.h"
+#include "zypp/sat/Pool.h"
+#include "zypp/repo/ContentStore.h"
+#include "zypp/repo/DeltaCandidates.h"
+#include "zypp/target/CommitPackageCacheDownloadAhead.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+  ///////////////////////////////////////////////////////////////////
+  namespace target
+  { /////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	CLASS NAME : CommitPackageCacheDownloadAhead
+    //
+    ///////////////////////////////////////////////////////////////////
+
+    CommitPackageCacheDownloadAhead::CommitPackageCacheDownloadAhead( const Pathname &        rootDir_r,
+                                                                      const PackageProvider & packageProvider_r,
+                                                                      unsigned                ahead_r,
+                                                                      const ByteCount &       space_r )
+    : CommitPackageCacheReadAhead( rootDir_r, packageProvider_r )
+    , _ahead( ahead_r )
+    , _space( space_r )
+    , _lastIdx( 0 )
+    , _nextIdx( 0 )
+    , _stop( false )
+    {
+      MIL << "Download ahead " << _ahead << " packages (" << _space << ")" << endl;
+    }
+
+    CommitPackageCacheDownloadAhead::~CommitPackageCacheDownloadAhead()
+    {
+      {
+        std::unique_lock<std::mutex> lock( _mutex );
+        _stop = true;
+      }
+      _pool.reset(); // waits for running downloads
+
+      // Packages downloaded but never requested (e.g. commit aborted).
+      _unused.reserve( _unused.size() + _entries.size() );
+      for_( it, _entries.begin(), _entries.end() )
+        _unused.push_back( it->second );
+      for_( it, _unused.begin(), _unused.end() )
+      {
+        if ( (*it)->_state == Entry::DONE && ! (*it)->_keep )
+        {
+          DBG << "Remove unused " << (*it)->_destination << endl;
+          filesystem::unlink( (*it)->_destination );
+        }
+      }
+    }
+
+    ManagedFile CommitPackageCacheDownloadAhead::get( const PoolItem & citem_r )
+    {
+      unsigned idx = commitListIndex( citem_r );
+      if ( idx < _commitList.size() )
+      {
+        dropBefore( idx );
+        consume( idx );
+        _lastIdx = idx;
+        // Let the next ones download while this one is provided and installed.
+        scheduleAhead( idx );
+      }
+      return CommitPackageCacheReadAhead::get( citem_r );
+    }
+
+    unsigned CommitPackageCacheDownloadAhead::commitListIndex( const PoolItem & citem_r )
+    {
+      sat::Solvable solv( citem_r.satSolvable() );
+      // Usually requested in commit order, so search from the last position first.
+      for ( unsigned idx = _lastIdx; idx < _commitList.size(); ++idx )
+      {
+        if ( _commitList[idx] == solv )
+          return idx;
+      }
+      for ( unsigned idx = 0; idx < _lastIdx && idx < _commitList.size(); ++idx )
+      {
+        if ( _commitList[idx] == solv )
+          return idx;
+      }
+      return _commitList.size();
+    }
+
+    CommitPackageCacheDownloadAhead::EntryPtr CommitPackageCacheDownloadAhead::makeEntry( unsigned idx_r, const PoolItem & pi ) const
+    {
+      if ( ! isKind<Package>( pi.resolvable() ) || ! pi.status().isToBeInstalled() )
+        return EntryPtr();
+
+      Package::constPtr p( pi->asKind<Package>() );
+      RepoInfo info( p->repoInfo() );
+      if ( info.baseUrlsEmpty() )
+        return EntryPtr();
+      // Like the PackageProvider we only support the first url.
+      Url url( *info.baseUrlsBegin() );
+      if ( ! url.schemeIsDownloading() )
+        return EntryPtr();
+
+      // The PackageProvider accepts a cached package with matching checksum only.
+      OnMediaLocation loc( p->location() );
+      if ( loc.checksum().empty() || ! p->cachedLocation().empty() )
+        return EntryPtr();
+      // Provided from the shared cache without download.
+      if ( repo::ContentStore::instance().contains( loc.checksum() ) )
+        return EntryPtr();
+
+      // The space budget needs a size. If the download size is unknown,
+      // the (usually bigger) installed size is a conservative estimate.
+      ByteCount size( loc.downloadSize() );
+      if ( ! size )
+        size = p->installSize();
+      if ( ! size )
+      {
+        DBG << "Not downloading ahead " << loc << ": unknown size" << endl;
+        return EntryPtr();
+      }
+
+      // Don't download the full package if the PackageProvider may use a delta rpm.
+      if ( ZConfig::instance().download_use_deltarpm() )
+      {
+        std::list<Repository> repos( sat::Pool::instance().reposBegin(), sat::Pool::instance().reposEnd() );
+        if ( ! repo::DeltaCandidates( repos, p->name() ).deltaRpms( p ).empty() )
+          return EntryPtr();
+      }
+
+      EntryPtr ret( new Entry );
+      ret->_idx		= idx_r;
+      ret->_url		= url;
+      ret->_location	= loc;
+      ret->_location.changeFilename( info.path() / loc.filename() ); // below the repos path
+      ret->_destination	= info.packagesPath() / loc.filename();
+      ret->_size	= size;
+      ret->_keep	= info.keepPackages();
+      return ret;
+    }
+
+    void CommitPackageCacheDownloadAhead::scheduleAhead( unsigned idx_r )
+    {
+      if ( _nextIdx <= idx_r )
+        _nextIdx = idx_r + 1;
+
+      while ( _nextIdx < _commitList.size() && _entries.size() < _ahead )
+      {
+        EntryPtr entry( makeEntry( _nextIdx, PoolItem( _commitList[_nextIdx] ) ) );
+        if ( entry )
+        {
+          // Keep the install order: wait until enough space is freed.
+          if ( _used + entry->_size > _space )
+            break;
+
+          ByteCount df( filesystem::df( entry->_destination.dirname() ) );
+          if ( df < 0 || df / 10 < entry->_size )
+          {
+            WAR << "Not downloading ahead " << entry->_location << ": available disk space " << df << endl;
+          }
+          else
+          {
+            if ( ! _pool )
+              _pool.reset( new thread::WorkerPool( _ahead ) );
+            _used += entry->_size;
+            _entries[_nextIdx] = entry;
+            _pool->schedule( bind( &CommitPackageCacheDownloadAhead::download, this, entry ) );
+          }
+        }
+        ++_nextIdx;
+      }
+    }
+
+    void CommitPackageCacheDownloadAhead::consume( unsigned idx_r )
+    {
+      EntryMap::iterator it( _entries.find( idx_r ) );
+      if ( it == _entries.end() )
+        return;
+
+      EntryPtr entry( it->second );
+      _entries.erase( it );
+      _used -= entry->_size;
+
+      std::unique_lock<std::mutex> lock( _mutex );
+      if ( entry->_state == Entry::QUEUED )
+      {
+        // Not yet started. Rather provide it in the application thread.
+        entry->_state = Entry::FAILED;
+        return;
+      }
+      while ( entry->_state == Entry::RUNNING )
+        _stateChanged.wait( lock );
+
+      if ( entry->_state == Entry::DONE )
+        MIL << "Downloaded ahead " << entry->_destination << endl;
+    }
+
+    void CommitPackageCacheDownloadAhead::dropBefore( unsigned idx_r )
+    {
+      while ( ! _entries.empty() && _entries.begin()->first < idx_r )
+      {
+        EntryPtr entry( _entries.begin()->second );
+        _entries.erase( _entries.begin() );
+        _used -= entry->_size;
+        {
+          std::unique_lock<std::mutex> lock( _mutex );
+          if ( entry->_state == Entry::QUEUED )
+            entry->_state = Entry::FAILED;
+        }
+        DBG << "Not requested " << entry->_location << endl;
+        _unused.push_back( entry );
+      }
+    }
+
+    void CommitPackageCacheDownloadAhead::download( EntryPtr entry_r )
+    {
+      // Here we're in a worker thread. Entries data are not modified
+      // once scheduled, just the state is shared.
+      {
+        std::unique_lock<std::mutex> lock( _mutex );
+        if ( _stop || entry_r->_state != Entry::QUEUED )
+        {
+          entry_r->_state = Entry::FAILED;
+          _stateChanged.notify_all();
+          return;
+        }
+        entry_r->_state = Entry::RUNNING;
+      }
+
+      Entry::State result = Entry::FAILED;
+      Pathname part( entry_r->_destination.extend( ".part" ) );
+      try
+      {
+        MediaSetAccess media( entry_r->_url );
+        Pathname file( media.provideFile( entry_r->_location ) );
+
+        const CheckSum & expected( entry_r->_location.checksum() );
+        CheckSum checksum( expected.type(), filesystem::checksum( file, expected.type() ) );
+        if ( checksum != expected )
+          ZYPP_THROW( Exception( str::form( "Checksum mismatch for %s", entry_r->_location.filename().c_str() ) ) );
+
+        if ( filesystem::assert_dir( entry_r->_destination.dirname() ) != 0
+             || filesystem::hardlinkCopy( file, part ) != 0
+             || filesystem::rename( part, entry_r->_destination ) != 0 )
+          ZYPP_THROW( Exception( str::form( "Can't store %s", entry_r->_destination.c_str() ) ) );
+        repo::ContentStore::instance().insert( expected, entry_r->_destination );
+
+        media.release();
+        result = Entry::DONE;
+      }
+      catch ( const Exception & excpt )
+      {
+        ZYPP_CAUGHT( excpt );
+        filesystem::unlink( part );
+        WAR << "Download ahead failed: " << entry_r->_location << endl;
+      }
+
+      {
+        std::unique_lock<std::mutex> lock( _mutex );
+        entry_r->_state = result;
+      }
+      _stateChanged.notify_all();
+    }
+
+    /////////////////////////////////////////////////////////////////
+  } // namespace target
+  ///////////////////////////////////////////////////////////////////
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,130 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/target/CommitPackageCacheDownloadAhead.h
+ *
+*/
+#ifndef ZYPP_TARGET_COMMITPACKAGECACHEDOWNLOADAHEAD_H
+#define ZYPP_TARGET_COMMITPACKAGECACHEDOWNLOADAHEAD_H
+
+#include <map>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
+#include "zypp/base/PtrTypes.h"
+#include "zypp/ByteCount.h"
+#include "zypp/Url.h"
+#include "zypp/OnMediaLocation.h"
+#include "zypp/thread/WorkerPool.h"
+#include "zypp/target/CommitPackageCacheReadAhead.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+  ///////////////////////////////////////////////////////////////////
+  namespace target
+  { /////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class CommitPackageCacheDownloadAhead
+    /// \brief Download the next packages of the commit while the current one is installed.
+    ///
+    /// Whenever a package is requested, the next packages to install
+    /// (in commit order) are downloaded by \ref thread::WorkerPool threads
+    /// into the repos package cache. When they are requested, the
+    /// \ref PackageProvider finds them there (checksum verified) and handles
+    /// the file like any other cache hit.
+    ///
+    /// The download ahead is limited by the number of packages and by the
+    /// disk space they occupy. Only packages from downloading repos, having
+    /// a checksum and no delta rpm candidates are downloaded ahead. If the
+    /// download size is unknown, the installed size is accounted for.
+    ///
+    /// Background downloads can't talk to the application. If they fail,
+    /// the package is provided as usual when it is requested, so all
+    /// retry/skip/abort decisions are made in the application thread.
+    ///
+    /// Interactive media are still handled by \ref CommitPackageCacheReadAhead.
+    ///////////////////////////////////////////////////////////////////
+    class CommitPackageCacheDownloadAhead : public CommitPackageCacheReadAhead
+    {
+    public:
+      CommitPackageCacheDownloadAhead( const Pathname &        rootDir_r,
+                                       const PackageProvider & packageProvider_r,
+                                       unsigned                ahead_r,
+                                       const ByteCount &       space_r );
+
+      /** Dtor stops pending downloads and removes unused files. */
+      virtual ~CommitPackageCacheDownloadAhead();
+
+    public:
+      /** Provide the package, downloading ahead the next ones. */
+      virtual ManagedFile get( const PoolItem & citem_r );
+
+    private:
+      /** A package to download ahead. */
+      struct Entry
+      {
+        enum State { QUEUED, RUNNING, DONE, FAILED };
+
+        Entry()
+        : _idx( 0 ), _keep( false ), _state( QUEUED )
+        {}
+
+        unsigned        _idx;		///< position in the commit list
+        Url             _url;		///< repos (first) baseurl
+        OnMediaLocation _location;	///< the package on the media (incl. the repos path)
+        Pathname        _destination;	///< target file in the repos package cache
+        ByteCount       _size;		///< disk space accounted for
+        bool            _keep;		///< repo keeps packages
+        State           _state;
+      };
+      typedef shared_ptr<Entry>               EntryPtr;
+      typedef std::map<unsigned,EntryPtr>     EntryMap;
+
+      /** Index of \a citem_r in the commit list (or commit list size). */
+      unsigned commitListIndex( const PoolItem & citem_r );
+
+      /** Whether and how \a pi can be downloaded ahead. */
+      EntryPtr makeEntry( unsigned idx_r, const PoolItem & pi ) const;
+
+      /** Schedule downloads behind \a idx_r as long as limits allow. */
+      void scheduleAhead( unsigned idx_r );
+
+      /** Take \a idx_r out of the queue, waiting for a running download. */
+      void consume( unsigned idx_r );
+
+      /** Forget entries before \a idx_r (not requested, e.g. skipped). */
+      void dropBefore( unsigned idx_r );
+
+      /** Worker thread job. */
+      void download( EntryPtr entry_r );
+
+    private:
+      unsigned                 _ahead;
+      ByteCount                _space;
+      unsigned                 _lastIdx;	///< last requested position
+      unsigned                 _nextIdx;	///< next position to consider for download
+      ByteCount                _used;	///< disk space of outstanding entries
+      EntryMap                 _entries;	///< outstanding entries
+      std::vector<EntryPtr>    _unused;	///< dropped entries (remove files in dtor)
+      bool                     _stop;
+      std::mutex               _mutex;
+      std::condition_variable  _stateChanged;
+      scoped_ptr<thread::WorkerPool> _pool;
+    };
+    ///////////////////////////////////////////////////////////////////
+
+    /////////////////////////////////////////////////////////////////
+  } // namespace target
+  ///////////////////////////////////////////////////////////////////
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_TARGET_COMMITPACKAGECACHEDOWNLOADAHEAD_H
@@ -0,0 +1,326 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/target/SolvJournal.cc
+ *
+*/
+#include <cstdio>
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <set>
+#include <map>
+
+extern "C"
+{
+#include <solv/pool.h>
+#include <solv/repo.h>
+#include <solv/knownid.h>
+#include <solv/repo_solv.h>
+#include <solv/repo_write.h>
+#include <solv/repo_rpmdb.h>
+}
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/Exception.h"
+#include "zypp/base/String.h"
+#include "zypp/base/NonCopyable.h"
+#include "zypp/PathInfo.h"
+
+#include "zypp/target/SolvJournal.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+  ///////////////////////////////////////////////////////////////////
+  namespace target
+  { /////////////////////////////////////////////////////////////////
+
+    namespace
+    {
+      /** Parsed journal file. */
+      struct JournalData
+      {
+        JournalData()
+        : started( false ), finished( false ), invalid( false )
+        {}
+
+        bool started;
+        bool finished;
+        bool invalid;
+        std::string solvstatus;
+        std::string productsstatus;
+        std::string rpmdbstatus;
+        /** The journaled changes in order: \c true for installed headers. */
+        std::vector<std::pair<bool,unsigned> > steps;
+      };
+
+      JournalData readJournal( const Pathname & file_r )
+      {
+        JournalData ret;
+        std::ifstream in( file_r.c_str() );
+        for( std::string line; std::getline( in, line ); )
+        {
+          std::vector<std::string> words;
+          str::split( line, std::back_inserter( words ) );
+          if ( words.empty() )
+            continue;
+
+          if ( words[0] == "start" && words.size() == 3 )
+          {
+            ret.started = true;
+            ret.solvstatus = words[1];
+            ret.productsstatus = words[2];
+          }
+          else if ( ! ret.started || ret.finished )
+            ret.invalid = true;
+          else if ( ( words[0] == "+" || words[0] == "-" ) && words.size() == 2 )
+            ret.steps.push_back( std::make_pair( words[0] == "+", str::strtonum<unsigned>( words[1] ) ) );
+          else if ( words[0] == "end" && words.size() == 2 )
+          {
+            ret.finished = true;
+            ret.rpmdbstatus = words[1];
+          }
+          else
+            ret.invalid = true;
+        }
+        return ret;
+      }
+
+      ///////////////////////////////////////////////////////////////////
+      /// \class PrivatePool
+      /// \brief A private libsolv pool holding the \c @System repo.
+      ///////////////////////////////////////////////////////////////////
+      struct PrivatePool : private base::NonCopyable
+      {
+        PrivatePool( const Pathname & root_r )
+        : _pool( ::pool_create() )
+        , _repo( ::repo_create( _pool, "@System" ) )
+        , _rpmstate( ::rpm_state_create( _pool, root_r.c_str() ) )
+        {}
+
+        ~PrivatePool()
+        {
+          ::rpm_state_free( _rpmstate );
+          ::pool_free( _pool );
+        }
+
+        ::Pool * _pool;
+        ::Repo * _repo;
+        void *   _rpmstate;
+      };
+    } // namespace
+
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	CLASS NAME : SolvJournal
+    //
+    ///////////////////////////////////////////////////////////////////
+
+    void SolvJournal::start( const RepoStatus & solvstatus_r, const RepoStatus & productsstatus_r ) const
+    {
+      std::ofstream out( _file.c_str(), std::ios_base::out|std::ios_base::trunc );
+      out << "start " << solvstatus_r.checksum() << " " << productsstatus_r.checksum() << endl;
+      if ( ! out )
+        ERR << "Can't write " << _file << endl;
+      else
+        MIL << "Started " << *this << endl;
+    }
+
+    void SolvJournal::installed( unsigned rpmdbid_r ) const
+    { append( "+ " + str::numstring( rpmdbid_r ) ); }
+
+    void SolvJournal::removed( unsigned rpmdbid_r ) const
+    { append( "- " + str::numstring( rpmdbid_r ) ); }
+
+    void SolvJournal::invalidate() const
+    { append( "invalid" ); }
+
+    void SolvJournal::finish( const RepoStatus & rpmdbstatus_r ) const
+    { append( "end " + rpmdbstatus_r.checksum() ); }
+
+    void SolvJournal::discard() const
+    { filesystem::unlink( _file ); }
+
+    void SolvJournal::append( const std::string & line_r ) const
+    {
+      if ( ! PathInfo( _file ).isFile() )
+        return; // not started
+      std::ofstream out( _file.c_str(), std::ios_base::out|std::ios_base::app );
+      out << line_r << endl;
+    }
+
+    bool SolvJournal::applicable( const RepoStatus & solvstatus_r,
+                                  const RepoStatus & rpmdbstatus_r,
+                                  const RepoStatus & productsstatus_r ) const
+    {
+      if ( ! PathInfo( _file ).isFile() )
+        return false;
+
+      JournalData data( readJournal( _file ) );
+      bool ret = ( data.finished && ! data.invalid
+                   && data.solvstatus == solvstatus_r.checksum()
+                   && data.rpmdbstatus == rpmdbstatus_r.checksum()
+                   && data.productsstatus == productsstatus_r.checksum() );
+      MIL << *this << " is " << ( ret ? "applicable" : "outdated" ) << endl;
+      return ret;
+    }
+
+    bool SolvJournal::replay( const std::set<unsigned> & insolv_r, const std::set<unsigned> & indb_r,
+                              std::set<unsigned> & drop_r, std::set<unsigned> & add_r ) const
+    {
+      JournalData data( readJournal( _file ) );
+      std::set<unsigned> current( insolv_r );
+      std::set<unsigned> skipped; // installed, but no longer in the database
+      drop_r.clear();
+      add_r.clear();
+
+      for ( const std::pair<bool,unsigned> & step : data.steps )
+      {
+        unsigned rpmdbid = step.second;
+        if ( step.first )
+        {
+          if ( ! indb_r.count( rpmdbid ) )
+          {
+            skipped.insert( rpmdbid ); // removed again by a later step
+            continue;
+          }
+          if ( current.count( rpmdbid ) )
+          {
+            WAR << "Journal: header " << rpmdbid << " is already in the solv file." << endl;
+            return false;
+          }
+          current.insert( rpmdbid );
+          add_r.insert( rpmdbid );
+        }
+        else
+        {
+          if ( ! current.erase( rpmdbid ) )
+          {
+            if ( skipped.count( rpmdbid ) )
+              continue;
+            WAR << "Journal: removed header " << rpmdbid << " is not in the solv file." << endl;
+            return false;
+          }
+          if ( ! add_r.erase( rpmdbid ) )
+            drop_r.insert( rpmdbid );
+        }
+      }
+
+      // Headers rpm removed without a journal entry (obsoleted by an update).
+      for ( std::set<unsigned>::iterator it = current.begin(); it != current.end(); )
+      {
+        if ( indb_r.count( *it ) )
+          ++it;
+        else
+        {
+          drop_r.insert( *it );
+          current.erase( it++ );
+        }
+      }
+
+      // And there must be nothing the journal does not know about.
+      if ( current != indb_r )
+      {
+        WAR << "Journal: solv file and rpm database disagree (" << current.size() << " vs. " << indb_r.size() << " headers)." << endl;
+        return false;
+      }
+      return true;
+    }
+
+    bool SolvJournal::apply( const Pathname & root_r, const Pathname & oldsolv_r, const Pathname & newsolv_r ) const
+    {
+      PrivatePool pool( root_r.empty() ? Pathname("/") : root_r );
+
+      {
+        FILE * fp = ::fopen( oldsolv_r.c_str(), "r" );
+        if ( ! fp )
+          ZYPP_THROW( Exception( str::form( "Can't open %s", oldsolv_r.c_str() ) ) );
+        int ret = ::repo_add_solv( pool._repo, fp, 0 );
+        ::fclose( fp );
+        if ( ret != 0 )
+          ZYPP_THROW( Exception( str::form( "Can't read %s: %s", oldsolv_r.c_str(), ::pool_errstr( pool._pool ) ) ) );
+      }
+
+      // What is in the solv file...
+      std::map<unsigned, ::Id> solvables;
+      std::set<unsigned> insolv;
+      {
+        ::Id p;
+        ::Solvable * s;
+        FOR_REPO_SOLVABLES( pool._repo, p, s )
+        {
+          unsigned rpmdbid = ::repo_lookup_num( pool._repo, p, RPM_RPMDBID, 0 );
+          if ( ! rpmdbid )
+            continue; // product from /etc/products.d
+          solvables[rpmdbid] = p;
+          insolv.insert( rpmdbid );
+        }
+      }
+
+      // ...and in the database.
+      std::set<unsigned> indb;
+      {
+        ::Queue q;
+        ::queue_init( &q );
+        ::rpm_installedrpmdbids( pool._rpmstate, "Name", 0, &q );
+        indb.insert( q.elements, q.elements + q.count );
+        ::queue_free( &q );
+      }
+
+      std::set<unsigned> drop;
+      std::set<unsigned> add;
+      if ( ! replay( insolv, indb, drop, add ) )
+        return false;
+
+      for ( unsigned rpmdbid : drop )
+        ::repo_free_solvable( pool._repo, solvables[rpmdbid], 1 );
+
+      for ( unsigned rpmdbid : add )
+      {
+        void * handle = ::rpm_byrpmdbid( pool._rpmstate, rpmdbid );
+        ::Id np = handle ? ::repo_add_rpm_handle( pool._repo, handle, REPO_REUSE_REPODATA|REPO_NO_INTERNALIZE ) : 0;
+        if ( ! np )
+        {
+          WAR << "Journal: can't read header " << rpmdbid << ": " << ::pool_errstr( pool._pool ) << endl;
+          return false;
+        }
+        ::repo_set_num( pool._repo, np, RPM_RPMDBID, rpmdbid );
+      }
+      ::repo_internalize( pool._repo );
+
+      FILE * fp = ::fopen( newsolv_r.c_str(), "w" );
+      if ( ! fp )
+        ZYPP_THROW( Exception( str::form( "Can't open %s", newsolv_r.c_str() ) ) );
+      ::repo_write( pool._repo, fp );
+      bool failed = ::ferror( fp );
+      if ( ::fclose( fp ) != 0 || failed )
+        ZYPP_THROW( Exception( str::form( "Can't write %s", newsolv_r.c_str() ) ) );
+
+      MIL << "Journal applied: -" << drop.size() << " +" << add.size() << " (" << indb.size() << " headers)" << endl;
+      return true;
+    }
+
+    /******************************************************************
+    **
+    **	FUNCTION NAME : operator<<
+    **	FUNCTION TYPE : std::ostream &
+    */
+    std::ostream & operator<<( std::ostream & str, const SolvJournal & obj )
+    {
+      return str << "SolvJournal(" << obj.file() << ")";
+    }
+
+    /////////////////////////////////////////////////////////////////
+  } // namespace target
+  ///////////////////////////////////////////////////////////////////
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
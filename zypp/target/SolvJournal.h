@@ -0,0 +1,130 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/target/SolvJournal.h
+ *
+*/
+#ifndef ZYPP_TARGET_SOLVJOURNAL_H
+#define ZYPP_TARGET_SOLVJOURNAL_H
+
+#include <iosfwd>
+#include <set>
+
+#include "zypp/Pathname.h"
+#include "zypp/RepoStatus.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+  ///////////////////////////////////////////////////////////////////
+  namespace target
+  { /////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	CLASS NAME : SolvJournal
+    //
+    /** Journal of the rpm database changes done by a commit.
+     *
+     * Instead of rescanning the whole rpm database via \c rpmdb2solv
+     * after each commit, the \c @System solv file is updated: Headers
+     * removed according to the journal are dropped, as are headers rpm
+     * removed on its own (obsoleted by an update). The headers installed
+     * according to the journal are read from the database and added.
+     *
+     * The journal is applied only if the solv file is the one the journal
+     * was started for, the rpm database is unchanged since the journal was
+     * finished, and \c /etc/products.d did not change. Otherwise, or if
+     * the rpm database contains headers the journal does not know about
+     * (e.g. installed by \c rpm in between), a full rescan is needed.
+     *
+     * The journal is written line by line, so an interrupted commit leaves
+     * an unfinished journal which is not applied.
+     */
+    class SolvJournal
+    {
+      friend std::ostream & operator<<( std::ostream & str, const SolvJournal & obj );
+      public:
+        /** Ctor taking the file to read/write. */
+        SolvJournal( const Pathname & file_r )
+        : _file( file_r )
+        {}
+
+        /** Return the file path. */
+        const Pathname & file() const
+        { return _file; }
+
+      public:
+        /** Start a new journal for a solv file built for \a solvstatus_r.
+         * \a productsstatus_r is the current status of \c /etc/products.d.
+         */
+        void start( const RepoStatus & solvstatus_r, const RepoStatus & productsstatus_r ) const;
+
+        /** Remember the header \a rpmdbid_r was installed. */
+        void installed( unsigned rpmdbid_r ) const;
+
+        /** Remember the header \a rpmdbid_r was removed. */
+        void removed( unsigned rpmdbid_r ) const;
+
+        /** Something happened the journal is not able to express.
+         * The journal will not be applied.
+         */
+        void invalidate() const;
+
+        /** Finish the journal remembering the rpm databases status. */
+        void finish( const RepoStatus & rpmdbstatus_r ) const;
+
+        /** Remove the journal file. */
+        void discard() const;
+
+      public:
+        /** Whether the journal is finished and applies to a solv file built
+         * for \a solvstatus_r, given the current rpm database and
+         * \c /etc/products.d status.
+         */
+        bool applicable( const RepoStatus & solvstatus_r,
+                         const RepoStatus & rpmdbstatus_r,
+                         const RepoStatus & productsstatus_r ) const;
+
+        /** Replay the journal on a solv file holding the headers \a insolv_r.
+         * Journaled removals and installs are applied in order. Headers no
+         * longer in the rpm database (\a indb_r) are dropped, too.
+         * \a drop_r and \a add_r are set to the headers to drop from the solv
+         * file and to add from the database.
+         * \return \c false if the journal and the database disagree, so a
+         * full rescan is needed.
+         */
+        bool replay( const std::set<unsigned> & insolv_r, const std::set<unsigned> & indb_r,
+                     std::set<unsigned> & drop_r, std::set<unsigned> & add_r ) const;
+
+        /** Apply the journal to \a oldsolv_r and write the result to \a newsolv_r.
+         * \return \c false if the journal and the rpm database below \a root_r
+         * disagree, so a full rescan is needed.
+         * \throws Exception if reading or writing the solv files fails.
+         */
+        bool apply( const Pathname & root_r, const Pathname & oldsolv_r, const Pathname & newsolv_r ) const;
+
+      private:
+        /** Append a line to the journal, if a journal was started. */
+        void append( const std::string & line_r ) const;
+
+      private:
+        Pathname _file;
+    };
+    ///////////////////////////////////////////////////////////////////
+
+    /** \relates SolvJournal Stream output */
+    std::ostream & operator<<( std::ostream & str, const SolvJournal & obj );
+
+    /////////////////////////////////////////////////////////////////
+  } // namespace target
+  ///////////////////////////////////////////////////////////////////
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_TARGET_SOLVJOURNAL_H
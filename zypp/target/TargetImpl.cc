@@ -45,6 +45,7 @@
 #include "zypp/target/TargetCallbackReceiver.h"
 #include "zypp/target/rpm/librpmDb.h"
 #include "zypp/target/CommitPackageCache.h"
+#include "zypp/target/SolvJournal.h"
 
 #include "zypp/parser/ProductFileReader.h"
 
@@ -963,17 +964,31 @@ namespace zypp
       filesystem::recursive_rmdir( base );
     }
 
+    namespace
+    {
+      /** Status of the rpm database below \a root_r. */
+      inline RepoStatus rpmdbStatus( const Pathname & root_r )
+      { return RepoStatus( root_r/"/var/lib/rpm/Name" ); }
+
+      /** Status of the installed products below \a root_r. */
+      inline RepoStatus productsStatus( const Pathname & root_r )
+      { return RepoStatus( root_r/"/etc/products.d" ); }
+    } // namespace
+
     bool TargetImpl::buildCache()
     {
       Pathname base = solvfilesPath();
       Pathname rpmsolv       = base/"solv";
       Pathname rpmsolvcookie = base/"cookie";
+      SolvJournal journal( solvJournalPath() );
 
       bool build_rpm_solv = true;
       // lets see if the rpm solv cache exists
 
-      RepoStatus rpmstatus( RepoStatus( _root/"/var/lib/rpm/Name" )
-                            && (_root/"/etc/products.d") );
+      RepoStatus dbstatus( rpmdbStatus( _root ) );
+      RepoStatus prodstatus( productsStatus( _root ) );
+      RepoStatus rpmstatus( dbstatus && prodstatus );
+      RepoStatus solvstatus;
 
       bool solvexisted = PathInfo(rpmsolv).isExist();
       if ( solvexisted )
@@ -984,6 +999,7 @@ namespace zypp
         if ( cookie.isExist() )
         {
           RepoStatus status = RepoStatus::fromCookieFile(rpmsolvcookie);
+          solvstatus = status;
           // now compare it with the rpm database
           if ( status.checksum() == rpmstatus.checksum() )
             build_rpm_solv = false;
@@ -1040,36 +1056,57 @@ namespace zypp
         // Take care we unlink the solvfile on exception
         ManagedFile guard( base, filesystem::recursive_rmdir );
 
-        std::ostringstream cmd;
-        cmd << "rpmdb2solv";
-        if ( ! _root.empty() )
-          cmd << " -r '" << _root << "'";
+        // If the changes since the last build are journaled, update the
+        // solv file instead of rescanning the whole database.
+        bool journalApplied = false;
+        if ( ! oldSolvFile.empty() && journal.applicable( solvstatus, dbstatus, prodstatus ) )
+        {
+          try
+          {
+            journalApplied = journal.apply( _root, oldSolvFile, tmpsolv.path() );
+          }
+          catch ( const Exception & excpt )
+          {
+            ZYPP_CAUGHT( excpt );
+          }
+          if ( ! journalApplied )
+            WAR << "Journal and rpm database disagree. Rescanning the database." << endl;
+        }
+        journal.discard();
 
-        cmd << " -p '" << Pathname::assertprefix( _root, "/etc/products.d" ) << "'";
+        if ( ! journalApplied )
+        {
+          std::ostringstream cmd;
+          cmd << "rpmdb2solv";
+          if ( ! _root.empty() )
+            cmd << " -r '" << _root << "'";
 
-        if ( ! oldSolvFile.empty() )
-          cmd << " '" << oldSolvFile << "'";
+          cmd << " -p '" << Pathname::assertprefix( _root, "/etc/products.d" ) << "'";
 
-        cmd << "  > '" << tmpsolv.path() << "'";
+          if ( ! oldSolvFile.empty() )
+            cmd << " '" << oldSolvFile << "'";
 
-        MIL << "Executing: " << cmd << endl;
-        ExternalProgram prog( cmd.str(), ExternalProgram::Stderr_To_Stdout );
+          cmd << "  > '" << tmpsolv.path() << "'";
 
-        cmd << endl;
-        for ( std::string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-          WAR << "  " << output;
-          cmd << "     " << output;
-        }
+          MIL << "Executing: " << cmd << endl;
+          ExternalProgram prog( cmd.str(), ExternalProgram::Stderr_To_Stdout );
 
-        int ret = prog.close();
-        if ( ret != 0 )
-        {
-          Exception ex(str::form("Failed to cache rpm database (%d).", ret));
-          ex.remember( cmd.str() );
-          ZYPP_THROW(ex);
+          cmd << endl;
+          for ( std::string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
+            WAR << "  " << output;
+            cmd << "     " << output;
+          }
+
+          int ret = prog.close();
+          if ( ret != 0 )
+          {
+            Exception ex(str::form("Failed to cache rpm database (%d).", ret));
+            ex.remember( cmd.str() );
+            ZYPP_THROW(ex);
+          }
         }
 
-        ret = filesystem::rename( tmpsolv, rpmsolv );
+        int ret = filesystem::rename( tmpsolv, rpmsolv );
         if ( ret != 0 )
           ZYPP_THROW(Exception("Failed to move cache to final destination"));
         // if this fails, don't bother throwing exceptions
@@ -1437,7 +1474,19 @@ namespace zypp
         }
         else if ( ! policy_r.dryRun() )
         {
+          // Journal the rpm database changes, so buildCache is able to
+          // update the solv file instead of rescanning the database.
+          SolvJournal journal( solvJournalPath() );
+          journal.discard();
+          RepoStatus prodstatus( productsStatus( _root ) );
+          RepoStatus solvstatus( RepoStatus::fromCookieFile( solvfilesPath()/"cookie" ) );
+          if ( PathInfo( solvfilesPath()/"solv" ).isFile()
+               && solvstatus.checksum() == ( rpmdbStatus( _root ) && prodstatus ).checksum() )
+            journal.start( solvstatus, prodstatus );
+
           commit( policy_r, packageCache, result );
+
+          journal.finish( rpmdbStatus( _root ) );
         }
         else
         {
@@ -1482,11 +1531,20 @@ namespace zypp
 
       bool abort = false;
       std::vector<sat::Solvable> successfullyInstalledPackages;
+      SolvJournal journal( solvJournalPath() );
       TargetImpl::PoolItemList remaining;
 
+      // All packages at once; the loop below handles the remaining resolvables.
+      if ( policy_r.singleTransaction() )
+        abort = commitInSingleTransaction( policy_r, packageCache_r, result_r, successfullyInstalledPackages );
+
       for_( step, steps.begin(), steps.end() )
       {
+        if ( abort )
+          break;
 	PoolItem citem( *step );
+	if ( policy_r.singleTransaction() && citem->isKind<Package>() )
+	  continue;
 	if ( step->stepType() == sat::Transaction::TRANSACTION_IGNORE )
 	{
 	  if ( citem->isKind<Package>() )
@@ -1604,6 +1662,20 @@ namespace zypp
               citem.status().resetTransact( ResStatus::USER );
               successfullyInstalledPackages.push_back( citem.satSolvable() );
 	      step->stepStage( sat::Transaction::STEP_DONE );
+
+              bool journaled = false;
+              rpm::librpmDb::db_const_iterator it;
+              for ( it.findPackage( p->name(), p->edition() ); *it; ++it )
+              {
+                if ( (*it)->tag_arch() == p->arch() )
+                {
+                  journal.installed( it.dbHdrNum() );
+                  journaled = true;
+                  break;
+                }
+              }
+              if ( ! journaled )
+                journal.invalidate();
             }
           }
           else
@@ -1651,6 +1723,7 @@ namespace zypp
             {
               citem.status().resetTransact( ResStatus::USER );
 	      step->stepStage( sat::Transaction::STEP_DONE );
+              journal.removed( citem.satSolvable().lookupNumAttribute( sat::SolvAttr( "rpm:dbid" ) ) );
             }
           }
         }
@@ -1724,6 +1797,243 @@ namespace zypp
       }
     }
 
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      ///////////////////////////////////////////////////////////////////
+      /// \class SingleTransactionReport
+      /// \brief Forward \ref rpm::RpmDb::runTransaction progress to the
+      /// per package install/remove receivers and do the step bookkeeping.
+      ///////////////////////////////////////////////////////////////////
+      struct SingleTransactionReport : public rpm::RpmDb::TransactionReport
+      {
+        typedef ZYppCommitResult::TransactionStepList::iterator StepIterator;
+
+        SingleTransactionReport( const std::vector<rpm::RpmDb::TransactionElement> & elements_r,
+                                 const std::vector<StepIterator> & steps_r )
+        : _elements( elements_r )
+        , _steps( steps_r )
+        , _aborted( false )
+        {}
+
+        virtual void start( unsigned idx_r )
+        {
+          PoolItem citem( *_steps[idx_r] );
+          if ( _elements[idx_r].file.empty() )
+          {
+            _remove.reset( new RpmRemovePackageReceiver( citem.resolvable() ) );
+            _remove->start( _elements[idx_r].erase );
+          }
+          else
+          {
+            _install.reset( new RpmInstallPackageReceiver( citem.resolvable() ) );
+            _install->tryLevel( target::rpm::InstallResolvableReport::RPM_NODEPS_FORCE );
+            _install->start( _elements[idx_r].file );
+          }
+        }
+
+        virtual void progress( unsigned idx_r, unsigned percent_r )
+        {
+          // librpm can't be interrupted; an abort takes effect after the transaction.
+          if ( _install )
+            _install->progress( percent_r );
+          else if ( _remove )
+            _remove->progress( percent_r );
+        }
+
+        virtual void finish( unsigned idx_r, const std::string & error_r, const std::string & info_r )
+        {
+          if ( ! _install && ! _remove )
+            start( idx_r );	// rpm did not process it
+
+          PoolItem citem( *_steps[idx_r] );
+          StepIterator step( _steps[idx_r] );
+          std::string name( _elements[idx_r].file.empty() ? _elements[idx_r].erase : _elements[idx_r].file.basename() );
+
+          if ( ! info_r.empty() )
+          {
+            // TranslatorExplanation Text is followed by a ':'  and the actual output.
+            std::string info( str::form( "%s:\n%s\n", _("Additional rpm output"),  info_r.c_str() ) );
+            if ( _install )
+              _install->finishInfo( info );
+            else
+              _remove->finishInfo( info );
+          }
+
+          if ( error_r.empty() )
+          {
+            if ( _install )
+            {
+              _install->finish();
+              HistoryLog().install( citem );
+              _installed.push_back( idx_r );
+            }
+            else
+            {
+              _remove->finish();
+              HistoryLog().remove( citem );
+              _removed.push_back( idx_r );
+            }
+            citem.status().resetTransact( ResStatus::USER );
+            step->stepStage( sat::Transaction::STEP_DONE );
+          }
+          else
+          {
+            rpm::RpmSubprocessException excpt( error_r );
+            if ( _install )
+              _install->finish( excpt );
+            else
+              _remove->finish( excpt );
+            HistoryLog().comment( str::form( "%s %s failed", name.c_str(), ( _install ? "install" : "remove" ) ), true /*timestamp*/ );
+            HistoryLog().comment( "rpm output:\n" + error_r + "\n" + info_r );
+            step->stepStage( sat::Transaction::STEP_ERROR );
+            _failed.push_back( idx_r );
+          }
+
+          if ( ( _install && _install->aborted() ) || ( _remove && _remove->aborted() ) )
+            _aborted = true;
+          _install.reset();
+          _remove.reset();
+        }
+
+        const std::vector<rpm::RpmDb::TransactionElement> & _elements;
+        const std::vector<StepIterator> & _steps;
+        shared_ptr<RpmInstallPackageReceiver> _install;
+        shared_ptr<RpmRemovePackageReceiver> _remove;
+        std::vector<unsigned> _installed;	///< successfully installed elements
+        std::vector<unsigned> _removed;		///< successfully removed elements
+        std::vector<unsigned> _failed;		///< elements failed to install or remove
+        bool _aborted;
+      };
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    bool TargetImpl::commitInSingleTransaction( const ZYppCommitPolicy & policy_r,
+                                                CommitPackageCache & packageCache_r,
+                                                ZYppCommitResult & result_r,
+                                                std::vector<sat::Solvable> & successfullyInstalledPackages_r )
+    {
+      ZYppCommitResult::TransactionStepList & steps( result_r.rTransactionStepList() );
+      MIL << "TargetImpl::commitInSingleTransaction(" << policy_r << ")" << steps.size() << endl;
+
+      std::vector<rpm::RpmDb::TransactionElement> elements;
+      std::vector<SingleTransactionReport::StepIterator> elementSteps;
+      std::vector<ManagedFile> localfiles; // per element; keep them until rpm is done
+
+      for_( step, steps.begin(), steps.end() )
+      {
+        PoolItem citem( *step );
+        if ( ! citem->isKind<Package>() )
+          continue;
+
+        if ( step->stepType() == sat::Transaction::TRANSACTION_IGNORE )
+        {
+          // for packages this means being obsoleted (by rpm)
+          // thius no additional action is needed.
+          step->stepStage( sat::Transaction::STEP_DONE );
+          continue;
+        }
+
+        Package::constPtr p = citem->asKind<Package>();
+        if ( citem.status().isToBeInstalled() )
+        {
+          ManagedFile localfile;
+          try
+          {
+            localfile = packageCache_r.get( citem );
+          }
+          catch ( const AbortRequestException &e )
+          {
+            WAR << "commit aborted by the user" << endl;
+            step->stepStage( sat::Transaction::STEP_ERROR );
+            return true;
+          }
+          catch ( const SkipRequestException &e )
+          {
+            ZYPP_CAUGHT( e );
+            WAR << "Skipping package " << p << " in commit" << endl;
+            step->stepStage( sat::Transaction::STEP_ERROR );
+            continue;
+          }
+          catch ( const Exception &e )
+          {
+            ZYPP_CAUGHT( e );
+            INT << "Unexpected Error: Skipping package " << p << " in commit" << endl;
+            step->stepStage( sat::Transaction::STEP_ERROR );
+            continue;
+          }
+          elements.push_back( rpm::RpmDb::TransactionElement( localfile, p->multiversionInstall() ) );
+          localfiles.push_back( localfile );
+        }
+        else
+        {
+          // 'rpm -e' does not like epochs
+          elements.push_back( rpm::RpmDb::TransactionElement( p->name()
+                                                              + "-" + p->edition().version()
+                                                              + "-" + p->edition().release()
+                                                              + "." + p->arch().asString() ) );
+          localfiles.push_back( ManagedFile() );
+        }
+        elementSteps.push_back( step );
+      }
+
+      if ( elements.empty() )
+        return false;
+
+      rpm::RpmInstFlags flags( policy_r.rpmInstFlags() & rpm::RPMINST_JUSTDB );
+      // See commit: zypp asserts the dependencies, rpm just unpacks.
+      flags |= rpm::RPMINST_NODEPS;
+      flags |= rpm::RPMINST_FORCE;
+      if (policy_r.rpmExcludeDocs()) flags |= rpm::RPMINST_EXCLUDEDOCS;
+      if (policy_r.rpmNoSignature()) flags |= rpm::RPMINST_NOSIGNATURE;
+
+      SingleTransactionReport report( elements, elementSteps );
+      try
+      {
+        rpm().runTransaction( elements, flags, report );
+      }
+      catch ( const Exception & excpt )
+      {
+        ZYPP_CAUGHT( excpt );
+        ERR << "Single rpm transaction failed." << endl;
+        for_( it, elementSteps.begin(), elementSteps.end() )
+          (*it)->stepStage( sat::Transaction::STEP_ERROR );
+        for_( it, localfiles.begin(), localfiles.end() )
+          it->resetDispose(); // keep the package files in the cache
+        return false;
+      }
+
+      for_( it, report._failed.begin(), report._failed.end() )
+        localfiles[*it].resetDispose(); // keep the package file in the cache
+
+      SolvJournal journal( solvJournalPath() );
+      for_( it, report._installed.begin(), report._installed.end() )
+      {
+        PoolItem citem( *elementSteps[*it] );
+        successfullyInstalledPackages_r.push_back( citem.satSolvable() );
+
+        bool journaled = false;
+        rpm::librpmDb::db_const_iterator dbit;
+        for ( dbit.findPackage( citem->name(), citem->edition() ); *dbit; ++dbit )
+        {
+          if ( (*dbit)->tag_arch() == citem->arch() )
+          {
+            journal.installed( dbit.dbHdrNum() );
+            journaled = true;
+            break;
+          }
+        }
+        if ( ! journaled )
+          journal.invalidate();
+      }
+      for_( it, report._removed.begin(), report._removed.end() )
+        journal.removed( elementSteps[*it]->satSolvable().lookupNumAttribute( sat::SolvAttr( "rpm:dbid" ) ) );
+
+      if ( report._aborted )
+        WAR << "commit aborted by the user" << endl;
+      return report._aborted;
+    }
+
     ///////////////////////////////////////////////////////////////////
 
     rpm::RpmDb & TargetImpl::rpm()
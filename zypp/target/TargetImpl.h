@@ -101,6 +101,10 @@ namespace zypp
 
       Pathname _tmpSolvfilesPath;
 
+      /** The journal of rpm database changes done by commit (\see \ref SolvJournal). */
+      Pathname solvJournalPath() const
+      { return solvfilesPath() / "journal"; }
+
     public:
       void load( bool force = true );
 
@@ -201,6 +205,14 @@ namespace zypp
 		   CommitPackageCache & packageCache_r,
 		   ZYppCommitResult & result_r );
 
+      /** Commit all packages in a single rpm transaction (internal helper).
+       * \return Whether the commit was aborted.
+       */
+      bool commitInSingleTransaction( const ZYppCommitPolicy & policy_r,
+                                      CommitPackageCache & packageCache_r,
+                                      ZYppCommitResult & result_r,
+                                      std::vector<sat::Solvable> & successfullyInstalledPackages_r );
+
     protected:
       /** Path to the target */
       Pathname _root;
@@ -16,7 +16,11 @@ extern "C"
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <vector>
+#include <set>
+#include <algorithm>
+#include <unordered_map>
 
 #undef ZYPP_BASE_LOGGER_LOGGROUP
 #define ZYPP_BASE_LOGGER_LOGGROUP "MODALIAS"
@@ -26,6 +30,9 @@ extern "C"
 #include "zypp/base/InputStream.h"
 #include "zypp/AutoDispose.h"
 #include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+#include "zypp/Digest.h"
+#include "zypp/ZConfig.h"
 
 #include "zypp/target/modalias/Modalias.h"
 
@@ -86,6 +93,77 @@ namespace zypp
 	  }
 	}
       }
+
+      /** Where the result of the /sys scan is remembered. */
+      inline Pathname cacheFile()
+      { return ZConfig::instance().repoCachePath() / "modalias.cache"; }
+
+      /** Fingerprint of the devices present since boot.
+       * Computed from the boot id, the device links below \c /sys/bus/\*\/devices
+       * and the udev database (which changes on hotplug). This is much cheaper
+       * than the full scan. Empty if the boot id is not available.
+       */
+      std::string sysfsFingerprint()
+      {
+	std::ifstream bootid( "/proc/sys/kernel/random/boot_id" );
+	std::string line( iostr::getline( bootid ) );
+	if ( line.empty() )
+	  return std::string();
+
+	std::set<std::string> devices;
+	filesystem::dirForEach( "/sys/bus",
+				[&devices]( const Pathname & dir_r, const char *const bus_r )->bool
+				{
+				  filesystem::dirForEach( dir_r / bus_r / "devices",
+							  [&devices,bus_r]( const Pathname &, const char *const dev_r )->bool
+							  {
+							    devices.insert( std::string( bus_r ) + '/' + dev_r );
+							    return true;
+							  } );
+				  return true;
+				} );
+
+	std::ostringstream str;
+	str << line << endl << PathInfo( "/run/udev/data" ).mtime() << endl;
+	for_( it, devices.begin(), devices.end() )
+	  str << *it << endl;
+	return Digest::digest( "sha1", str.str() );
+      }
+
+      /** Read the modaliases remembered for \a fingerprint_r. */
+      bool readCache( const std::string & fingerprint_r, Modalias::ModaliasList & arg )
+      {
+	std::ifstream str( cacheFile().c_str() );
+	if ( ! str || iostr::getline( str ) != "#"+fingerprint_r )
+	  return false;
+
+	for ( std::string line( iostr::getline( str ) ); str; line = iostr::getline( str ) )
+	{
+	  if ( ! line.empty() )
+	    arg.push_back( line );
+	}
+	return true;
+      }
+
+      /** Remember the modaliases for \a fingerprint_r (if the cache dir exists). */
+      void writeCache( const std::string & fingerprint_r, const Modalias::ModaliasList & arg )
+      {
+	Pathname file( cacheFile() );
+	if ( ! PathInfo( file.dirname() ).isDir() )
+	  return;
+
+	filesystem::TmpFile tmp( filesystem::TmpFile::makeSibling( file ) );
+	{
+	  std::ofstream str( tmp.path().c_str() );
+	  str << '#' << fingerprint_r << endl;
+	  for_( it, arg.begin(), arg.end() )
+	    str << *it << endl;
+	  if ( ! str )
+	    return;
+	}
+	if ( filesystem::rename( tmp.path(), file ) == 0 )
+	  tmp.autoCleanup( false );
+      }
     } // namespace
     ///////////////////////////////////////////////////////////////////
 
@@ -115,6 +193,7 @@ namespace zypp
 		                  this->_modaliases.push_back( line_r );
 			          return true;
 				} );
+	    buildIndex();
 	    return;
 	  }
 	  DBG << "Using $ZYPP_MODALIAS_SYSFS: " << dir << endl;
@@ -122,10 +201,26 @@ namespace zypp
 	else
 	{
 	  dir = "/sys";
+	  std::string fingerprint( sysfsFingerprint() );
+	  if ( ! fingerprint.empty() )
+	  {
+	    if ( readCache( fingerprint, _modaliases ) )
+	    {
+	      DBG << "Using cached /sys scan " << cacheFile() << endl;
+	      buildIndex();
+	      return;
+	    }
+	    DBG << "Using /sys directory." << endl;
+	    foreach_file_recursive( dir, _modaliases );
+	    writeCache( fingerprint, _modaliases );
+	    buildIndex();
+	    return;
+	  }
 	  DBG << "Using /sys directory." << endl;
 	}
 
 	foreach_file_recursive( dir, _modaliases );
+	buildIndex();
       }
 
       /** Dtor. */
@@ -148,13 +243,48 @@ namespace zypp
        */
       bool query( const char * cap_r ) const
       {
-	if ( cap_r && *cap_r )
+	if ( ! ( cap_r && *cap_r ) )
+	  return false;
+
+	// Patterns are queried repeatedly while the solver builds its index.
+	std::unordered_map<std::string,bool>::const_iterator it( _matches.find( cap_r ) );
+	if ( it != _matches.end() )
+	  return it->second;
+	return( _matches[cap_r] = lookup( cap_r ) );
+      }
+
+      /** Replace the list of modaliases. */
+      void modaliasList( ModaliasList newlist_r )
+      {
+	_modaliases.swap( newlist_r );
+	buildIndex();
+      }
+
+    private:
+      /** Sort the modaliases for \ref lookup and forget former results. */
+      void buildIndex()
+      {
+	_index = _modaliases;
+	std::sort( _index.begin(), _index.end() );
+	_index.erase( std::unique( _index.begin(), _index.end() ), _index.end() );
+	_matches.clear();
+      }
+
+      /** Only devices starting with the literal prefix of \a cap_r (bus, vendor,...)
+       * can match the pattern. Those are adjacent in the sorted \ref _index.
+       */
+      bool lookup( const char * cap_r ) const
+      {
+	const char * wildcard = ::strpbrk( cap_r, "*?[\\" );
+	if ( ! wildcard )
+	  return std::binary_search( _index.begin(), _index.end(), std::string( cap_r ) );
+
+	std::string prefix( cap_r, wildcard - cap_r );
+	for ( ModaliasList::const_iterator it = std::lower_bound( _index.begin(), _index.end(), prefix );
+	      it != _index.end() && str::hasPrefix( *it, prefix ); ++it )
 	{
-	  for_( it, _modaliases.begin(), _modaliases.end() )
-	  {
-	    if ( fnmatch( cap_r, (*it).c_str(), 0 ) == 0 )
-	      return true;
-	  }
+	  if ( fnmatch( cap_r, (*it).c_str(), 0 ) == 0 )
+	    return true;
 	}
 	return false;
       }
@@ -162,6 +292,10 @@ namespace zypp
     public:
       ModaliasList _modaliases;
 
+    private:
+      ModaliasList _index;					//!< sorted and unique _modaliases
+      mutable std::unordered_map<std::string,bool> _matches;	//!< query results
+
     public:
       /** Offer default Impl. */
       static shared_ptr<Impl> nullimpl()
@@ -208,7 +342,7 @@ namespace zypp
     { return _pimpl->_modaliases; }
 
     void Modalias::modaliasList( ModaliasList newlist_r )
-    { _pimpl->_modaliases.swap( newlist_r ); }
+    { _pimpl->modaliasList( newlist_r ); }
 
     std::ostream & operator<<( std::ostream & str, const Modalias & obj )
     { return str << *obj._pimpl; }
@@ -31,6 +31,11 @@ namespace zypp
     //	CLASS NAME : Modalias
     //
     /** Hardware abstaction layer singleton.
+     *
+     * The modaliases found below \c /sys are remembered in
+     * \c modalias.cache in the \ref ZConfig::repoCachePath. The cache
+     * is reused as long as the boot id, the devices listed in
+     * \c /sys/bus/\*\/devices and the udev database do not change.
      */
     class Modalias
     {
@@ -2123,6 +2123,387 @@ void RpmDb::doRemovePackage( const string & name_r, RpmInstFlags flags, callback
   }
 }
 
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  /** State of a \ref RpmDb::runTransaction passed to the librpm callbacks. */
+  struct TransactionCbData
+  {
+    TransactionCbData( const std::vector<RpmDb::TransactionElement> & elements_r, RpmDb::TransactionReport & report_r )
+    : elements( elements_r )
+    , report( report_r )
+    , fd( 0 )
+    , current( -1 )
+    , pending( -1 )
+    , tes( elements_r.size() )
+    , instances( elements_r.size(), 0 )
+    , started( elements_r.size(), false )
+    , closed( elements_r.size(), false )
+    , error( elements_r.size() )
+    , message( elements_r.size() )
+    {}
+
+    /** Element index of a callback; -1 if not ours (e.g. erasure on upgrade). */
+    int index( const void * hd_r, fnpyKey key_r ) const
+    {
+      if ( key_r )
+        return int( reinterpret_cast<intptr_t>( key_r ) ) - 1;
+      if ( hd_r )
+      {
+        std::map<unsigned,unsigned>::const_iterator it( eraseIdx.find( ::headerGetInstance( (Header)hd_r ) ) );
+        if ( it != eraseIdx.end() )
+          return it->second;
+      }
+      return -1;
+    }
+
+    /** Element index of a transaction element; -1 if not ours. */
+    int index( rpmte te_r ) const
+    {
+      if ( ::rpmteKey( te_r ) )
+        return index( 0, ::rpmteKey( te_r ) );
+      std::map<unsigned,unsigned>::const_iterator it( eraseIdx.find( ::rpmteDBInstance( te_r ) ) );
+      return( it != eraseIdx.end() ? int(it->second) : -1 );
+    }
+
+    void start( int idx_r )
+    {
+      current = idx_r;
+      if ( idx_r < 0 || started[idx_r] )
+        return;
+      started[idx_r] = true;
+      report.start( idx_r );
+    }
+
+    void progress( int idx_r, rpm_loff_t amount_r, rpm_loff_t total_r )
+    {
+      if ( idx_r < 0 || ! total_r )
+        return;
+      report.progress( idx_r, unsigned( amount_r * 100 / total_r ) );
+    }
+
+    void fail( int idx_r, const std::string & error_r )
+    {
+      if ( idx_r < 0 )
+        return;
+      if ( error[idx_r].empty() )
+        error[idx_r] = error_r;
+      close( idx_r, true );
+    }
+
+    /** Element closed by rpm. If \a all_r, all of its db instances.
+     * rpm marks an element as failed only after closing it (e.g. if
+     * \c %pre failed), so it is reported by the next \ref flush.
+     */
+    void close( int idx_r, bool all_r = false )
+    {
+      if ( idx_r < 0 || closed[idx_r] )
+        return;
+      if ( ! all_r && instances[idx_r] > 1 )
+      {
+        --instances[idx_r];
+        return;
+      }
+      flush();
+      closed[idx_r] = true;
+      pending = idx_r;
+    }
+
+    /** Report the closed element, if any. Call as soon as rpm
+     * moved on to the next element, and after the transaction.
+     */
+    void flush()
+    {
+      if ( pending < 0 )
+        return;
+      int idx = pending;
+      pending = -1;
+      if ( error[idx].empty() && failed( idx ) )
+        // TranslatorExplanation the colon is followed by an error message
+        error[idx] = string(_("RPM failed: ")) + _("Installing or removing the package failed.");
+      if ( current == idx )
+        current = -1;
+      report.finish( idx, error[idx], message[idx] );
+    }
+
+    /** Whether rpm marked any of the elements db instances as failed. */
+    bool failed( int idx_r ) const
+    {
+      for_( it, tes[idx_r].begin(), tes[idx_r].end() )
+      {
+        if ( ::rpmteFailed( *it ) )
+          return true;
+      }
+      return false;
+    }
+
+    const std::vector<RpmDb::TransactionElement> & elements;
+    RpmDb::TransactionReport & report;
+    std::map<unsigned,unsigned> eraseIdx;	///< db instance to erase element
+    FD_t fd;
+    int current;				///< element in progress (for log messages)
+    int pending;				///< element closed but not yet reported
+    std::vector<std::vector<rpmte> > tes;	///< rpm transaction elements per element
+    std::vector<unsigned> instances;		///< number of db instances per element
+    std::vector<bool> started;
+    std::vector<bool> closed;
+    std::vector<std::string> error;
+    std::vector<std::string> message;		///< rpm log output per element
+  };
+
+  void * transactionCallback( const void * hd, const rpmCallbackType what,
+                              const rpm_loff_t amount, const rpm_loff_t total,
+                              fnpyKey key, rpmCallbackData data )
+  {
+    TransactionCbData & cb( *static_cast<TransactionCbData*>( data ) );
+    int idx = cb.index( hd, key );
+    if ( idx >= 0 && idx != cb.pending )
+      cb.flush(); // rpm moved on
+
+    switch ( what )
+    {
+      case RPMCALLBACK_INST_OPEN_FILE:
+        if ( idx < 0 )
+          return 0;
+        cb.fd = ::Fopen( cb.elements[idx].file.c_str(), "r.ufdio" );
+        if ( ! cb.fd || ::Ferror( cb.fd ) )
+        {
+          cb.fail( idx, str::form( _("Can't open file '%s' for reading."), cb.elements[idx].file.c_str() ) );
+          if ( cb.fd )
+            ::Fclose( cb.fd );
+          cb.fd = 0;
+        }
+        return cb.fd;
+        break;
+
+      case RPMCALLBACK_INST_CLOSE_FILE:
+        if ( cb.fd )
+        {
+          ::Fclose( cb.fd );
+          cb.fd = 0;
+        }
+        cb.close( idx );
+        break;
+
+      case RPMCALLBACK_INST_START:
+      case RPMCALLBACK_UNINST_START:
+        cb.start( idx );
+        break;
+
+      case RPMCALLBACK_INST_PROGRESS:
+      case RPMCALLBACK_UNINST_PROGRESS:
+        cb.progress( idx, amount, total );
+        break;
+
+      case RPMCALLBACK_UNINST_STOP:
+        cb.close( idx );
+        break;
+
+      case RPMCALLBACK_UNPACK_ERROR:
+      case RPMCALLBACK_CPIO_ERROR:
+        cb.fail( idx, _("Unpacking the package failed.") );
+        break;
+
+      case RPMCALLBACK_SCRIPT_ERROR:
+        // total is RPMRC_OK if the scriptlet is not critical (just a warning)
+        if ( total != RPMRC_OK )
+          cb.fail( idx, _("A package scriptlet failed.") );
+        break;
+
+      default:
+        break;
+    }
+    return 0;
+  }
+
+  /** Collect rpm log messages per transaction element. */
+  int transactionLogCallback( rpmlogRec rec, rpmlogCallbackData data )
+  {
+    TransactionCbData & cb( *static_cast<TransactionCbData*>( data ) );
+    std::string msg( ::rpmlogRecMessage( rec ) );
+    if ( ::rpmlogRecPriority( rec ) == RPMLOG_WARNING )
+      msg = "warning: " + msg;
+    WAR << "  " << msg;
+    if ( cb.current >= 0 )
+      cb.message[cb.current] += msg;
+    return 0; // don't print it
+  }
+} // namespace
+///////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////
+//
+//
+//	METHOD NAME : RpmDb::runTransaction
+//	METHOD TYPE : void
+//
+void RpmDb::runTransaction( const std::vector<TransactionElement> & elements_r, RpmInstFlags flags,
+                            TransactionReport & report_r )
+{
+  FAILIFNOTINITIALIZED;
+  MIL << "RpmDb::runTransaction(" << elements_r.size() << " elements," << flags << ")" << endl;
+
+  if ( _packagebackups )
+  {
+    for_( it, elements_r.begin(), elements_r.end() )
+    {
+      if ( ! ( it->file.empty() ? backupPackage( it->erase ) : backupPackage( it->file ) ) )
+        ERR << "backup of " << ( it->file.empty() ? it->erase : it->file.asString() ) << " failed" << endl;
+    }
+  }
+
+  // Invalidate all outstanding database handles, as the database gets modified.
+  librpmDb::dbRelease( true );
+  librpmDb::globalInit();
+  ::addMacro( NULL, "_dbpath", NULL, _dbPath.asString().c_str(), RMIL_CMDLINE );
+
+  rpmts ts = ::rpmtsCreate();
+  ::rpmtsSetRootDir( ts, _root.asString().c_str() );
+  if ( ::rpmtsOpenDB( ts, O_RDWR ) != 0 )
+  {
+    ::rpmtsFree( ts );
+    ZYPP_THROW( RpmDbOpenException( _root, _dbPath ) );
+  }
+
+  rpmVSFlags vsflags = RPMVSF_DEFAULT;
+  if ( flags & RPMINST_NODIGEST )
+    vsflags |= _RPMVSF_NODIGESTS;
+  if ( flags & RPMINST_NOSIGNATURE )
+    vsflags |= _RPMVSF_NOSIGNATURES;
+  ::rpmtsSetVSFlags( ts, vsflags );
+
+  rpmtransFlags tflags = RPMTRANS_FLAG_NONE;
+  if ( flags & RPMINST_EXCLUDEDOCS )
+    tflags |= RPMTRANS_FLAG_NODOCS;
+  if ( flags & RPMINST_NOSCRIPTS )
+    tflags |= RPMTRANS_FLAG_NOSCRIPTS;
+  if ( flags & RPMINST_JUSTDB )
+    tflags |= RPMTRANS_FLAG_JUSTDB;
+  if ( flags & RPMINST_TEST )
+    tflags |= RPMTRANS_FLAG_TEST;
+  ::rpmtsSetFlags( ts, tflags );
+
+  rpmprobFilterFlags pflags = RPMPROB_FILTER_NONE;
+  if ( flags & RPMINST_FORCE )
+    pflags |= RPMPROB_FILTER_REPLACEPKG | RPMPROB_FILTER_REPLACENEWFILES | RPMPROB_FILTER_REPLACEOLDFILES | RPMPROB_FILTER_OLDPACKAGE;
+  if ( flags & RPMINST_IGNORESIZE )
+    pflags |= RPMPROB_FILTER_DISKSPACE | RPMPROB_FILTER_DISKNODES;
+  // ZConfig defines cross-arch installation
+  if ( ! ZConfig::instance().systemArchitecture().compatibleWith( ZConfig::instance().defaultSystemArchitecture() ) )
+    pflags |= RPMPROB_FILTER_IGNOREARCH | RPMPROB_FILTER_IGNOREOS;
+
+  TransactionCbData cb( elements_r, report_r );
+
+  // Add the elements in our order. rpmtsOrder is not called.
+  for ( unsigned idx = 0; idx < elements_r.size(); ++idx )
+  {
+    const TransactionElement & el( elements_r[idx] );
+    if ( ! el.file.empty() )
+    {
+      Header h = 0;
+      FD_t fd = ::Fopen( el.file.c_str(), "r.ufdio" );
+      int res = ( fd && ! ::Ferror( fd ) ) ? ::rpmReadPackageFile( ts, fd, el.file.c_str(), &h ) : RPMRC_FAIL;
+      if ( fd )
+        ::Fclose( fd );
+
+      if ( ( res != RPMRC_OK && res != RPMRC_NOTTRUSTED && res != RPMRC_NOKEY )
+           || ::rpmtsAddInstallElement( ts, h, (fnpyKey)(intptr_t)( idx + 1 ), ! el.noupgrade, NULL ) != 0 )
+        cb.error[idx] = str::form( _("Can't read package header of '%s'."), el.file.c_str() );
+      else
+        cb.instances[idx] = 1;
+      if ( h )
+        ::headerFree( h );
+    }
+    else
+    {
+      rpmdbMatchIterator mi = ::rpmtsInitIterator( ts, RPMDBI_LABEL, el.erase.c_str(), 0 );
+      while ( Header h = ::rpmdbNextIterator( mi ) )
+      {
+        unsigned instance = ::rpmdbGetIteratorOffset( mi );
+        if ( ::rpmtsAddEraseElement( ts, h, instance ) == 0 )
+        {
+          cb.eraseIdx[instance] = idx;
+          ++cb.instances[idx];
+        }
+      }
+      ::rpmdbFreeIterator( mi );
+      if ( ! cb.instances[idx] )
+        cb.error[idx] = str::form( _("Package %s is not installed."), el.erase.c_str() );
+    }
+  }
+
+  {
+    rpmtsi tsi = ::rpmtsiInit( ts );
+    while ( rpmte te = ::rpmtsiNext( tsi, (rpmElementTypes)0 ) )
+    {
+      int idx = cb.index( te );
+      if ( idx >= 0 )
+        cb.tes[idx].push_back( te );
+    }
+    ::rpmtsiFree( tsi );
+  }
+
+  modifyDatabase();
+  ::rpmtsSetNotifyCallback( ts, transactionCallback, &cb );
+  ::rpmlogSetCallback( transactionLogCallback, &cb );
+  int res = ::rpmtsRun( ts, NULL, pflags );
+  ::rpmlogSetCallback( NULL, NULL );
+
+  std::string problems;
+  if ( res > 0 )
+  {
+    rpmps ps = ::rpmtsProblems( ts );
+    rpmpsi psi = ::rpmpsInitIterator( ps );
+    while ( ::rpmpsNextIterator( psi ) >= 0 )
+    {
+      char * msg = ::rpmProblemString( ::rpmpsGetProblem( psi ) );
+      problems += msg;
+      problems += '\n';
+      ::free( msg );
+    }
+    ::rpmpsFreeIterator( psi );
+    ::rpmpsFree( ps );
+  }
+  MIL << "rpmtsRun returned " << res << endl;
+
+  // Whatever rpm did not process failed.
+  cb.flush();
+  for ( unsigned idx = 0; idx < elements_r.size(); ++idx )
+  {
+    if ( ! cb.closed[idx] )
+    {
+      if ( cb.error[idx].empty() )
+        // TranslatorExplanation the colon is followed by an error message
+        cb.error[idx] = string(_("RPM failed: ")) + ( problems.empty() ? _("Package was not processed.") : problems );
+      cb.fail( idx, cb.error[idx] );
+      cb.flush();
+    }
+  }
+  ::rpmtsFree( ts );
+
+  for ( unsigned idx = 0; idx < elements_r.size(); ++idx )
+  {
+    std::vector<std::string> lines;
+    str::split( cb.message[idx], std::back_inserter( lines ), "\n" );
+    for_( line, lines.begin(), lines.end() )
+    {
+      if ( line->substr(0,8) != "warning:" )
+        continue;
+      std::string name( elements_r[idx].file.empty() ? elements_r[idx].erase : elements_r[idx].file.basename() );
+      processConfigFiles(*line, name, " saved as ",
+                         // %s = filenames
+                         _("rpm saved %s as %s, but it was impossible to determine the difference"),
+                         // %s = filenames
+                         _("rpm saved %s as %s.\nHere are the first 25 lines of difference:\n"));
+      processConfigFiles(*line, name, " created as ",
+                         // %s = filenames
+                         _("rpm created %s as %s, but it was impossible to determine the difference"),
+                         // %s = filenames
+                         _("rpm created %s as %s.\nHere are the first 25 lines of difference:\n"));
+    }
+  }
+}
+
 ///////////////////////////////////////////////////////////////////
 //
 //
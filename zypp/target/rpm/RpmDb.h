@@ -470,6 +470,55 @@ public:
   void removePackage( const std::string & name_r, RpmInstFlags flags = RPMINST_NONE );
   void removePackage( Package::constPtr package, RpmInstFlags flags = RPMINST_NONE );
 
+  /** One element of a \ref runTransaction: install a rpm file or erase an installed package. */
+  struct TransactionElement
+  {
+    /** Install \a file_r (without upgrading if \a noupgrade_r, e.g. multiversion). */
+    TransactionElement( const Pathname & file_r, bool noupgrade_r = false )
+    : file( file_r ), noupgrade( noupgrade_r )
+    {}
+    /** Erase all installed packages matching \a erase_r ("name-version-release.arch"). */
+    TransactionElement( const std::string & erase_r )
+    : erase( erase_r ), noupgrade( false )
+    {}
+
+    Pathname    file;
+    std::string erase;
+    bool        noupgrade;
+  };
+
+  /** Per element progress of a \ref runTransaction.
+   * Elements are identified by their index in the element list.
+   */
+  struct TransactionReport
+  {
+    virtual ~TransactionReport() {}
+    /** Element \a idx_r is about to be processed. */
+    virtual void start( unsigned idx_r ) {}
+    /** Progress of element \a idx_r. */
+    virtual void progress( unsigned idx_r, unsigned percent_r ) {}
+    /** Element \a idx_r is done. \a error_r is empty on success,
+     * \a info_r is additional rpm output.
+     */
+    virtual void finish( unsigned idx_r, const std::string & error_r, const std::string & info_r ) {}
+  };
+
+  /** Install and erase packages in one rpm transaction.
+   *
+   * Unlike \ref installPackage and \ref removePackage, which run
+   * one rpm process per package, the whole list is handed to a
+   * single librpm transaction. The elements are processed in the given
+   * order, rpm's ordering is not used. Supported \a flags are the
+   * same as for \ref installPackage; dependencies are never checked.
+   *
+   * \ref TransactionReport::finish is called exactly once for each
+   * element, also for elements rpm did not process.
+   *
+   * \throws RpmException if the transaction could not be set up.
+   */
+  void runTransaction( const std::vector<TransactionElement> & elements_r, RpmInstFlags flags,
+                       TransactionReport & report_r );
+
   /**
    * get backup dir for rpm config files
    *
@@ -0,0 +1,205 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file zypp/thread/WorkerPool.cc
+ */
+#include <unistd.h>
+#include <iostream>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <condition_variable>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/Exception.h"
+#include "zypp/thread/WorkerPool.h"
+
+using std::endl;
+
+//////////////////////////////////////////////////////////////////////
+namespace zypp
+{ ////////////////////////////////////////////////////////////////////
+  ////////////////////////////////////////////////////////////////////
+  namespace thread
+  { //////////////////////////////////////////////////////////////////
+
+    namespace
+    {
+      /** Set in every thread started by a \ref WorkerPool. */
+      thread_local bool _isWorkerThread = false;
+    }
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class WorkerPool::Impl
+    /// \brief WorkerPool implementation.
+    ///////////////////////////////////////////////////////////////////
+    class WorkerPool::Impl : private base::NonCopyable
+    {
+    public:
+      Impl( unsigned size_r )
+      : _pending( 0 )
+      , _stop( false )
+      {
+        if ( ! size_r )
+          size_r = WorkerPool::defaultSize();
+        _threads.reserve( size_r );
+        for ( unsigned i = 0; i < size_r; ++i )
+          _threads.push_back( std::thread( &Impl::worker, this ) );
+      }
+
+      ~Impl()
+      {
+        wait();
+        {
+          std::unique_lock<std::mutex> lock( _mutex );
+          _stop = true;
+        }
+        _jobAvailable.notify_all();
+        for ( std::thread & thr : _threads )
+          thr.join();
+      }
+
+    public:
+      unsigned size() const
+      { return _threads.size(); }
+
+      unsigned pending() const
+      {
+        std::unique_lock<std::mutex> lock( _mutex );
+        return _pending;
+      }
+
+      void schedule( const Job & job_r )
+      {
+        {
+          std::unique_lock<std::mutex> lock( _mutex );
+          _queue.push_back( job_r );
+          ++_pending;
+        }
+        _jobAvailable.notify_one();
+      }
+
+      void wait()
+      {
+        std::unique_lock<std::mutex> lock( _mutex );
+        while ( _pending )
+          _allDone.wait( lock );
+      }
+
+      bool waitFor( unsigned msec_r )
+      {
+        std::unique_lock<std::mutex> lock( _mutex );
+        if ( _pending )
+          _allDone.wait_for( lock, std::chrono::milliseconds( msec_r ) );
+        return ! _pending;
+      }
+
+    private:
+      /** Thread main loop. */
+      void worker()
+      {
+        _isWorkerThread = true;
+        while ( true )
+        {
+          Job job;
+          {
+            std::unique_lock<std::mutex> lock( _mutex );
+            while ( _queue.empty() && ! _stop )
+              _jobAvailable.wait( lock );
+            if ( _queue.empty() )
+              return; // _stop
+            job.swap( _queue.front() );
+            _queue.pop_front();
+          }
+
+          try
+          {
+            job();
+          }
+          catch ( const Exception & excpt )
+          {
+            ZYPP_CAUGHT( excpt );
+            ERR << "WorkerPool job aborted by exception." << endl;
+          }
+          catch ( const std::exception & excpt )
+          {
+            ERR << "WorkerPool job aborted by exception: " << excpt.what() << endl;
+          }
+          catch ( ... )
+          {
+            ERR << "WorkerPool job aborted by unknown exception." << endl;
+          }
+
+          {
+            std::unique_lock<std::mutex> lock( _mutex );
+            if ( --_pending == 0 )
+              _allDone.notify_all();
+          }
+        }
+      }
+
+    private:
+      std::vector<std::thread>	_threads;
+      std::deque<Job>		_queue;
+      unsigned			_pending;
+      bool			_stop;
+      mutable std::mutex	_mutex;
+      std::condition_variable	_jobAvailable;
+      std::condition_variable	_allDone;
+    };
+
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	CLASS NAME : WorkerPool
+    //
+    ///////////////////////////////////////////////////////////////////
+
+    WorkerPool::WorkerPool( unsigned size_r )
+    : _pimpl( new Impl( size_r ) )
+    {}
+
+    WorkerPool::~WorkerPool()
+    {}
+
+    unsigned WorkerPool::size() const
+    { return _pimpl->size(); }
+
+    unsigned WorkerPool::pending() const
+    { return _pimpl->pending(); }
+
+    void WorkerPool::schedule( const Job & job_r )
+    { _pimpl->schedule( job_r ); }
+
+    void WorkerPool::wait()
+    { _pimpl->wait(); }
+
+    bool WorkerPool::waitFor( unsigned msec_r )
+    { return _pimpl->waitFor( msec_r ); }
+
+    unsigned WorkerPool::defaultSize()
+    {
+      long cpus = ::sysconf( _SC_NPROCESSORS_ONLN );
+      return cpus > 0 ? unsigned(cpus) : 1U;
+    }
+
+    bool WorkerPool::isWorkerThread()
+    { return _isWorkerThread; }
+
+    std::ostream & operator<<( std::ostream & str, const WorkerPool & obj )
+    {
+      return str << "WorkerPool(" << obj.size() << " threads, " << obj.pending() << " pending)";
+    }
+
+    //////////////////////////////////////////////////////////////////
+  } // namespace thread
+  ////////////////////////////////////////////////////////////////////
+  ////////////////////////////////////////////////////////////////////
+} // namespace zypp
+//////////////////////////////////////////////////////////////////////
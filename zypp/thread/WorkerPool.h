@@ -0,0 +1,113 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file zypp/thread/WorkerPool.h
+ */
+#ifndef ZYPP_THREAD_WORKERPOOL_H
+#define ZYPP_THREAD_WORKERPOOL_H
+
+#include <iosfwd>
+
+#include "zypp/base/NonCopyable.h"
+#include "zypp/base/PtrTypes.h"
+#include "zypp/base/Function.h"
+
+//////////////////////////////////////////////////////////////////////
+namespace zypp
+{ ////////////////////////////////////////////////////////////////////
+  ////////////////////////////////////////////////////////////////////
+  namespace thread
+  { //////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class WorkerPool
+    /// \brief Fixed size pool of threads processing queued jobs.
+    ///
+    /// Jobs are processed in the order they were scheduled. A job
+    /// is not supposed to throw. If it does, the exception is logged
+    /// and dropped.
+    ///
+    /// Most parts of libzypp are \b not thread safe. Jobs must not
+    /// touch the sat::Pool (\ref IdString, \ref Arch, ...), nor
+    /// any object shared with other threads, unless explicitly
+    /// documented to be thread safe.
+    ///
+    /// Code running in a worker thread does not talk to the applications
+    /// callback receivers. Every \ref callback::SendReport sent from a worker
+    /// thread is delivered to the default (no-)receiver. This way the
+    /// application never gets called from a thread it does not know of.
+    /// Interactive decisions (e.g. asking for credentials or trusting a key)
+    /// fall back to their defaults.
+    ///
+    /// \code
+    ///   thread::WorkerPool pool( 4 );
+    ///   for ( const Pathname & file : files )
+    ///     pool.schedule( [file]() { doSomething( file ); } );
+    ///   pool.wait();
+    /// \endcode
+    ///////////////////////////////////////////////////////////////////
+    class WorkerPool : private base::NonCopyable
+    {
+      friend std::ostream & operator<<( std::ostream & str, const WorkerPool & obj );
+
+    public:
+      /** A job to execute. */
+      typedef function<void()> Job;
+
+    public:
+      /** Ctor starting \a size_r worker threads.
+       * A \a size_r of \c 0 uses \ref defaultSize.
+       */
+      explicit WorkerPool( unsigned size_r = 0 );
+
+      /** Dtor waits until all scheduled jobs are done. */
+      ~WorkerPool();
+
+    public:
+      /** Number of worker threads. */
+      unsigned size() const;
+
+      /** Number of jobs scheduled but not yet finished. */
+      unsigned pending() const;
+
+      /** Append a job to the queue. */
+      void schedule( const Job & job_r );
+
+      /** Block until all scheduled jobs are finished. */
+      void wait();
+
+      /** Block until all scheduled jobs are finished, but at most
+       * \a msec_r milliseconds.
+       * \return Whether all jobs are finished.
+       */
+      bool waitFor( unsigned msec_r );
+
+    public:
+      /** The number of threads to use by default (number of online CPUs). */
+      static unsigned defaultSize();
+
+      /** Whether the calling thread is a \ref WorkerPool thread. */
+      static bool isWorkerThread();
+
+    public:
+      class Impl;                 ///< Implementation class.
+    private:
+      RW_pointer<Impl> _pimpl;    ///< Pointer to implementation.
+    };
+
+    /** \relates WorkerPool Stream output */
+    std::ostream & operator<<( std::ostream & str, const WorkerPool & obj );
+
+    //////////////////////////////////////////////////////////////////
+  } // namespace thread
+  ////////////////////////////////////////////////////////////////////
+  ////////////////////////////////////////////////////////////////////
+} // namespace zypp
+//////////////////////////////////////////////////////////////////////
+
+#endif // ZYPP_THREAD_WORKERPOOL_H